@@ -44,6 +44,8 @@
 #include "Windows/mainwindow.h"
 #include "Utils/info.h"
 
+#include <fiff/fiff_stream.h>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -63,6 +65,7 @@
 //=============================================================================================================
 
 using namespace MNEBROWSE;
+using namespace FIFFLIB;
 
 
 //*************************************************************************************************************
@@ -117,6 +120,9 @@ int main(int argc, char *argv[])
     QCoreApplication::setOrganizationName(CInfo::OrganizationName());
     QCoreApplication::setApplicationName(CInfo::AppNameShort());
 
+    //cache the tag directory of files without one, so that they are not scanned again the next time they are opened
+    FiffStream::set_dir_cache_enabled(true);
+
     //show splash screen for 1 second
     QPixmap pixmap(":/Resources/Images/splashscreen_mne_browse.png");
     QSplashScreen splash(pixmap);
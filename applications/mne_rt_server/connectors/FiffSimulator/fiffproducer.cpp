@@ -87,6 +87,13 @@ FiffProducer::~FiffProducer()
 bool FiffProducer::stop()
 {
     m_bIsRunning = false;
+
+    if(m_pFiffSimulator->m_pRawMatrixBuffer)
+    {
+        //In case the semaphore blocks the thread -> Release the QSemaphore and let it exit from the push function (acquire statement)
+        m_pFiffSimulator->m_pRawMatrixBuffer->releaseFromPush();
+    }
+
     QThread::wait();
 
     return true;
@@ -110,7 +117,18 @@ void FiffProducer::run()
     fiff_int_t from = m_pFiffSimulator->m_RawInfo.first_samp;
     fiff_int_t to = m_pFiffSimulator->m_RawInfo.last_samp;
 //    float quantum_sec = (float)uiSamplePeriod/1000000.0f; //read and write in 10 sec junks
-    fiff_int_t quantum = m_pFiffSimulator->m_uiBufferSampleSize;//ceil(quantum_sec*m_pFiffSimulator->m_pRawInfo->info.sfreq);
+    fiff_int_t t_iBufferSize = m_pFiffSimulator->m_uiBufferSampleSize;
+
+    //
+    // Read about one second per read_raw_segment call and hand it out buffer by buffer, the circular buffer
+    // holds the prefetch time and blocks the reader as soon as it is that far ahead of the playback
+    //
+    fiff_int_t t_iBuffersPerRead = (fiff_int_t)(m_pFiffSimulator->m_TrueSamplingRate/t_iBufferSize);
+    t_iBuffersPerRead = qMin(t_iBuffersPerRead, (fiff_int_t)m_pFiffSimulator->m_pRawMatrixBuffer->size()/2);
+    t_iBuffersPerRead = qMin(t_iBuffersPerRead, (to - from + 1)/t_iBufferSize);
+    t_iBuffersPerRead = qMax(t_iBuffersPerRead, 1);
+
+    fiff_int_t quantum = t_iBuffersPerRead*t_iBufferSize;//ceil(quantum_sec*m_pFiffSimulator->m_pRawInfo->info.sfreq);
 
     qDebug() << "quantum " << quantum;
 
@@ -136,9 +154,6 @@ void FiffProducer::run()
 //    for(qint32 i = 0; i < nchan; ++i)
 //        inv_calsMat.insert(i, i) = 1.0f/m_pFiffSimulator->m_RawInfo.info.chs[i].cal;
 
-    //Not good cause production time is not accurate
-    //loading and thread sleep is longer than thread sleep time - better to have a extra loading thread
-    // ToDo restructure this producer as laoding buffer --> and thread sleep to simulator buffer
     fiff_int_t t_iDiff;
     bool t_bRestart = false;
 
@@ -193,7 +208,11 @@ void FiffProducer::run()
         }
 
         // call blocks until there is free space in the buffer
-        m_pFiffSimulator->m_pRawMatrixBuffer->push(&tmp);
+        for(fiff_int_t i = 0; i < t_iBuffersPerRead && m_bIsRunning; ++i)
+        {
+            MatrixXf t_matBuffer = tmp.middleCols(i*t_iBufferSize, t_iBufferSize);
+            m_pFiffSimulator->m_pRawMatrixBuffer->push(&t_matBuffer);
+        }
     }
 
     // close datastream in this thread
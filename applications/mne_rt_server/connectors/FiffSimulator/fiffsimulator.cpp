@@ -78,6 +78,9 @@
 #include <QFile>
 #include <QCoreApplication>
 #include <QDebug>
+#include <QElapsedTimer>
+#include <QMutexLocker>
+#include <QtMath>
 
 
 //*************************************************************************************************************
@@ -89,6 +92,21 @@ using namespace FIFFSIMULATORPLUGIN;
 using namespace FIFFLIB;
 using namespace MNELIB;
 
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+namespace
+{
+
+// If the playback falls further behind than this, the clock is reset instead of catching up with a burst
+const double c_dMaxLagSeconds = 0.5;
+
+} // NAMESPACE
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER CONSTANTS
@@ -99,6 +117,9 @@ const QString FiffSimulator::Commands::GETBUFSIZE   = "getbufsize";
 const QString FiffSimulator::Commands::ACCEL        = "accel";
 const QString FiffSimulator::Commands::GETACCEL     = "getaccel";
 const QString FiffSimulator::Commands::SIMFILE      = "simfile";
+const QString FiffSimulator::Commands::FAST         = "fast";
+const QString FiffSimulator::Commands::PREFETCH     = "prefetch";
+const QString FiffSimulator::Commands::GETRATE      = "getrate";
 
 
 //*************************************************************************************************************
@@ -114,6 +135,9 @@ FiffSimulator::FiffSimulator()
 , m_TrueSamplingRate(0.0)
 , m_pRawMatrixBuffer(NULL)
 , m_bIsRunning(false)
+, m_bFastMode(false)
+, m_fPrefetchSeconds(2.0f)
+, m_statistics(Statistics())
 {
     this->init();
 }
@@ -285,6 +309,87 @@ void FiffSimulator::comSimfile(Command p_command)
 }
 
 
+//*************************************************************************************************************
+
+void FiffSimulator::comFast(Command p_command)
+{
+    //The playback thread picks the mode up with the next buffer
+    m_bFastMode = p_command.pValues()[0].toBool();
+
+    QString str = QString("\tSet %1 to %2 playback\r\n\n").arg(getName()).arg(m_bFastMode ? "as fast as possible" : "real time");
+
+    m_commandManager[Commands::FAST].reply(str);
+}
+
+
+//*************************************************************************************************************
+
+void FiffSimulator::comPrefetch(Command p_command)
+{
+    float t_fPrefetchSeconds = p_command.pValues()[0].toFloat();
+
+    if(t_fPrefetchSeconds > 0)
+    {
+        bool t_bWasRunning = m_bIsRunning;
+
+        if(m_bIsRunning)
+        {
+            m_pFiffProducer->stop();
+            this->stop();
+        }
+
+        m_fPrefetchSeconds = t_fPrefetchSeconds;
+
+        if(t_bWasRunning)
+            this->start();
+
+        QString str = QString("\tSet prefetch time to %1 s\r\n\n").arg(t_fPrefetchSeconds);
+
+        m_commandManager[Commands::PREFETCH].reply(str);
+    }
+    else
+        m_commandManager[Commands::PREFETCH].reply("Prefetch time not set\r\n");
+}
+
+
+//*************************************************************************************************************
+
+void FiffSimulator::comGetRate(Command p_command)
+{
+    Statistics t_statistics = statistics();
+
+    bool t_bCommandIsJson = p_command.isJson();
+    if(t_bCommandIsJson)
+    {
+        //
+        //create JSON help object
+        //
+        QJsonObject t_qJsonObjectRoot;
+        t_qJsonObjectRoot.insert("requested", QJsonValue(t_statistics.dRequestedRate));
+        t_qJsonObjectRoot.insert("achieved", QJsonValue(t_statistics.dAchievedRate));
+        t_qJsonObjectRoot.insert("meanlateness", QJsonValue(t_statistics.dMeanLatenessMs));
+        t_qJsonObjectRoot.insert("maxlateness", QJsonValue(t_statistics.dMaxLatenessMs));
+        t_qJsonObjectRoot.insert("resyncs", QJsonValue((double)t_statistics.iResyncs));
+        t_qJsonObjectRoot.insert(Commands::FAST, QJsonValue(m_bFastMode));
+        QJsonDocument p_qJsonDocument(t_qJsonObjectRoot);
+
+        m_commandManager[Commands::GETRATE].reply(p_qJsonDocument.toJson());
+    }
+    else
+    {
+        QString str = QString("\trequested %1 Hz, achieved %2 Hz%3\r\n"
+                              "\tlateness mean %4 ms, max %5 ms, %6 clock resets\r\n\n")
+                .arg(t_statistics.dRequestedRate, 0, 'f', 1)
+                .arg(t_statistics.dAchievedRate, 0, 'f', 1)
+                .arg(m_bFastMode ? " (as fast as possible)" : "")
+                .arg(t_statistics.dMeanLatenessMs, 0, 'f', 3)
+                .arg(t_statistics.dMaxLatenessMs, 0, 'f', 3)
+                .arg(t_statistics.iResyncs);
+        m_commandManager[Commands::GETRATE].reply(str);
+    }
+}
+
+
 //*************************************************************************************************************
 
 void FiffSimulator::connectCommandManager()
@@ -295,6 +400,9 @@ void FiffSimulator::connectCommandManager()
     QObject::connect(&m_commandManager[Commands::ACCEL], &Command::executed, this, &FiffSimulator::comAccel);
     QObject::connect(&m_commandManager[Commands::GETACCEL], &Command::executed, this, &FiffSimulator::comGetAccel);
     QObject::connect(&m_commandManager[Commands::SIMFILE], &Command::executed, this, &FiffSimulator::comSimfile);
+    QObject::connect(&m_commandManager[Commands::FAST], &Command::executed, this, &FiffSimulator::comFast);
+    QObject::connect(&m_commandManager[Commands::PREFETCH], &Command::executed, this, &FiffSimulator::comPrefetch);
+    QObject::connect(&m_commandManager[Commands::GETRATE], &Command::executed, this, &FiffSimulator::comGetRate);
 }
 
 
@@ -353,7 +461,7 @@ void FiffSimulator::init()
     m_pRawMatrixBuffer = NULL;
 
     if(!m_RawInfo.isEmpty())
-        m_pRawMatrixBuffer = new RawMatrixBuffer(RAW_BUFFFER_SIZE, m_RawInfo.info.nchan, this->m_uiBufferSampleSize);
+        m_pRawMatrixBuffer = new RawMatrixBuffer(prefetchBufferSize(), m_RawInfo.info.nchan, this->m_uiBufferSampleSize);
 }
 
 
@@ -378,12 +486,28 @@ bool FiffSimulator::stop()
 {
     this->m_pFiffProducer->stop();
     m_bIsRunning = false;
+
+    if(m_pRawMatrixBuffer)
+    {
+        //In case the semaphore blocks the thread -> Release the QSemaphore and let it exit from the pop function (acquire statement)
+        m_pRawMatrixBuffer->releaseFromPop();
+    }
+
     QThread::wait();
 
     return true;
 }
 
 
+//*************************************************************************************************************
+
+FiffSimulator::Statistics FiffSimulator::statistics() const
+{
+    QMutexLocker locker(&m_qStatisticsMutex);
+    return m_statistics;
+}
+
+
 //*************************************************************************************************************
 
 void FiffSimulator::info(qint32 ID)
@@ -505,7 +629,7 @@ bool FiffSimulator::readRawInfo()
         //
         if(m_pRawMatrixBuffer)
             delete m_pRawMatrixBuffer;
-        m_pRawMatrixBuffer = new RawMatrixBuffer(10, m_RawInfo.info.nchan, m_uiBufferSampleSize);
+        m_pRawMatrixBuffer = new RawMatrixBuffer(prefetchBufferSize(), m_RawInfo.info.nchan, m_uiBufferSampleSize);
 
         mutex.unlock();
     }
@@ -514,26 +638,100 @@ bool FiffSimulator::readRawInfo()
 }
 
 
+//*************************************************************************************************************
+
+quint32 FiffSimulator::prefetchBufferSize() const
+{
+    quint32 t_uiPrefetchBuffers = (quint32)qCeil(m_fPrefetchSeconds*m_RawInfo.info.sfreq/m_uiBufferSampleSize);
+
+    return qMax<quint32>(RAW_BUFFFER_SIZE, t_uiPrefetchBuffers);
+}
+
+
 //*************************************************************************************************************
 
 void FiffSimulator::run()
 {
     m_bIsRunning = true;
 
-    float t_fSamplingFrequency = m_RawInfo.info.sfreq;
-    float t_fBuffSampleSize = (float)m_uiBufferSampleSize;
+    double t_dSamplingFrequency = m_RawInfo.info.sfreq;
+    double t_dBlockPeriodNs = ((double)m_uiBufferSampleSize/t_dSamplingFrequency)*1000000000.0;
+    qint64 t_iMaxLagNs = (qint64)(c_dMaxLagSeconds*1000000000.0);
 
-    quint32 uiSamplePeriod = (unsigned int) ((t_fBuffSampleSize/t_fSamplingFrequency)*1000000.0f);
+    m_qStatisticsMutex.lock();
+    m_statistics = Statistics();
+    m_statistics.dRequestedRate = t_dSamplingFrequency;
+    m_qStatisticsMutex.unlock();
 
-//    quint32 count = 0;
+    double t_dTotalLatenessMs = 0.0;
+
+    //
+    // Absolute deadlines on a monotonic clock: deadline k = epoch + k * block period, so processing time
+    // and sleep overshoot do not accumulate. A delay below the maximum lag is caught up by emitting
+    // without sleeping, a larger one resets the epoch.
+    //
+    QElapsedTimer t_timer;
+    qint64 t_iEpochNs = 0;
+    qint64 t_iBlocksSinceEpoch = 0;
 
     while(m_bIsRunning)
     {
         QSharedPointer<Eigen::MatrixXf> t_pRawBuffer(new Eigen::MatrixXf(m_pRawMatrixBuffer->pop()));
-//        ++count;
-//        printf("%d raw buffer (%d x %d) generated\r\n", count, t_pRawBuffer->rows(), t_pRawBuffer->cols());
+
+        if(!m_bIsRunning)
+            break;
+
+        //The clock starts with the first buffer, not while the producer fills the prefetch buffer
+        if(!t_timer.isValid())
+            t_timer.start();
+
+        qint64 t_iNowNs = t_timer.nsecsElapsed();
+        double t_dLatenessMs = 0.0;
+
+        if(m_bFastMode)
+        {
+            //Keep the clock at now, to continue in real time when the mode is switched off
+            t_iEpochNs = t_iNowNs;
+            t_iBlocksSinceEpoch = 0;
+        }
+        else
+        {
+            qint64 t_iDeadlineNs = t_iEpochNs + (qint64)(t_iBlocksSinceEpoch*t_dBlockPeriodNs);
+
+            if(t_iNowNs < t_iDeadlineNs)
+            {
+                QThread::usleep((unsigned long)((t_iDeadlineNs - t_iNowNs)/1000));
+                t_iNowNs = t_timer.nsecsElapsed();
+            }
+            else if(t_iNowNs - t_iDeadlineNs > t_iMaxLagNs)
+            {
+                t_iEpochNs = t_iNowNs;
+                t_iBlocksSinceEpoch = 0;
+                t_iDeadlineNs = t_iNowNs;
+
+                QMutexLocker locker(&m_qStatisticsMutex);
+                ++m_statistics.iResyncs;
+            }
+
+            t_dLatenessMs = qMax<qint64>(0, t_iNowNs - t_iDeadlineNs)/1000000.0;
+        }
+
+        ++t_iBlocksSinceEpoch;
 
         emit remitRawBuffer(t_pRawBuffer);
-        usleep(uiSamplePeriod);
+
+        QMutexLocker locker(&m_qStatisticsMutex);
+        //Rate of the samples emitted before this buffer over the time until this buffer
+        if(t_iNowNs > 0)
+            m_statistics.dAchievedRate = m_statistics.iSamplesSent/(t_iNowNs/1000000000.0);
+        ++m_statistics.iBlocksSent;
+        m_statistics.iSamplesSent += t_pRawBuffer->cols();
+        t_dTotalLatenessMs += t_dLatenessMs;
+        m_statistics.dMeanLatenessMs = t_dTotalLatenessMs/m_statistics.iBlocksSent;
+        m_statistics.dMaxLatenessMs = qMax(m_statistics.dMaxLatenessMs, t_dLatenessMs);
     }
+
+    Statistics t_statistics = statistics();
+    printf("%s: requested %.1f Hz, achieved %.1f Hz, lateness mean %.3f ms, max %.3f ms\r\n",
+           getName(), t_statistics.dRequestedRate, t_statistics.dAchievedRate, t_statistics.dMeanLatenessMs, t_statistics.dMaxLatenessMs);
 }
@@ -111,6 +111,23 @@ public:
         static const QString ACCEL;
         static const QString GETACCEL;
         static const QString SIMFILE;
+        static const QString FAST;
+        static const QString PREFETCH;
+        static const QString GETRATE;
+    };
+
+    /**
+    * Playback statistics of the simulator thread.
+    */
+    struct Statistics
+    {
+        qint64  iBlocksSent;        /**< Number of emitted raw buffers. */
+        qint64  iSamplesSent;       /**< Number of emitted samples. */
+        qint64  iResyncs;           /**< Number of times the playback clock was reset because the simulator fell too far behind. */
+        double  dRequestedRate;     /**< The requested sampling rate in Hz (file rate times acceleration factor). */
+        double  dAchievedRate;      /**< The achieved sampling rate in Hz since the playback started. */
+        double  dMeanLatenessMs;    /**< Mean delay of an emission after its deadline in ms. */
+        double  dMaxLatenessMs;     /**< Maximum delay of an emission after its deadline in ms. */
     };
 
     //=========================================================================================================
@@ -137,6 +154,14 @@ public:
 
     virtual bool stop();
 
+    //=========================================================================================================
+    /**
+    * Returns the playback statistics of the current or last simulation run.
+    *
+    * @return the playback statistics.
+    */
+    Statistics statistics() const;
+
 protected:
     virtual void run();
 
@@ -183,6 +208,30 @@ private:
     */
     void comSimfile(Command p_command);
 
+    //=========================================================================================================
+    /**
+    * Switches the as fast as possible mode on or off, which emits buffers without pacing for load tests
+    *
+    * @param[in] p_command  The fast mode command.
+    */
+    void comFast(Command p_command);
+
+    //=========================================================================================================
+    /**
+    * Sets the number of seconds the reader thread decodes ahead of the playback
+    *
+    * @param[in] p_command  The prefetch command.
+    */
+    void comPrefetch(Command p_command);
+
+    //=========================================================================================================
+    /**
+    * Returns the requested and the achieved sampling rate together with the timing statistics
+    *
+    * @param[in] p_command  The rate command.
+    */
+    void comGetRate(Command p_command);
+
     //////////
 
     //=========================================================================================================
@@ -193,6 +242,14 @@ private:
 
     bool readRawInfo();
 
+    //=========================================================================================================
+    /**
+    * Returns the number of buffers the circular buffer has to hold to keep the prefetch time ahead.
+    *
+    * @return the circular buffer size in buffers.
+    */
+    quint32 prefetchBufferSize() const;
+
     QMutex mutex;
 
     FiffProducer*   m_pFiffProducer;        /**< Holds the DataProducer.*/
@@ -205,6 +262,11 @@ private:
     RawMatrixBuffer* m_pRawMatrixBuffer;    /**< The Circular Raw Matrix Buffer. */
 
     bool            m_bIsRunning;
+    bool            m_bFastMode;            /**< Whether buffers are emitted as fast as possible instead of in real time. */
+    float           m_fPrefetchSeconds;     /**< Seconds of data the producer decodes ahead of the playback. */
+
+    mutable QMutex  m_qStatisticsMutex;     /**< Guards the playback statistics. */
+    Statistics      m_statistics;           /**< The playback statistics. */
 };
 
 } // NAMESPACE
@@ -43,6 +43,8 @@
 
 #include "mne_rt_server.h"
 
+#include <fiff/fiff_stream.h>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -373,10 +375,17 @@ void FiffStreamServer::forwardMeasInfo(qint32 ID, const FiffInfo& p_fiffInfo)
 
 
 //*************************************************************************************************************
-//ToDo increase preformance --> try inline
+
 void FiffStreamServer::forwardRawBuffer(QSharedPointer<Eigen::MatrixXf> m_pMatRawData)
 {
-    emit remitRawBuffer(m_pMatRawData);
+    //
+    // Frame the tag once, all clients queue the same implicitly shared block
+    //
+    QByteArray t_blockRawBuffer;
+    FiffStream t_FiffStreamOut(&t_blockRawBuffer, QIODevice::WriteOnly);
+    t_FiffStreamOut.write_float(FIFF_DATA_BUFFER, m_pMatRawData->data(), m_pMatRawData->rows()*m_pMatRawData->cols());
+
+    emit remitRawBuffer(t_blockRawBuffer);
 }
 
 
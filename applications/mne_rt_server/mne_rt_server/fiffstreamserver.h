@@ -52,6 +52,7 @@
 
 #include <QStringList>
 #include <QTcpServer>
+#include <QByteArray>
 
 
 //*************************************************************************************************************
@@ -132,7 +133,7 @@ signals:
     void stopMeasFiffStreamClient(qint32 ID);
 
     void remitMeasInfo(qint32 ID, const FIFFLIB::FiffInfo& p_fiffInfo);
-    void remitRawBuffer(QSharedPointer<Eigen::MatrixXf>);
+    void remitRawBuffer(const QByteArray& p_blockRawBuffer);
 
     void closeFiffStreamServer();
 
@@ -60,6 +60,7 @@
 //=============================================================================================================
 
 #include <QtNetwork>
+#include <QtEndian>
 
 
 //*************************************************************************************************************
@@ -72,6 +73,26 @@ using namespace RTSERVER;
 using namespace FIFFLIB;
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+namespace
+{
+
+// Queued tags are handed to the socket only while it buffers less than this, the rest stays shared in the queue
+const qint64 c_iMaxBytesToWrite = 1024 * 1024;
+
+// Raw buffers are dropped while a client has more than this queued, e.g. when it stopped reading
+const qint64 c_iMaxQueuedBytes = 64 * 1024 * 1024;
+
+// Size of a fiff tag header (kind, type, size, next)
+const qint64 c_iTagHeaderSize = 4 * sizeof(qint32);
+
+} // NAMESPACE
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS
@@ -82,8 +103,10 @@ FiffStreamThread::FiffStreamThread(qint32 id, int socketDescriptor, QObject *par
 , m_iDataClientId(id)
 , m_sDataClientAlias(QString(""))
 , m_iSocketDescriptor(socketDescriptor)
+, m_iSendOffset(0)
+, m_iQueuedBytes(0)
+, m_iDroppedRawBuffers(0)
 , m_bIsSendingRawBuffer(false)
-, m_bIsRunning(false)
 {
 }
 
@@ -97,7 +120,7 @@ FiffStreamThread::~FiffStreamThread()
     if(t_pFiffStreamServer)
         t_pFiffStreamServer->m_qClientList.remove(m_iDataClientId);
 
-    m_bIsRunning = false;
+    QThread::quit();
     QThread::wait();
 }
 
@@ -110,12 +133,12 @@ void FiffStreamThread::startMeas(qint32 ID)
     {
         qDebug() << "Activate raw buffer sending.";
 
-        m_qMutex.lock();
         // ToDo send start meas
-        FiffStream t_FiffStreamOut(&m_qSendBlock, QIODevice::WriteOnly);
+        QByteArray t_blockTag;
+        FiffStream t_FiffStreamOut(&t_blockTag, QIODevice::WriteOnly);
         t_FiffStreamOut.start_block(FIFFB_RAW_DATA);
+        enqueue(t_blockTag);
         m_bIsSendingRawBuffer = true;
-        m_qMutex.unlock();
     }
 }
 
@@ -129,11 +152,11 @@ void FiffStreamThread::stopMeas(qint32 ID)
     {
         qDebug() << "stop raw buffer sending.";
 
-        m_qMutex.lock();
-        FiffStream t_FiffStreamOut(&m_qSendBlock, QIODevice::WriteOnly);
+        QByteArray t_blockTag;
+        FiffStream t_FiffStreamOut(&t_blockTag, QIODevice::WriteOnly);
         t_FiffStreamOut.end_block(FIFFB_RAW_DATA);
         m_bIsSendingRawBuffer = false;
-        m_qMutex.unlock();
+        enqueue(t_blockTag);
     }
 }
 
@@ -178,19 +201,14 @@ void FiffStreamThread::parseCommand(FiffTag::SPtr p_pTag)
 
 //*************************************************************************************************************
 
-void FiffStreamThread::sendRawBuffer(QSharedPointer<Eigen::MatrixXf> m_pMatRawData)
+void FiffStreamThread::sendRawBuffer(const QByteArray& p_blockRawBuffer)
 {
     if(m_bIsSendingRawBuffer)
     {
 //        qDebug() << "Send RawBuffer to client";
 
-        m_qMutex.lock();
-
-        FiffStream t_FiffStreamOut(&m_qSendBlock, QIODevice::WriteOnly);
-        t_FiffStreamOut.write_float(FIFF_DATA_BUFFER,m_pMatRawData->data(),m_pMatRawData->rows()*m_pMatRawData->cols());
-
-        m_qMutex.unlock();
-
+        //No copy, the framed tag is shared with all other clients
+        enqueue(p_blockRawBuffer, true);
     }
 //    else
 //    {
@@ -225,9 +243,8 @@ void FiffStreamThread::sendMeasurementInfo(qint32 ID, const FiffInfo& p_fiffInfo
 {
     if(ID == m_iDataClientId)
     {
-        m_qMutex.lock();
-
-        FiffStream t_FiffStreamOut(&m_qSendBlock, QIODevice::WriteOnly);
+        QByteArray t_blockTag;
+        FiffStream t_FiffStreamOut(&t_blockTag, QIODevice::WriteOnly);
 
 //        qint32 init_info[2];
 //        init_info[0] = FIFF_MNE_RT_CLIENT_ID;
@@ -238,7 +255,7 @@ void FiffStreamThread::sendMeasurementInfo(qint32 ID, const FiffInfo& p_fiffInfo
 //FiffStream::start_writing_raw
 
         p_fiffInfo.writeToStream(&t_FiffStreamOut);
-        m_qMutex.unlock();
+        enqueue(t_blockTag);
 
 //        qDebug() << "MeasInfo Blocksize: " << m_qSendBlock.size();
     }
@@ -249,9 +266,110 @@ void FiffStreamThread::sendMeasurementInfo(qint32 ID, const FiffInfo& p_fiffInfo
 
 void FiffStreamThread::writeClientId()
 {
-    FiffStream t_FiffStreamOut(&m_qSendBlock, QIODevice::WriteOnly);
+    QByteArray t_blockTag;
+    FiffStream t_FiffStreamOut(&t_blockTag, QIODevice::WriteOnly);
 
     t_FiffStreamOut.write_int(FIFF_MNE_RT_CLIENT_ID, &m_iDataClientId);
+    enqueue(t_blockTag);
+}
+
+
+//*************************************************************************************************************
+
+void FiffStreamThread::enqueue(const QByteArray& p_blockTag, bool p_bDroppable)
+{
+    if(p_blockTag.isEmpty())
+        return;
+
+    m_qMutex.lock();
+    if(p_bDroppable)
+    {
+        //Drop whole tags only, the stream stays valid and continues with the next buffer which fits
+        if(m_iQueuedBytes + p_blockTag.size() > c_iMaxQueuedBytes)
+        {
+            if(m_iDroppedRawBuffers == 0)
+                printf("FiffStreamClient (ID %d): send queue full, dropping raw buffers\r\n\n", m_iDataClientId);
+            ++m_iDroppedRawBuffers;
+            m_qMutex.unlock();
+            return;
+        }
+
+        if(m_iDroppedRawBuffers > 0)
+        {
+            printf("FiffStreamClient (ID %d): %d raw buffers were dropped\r\n\n", m_iDataClientId, m_iDroppedRawBuffers);
+            m_iDroppedRawBuffers = 0;
+        }
+    }
+
+    bool t_bWasEmpty = m_qSendQueue.isEmpty();
+    m_qSendQueue.append(p_blockTag);
+    m_iQueuedBytes += p_blockTag.size();
+    m_qMutex.unlock();
+
+    //A non empty queue is drained by the bytesWritten notifications of the socket
+    if(t_bWasEmpty)
+        emit dataQueued();
+}
+
+
+//*************************************************************************************************************
+
+void FiffStreamThread::writeQueued(QTcpSocket& p_qTcpSocket)
+{
+    QMutexLocker t_locker(&m_qMutex);
+
+    while(!m_qSendQueue.isEmpty() && p_qTcpSocket.bytesToWrite() < c_iMaxBytesToWrite)
+    {
+        //Write from the offset instead of removing the written bytes from the shared tag
+        const QByteArray& t_blockTag = m_qSendQueue.first();
+        qint64 t_iBytesToWrite = qMin(t_blockTag.size() - m_iSendOffset, c_iMaxBytesToWrite - p_qTcpSocket.bytesToWrite());
+        qint64 t_iBytesWritten = p_qTcpSocket.write(t_blockTag.constData() + m_iSendOffset, t_iBytesToWrite);
+        if(t_iBytesWritten <= 0)
+            break;
+
+        m_iSendOffset += t_iBytesWritten;
+        if(m_iSendOffset == t_blockTag.size())
+        {
+            m_iQueuedBytes -= t_blockTag.size();
+            m_qSendQueue.removeFirst();
+            m_iSendOffset = 0;
+        }
+    }
+}
+
+
+//*************************************************************************************************************
+
+void FiffStreamThread::readCommands(QTcpSocket& p_qTcpSocket, FiffStream& p_FiffStreamIn)
+{
+    //
+    // Parse all complete tags, an incomplete one stays in the socket until the rest arrived
+    //
+    while(p_qTcpSocket.bytesAvailable() >= c_iTagHeaderSize)
+    {
+        QByteArray t_header = p_qTcpSocket.peek(c_iTagHeaderSize);
+        qint32 t_iSize = qFromBigEndian<qint32>(reinterpret_cast<const uchar*>(t_header.constData()) + 2*sizeof(qint32));
+        if(t_iSize < 0)
+        {
+            printf("FiffStreamClient (ID %d): invalid tag received, disconnecting\r\n\n", m_iDataClientId);
+            p_qTcpSocket.abort();
+            return;
+        }
+        if(p_qTcpSocket.bytesAvailable() < c_iTagHeaderSize + t_iSize)
+            return;
+
+        FiffTag::SPtr t_pTag;
+        p_FiffStreamIn.read_tag_info(t_pTag, false);
+        p_FiffStreamIn.read_tag_data(t_pTag);
+
+        //
+        // Parse the tag
+        //
+        if(t_pTag->kind == FIFF_MNE_RT_COMMAND)
+        {
+            parseCommand(t_pTag);
+        }
+    }
 }
 
 
@@ -296,8 +414,6 @@ void FiffStreamThread::writeClientId()
 
 void FiffStreamThread::run()
 {
-    m_bIsRunning = true;
-
     FiffStreamServer* t_pParentServer = qobject_cast<FiffStreamServer*>(this->parent());
 
     connect(t_pParentServer, &FiffStreamServer::remitMeasInfo,
@@ -324,62 +440,27 @@ void FiffStreamThread::run()
 
     FiffStream t_FiffStreamIn(&t_qTcpSocket);
 
-//    int i = 0;
-    while(t_qTcpSocket.state() != QAbstractSocket::UnconnectedState && m_bIsRunning)
-    {
-        //
-        // Write available data
-        //
-        m_qMutex.lock();
-        qint32 t_iBlockSize = m_qSendBlock.size();
-//        qDebug() << "data available" << t_iBlockSize;
-        if(t_iBlockSize > 0)
-        {
-            qint32 t_iBytesWritten = t_qTcpSocket.write(m_qSendBlock);
-//            qDebug() << ++i<< "[wrote bytes] " << t_iBytesWritten;
-            t_qTcpSocket.waitForBytesWritten();
-            if(t_iBytesWritten == t_iBlockSize)
-            {
-                m_qSendBlock.clear();
-            }
-            else
-            {
-                //we have to store bytes which were not written to the socket, due to writing limit
-                //m_qSendBlock = m_qSendBlock.mid(t_iBytesWritten, t_iBlockSize-t_iBytesWritten);
-                m_qSendBlock.remove(0,t_iBytesWritten); //higher performance then mid
-            }
-        }
-        m_qMutex.unlock();
-
-        //
-        // Read: Wait 10ms for incomming tag header, read and continue
-        //
-        t_qTcpSocket.waitForReadyRead(10);
+    //
+    // Event driven: write when tags were queued or the socket wrote data, read when data arrived.
+    // The socket is the context, so all handlers run in this thread.
+    //
+    connect(this, &FiffStreamThread::dataQueued, &t_qTcpSocket, [this, &t_qTcpSocket]() {
+        writeQueued(t_qTcpSocket);
+    });
+    connect(&t_qTcpSocket, &QTcpSocket::bytesWritten, &t_qTcpSocket, [this, &t_qTcpSocket]() {
+        writeQueued(t_qTcpSocket);
+    });
+    connect(&t_qTcpSocket, &QTcpSocket::readyRead, &t_qTcpSocket, [this, &t_qTcpSocket, &t_FiffStreamIn]() {
+        readCommands(t_qTcpSocket, t_FiffStreamIn);
+    });
+    connect(&t_qTcpSocket, &QTcpSocket::disconnected, this, &FiffStreamThread::quit, Qt::DirectConnection);
+
+    //Tags queued and commands received before the connections were made
+    writeQueued(t_qTcpSocket);
+    readCommands(t_qTcpSocket, t_FiffStreamIn);
 
-        if (t_qTcpSocket.bytesAvailable() >= (int)sizeof(qint32)*4)
-        {
-//            qDebug() << "goes to read bytes " ;
-            FiffTag::SPtr t_pTag;
-            t_FiffStreamIn.read_tag_info(t_pTag, false);
-
-            //
-            // wait until tag size data are available and read the data
-            //
-            while (t_qTcpSocket.bytesAvailable() < t_pTag->size())
-            {
-                t_qTcpSocket.waitForReadyRead(10);
-            }
-            t_FiffStreamIn.read_tag_data(t_pTag);
-
-            //
-            // Parse the tag
-            //
-            if(t_pTag->kind == FIFF_MNE_RT_COMMAND)
-            {
-                parseCommand(t_pTag);
-            }
-        }
-    }
+    if(t_qTcpSocket.state() != QAbstractSocket::UnconnectedState)
+        exec();
 
     t_qTcpSocket.disconnectFromHost();
     if(t_qTcpSocket.state() != QAbstractSocket::UnconnectedState)
@@ -54,6 +54,8 @@
 #include <QTcpSocket>
 #include <QMutex>
 #include <QSharedPointer>
+#include <QByteArray>
+#include <QList>
 
 
 //*************************************************************************************************************
@@ -103,26 +105,67 @@ public:
 signals:
     void error(QTcpSocket::SocketError socketError);
 
+    //=========================================================================================================
+    /**
+    * Emitted when a tag was queued to an empty send queue, wakes up the socket thread.
+    */
+    void dataQueued();
+
 private:
     qint32 m_iDataClientId;
     QString m_sDataClientAlias;
 
     int m_iSocketDescriptor;
 
-    QMutex m_qMutex;
-    QByteArray m_qSendBlock;
+    QMutex m_qMutex;                    /**< Guards the send queue. */
+    QList<QByteArray> m_qSendQueue;     /**< Framed tags waiting to be written, raw buffers are shared with all other clients. */
+    qint64 m_iSendOffset;               /**< Bytes of the first queued tag already handed to the socket. */
+    qint64 m_iQueuedBytes;              /**< Bytes of all queued tags. */
+    qint32 m_iDroppedRawBuffers;        /**< Raw buffers dropped since the send queue was last below its limit. */
 
     bool m_bIsSendingRawBuffer;
 
-    bool m_bIsRunning;
-
     void startMeas(qint32 ID);
 
     void stopMeas(qint32 ID);
 
     void sendMeasurementInfo(qint32 ID, const FiffInfo& p_fiffInfo);
 
-    void sendRawBuffer(QSharedPointer<Eigen::MatrixXf> m_pMatRawData);
+    //=========================================================================================================
+    /**
+    * Queues a raw buffer tag which was framed once by the FiffStreamServer for all clients.
+    *
+    * @param[in] p_blockRawBuffer   The framed FIFF_DATA_BUFFER tag, it is shared and never modified.
+    */
+    void sendRawBuffer(const QByteArray& p_blockRawBuffer);
+
+    //=========================================================================================================
+    /**
+    * Appends a framed tag to the send queue. Droppable tags are discarded while the queue holds more than its
+    * byte limit, so a client which does not read its data can not make the queue grow without bound.
+    *
+    * @param[in] p_blockTag     The framed tag.
+    * @param[in] p_bDroppable   Whether the tag is dropped when the queue is full (raw buffers).
+    */
+    void enqueue(const QByteArray& p_blockTag, bool p_bDroppable = false);
+
+    //=========================================================================================================
+    /**
+    * Hands queued tags to the socket until its write buffer is full. Called in the socket thread whenever data
+    * was queued or the socket wrote data.
+    *
+    * @param[in] p_qTcpSocket   The client socket.
+    */
+    void writeQueued(QTcpSocket& p_qTcpSocket);
+
+    //=========================================================================================================
+    /**
+    * Parses all completely received tags. Called in the socket thread whenever data arrived.
+    *
+    * @param[in] p_qTcpSocket       The client socket.
+    * @param[in] p_FiffStreamIn     The stream reading from the socket.
+    */
+    void readCommands(QTcpSocket& p_qTcpSocket, FiffStream& p_FiffStreamIn);
     //void readToBuffer1();
 //    void readProc(QTcpSocket& p_qTcpSocket);
 };
@@ -906,12 +906,10 @@ void RealTimeMultiSampleArrayModel::filterChanged(QList<FilterData> filterData)
 {
     m_filterData = filterData;
 
-    m_iMaxFilterLength = 1;
-    for(int i=0; i<filterData.size(); ++i) {
-        if(m_iMaxFilterLength<filterData.at(i).m_iFilterOrder) {
-            m_iMaxFilterLength = filterData.at(i).m_iFilterOrder;
-        }
-    }
+    //All filters are planned as one impulse response. The order of this cascade, not the order of the longest
+    //filter, is the length the convolution grows by and twice the delay of the filtered data.
+    m_rtFilter.setFilters(m_filterData);
+    m_iMaxFilterLength = qMax(1, m_rtFilter.filterLength() - 1);
 
     m_matOverlap.conservativeResize(m_pFiffInfo->chs.size(), m_iMaxFilterLength);
     m_matOverlap.setZero();
@@ -1119,16 +1117,6 @@ void RealTimeMultiSampleArrayModel::markChBad(QModelIndexList chlist, bool statu
 }
 
 
-//*************************************************************************************************************
-
-void doFilterPerChannelRTMSA(QPair<QList<FilterData>,QPair<int,RowVectorXd> > &channelDataTime)
-{
-    for(int i = 0; i < channelDataTime.first.size(); ++i)
-        //channelDataTime.second.second = channelDataTime.first.at(i).applyConvFilter(channelDataTime.second.second, true, FilterData::ZeroPad);
-        channelDataTime.second.second = channelDataTime.first.at(i).applyFFTFilter(channelDataTime.second.second, true, FilterData::ZeroPad); //FFT Convolution for rt is not suitable. FFT make the signal filtering non causal.
-}
-
-
 //*************************************************************************************************************
 
 void RealTimeMultiSampleArrayModel::filterChannelsConcurrently()
@@ -1138,52 +1126,33 @@ void RealTimeMultiSampleArrayModel::filterChannelsConcurrently()
     if(m_filterData.isEmpty())
         return;
 
-    //Create temporary filters with higher fft length because we are going to filter all available data at once for one time
-    QList<FilterData> tempFilterList;
-
-    int fftLength = m_matDataRaw.row(0).cols() + 4 * m_iMaxFilterLength;
-    int exp = ceil(MNEMath::log2(fftLength));
-    fftLength = pow(2, exp) < 512 ? 512 : pow(2, exp);
-
-    for(int i = 0; i<m_filterData.size(); ++i) {
-        FilterData tempFilter(m_filterData.at(i).m_sName,
-                              m_filterData.at(i).m_Type,
-                              m_filterData.at(i).m_iFilterOrder,
-                              m_filterData.at(i).m_dCenterFreq,
-                              m_filterData.at(i).m_dBandwidth,
-                              m_filterData.at(i).m_dParksWidth,
-                              m_filterData.at(i).m_sFreq,
-                              fftLength,
-                              m_filterData.at(i).m_designMethod);
-
-        tempFilterList.append(tempFilter);
-    }
-
-    //Generate QList structure which can be handled by the QConcurrent framework
-    QList<QPair<QList<FilterData>,QPair<int,RowVectorXd> > > timeData;
+    //Select the channels to filter. The FFT length is planned by the filter object for the length of the whole matrix.
+    QVector<int> lFilterRows;
     QList<int> notFilterChannelIndex;
 
-    //Also append mirrored data in front and back to get rid of edge effects
     for(qint32 i=0; i<m_matDataRaw.rows(); ++i) {
-        if(m_filterChannelList.contains(m_pFiffInfo->chs.at(i).ch_name)) {
-            RowVectorXd datTemp(m_matDataRaw.row(i).cols() + 2 * m_iMaxFilterLength);
-            datTemp << m_matDataRaw.row(i).head(m_iMaxFilterLength).reverse(), m_matDataRaw.row(i), m_matDataRaw.row(i).tail(m_iMaxFilterLength).reverse();
-            timeData.append(QPair<QList<FilterData>,QPair<int,RowVectorXd> >(tempFilterList,QPair<int,RowVectorXd>(i,datTemp)));
-        }
+        if(m_filterChannelList.contains(m_pFiffInfo->chs.at(i).ch_name))
+            lFilterRows.append(i);
         else
             notFilterChannelIndex.append(i);
     }
 
     //Do the concurrent filtering
-    if(!timeData.isEmpty()) {
-        QFuture<void> future = QtConcurrent::map(timeData,
-                                             doFilterPerChannelRTMSA);
+    if(!lFilterRows.isEmpty()) {
+        //Also append mirrored data in front and back to get rid of edge effects
+        MatrixXd matDataMirrored(m_matDataRaw.rows(), m_matDataRaw.cols() + 2 * m_iMaxFilterLength);
+        for(int r = 0; r < lFilterRows.size(); ++r) {
+            const int iRow = lFilterRows.at(r);
+            matDataMirrored.row(iRow) << m_matDataRaw.row(iRow).head(m_iMaxFilterLength).reverse(), m_matDataRaw.row(iRow), m_matDataRaw.row(iRow).tail(m_iMaxFilterLength).reverse();
+        }
 
-        future.waitForFinished();
+        //The convolution has matDataMirrored.cols() + m_iMaxFilterLength columns, m_iMaxFilterLength is the order of the planned filter
+        m_rtFilter.convolve(matDataMirrored, lFilterRows, m_matFilterConv);
 
-        for(int r = 0; r < timeData.size(); ++r) {
-            m_matDataFiltered.row(timeData.at(r).second.first) = timeData.at(r).second.second.segment(m_iMaxFilterLength+m_iMaxFilterLength/2, m_matDataRaw.cols());
-            m_matOverlap.row(timeData.at(r).second.first) = timeData.at(r).second.second.tail(m_iMaxFilterLength);
+        for(int r = 0; r < lFilterRows.size(); ++r) {
+            const int iRow = lFilterRows.at(r);
+            m_matDataFiltered.row(iRow) = m_matFilterConv.row(iRow).segment(m_iMaxFilterLength+m_iMaxFilterLength/2, m_matDataRaw.cols());
+            m_matOverlap.row(iRow) = m_matFilterConv.row(iRow).tail(m_iMaxFilterLength);
         }
     }
 
@@ -1205,100 +1174,100 @@ void RealTimeMultiSampleArrayModel::filterChannelsConcurrently(const MatrixXd &d
 {
     //std::cout<<"START RealTimeMultiSampleArrayModel::filterChannelsConcurrently"<<std::endl;
 
-    if(iDataIndex >= m_matDataFiltered.cols() || data.cols() < m_iMaxFilterLength)
+    if(m_filterData.isEmpty() || iDataIndex >= m_matDataFiltered.cols() || data.cols() < m_iMaxFilterLength)
         return;
 
-    //Generate QList structure which can be handled by the QConcurrent framework
-    QList<QPair<QList<FilterData>,QPair<int,RowVectorXd> > > timeData;
+    //Select the channels to filter
+    QVector<int> lFilterRows;
     QList<int> notFilterChannelIndex;
 
     for(qint32 i = 0; i < data.rows(); ++i) {
         if(m_filterChannelList.contains(m_pFiffInfo->chs.at(i).ch_name))
-            timeData.append(QPair<QList<FilterData>,QPair<int,RowVectorXd> >(m_filterData,QPair<int,RowVectorXd>(i,data.row(i))));
+            lFilterRows.append(i);
         else
             notFilterChannelIndex.append(i);
     }
 
     //Do the concurrent filtering
-    if(!timeData.isEmpty()) {
-        QFuture<void> future = QtConcurrent::map(timeData,
-                                             doFilterPerChannelRTMSA);
+    if(!lFilterRows.isEmpty()) {
+        //Convolve all selected channels with the planned filter. This data has a delay of filterLength/2 in front and back.
+        int iFilterDelay = m_iMaxFilterLength/2;
+        int iFilteredNumberCols = data.cols() + m_iMaxFilterLength;
 
-        future.waitForFinished();
+        m_rtFilter.convolve(data, lFilterRows, m_matFilterConv);
 
         //Do the overlap add method and store in m_matDataFiltered
-        int iFilterDelay = m_iMaxFilterLength/2;
-        int iFilteredNumberCols = timeData.at(0).second.second.cols();
+        for(int r = 0; r<lFilterRows.size(); ++r) {
+            const int iRow = lFilterRows.at(r);
 
-        for(int r = 0; r<timeData.size(); ++r) {
             if(iDataIndex+2*data.cols() > m_matDataRaw.cols()) {
                 //Handle last data block
                 //std::cout<<"Handle last data block"<<std::endl;
 
                 if(m_bDrawFilterFront) {
                     //Get the currently filtered data. This data has a delay of filterLength/2 in front and back.
-                    RowVectorXd tempData = timeData.at(r).second.second;
+                    RowVectorXd tempData = m_matFilterConv.row(iRow);
 
                     //Perform the actual overlap add by adding the last filterlength data to the newly filtered one
-                    tempData.head(m_iMaxFilterLength) += m_matOverlap.row(timeData.at(r).second.first);
+                    tempData.head(m_iMaxFilterLength) += m_matOverlap.row(iRow);
 
                     //Write the newly calulated filtered data to the filter data matrix. Keep in mind that the current block also effect last part of the last block (begin at dataIndex-iFilterDelay).
                     int start = iDataIndex-iFilterDelay < 0 ? 0 : iDataIndex-iFilterDelay;
-                    m_matDataFiltered.row(timeData.at(r).second.first).segment(start,iFilteredNumberCols-m_iMaxFilterLength) = tempData.head(iFilteredNumberCols-m_iMaxFilterLength);
+                    m_matDataFiltered.row(iRow).segment(start,iFilteredNumberCols-m_iMaxFilterLength) = tempData.head(iFilteredNumberCols-m_iMaxFilterLength);
                 } else {
                     //Perform this else case everytime the filter was changed. Do not begin to plot from dataIndex-iFilterDelay because the impsulse response and m_matOverlap do not match with the new filter anymore.
-                    m_matDataFiltered.row(timeData.at(r).second.first).segment(iDataIndex-iFilterDelay,m_iMaxFilterLength) = timeData.at(r).second.second.segment(m_iMaxFilterLength,m_iMaxFilterLength);
-                    m_matDataFiltered.row(timeData.at(r).second.first).segment(iDataIndex+iFilterDelay,iFilteredNumberCols-2*m_iMaxFilterLength) = timeData.at(r).second.second.segment(m_iMaxFilterLength,iFilteredNumberCols-2*m_iMaxFilterLength);
+                    m_matDataFiltered.row(iRow).segment(iDataIndex-iFilterDelay,m_iMaxFilterLength) = m_matFilterConv.row(iRow).segment(m_iMaxFilterLength,m_iMaxFilterLength);
+                    m_matDataFiltered.row(iRow).segment(iDataIndex+iFilterDelay,iFilteredNumberCols-2*m_iMaxFilterLength) = m_matFilterConv.row(iRow).segment(m_iMaxFilterLength,iFilteredNumberCols-2*m_iMaxFilterLength);
                 }
 
                 //Refresh the m_matOverlap with the new calculated filtered data.
-                m_matOverlap.row(timeData.at(r).second.first) = timeData.at(r).second.second.tail(m_iMaxFilterLength);
+                m_matOverlap.row(iRow) = m_matFilterConv.row(iRow).tail(m_iMaxFilterLength);
             } else if(iDataIndex == 0) {
                 //Handle first data block
                 //std::cout<<"Handle first data block"<<std::endl;
 
                 if(m_bDrawFilterFront) {
                     //Get the currently filtered data. This data has a delay of filterLength/2 in front and back.
-                    RowVectorXd tempData = timeData.at(r).second.second;
+                    RowVectorXd tempData = m_matFilterConv.row(iRow);
 
                     //Add newly calculate data to the tail of the current filter data matrix
-                    m_matDataFiltered.row(timeData.at(r).second.first).segment(m_matDataFiltered.cols()-iFilterDelay-m_iResidual, iFilterDelay) = tempData.head(iFilterDelay) + m_matOverlap.row(timeData.at(r).second.first).head(iFilterDelay);
+                    m_matDataFiltered.row(iRow).segment(m_matDataFiltered.cols()-iFilterDelay-m_iResidual, iFilterDelay) = tempData.head(iFilterDelay) + m_matOverlap.row(iRow).head(iFilterDelay);
 
                     //Perform the actual overlap add by adding the last filterlength data to the newly filtered one
-                    tempData.head(m_iMaxFilterLength) += m_matOverlap.row(timeData.at(r).second.first);
-                    m_matDataFiltered.row(timeData.at(r).second.first).head(iFilteredNumberCols-m_iMaxFilterLength-iFilterDelay) = tempData.segment(iFilterDelay,iFilteredNumberCols-m_iMaxFilterLength-iFilterDelay);
+                    tempData.head(m_iMaxFilterLength) += m_matOverlap.row(iRow);
+                    m_matDataFiltered.row(iRow).head(iFilteredNumberCols-m_iMaxFilterLength-iFilterDelay) = tempData.segment(iFilterDelay,iFilteredNumberCols-m_iMaxFilterLength-iFilterDelay);
 
                     //Copy residual data from the front to the back. The residual is != 0 if the chosen block size cannot be evenly fit into the matrix size
-                    m_matDataFiltered.row(timeData.at(r).second.first).tail(m_iResidual) = m_matDataFiltered.row(timeData.at(r).second.first).head(m_iResidual);
+                    m_matDataFiltered.row(iRow).tail(m_iResidual) = m_matDataFiltered.row(iRow).head(m_iResidual);
                 } else {
                     //Perform this else case everytime the filter was changed. Do not begin to plot from dataIndex-iFilterDelay because the impsulse response and m_matOverlap do not match with the new filter anymore.
-                    m_matDataFiltered.row(timeData.at(r).second.first).head(m_iMaxFilterLength) = timeData.at(r).second.second.segment(m_iMaxFilterLength,m_iMaxFilterLength);
-                    m_matDataFiltered.row(timeData.at(r).second.first).segment(iFilterDelay,iFilteredNumberCols-2*m_iMaxFilterLength) = timeData.at(r).second.second.segment(m_iMaxFilterLength,iFilteredNumberCols-2*m_iMaxFilterLength);
+                    m_matDataFiltered.row(iRow).head(m_iMaxFilterLength) = m_matFilterConv.row(iRow).segment(m_iMaxFilterLength,m_iMaxFilterLength);
+                    m_matDataFiltered.row(iRow).segment(iFilterDelay,iFilteredNumberCols-2*m_iMaxFilterLength) = m_matFilterConv.row(iRow).segment(m_iMaxFilterLength,iFilteredNumberCols-2*m_iMaxFilterLength);
                 }
 
                 //Refresh the m_matOverlap with the new calculated filtered data.
-                m_matOverlap.row(timeData.at(r).second.first) = timeData.at(r).second.second.tail(m_iMaxFilterLength);
+                m_matOverlap.row(iRow) = m_matFilterConv.row(iRow).tail(m_iMaxFilterLength);
             } else {
                 //Handle middle data blocks
                 //std::cout<<"Handle middle data block"<<std::endl;
 
                 if(m_bDrawFilterFront) {
                     //Get the currently filtered data. This data has a delay of filterLength/2 in front and back.
-                    RowVectorXd tempData = timeData.at(r).second.second;
+                    RowVectorXd tempData = m_matFilterConv.row(iRow);
 
                     //Perform the actual overlap add by adding the last filterlength data to the newly filtered one
-                    tempData.head(m_iMaxFilterLength) += m_matOverlap.row(timeData.at(r).second.first);
+                    tempData.head(m_iMaxFilterLength) += m_matOverlap.row(iRow);
 
                     //Write the newly calulated filtered data to the filter data matrix. Keep in mind that the current block also effect last part of the last block (begin at dataIndex-iFilterDelay).
-                    m_matDataFiltered.row(timeData.at(r).second.first).segment(iDataIndex-iFilterDelay,iFilteredNumberCols-m_iMaxFilterLength) = tempData.head(iFilteredNumberCols-m_iMaxFilterLength);
+                    m_matDataFiltered.row(iRow).segment(iDataIndex-iFilterDelay,iFilteredNumberCols-m_iMaxFilterLength) = tempData.head(iFilteredNumberCols-m_iMaxFilterLength);
                 } else {
                     //Perform this else case everytime the filter was changed. Do not begin to plot from dataIndex-iFilterDelay because the impsulse response and m_matOverlap do not match with the new filter anymore.
-                    m_matDataFiltered.row(timeData.at(r).second.first).segment(iDataIndex-iFilterDelay,m_iMaxFilterLength).setZero();// = timeData.at(r).second.second.segment(m_iMaxFilterLength,m_iMaxFilterLength);
-                    m_matDataFiltered.row(timeData.at(r).second.first).segment(iDataIndex+iFilterDelay,iFilteredNumberCols-2*m_iMaxFilterLength) = timeData.at(r).second.second.segment(m_iMaxFilterLength,iFilteredNumberCols-2*m_iMaxFilterLength);
+                    m_matDataFiltered.row(iRow).segment(iDataIndex-iFilterDelay,m_iMaxFilterLength).setZero();// = m_matFilterConv.row(iRow).segment(m_iMaxFilterLength,m_iMaxFilterLength);
+                    m_matDataFiltered.row(iRow).segment(iDataIndex+iFilterDelay,iFilteredNumberCols-2*m_iMaxFilterLength) = m_matFilterConv.row(iRow).segment(m_iMaxFilterLength,iFilteredNumberCols-2*m_iMaxFilterLength);
                 }
 
                 //Refresh the m_matOverlap with the new calculated filtered data.
-                m_matOverlap.row(timeData.at(r).second.first) = timeData.at(r).second.second.tail(m_iMaxFilterLength);
+                m_matOverlap.row(iRow) = m_matFilterConv.row(iRow).tail(m_iMaxFilterLength);
             }
         }
     }
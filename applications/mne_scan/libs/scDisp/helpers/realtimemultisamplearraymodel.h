@@ -52,6 +52,8 @@
 #include <utils/ioutils.h>
 #include <utils/filterTools/sphara.h>
 
+#include <realtime/rtProcessing/rtfilter.h>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -553,7 +555,7 @@ private:
     qint32                              m_iMaxSamples;                              /**< Max samples per window */
     qint32                              m_iCurrentSample;                           /**< Current sample which holds the current position in the data matrix */
     qint32                              m_iCurrentSampleFreeze;                     /**< Current sample which holds the current position in the data matrix when freezing tool is active */
-    qint32                              m_iMaxFilterLength;                         /**< Max order of the current filters */
+    qint32                              m_iMaxFilterLength;                         /**< Order of the planned filter cascade, the convolution grows by this many samples */
     qint32                              m_iCurrentBlockSize;                        /**< Current block size */
     qint32                              m_iResidual;                                /**< Current amount of samples which were to size */
     int                                 m_iCurrentTriggerChIndex;                   /**< The index of the current trigger channel */
@@ -574,6 +576,7 @@ private:
     MatrixXdR                           m_matDataRawFreeze;                         /**< The raw data in freeze mode */
     MatrixXdR                           m_matDataFilteredFreeze;                    /**< The raw filtered data in freeze mode */
     MatrixXd                            m_matOverlap;                               /**< Last overlap block for the back */
+    MatrixXd                            m_matFilterConv;                            /**< Convolution of the last filtered block, kept to reuse its memory */
 
     Eigen::VectorXi                     m_vecIndicesFirstVV;                        /**< The indices of the channels to pick for the first SPHARA operator in case of a VectorView system.*/
     Eigen::VectorXi                     m_vecIndicesSecondVV;                       /**< The indices of the channels to pick for the second SPHARA operator in case of a VectorView system.*/
@@ -603,6 +606,7 @@ private:
     QMap<int,QList<QPair<int,double> > >m_qMapDetectedTriggerOldFreeze;             /**< Old detected trigger for each trigger channel while display is freezed. */
     QMap<qint32,float>                  m_qMapChScaling;                            /**< Channel scaling map. */
     QList<FilterData>                   m_filterData;                               /**< List of currently active filters. */
+    REALTIMELIB::RtFilter               m_rtFilter;                                 /**< Planned filter used to convolve the data blocks. */
     QList<RealTimeSampleArrayChInfo>    m_qListChInfo;                              /**< Channel info list. ToDo: Obsolete*/
     QStringList                         m_filterChannelList;                        /**< List of channels which are to be filtered.*/
     QStringList                         m_visibleChannelList;                       /**< List of currently visible channels in the view.*/
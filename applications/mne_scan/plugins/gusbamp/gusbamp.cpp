@@ -77,7 +77,7 @@ GUSBAmp::GUSBAmp()
 , m_iNumberOfChannels(0)
 , m_iSamplesPerBlock(0)
 , m_iSampleRate(128)
-, m_bWriteToFile(false)
+, m_pRawRecorder(new FIFFLIB::FiffRawRecorder)
 {
     m_viChannelsToAcquire = {1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16};
 
@@ -209,10 +209,6 @@ QSharedPointer<IPlugin> GUSBAmp::clone() const
 
 void GUSBAmp::init()
 {
-    m_iSplitFileSizeMs = 10;
-    m_iSplitCount = 0;
-    m_bSplitFile = false;
-
     QDate date;
     m_sOutputFilePath = QString ("%1Sequence_01/Subject_01/%2_%3_%4_EEG_001_raw.fif").arg(m_qStringResourcePath).arg(date.currentDate().year()).arg(date.currentDate().month()).arg(date.currentDate().day());
 
@@ -332,8 +328,6 @@ QWidget* GUSBAmp::setupWidget()
 
 void GUSBAmp::run()
 {
-    qint32 size = 0;
-
     //get Matrix from the producer
     while(m_bIsRunning)
     {
@@ -352,60 +346,14 @@ void GUSBAmp::run()
             m_pRTMSA_GUSBAmp->data()->setValue(matValue_show.cast<double>());
             qDebug() << "PUSH!";
 
-            //Write raw data to fif file
-            if(m_bWriteToFile)
-            {
-                m_pOutfid->write_raw_buffer(matValue.cast<double>(), m_cals);
-                size += matValue.cols();
-
-                //                qDebug()<<"size"<<size;
-                //                qDebug()<<"(m_iSplitFileSizeMs/1000)*m_pFiffInfo->sfreq"<<(double(m_iSplitFileSizeMs)/1000.0)*m_pFiffInfo->sfreq;
-                if(size > (double(m_iSplitFileSizeMs)/1000.0)*m_pFiffInfo->sfreq && m_bSplitFile)
-                {
-                    size = 0;
-                    splitRecordingFile();
-                }
-            }
-            else
-                size = 0;
+            //Hand raw data to the recorder, which writes and splits the fif file from its own thread
+            if(m_pRawRecorder->isRecording())
+                m_pRawRecorder->push(matValue);
         }
     }
 }
 
 
-//*************************************************************************************************************
-
-void GUSBAmp::splitRecordingFile()
-{
-    qDebug() << "Split recording file";
-    ++m_iSplitCount;
-    QString nextFileName = m_sOutputFilePath.remove("_raw.fif");
-    nextFileName += QString("-%1_raw.fif").arg(m_iSplitCount);
-
-    /*
-    * Write the link to the next file
-    */
-    qint32 data;
-    m_pOutfid->start_block(FIFFB_REF);
-    data = FIFFV_ROLE_NEXT_FILE;
-    m_pOutfid->write_int(FIFF_REF_ROLE,&data);
-    m_pOutfid->write_string(FIFF_REF_FILE_NAME, nextFileName);
-    m_pOutfid->write_id(FIFF_REF_FILE_ID);//ToDo meas_id
-    data = m_iSplitCount - 1;
-    m_pOutfid->write_int(FIFF_REF_FILE_NUM, &data);
-    m_pOutfid->end_block(FIFFB_REF);
-
-    //finish file
-    m_pOutfid->finish_writing_raw();
-
-    //start next file
-    m_fileOut.setFileName(nextFileName);
-    m_pOutfid = Fiff::start_writing_raw(m_fileOut, *m_pFiffInfo, m_cals);
-    fiff_int_t first = 0;
-    m_pOutfid->write_int(FIFF_FIRST_SAMPLE, &first);
-}
-
-
 //*************************************************************************************************************
 
 void GUSBAmp::showSetupProjectDialog()
@@ -428,13 +376,10 @@ void GUSBAmp::showSetupProjectDialog()
 
 void GUSBAmp::showStartRecording()
 {
-    m_iSplitCount = 0;
-
     //Setup writing to file
-    if(m_bWriteToFile)
+    if(m_pRawRecorder->isRecording())
     {
-        m_pOutfid->finish_writing_raw();
-        m_bWriteToFile = false;
+        m_pRawRecorder->stopRecording();
         m_pTimerRecordingChange->stop();
         m_pActionStartRecording->setIcon(QIcon(":/images/record.png"));
     }
@@ -457,8 +402,7 @@ void GUSBAmp::showStartRecording()
         }
 
         //Initiate the stream for writing to the fif file
-        m_fileOut.setFileName(m_sOutputFilePath);
-        if(m_fileOut.exists())
+        if(QFile::exists(m_sOutputFilePath))
         {
             QMessageBox msgBox;
             msgBox.setText("The file you want to write already exists.");
@@ -480,11 +424,13 @@ void GUSBAmp::showStartRecording()
             dir.mkpath(fileDir);
         }
 
-        m_pOutfid = Fiff::start_writing_raw(m_fileOut, *m_pFiffInfo, m_cals);
-        fiff_int_t first = 0;
-        m_pOutfid->write_int(FIFF_FIRST_SAMPLE, &first);
-
-        m_bWriteToFile = true;
+        if(!m_pRawRecorder->startRecording(m_sOutputFilePath, *m_pFiffInfo))
+        {
+            QMessageBox msgBox;
+            msgBox.setText("Could not open the file for writing.");
+            msgBox.exec();
+            return;
+        }
 
         m_pTimerRecordingChange = QSharedPointer<QTimer>(new QTimer);
         connect(m_pTimerRecordingChange.data(), &QTimer::timeout, this, &GUSBAmp::changeRecordingButton);
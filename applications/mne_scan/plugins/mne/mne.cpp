@@ -458,6 +458,7 @@ void MNE::updateInvOp(MNEInverseOperator::SPtr p_pInvOp)
     m_qMutex.lock();
 
     m_pMinimumNorm = MinimumNorm::SPtr(new MinimumNorm(*m_pInvOp.data(), lambda2, method));
+    m_pMinimumNorm->setFactoredKernel(true);
 
     //
     //   Set up the inverse according to the parameters
@@ -481,6 +481,8 @@ void NoiseReduction::setFilterChannelType(QString sType)
 
 void NoiseReduction::filterChanged(QList<FilterData> filterData)
 {
+    QMutexLocker locker(&m_mutex);
+
     m_filterData = filterData;
 
     m_iMaxFilterLength = 1;
@@ -489,6 +491,11 @@ void NoiseReduction::filterChanged(QList<FilterData> filterData)
             m_iMaxFilterLength = filterData.at(i).m_iFilterOrder;
         }
     }
+
+    //Plan the new filters once instead of on every block
+    if(m_pRtFilter) {
+        m_pRtFilter->setFilters(m_filterData);
+    }
 }
 
 
@@ -596,6 +603,7 @@ void NoiseReduction::initFilter()
     m_pOptionsWidget->filterGroupChanged(m_pFilterWindow->getActivationCheckBoxList());
 
     m_pRtFilter = RtFilter::SPtr(new RtFilter());
+    m_pRtFilter->setFilters(m_filterData);
 
     this->setFilterChannelType("MEG");
 
@@ -757,7 +765,7 @@ void NoiseReduction::run()
 
         //Do temporal filtering here
         if(m_bFilterActivated) {
-            t_mat = m_pRtFilter->filterChannelsConcurrently(t_mat, m_iMaxFilterLength, m_lFilterChannelList, m_filterData);
+            m_pRtFilter->filterData(t_mat, m_lFilterChannelList);
         }
 
 //        qDebug()<<"t_mat dim:"<<t_mat.rows()<<"x"<<t_mat.cols();
@@ -55,6 +55,9 @@
 
 RtSssAlgo rsss;
 
+// Head movement (in m) which moves the SSS origin far enough to rebuild the operator
+#define SSS_ORIGIN_MOVE_TOL 0.001
+
 //*************************************************************************************************************
 //=============================================================================================================
 // USED NAMESPACES
@@ -276,9 +279,18 @@ void RtSss::update(SCMEASLIB::NewMeasurement::SPtr pMeasurement)
         if(!m_pRtSssBuffer)
             m_pRtSssBuffer = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(32, pRTMSA->getNumChannels(), pRTMSA->getMultiSampleArray()[0].cols()));
 
+        //Keep a copy of the bad channels and the head position for the processing thread. The copy is taken
+        //before m_pFiffInfo is set, so it is there as soon as run() sees the fiff information.
+        FiffInfo::SPtr pFiffInfo = m_pFiffInfo ? m_pFiffInfo : pRTMSA->info();
+
+        m_qMutex.lock();
+        m_lBads = pFiffInfo->bads;
+        m_devHeadT = pFiffInfo->dev_head_t;
+        m_qMutex.unlock();
+
         //Fiff information
         if(!m_pFiffInfo)
-            m_pFiffInfo = pRTMSA->info();
+            m_pFiffInfo = pFiffInfo;
 
         if(m_bProcessData)
         {
@@ -303,6 +315,41 @@ MatrixXd rt_sss(const MatrixXd &p_mat)
 }
 
 
+//*************************************************************************************************************
+
+RowVectorXi RtSss::pickSssChannels(const QStringList& bads)
+{
+    QStringList exclude;
+    for(int i = 0; i < m_pFiffInfo->chs.size(); i++) {
+        if(m_pFiffInfo->chs.at(i).chpos.coil_type != FIFFV_COIL_BABY_MAG)
+            exclude<<m_pFiffInfo->chs.at(i).ch_name;
+    }
+
+    exclude<<bads;
+
+//    qDebug()<< exclude ;
+
+    QString chType("mag");
+    return m_pFiffInfo->pick_types(chType,false, false, QStringList(),exclude);
+}
+
+
+//*************************************************************************************************************
+
+Vector3d RtSss::computeSssOrigin(const FiffCoordTrans& devHeadT) const
+{
+    //Without a head position the origin stays at its default in device coordinates
+    Vector3d origin(0.0, 0.0, 0.04);
+
+    if(devHeadT.from == FIFFV_COORD_DEVICE && devHeadT.to == FIFFV_COORD_HEAD && !devHeadT.trans.isIdentity()) {
+        Vector4d originHead(0.0, 0.0, 0.04, 1.0);
+        origin = (devHeadT.trans.cast<double>().inverse() * originHead).head<3>();
+    }
+
+    return origin;
+}
+
+
 //*************************************************************************************************************
 
 void RtSss::run()
@@ -321,19 +368,14 @@ void RtSss::run()
     while(!m_pFiffInfo)
         msleep(10);// Wait for fiff Info
 
-    //Find index vector for wanted meg channels
-    QStringList exclude;
-    for(int i = 0; i < m_pFiffInfo->chs.size(); i++) {
-        if(m_pFiffInfo->chs.at(i).chpos.coil_type != FIFFV_COIL_BABY_MAG)
-            exclude<<m_pFiffInfo->chs.at(i).ch_name;
-    }
-
-    exclude<<m_pFiffInfo->bads;
-
-//    qDebug()<< exclude ;
+    //Bad channels and head position which the SSS operator is built for
+    m_qMutex.lock();
+    QStringList lBads = m_lBads;
+    FiffCoordTrans devHeadT = m_devHeadT;
+    m_qMutex.unlock();
 
-    QString chType("mag");
-    RowVectorXi pickedChannels = m_pFiffInfo->pick_types(chType,false, false, QStringList(),exclude);
+    //Find index vector for wanted meg channels
+    RowVectorXi pickedChannels = pickSssChannels(lBads);
     qDebug()<< "finished pickedChannels";
     qint32 nmegchanused = pickedChannels.cols();
 
@@ -397,6 +439,10 @@ void RtSss::run()
 //        }
     //qDebug() << "strat id: " << startID_MEGch;
 
+    // Set the expansion origin for the current head position
+    Vector3d origin = computeSssOrigin(devHeadT);
+    rsss.setOrigin(origin);
+
     //  Build linear equation
     qDebug() << "building an initial SSS linear equation .....";
     lineqn = rsss.buildLinearEqn();
@@ -413,6 +459,33 @@ void RtSss::run()
 
     while(m_bIsRunning)
     {
+        // Rebuild the SSS operator when the bad channels change or the head moved the origin. Configurations
+        // which were used before come from the operator cache.
+        m_qMutex.lock();
+        bool bBadsChanged = (m_lBads != lBads);
+        if(bBadsChanged)
+            lBads = m_lBads;
+        devHeadT = m_devHeadT;
+        m_qMutex.unlock();
+
+        Vector3d newOrigin = computeSssOrigin(devHeadT);
+        bool bOriginMoved = (newOrigin - origin).norm() > SSS_ORIGIN_MOVE_TOL;
+
+        if(bBadsChanged)
+        {
+            pickedChannels = pickSssChannels(lBads);
+            rsss.setMEGInfo(m_pFiffInfo, pickedChannels);
+        }
+
+        if(bOriginMoved)
+        {
+            origin = newOrigin;
+            rsss.setOrigin(origin);
+        }
+
+        if(bBadsChanged || bOriginMoved)
+            lineqn = rsss.buildLinearEqn();
+
 //        if (m_bIsHeadMov)
 //        {
 //            lineqn = rsss.buildLinearEqn();
@@ -155,6 +155,27 @@ public:
 protected:
     virtual void run();
 
+    //=========================================================================================================
+    /**
+    * Picks the good BabyMEG magnetometers which are used for rtSSS.
+    *
+    * @param[in] bads   The bad channels which are excluded.
+    *
+    * @return The indices of the picked channels.
+    */
+    Eigen::RowVectorXi pickSssChannels(const QStringList& bads);
+
+    //=========================================================================================================
+    /**
+    * Computes the SSS expansion origin in device coordinates. The origin is kept at (0,0,0.04) m in head
+    * coordinates and follows the head when a device to head transformation is available.
+    *
+    * @param[in] devHeadT   The device to head transformation.
+    *
+    * @return The SSS expansion origin in device coordinates.
+    */
+    Eigen::Vector3d computeSssOrigin(const FiffCoordTrans& devHeadT) const;
+
 private:
 //    PluginInputData<NewRealTimeSampleArray>::SPtr   m_pDummyInput;      /**< The RealTimeSampleArray of the DummyToolbox input.*/
 //    PluginOutputData<NewRealTimeSampleArray>::SPtr  m_pDummyOutput;    /**< The RealTimeSampleArray of the DummyToolbox output.*/
@@ -177,6 +198,9 @@ private:
 
     QMutex m_qMutex;
 
+    QStringList     m_lBads;            /**< Bad channels of the latest incoming block. Guarded by m_qMutex. */
+    FiffCoordTrans  m_devHeadT;         /**< Device to head transformation of the latest incoming block. Guarded by m_qMutex. */
+
     //    dBuffer::SPtr   m_pRtSssBuffer;      /**< Holds incoming data.*/
 };
 
@@ -40,6 +40,7 @@
 #include <QFuture>
 #include <QtConcurrent/QtConcurrentMap>
 #include <QFile>
+#include <QCryptographicHash>
 //#include "FormFiles/rtssssetupwidget.h"
 
 RtSssAlgo::RtSssAlgo()
@@ -51,7 +52,8 @@ RtSssAlgo::RtSssAlgo()
 , LInOLS(0)
 , LOutOLS(0)
 {
-
+    // Set origin of head(?) coordinate
+    Origin << 0.0, 0.0, 0.04;
 }
 
 RtSssAlgo::~RtSssAlgo()
@@ -64,6 +66,25 @@ MatrixXd RtSssAlgo::buildLinearEqn()
 {
     //qDebug() << "buildLinearEqn START";
 
+    // The operator only depends on the coil geometry, the expansion orders, the origin and the channel
+    // selection. Reuse it if it was already built for this configuration.
+    QByteArray key = getOperatorKey();
+
+    if(OperatorCache.contains(key))
+    {
+        const SssOperator& op = OperatorCache[key];
+        EqnIn = op.EqnIn;
+        EqnOut = op.EqnOut;
+        EqnARR = op.EqnARR;
+        EqnA = op.EqnA;
+        EqnRRInv = op.EqnRRInv;
+        EqnInv = op.EqnInv;
+        EqnRRPinv = op.EqnRRPinv;
+        SSSProj = op.SSSProj;
+
+        return op.CoilScale;
+    }
+
     QList<MatrixXd> Eqn, EqnRR;
     QList<MatrixXd> LinEqn;
     qint32 LIn, LOut;
@@ -160,6 +181,29 @@ MatrixXd RtSssAlgo::buildLinearEqn()
 //    LinEqn.append(EqnB);
     LinEqn.append(CoilScale.asDiagonal());
 
+    // Precompute the inverses of the normal matrices and the fused OLS projection
+    //      SSSProj = EqnIn * [(EqnA' * EqnA)^-1 * EqnA'](1:NumBIn,:)
+    // which maps a block of data onto the recovered internal signal with a single product.
+    EqnRRInv = (EqnARR.transpose() * EqnARR).inverse();
+    EqnInv = (EqnA.transpose() * EqnA).inverse();
+    EqnRRPinv = EqnRRInv * EqnARR.transpose();
+    SSSProj = EqnIn * (EqnInv * EqnA.transpose()).topRows(EqnIn.cols());
+
+    if(OperatorCache.size() >= SSS_OPERATOR_CACHE_SIZE)
+        OperatorCache.clear();
+
+    SssOperator op;
+    op.EqnIn = EqnIn;
+    op.EqnOut = EqnOut;
+    op.EqnARR = EqnARR;
+    op.EqnA = EqnA;
+    op.EqnRRInv = EqnRRInv;
+    op.EqnInv = EqnInv;
+    op.EqnRRPinv = EqnRRPinv;
+    op.SSSProj = SSSProj;
+    op.CoilScale = CoilScale.asDiagonal();
+    OperatorCache.insert(key, op);
+
 
 //    std::cout << "EqnInRR *********************************" << endl << EqnInRR << endl << endl;
 //    std::cout << "EqnOutRR ********************************" << endl << EqnOutRR << endl << endl;
@@ -190,13 +234,46 @@ void RtSssAlgo::setSSSParameter(QList<int> expansionOrder)
     LOutOLS = expansionOrder[3];
 }
 
+void RtSssAlgo::setOrigin(const Vector3d& origin)
+{
+    Origin = origin;
+}
+
+//
+// Key of the SSS operator: the coil geometry and names of the used channels (this covers the bad channel
+// set), the expansion orders and the origin.
+QByteArray RtSssAlgo::getOperatorKey()
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+
+    hash.addData((const char*)&LInRR, sizeof(qint32));
+    hash.addData((const char*)&LOutRR, sizeof(qint32));
+    hash.addData((const char*)&LInOLS, sizeof(qint32));
+    hash.addData((const char*)&LOutOLS, sizeof(qint32));
+    hash.addData((const char*)Origin.data(), 3*sizeof(double));
+    hash.addData((const char*)&NumCoil, sizeof(qint32));
+
+    for(int i=0; i<NumCoil; i++)
+    {
+        hash.addData(CoilName[i].toUtf8());
+        hash.addData((const char*)CoilT[i].data(), CoilT[i].size()*sizeof(double));
+        hash.addData((const char*)CoilRk[i].data(), CoilRk[i].size()*sizeof(double));
+        hash.addData((const char*)CoilWk[i].data(), CoilWk[i].size()*sizeof(double));
+        hash.addData((const char*)&CoilGrad(i), sizeof(int));
+    }
+
+    return hash.result();
+}
+
 void RtSssAlgo::setMEGInfo(FiffInfo::SPtr fiffInfo, RowVectorXi pickedChannels)
 {
     //qDebug() << "setMEGInfo START";
 
-    // Set origin of head(?) coordinate
-    Origin.resize(3);
-    Origin << 0.0, 0.0, 0.04;
+    // Forget the coils of a previous channel selection
+    CoilT.clear();
+    CoilName.clear();
+    CoilRk.clear();
+    CoilWk.clear();
 
 //    // Find the number of MEG channels
 //    qint32 nmegchan = 0;
@@ -820,15 +897,51 @@ MatrixXd RtSssAlgo::getSSSRR(MatrixXd EqnB)
 {
     //qDebug() << "getSSSRR START";
 
-    int NumBIn, NumBOut, NumCoil, NumExp;
-    MatrixXd EqnRRInv, EqnInv, SSSIn, SSSOut, Weight; //, ErrRel;
-    VectorXd ErrRel;
+    int NumCoil, NumExp;
+    MatrixXd SSSIn, SolRR, ErrRR;
+
+//  % initialization
+    NumCoil = EqnB.rows();
+    NumExp = EqnB.cols();
+
+    SSSIn.setZero(NumCoil,NumExp);
+
+//  % solve OLS solution and its residual for the whole block at once
+    SolRR = EqnRRPinv * EqnB;
+    ErrRR = EqnARR * SolRR - EqnB;
+
+//  % the robust regression is independent for every sample -> solve the samples concurrently
+    QList<int> lSamples;
+    for(int i=0; i<NumExp; i++)
+        lSamples.append(i);
+
+    QtConcurrent::blockingMap(lSamples, [&](int& i) {
+        SSSIn.col(i) = getSSSRRSample(EqnB.col(i), SolRR.col(i), ErrRR.col(i));
+    });
+
+    //qDebug() << "getSSSRR END";
+
+    return SSSIn;
+}
+
+//%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+//% robust SSS of a single sample
+//%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+//% EqnBi(i,1):       SSS equation (RHS) of the sample
+//% SolRRi(j,1):      OLS solution of the robust equation EqnARR
+//% ErrRRi(i,1):      residual of the OLS solution
+//%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+//% returns the internal MEG signal of the sample recovered by SSS
+//%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
+VectorXd RtSssAlgo::getSSSRRSample(const VectorXd& EqnBi, const VectorXd& SolRRi, const VectorXd& ErrRRi) const
+{
+    int NumBIn, NumBOut;
+    VectorXd Weight;
     double RR_K1, RR_K2, RR_K3;
     double eqn_scale0, eqn_scale;
-    MatrixXd sol_X, sol_X_old, eqn_Y, eqn_D, temp_M, temp_N, sol_in, sol_out;
+    MatrixXd sol_X, sol_X_old, eqn_Y, eqn_D, temp_M, temp_N, sol_in;
     MatrixXd diagMat;
     VectorXd eqn_err, weight_index;
-    QList<MatrixXd> RRsss;
 
 //  % error tolerance for robust regression
     double ErrTolRel = 1e-3;
@@ -839,126 +952,63 @@ MatrixXd RtSssAlgo::getSSSRR(MatrixXd EqnB)
 //  % initialization
     NumBIn = EqnIn.cols();
     NumBOut = EqnOut.cols();
-    NumCoil = EqnB.rows();
-    NumExp = EqnB.cols();
 
-    EqnRRInv = (EqnARR.transpose() * EqnARR).inverse();
-    EqnInv = (EqnA.transpose() * EqnA).inverse();
-
-    SSSIn.setZero(NumCoil,NumExp);
-    SSSOut.setZero(NumCoil,NumExp);
-    Weight.setZero(NumCoil,NumExp);
-    ErrRel.setZero(NumExp);
     RR_K3 = 3;
     RR_K2 = 4.685;
     RR_K1 = qSqrt(1-qSqrt(3)/2) * RR_K2;
 
-    for(int i=0; i<NumExp; i++)
-    {
-//      % solve OLS solution
-        sol_X = EqnRRInv * (EqnARR.transpose() * EqnB.col(i));
-//        std::cout << "sol_X ************************" << endl << sol_X.transpose() << endl;
-
-//      % scale linear equation
-        eqn_err = EqnARR * sol_X - EqnB.col(i);
-        eqn_scale0 = stdev(eqn_err);
-        eqn_err = eqn_err.cwiseAbs() / eqn_scale0;
-
-//      % solve iteratively re-weighted least squares (Bi-Square) -- subspace
-        sol_X_old.setConstant(sol_X.rows(), sol_X.cols(), 1e30);
-//        while (((sol_X-sol_X_old).norm() / sol_X.norm()) > ErrTolRel)
-        int cnt=0;
-        while (((sol_X.array()-sol_X_old.array()).matrix().norm() / sol_X.norm()) > ErrTolRel)
-//        for (int h=0; h<2; h++)
-        {
-            cnt++;
-//            cout << "while cnt: " << cnt << endl;
-            sol_X_old = sol_X;
-//            Weight(:,i) = (eqn_err <= RR_K1) + (eqn_err > RR_K1 & eqn_err <= RR_K2) .* (1-(eqn_err-RR_K1).^2/(RR_K2-RR_K1)^2).^2;
-//            Weight.col(i) = eigen_LTE(eqn_err, RR_K1) + eigen_AND(eigen_GT(eqn_err, RR_K1),eigen_LTE(eqn_err, RR_K2));
-            Weight.col(i) = eigen_LTE(eqn_err,RR_K1).array() + eigen_AND(eigen_GT(eqn_err,RR_K1),eigen_LTE(eqn_err,RR_K2)).array() * (1 - ((eqn_err.array()-RR_K1).pow(2)) / pow(RR_K2-RR_K1,2) ).pow(2);
-//            std::cout << "Weight **************************" << endl << Weight.transpose() << endl;
-
-//          % weight_index = find(Weight(:,i) < WeightThres);
-            weight_index = eigen_LT_index(Weight.col(i), WeightThres);
-//            weight_index = eigen_LT_index_test(Weight.col(i), h);
-//            std:cout << "weight_index ********************* " << endl << weight_index << endl;
-
-//          % eqn_Y = EqnARR(weight_index,:);   eqn_D = Weight(weight_index,i) - 1;
-            eqn_Y.resize(weight_index.size(), EqnARR.cols());
-            eqn_D.resize(weight_index.size(),1);
-            for(int k=0; k<weight_index.size(); k++)
-            {
-                eqn_Y.row(k) = EqnARR.row(weight_index(k));
-//                std::cout << "eqn_Y: " << eqn_Y.rows() << " x " << eqn_Y.cols() << endl;
-//                std::cout << "eqn_D: "  << eqn_D.rows() << " x " << eqn_D.cols() << endl;
-                eqn_D(k) = Weight(weight_index(k),i) - 1;
-            }
-//              std::cout << "eqn_D: " << endl << eqn_D.transpose() << endl << endl;
-            temp_M = EqnARR.transpose() * (Weight.col(i).array() * EqnB.col(i).array()).matrix();
-//              std::cout << "temp_M: " << endl << temp_M.transpose() << endl << endl;
+//  % OLS solution
+    sol_X = SolRRi;
 
-//            std::cout << "EqnRRInv: " << EqnRRInv.rows() << " x " << EqnRRInv.cols() << endl;
-//            std::cout << "eqn_Y: " << eqn_Y.rows() << " x " << eqn_Y.cols() << endl;
-//              std::cout << "EqnRRInv: " << endl << EqnRRInv.transpose() << endl << endl;
-//              std::cout << "eqn_Y: " << endl << eqn_Y.transpose() << endl << endl;
+//  % scale linear equation
+    eqn_scale0 = stdev(ErrRRi);
+    eqn_err = ErrRRi.cwiseAbs() / eqn_scale0;
 
-            temp_N = EqnRRInv * eqn_Y.transpose();
-//              std::cout << "temp_N: " << endl << temp_N.transpose() << endl << endl;
-
-
-//            diagMat = eqn_D.asDiagonal();
-//        std::cout << "diagMat ************************" << endl << diagMat.transpose() << endl;
-//            diagMat = 1 / diagMat.array();
-//        std::cout << "diagMat ************************" << endl << diagMat.transpose() << endl;
-
-            diagMat = (1 / eqn_D.array()).matrix().asDiagonal();
-//            cout << "diagMat ************************" << i+1 << endl << diagMat.rows() << " x" << diagMat.cols() << endl;
-
-            sol_X = EqnRRInv * temp_M - temp_N * (diagMat + eqn_Y * temp_N).inverse() * (temp_N.transpose() * temp_M);
-            eqn_err = (EqnARR * sol_X - EqnB.col(i)).cwiseAbs();
-            eqn_scale = qMin(eqn_scale0, RR_K3 * qSqrt((Weight.col(i).array() * eqn_err.array() * eqn_err.array()).mean()));
-            eqn_err = eqn_err / eqn_scale;
-//             std::cout << "temp_M: " << endl << temp_M.transpose() << endl << endl;
+//  % solve iteratively re-weighted least squares (Bi-Square) -- subspace
+    sol_X_old.setConstant(sol_X.rows(), sol_X.cols(), 1e30);
+    while (((sol_X.array()-sol_X_old.array()).matrix().norm() / sol_X.norm()) > ErrTolRel)
+    {
+        sol_X_old = sol_X;
+//      % Weight(:,i) = (eqn_err <= RR_K1) + (eqn_err > RR_K1 & eqn_err <= RR_K2) .* (1-(eqn_err-RR_K1).^2/(RR_K2-RR_K1)^2).^2;
+        Weight = eigen_LTE(eqn_err,RR_K1).array() + eigen_AND(eigen_GT(eqn_err,RR_K1),eigen_LTE(eqn_err,RR_K2)).array() * (1 - ((eqn_err.array()-RR_K1).pow(2)) / pow(RR_K2-RR_K1,2) ).pow(2);
 
-//            std::cout << "(sol_X.array()-sol_X_old.array()).matrix().norm(): " << (sol_X.array()-sol_X_old.array()).matrix().norm() << endl << endl;
-//            std::cout << "sol_X.norm():  " << sol_X.norm()  << endl  << endl;
-//        std::cout << "sol_X ************************" << endl << sol_X.transpose() << endl << endl;
+//      % weight_index = find(Weight(:,i) < WeightThres);
+        weight_index = eigen_LT_index(Weight, WeightThres);
 
+//      % eqn_Y = EqnARR(weight_index,:);   eqn_D = Weight(weight_index,i) - 1;
+        eqn_Y.resize(weight_index.size(), EqnARR.cols());
+        eqn_D.resize(weight_index.size(),1);
+        for(int k=0; k<weight_index.size(); k++)
+        {
+            eqn_Y.row(k) = EqnARR.row(weight_index(k));
+            eqn_D(k) = Weight(weight_index(k)) - 1;
         }
-//      % solve weighted SSS - full
-//      % eqn_Y = EqnA(weight_index,:); temp_M = EqnA' * (Weight(:,i).*EqnB(:,i)); temp_N = EqnInv * eqn_Y';
-        eqn_Y.resize(weight_index.size(), NumBIn+NumBOut);
-        for(int k=0; k<weight_index.size(); k++) eqn_Y.row(k) = EqnA.row(weight_index(k));
-        temp_M = EqnA.transpose() * (Weight.col(i).array() * EqnB.col(i).array()).matrix();
-        temp_N = EqnInv * eqn_Y.transpose();
-
+        temp_M = EqnARR.transpose() * (Weight.array() * EqnBi.array()).matrix();
+        temp_N = EqnRRInv * eqn_Y.transpose();
 
-//      % sol_X = EqnInv * temp_M - temp_N * ((diag(1./eqn_D) + eqn_Y * temp_N); // \ (temp_N'*temp_M));
-//        diagMat = eqn_D.asDiagonal();
-//        diagMat = 1 / diagMat.array();
         diagMat = (1 / eqn_D.array()).matrix().asDiagonal();
-        sol_X = EqnInv * temp_M - temp_N * (diagMat + eqn_Y * temp_N).inverse() * (temp_N.transpose() * temp_M);
-
-        ErrRel(i) = (EqnA * sol_X - EqnB.col(i)).norm() / EqnB.col(i).norm();
 
-        sol_in = sol_X.block(0,0,NumBIn,1);
-        sol_out = sol_X.block(NumBIn,0,NumBOut,1);  // sol_X(NumBIn+1:NumBIn+NumBOut,1);
+        sol_X = EqnRRInv * temp_M - temp_N * (diagMat + eqn_Y * temp_N).inverse() * (temp_N.transpose() * temp_M);
+        eqn_err = (EqnARR * sol_X - EqnBi).cwiseAbs();
+        eqn_scale = qMin(eqn_scale0, RR_K3 * qSqrt((Weight.array() * eqn_err.array() * eqn_err.array()).mean()));
+        eqn_err = eqn_err / eqn_scale;
+    }
 
-//      % recover internal/external MEG siganl
-        SSSIn.col(i) = EqnIn * sol_in;
-        SSSOut.col(i) = EqnOut * sol_out;
+//  % solve weighted SSS - full
+//  % eqn_Y = EqnA(weight_index,:); temp_M = EqnA' * (Weight(:,i).*EqnB(:,i)); temp_N = EqnInv * eqn_Y';
+    eqn_Y.resize(weight_index.size(), NumBIn+NumBOut);
+    for(int k=0; k<weight_index.size(); k++) eqn_Y.row(k) = EqnA.row(weight_index(k));
+    temp_M = EqnA.transpose() * (Weight.array() * EqnBi.array()).matrix();
+    temp_N = EqnInv * eqn_Y.transpose();
 
-    }
-    RRsss.append(SSSIn);
-    RRsss.append(SSSOut);
-    RRsss.append(Weight);
-    RRsss.append(ErrRel);
+//  % sol_X = EqnInv * temp_M - temp_N * ((diag(1./eqn_D) + eqn_Y * temp_N); // \ (temp_N'*temp_M));
+    diagMat = (1 / eqn_D.array()).matrix().asDiagonal();
+    sol_X = EqnInv * temp_M - temp_N * (diagMat + eqn_Y * temp_N).inverse() * (temp_N.transpose() * temp_M);
 
-    //qDebug() << "getSSSRR END";
+    sol_in = sol_X.block(0,0,NumBIn,1);
 
-//    return RRsss;
-    return SSSIn;
+//  % recover internal MEG siganl
+    return EqnIn * sol_in;
 }
 
 //%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%%
@@ -989,42 +1039,11 @@ MatrixXd RtSssAlgo::getSSSOLS(MatrixXd EqnB)
 {
     //qDebug() << "getSSSOLS START";
 
-    int NumBIn, NumBOut, NumCoil, NumExp;
-    MatrixXd EqnRRInv, EqnInv, SSSIn, SSSOut;
-    MatrixXd sol_X, sol_in, sol_out;
-    VectorXd ErrRel;
-    QList<MatrixXd> OLSsss;
-
-//  % initialization
-    NumBIn = EqnIn.cols();
-    NumBOut = EqnOut.cols();
-    NumCoil = EqnB.rows();
-    NumExp = EqnB.cols();
-
-    EqnRRInv = (EqnA.transpose() * EqnA).inverse();
-    SSSIn.setZero(NumCoil,NumExp);
-    SSSOut.setZero(NumCoil,NumExp);
-    ErrRel.setZero(NumExp);
-
-    for (int i=0; i<NumExp; i++)
-    {
-//      % solve OLS solution
-        sol_X = EqnRRInv * (EqnA.transpose() * EqnB.col(i));
-
-        ErrRel(i) = (EqnA * sol_X - EqnB.col(i)).norm() / EqnB.col(i).norm();
-
-        sol_in = sol_X.block(0,0,NumBIn,1);
-
-        sol_out = sol_X.block(NumBIn,0, NumBOut,1);    // probably NumBIn+0 is correct.  Please debug !!!!
-
-//      % recover internal/external MEG siganl
-        SSSIn.col(i) = EqnIn * sol_in;
-        SSSOut.col(i) = EqnOut * sol_out;
-    }
+    MatrixXd SSSIn;
 
-    OLSsss.append(SSSIn);
-    OLSsss.append(SSSOut);
-    OLSsss.append(ErrRel);
+//  % recover internal MEG signal of the whole block with the fused projection
+//  %   SSSIn = EqnIn * sol_in,  sol_X = (EqnA' * EqnA)^-1 * EqnA' * EqnB
+    SSSIn.noalias() = SSSProj * EqnB;
 
     //qDebug() << "getSSSOLS END";
 
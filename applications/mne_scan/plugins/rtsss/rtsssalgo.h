@@ -49,6 +49,8 @@
 #include <QtGlobal>
 #include <QtCore/qmath.h>
 #include <QList>
+#include <QHash>
+#include <QByteArray>
 #include <Eigen/Dense>
 #include <iostream>
 #include <QString>
@@ -68,6 +70,9 @@
 #define BABYMEG 1
 #define VECTORVIEW 2
 
+// Number of SSS operators kept for earlier channel selections
+#define SSS_OPERATOR_CACHE_SIZE 8
+
 using namespace Eigen;
 using namespace std;
 using namespace FIFFLIB;
@@ -90,6 +95,16 @@ VectorXd eigen_LT_index_test(int);
 VectorXd eigen_GT(VectorXd V, double tol);
 VectorXd eigen_AND(VectorXd V1, VectorXd V2);
 
+// Everything the SSS reconstruction needs for one sensor geometry, expansion order and channel selection
+struct SssOperator
+{
+    MatrixXd EqnIn, EqnOut, EqnARR, EqnA;   // in/out basis and scaled linear equations (robust and full)
+    MatrixXd EqnRRInv, EqnInv;              // inverses of the normal matrices of EqnARR and EqnA
+    MatrixXd EqnRRPinv;                     // pseudo-inverse of EqnARR (initial solution of the robust regression)
+    MatrixXd SSSProj;                       // fused projection of the data onto the internal signal (OLS)
+    MatrixXd CoilScale;                     // diagonal coil scaling
+};
+
 class RtSssAlgo
 {
 public:
@@ -111,6 +126,7 @@ public:
 
     void setMEGInfo(FiffInfo::SPtr fiffinfo, RowVectorXi);
     void setSSSParameter(QList<int>);
+    void setOrigin(const Vector3d&);
     qint32 getNumMEGChan();
     qint32 getNumMEGChanUsed();
     qint32 getNumMEGBadChan();
@@ -126,6 +142,8 @@ private:
     void getCartesianToSpherCoordinate(VectorXd, VectorXd, VectorXd);
     void getSphereToCartesianVector();
     int strmatch(char, char);
+    QByteArray getOperatorKey();
+    VectorXd getSSSRRSample(const VectorXd&, const VectorXd&, const VectorXd&) const;
 
     qint32 NumMEGChan, NumCoil, NumBadCoil;
     VectorXi BadChan;
@@ -140,6 +158,9 @@ private:
     Vector3d Origin;
     MatrixXd BInX, BInY, BInZ, BOutX, BOutY, BOutZ;
     MatrixXd EqnInRR, EqnOutRR, EqnIn, EqnOut, EqnARR, EqnA, EqnB;
+    MatrixXd EqnRRInv, EqnInv, EqnRRPinv, SSSProj;
+
+    QHash<QByteArray, SssOperator> OperatorCache;
 
     VectorXd R, PHI, THETA;
     VectorXd R_X, R_Y, R_Z;
@@ -53,6 +53,9 @@
 //=============================================================================================================
 
 #include <QDebug>
+#include <QList>
+#include <QThread>
+#include <QtConcurrent/QtConcurrent>
 
 
 //*************************************************************************************************************
@@ -77,6 +80,71 @@ using namespace Eigen;
 // DEFINE GLOBAL METHODS
 //=============================================================================================================
 
+namespace {
+
+/**
+* One share of the work of calcCrossCorrelationMatrix. Every job owns its FFT object and buffers.
+*/
+struct CrossCorrelationJob
+{
+    const MatrixXd*     pMatData;
+    MatrixXcd*          pMatSpectra;    /**< Half spectra, one column per row of the data. */
+    MatrixXd*           pMatCorr;
+    MatrixXi*           pMatLags;
+    int                 iFFTSize;
+    int                 iJob;
+    int                 iNumJobs;
+};
+
+void computeSpectraCrossCorrelation(CrossCorrelationJob& job)
+{
+    Eigen::FFT<double> fft;
+    fft.SetFlag(Eigen::FFT<double>::HalfSpectrum);
+
+    const int iSamples = job.pMatData->cols();
+    RowVectorXd vecTime = RowVectorXd::Zero(job.iFFTSize);
+
+    for(int i = job.iJob; i < job.pMatData->rows(); i += job.iNumJobs) {
+        vecTime.head(iSamples) = job.pMatData->row(i);
+        fft.fwd(job.pMatSpectra->col(i).data(), vecTime.data(), job.iFFTSize);
+    }
+}
+
+void computePairsCrossCorrelation(CrossCorrelationJob& job)
+{
+    Eigen::FFT<double> fft;
+    fft.SetFlag(Eigen::FFT<double>::HalfSpectrum);
+    fft.SetFlag(Eigen::FFT<double>::Unscaled);
+
+    const int iRows = job.pMatData->rows();
+    VectorXcd vecCrossSpectrum(job.pMatSpectra->rows());
+    VectorXd vecResult(job.iFFTSize);
+    const double dScale = 1.0 / job.iFFTSize;
+    int idx = 0;
+
+    //Interleave the rows of the upper triangle over the jobs to balance the load
+    for(int i = job.iJob; i < iRows; i += job.iNumJobs) {
+        for(int j = i; j < iRows; ++j) {
+            vecCrossSpectrum = job.pMatSpectra->col(i).cwiseProduct(job.pMatSpectra->col(j).conjugate());
+            fft.inv(vecResult.data(), vecCrossSpectrum.data(), job.iFFTSize);
+
+            const double dMax = vecResult.maxCoeff(&idx) * dScale;
+
+            (*job.pMatCorr)(i,j) = dMax;
+            (*job.pMatCorr)(j,i) = dMax;
+
+            if(job.pMatLags) {
+                //Indices past the middle are negative lags. Cross correlation is antisymmetric in the lag.
+                const int iLag = idx <= job.iFFTSize/2 ? idx : idx - job.iFFTSize;
+                (*job.pMatLags)(i,j) = iLag;
+                (*job.pMatLags)(j,i) = -iLag;
+            }
+        }
+    }
+}
+
+} // NAMESPACE
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -92,76 +160,91 @@ ConnectivityMeasures::ConnectivityMeasures()
 
 Network ConnectivityMeasures::pearsonsCorrelationCoeff(const MatrixXd& matData, const MatrixX3f& matVert)
 {
-    Network finalNetwork("Pearson's Correlation Coefficient");
+    return createNetwork("Pearson's Correlation Coefficient", calcPearsonsCorrelationMatrix(matData), matVert);
+}
 
-    //Create nodes
-    for(int i = 0; i < matData.rows(); ++i) {
-        RowVectorXf rowVert = RowVectorXf::Zero(3);
 
-        if(matVert.rows() != 0 && i < matVert.rows()) {
-            rowVert(0) = matVert.row(i)(0);
-            rowVert(1) = matVert.row(i)(1);
-            rowVert(2) = matVert.row(i)(2);
-        }
+//*************************************************************************************************************
 
-        finalNetwork << NetworkNode::SPtr(new NetworkNode(i, rowVert));
-    }
+Network ConnectivityMeasures::crossCorrelation(const MatrixXd& matData, const MatrixX3f& matVert)
+{
+    return createNetwork("Cross Correlation", calcCrossCorrelationMatrix(matData), matVert);
+}
+
+
+//*************************************************************************************************************
 
-    //Create edges
-    double pearsonsCoeff;
+MatrixXd ConnectivityMeasures::calcPearsonsCorrelationMatrix(const MatrixXd& matData)
+{
+    const int iRows = matData.rows();
 
-    for(int i = 0; i < matData.rows(); ++i) {
-        for(int j = i; j < matData.rows(); ++j) {
-            pearsonsCoeff = calcPearsonsCorrelationCoeff(matData.row(i), matData.row(j));
+    if(iRows == 0 || matData.cols() == 0) {
+        return MatrixXd::Zero(iRows, iRows);
+    }
 
-            QSharedPointer<NetworkEdge> pEdge = QSharedPointer<NetworkEdge>(new NetworkEdge(finalNetwork.getNodes()[i], finalNetwork.getNodes()[j], pearsonsCoeff));
+    //Center and normalize every row, constant rows do not correlate with anything
+    MatrixXd matNormalized = matData.colwise() - matData.rowwise().mean();
+    VectorXd vecNorms = matNormalized.rowwise().norm();
 
-            *finalNetwork.getNodeAt(i) << pEdge;
-            finalNetwork << pEdge;
+    for(int i = 0; i < iRows; ++i) {
+        if(vecNorms(i) > 0.0) {
+            matNormalized.row(i) /= vecNorms(i);
+        } else {
+            matNormalized.row(i).setZero();
         }
     }
 
-    return finalNetwork;
+    //All coefficients by one symmetric rank-k update
+    MatrixXd matCorr = MatrixXd::Zero(iRows, iRows);
+    matCorr.selfadjointView<Eigen::Lower>().rankUpdate(matNormalized);
+
+    return matCorr.selfadjointView<Eigen::Lower>();
 }
 
 
 //*************************************************************************************************************
 
-Network ConnectivityMeasures::crossCorrelation(const MatrixXd& matData, const MatrixX3f& matVert)
+MatrixXd ConnectivityMeasures::calcCrossCorrelationMatrix(const MatrixXd& matData, MatrixXi* pMatLags)
 {
-    Network finalNetwork("Cross Correlation");
-
-    //Create nodes
-    for(int i = 0; i < matData.rows(); ++i) {
-        RowVectorXf rowVert = RowVectorXf::Zero(3);
-
-        if(matVert.rows() != 0 && i < matVert.rows()) {
-            rowVert(0) = matVert.row(i)(0);
-            rowVert(1) = matVert.row(i)(1);
-            rowVert(2) = matVert.row(i)(2);
-        }
+    const int iRows = matData.rows();
+    MatrixXd matCorr = MatrixXd::Zero(iRows, iRows);
 
-        finalNetwork << NetworkNode::SPtr(new NetworkNode(i, rowVert));
+    if(pMatLags) {
+        pMatLags->setZero(iRows, iRows);
     }
 
-    //Create edges
-    QPair<int,double> crossCorrPair;
-
-    for(int i = 0; i < matData.rows(); ++i) {
-        for(int j = i; j < matData.rows(); ++j) {
-            crossCorrPair = calcCrossCorrelation(matData.row(i), matData.row(j));
+    if(iRows == 0 || matData.cols() == 0) {
+        return matCorr;
+    }
 
-            QSharedPointer<NetworkEdge> pEdge = QSharedPointer<NetworkEdge>(new NetworkEdge(finalNetwork.getNodes()[i], finalNetwork.getNodes()[j], crossCorrPair.second));
+    //Compute the FFT size as the "next power of 2" of 2*N-1, so that the correlation does not wrap around
+    int iFFTSize = 2;
+    while(iFFTSize < 2 * matData.cols() - 1) {
+        iFFTSize *= 2;
+    }
 
-            *finalNetwork.getNodeAt(i) << pEdge;
-            finalNetwork << pEdge;
-        }
+    //One half spectrum per row, stored column wise so that every spectrum is contiguous
+    MatrixXcd matSpectra(iFFTSize/2 + 1, iRows);
+
+    const int iNumJobs = std::max(1, std::min(QThread::idealThreadCount(), iRows));
+    QList<CrossCorrelationJob> lJobs;
+
+    for(int t = 0; t < iNumJobs; ++t) {
+        CrossCorrelationJob job;
+        job.pMatData = &matData;
+        job.pMatSpectra = &matSpectra;
+        job.pMatCorr = &matCorr;
+        job.pMatLags = pMatLags;
+        job.iFFTSize = iFFTSize;
+        job.iJob = t;
+        job.iNumJobs = iNumJobs;
+        lJobs.append(job);
     }
 
-//    finalNetwork.scale();
-//    matDist /= matDist.maxCoeff();
+    QtConcurrent::blockingMap(lJobs, computeSpectraCrossCorrelation);
+    QtConcurrent::blockingMap(lJobs, computePairsCrossCorrelation);
 
-    return finalNetwork;
+    return matCorr;
 }
 
 
@@ -173,7 +256,16 @@ double ConnectivityMeasures::calcPearsonsCorrelationCoeff(const Eigen::RowVector
         qDebug() << "ConnectivityMeasures::calcPearsonsCorrelationCoeff - Vectors length do not match!";
     }
 
-    return (vecFirst.dot(vecSecond))/vecFirst.cols();
+    RowVectorXd vecFirstCentered = vecFirst.array() - vecFirst.mean();
+    RowVectorXd vecSecondCentered = vecSecond.array() - vecSecond.mean();
+
+    double dNorm = vecFirstCentered.norm() * vecSecondCentered.norm();
+
+    if(dNorm == 0.0) {
+        return 0.0;
+    }
+
+    return vecFirstCentered.dot(vecSecondCentered) / dNorm;
 }
 
 
@@ -205,13 +297,8 @@ QPair<int,double> ConnectivityMeasures::calcCrossCorrelation(const RowVectorXd&
     fft.fwd(freqvec, xCorrInputVecFirst);
     fft.fwd(freqvec2, xCorrInputVecSecond);
 
-    //Create conjugate complex
-    freqvec2.conjugate();
-
     //Main step of cross corr
-    for (int i = 0; i < fftsize; i++) {
-        freqvec[i] = freqvec[i] * freqvec2[i];
-    }
+    freqvec = freqvec.cwiseProduct(freqvec2.conjugate());
 
     RowVectorXd result;
     fft.inv(result, freqvec);
@@ -233,9 +320,21 @@ QPair<int,double> ConnectivityMeasures::calcCrossCorrelation(const RowVectorXd&
 //    std::cout<<"end"<<end<<std::endl;
 //    std::cout<<"maxlag"<<maxlag<<std::endl;
 
-    //Return val
+    //Return val, indices past the middle are negative lags as in calcCrossCorrelationMatrix
     int resultIndex = minMaxRange.second;
     double maxValue = result2(resultIndex);
+    int iLag = resultIndex <= fftsize/2 ? resultIndex : resultIndex - fftsize;
+
+    return QPair<int,double>(iLag, maxValue);
+}
+
+
+//*************************************************************************************************************
+
+Network ConnectivityMeasures::createNetwork(const QString& sName, const MatrixXd& matConnectivity, const MatrixX3f& matVert)
+{
+    //Undirected measures, store every edge once in the upper triangle
+    MatrixXd matWeights = matConnectivity.triangularView<Eigen::Upper>();
 
-    return QPair<int,double>(resultIndex, maxValue);
+    return Network(matWeights, matVert, sName);
 }
@@ -126,7 +126,47 @@ public:
     */
     static Network crossCorrelation(const Eigen::MatrixXd& matData, const Eigen::MatrixX3f& matVert);
 
+    //=========================================================================================================
+    /**
+    * Calculates the Pearson's correlation coefficients between all rows of the data matrix at once. The rows are
+    * centered and normalized, the coefficients are then given by a single symmetric rank-k update.
+    *
+    * @param[in] matData    The input data (channels x samples).
+    *
+    * @return               The symmetric matrix of correlation coefficients (channels x channels).
+    */
+    static Eigen::MatrixXd calcPearsonsCorrelationMatrix(const Eigen::MatrixXd& matData);
+
+    //=========================================================================================================
+    /**
+    * Calculates the cross correlation between all rows of the data matrix at once. The spectrum of every row is
+    * computed only once. The cross spectra and their inverse transforms are then evaluated in parallel, every
+    * thread working with its own FFT object and buffers.
+    *
+    * @param[in] matData    The input data (channels x samples).
+    * @param[out] pMatLags  If not NULL, the lag in samples at the maximum of each cross correlation is stored here.
+    *                       Entry (i,j) is positive if row i lags behind row j, entry (j,i) is its negative. The FFT
+    *                       index k of the maximum maps to the lag k for k <= FFT size/2 and to k - FFT size above,
+    *                       the same convention as calcCrossCorrelation.
+    *
+    * @return               The symmetric matrix of maximal cross correlation values (channels x channels).
+    */
+    static Eigen::MatrixXd calcCrossCorrelationMatrix(const Eigen::MatrixXd& matData, Eigen::MatrixXi* pMatLags = Q_NULLPTR);
+
 protected:
+    //=========================================================================================================
+    /**
+    * Creates a matrix backed network with one node per row of matConnectivity and one edge per non-zero upper
+    * triangular element.
+    *
+    * @param[in] sName              The name of the connectivity measure.
+    * @param[in] matConnectivity    The symmetric connectivity matrix.
+    * @param[in] matVert            The vertices of each network node.
+    *
+    * @return                       The connectivity information in form of a network structure.
+    */
+    static Network createNetwork(const QString& sName, const Eigen::MatrixXd& matConnectivity, const Eigen::MatrixX3f& matVert);
+
     //=========================================================================================================
     /**
     * Calculates the actual Pearson's correlation coefficient between two data vectors.
@@ -145,7 +185,9 @@ protected:
     * @param[in] vecFirst    The first input data row.
     * @param[in] vecSecond   The second input data row.
     *
-    * @return               The result in form of a QPair. First element represents the index of the maximum. Second element represents the actual correlation value.
+    * @return               The result in form of a QPair. First element represents the lag in samples at the maximum, positive if
+    *                       vecFirst lags behind vecSecond, with the same sign convention as calcCrossCorrelationMatrix. Second
+    *                       element represents the actual correlation value.
     */
     static QPair<int,double> calcCrossCorrelation(const Eigen::RowVectorXd &vecFirst, const Eigen::RowVectorXd &vecSecond);
 
@@ -45,11 +45,24 @@
 #include "networknode.h"
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <vector>
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // QT INCLUDES
 //=============================================================================================================
 
+#include <QMutexLocker>
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -78,8 +91,58 @@ using namespace Eigen;
 //=============================================================================================================
 
 Network::Network(const QString& sConnectivityMethod)
-: m_sConnectivityMethod(sConnectivityMethod)
+: m_bObjectsCreated(true)
+, m_storageMode(ObjectStorage)
+, m_sConnectivityMethod(sConnectivityMethod)
+{
+}
+
+
+//*************************************************************************************************************
+
+Network::Network(const MatrixXd& matWeights, const MatrixX3f& matNodeVert, const QString& sConnectivityMethod)
+: m_bObjectsCreated(false)
+, m_storageMode(DenseStorage)
+, m_matNodeVert(MatrixX3f::Zero(matWeights.rows(), 3))
+, m_matWeights(matWeights)
+, m_sConnectivityMethod(sConnectivityMethod)
+{
+    const int iRows = std::min(matNodeVert.rows(), m_matNodeVert.rows());
+    m_matNodeVert.topRows(iRows) = matNodeVert.topRows(iRows);
+}
+
+
+//*************************************************************************************************************
+
+Network::Network(const Network& p_Network)
+{
+    *this = p_Network;
+}
+
+
+//*************************************************************************************************************
+
+Network& Network::operator=(const Network& p_Network)
 {
+    if(this == &p_Network) {
+        return *this;
+    }
+
+    {
+        QMutexLocker locker(&p_Network.m_mutexObjects);
+        m_lEdges = p_Network.m_lEdges;
+        m_lNodes = p_Network.m_lNodes;
+        m_bObjectsCreated = p_Network.m_bObjectsCreated;
+    }
+
+    m_matDistMatrix = p_Network.m_matDistMatrix;
+    m_storageMode = p_Network.m_storageMode;
+    m_matNodeVert = p_Network.m_matNodeVert;
+    m_matWeights = p_Network.m_matWeights;
+    m_matSparseWeights = p_Network.m_matSparseWeights;
+    m_sConnectivityMethod = p_Network.m_sConnectivityMethod;
+
+    return *this;
 }
 
 
@@ -87,7 +150,199 @@ Network::Network(const QString& sConnectivityMethod)
 
 MatrixXd Network::getConnectivityMatrix() const
 {
-    return generateConnectMat();
+    switch(m_storageMode) {
+        case DenseStorage:
+            return m_matWeights;
+
+        case SparseStorage:
+            return MatrixXd(m_matSparseWeights);
+
+        default:
+            return generateConnectMat();
+    }
+}
+
+
+//*************************************************************************************************************
+
+SparseMatrix<double,RowMajor> Network::getSparseConnectivityMatrix() const
+{
+    switch(m_storageMode) {
+        case DenseStorage:
+            return m_matWeights.sparseView();
+
+        case SparseStorage:
+            return m_matSparseWeights;
+
+        default:
+            return generateConnectMat().sparseView();
+    }
+}
+
+
+//*************************************************************************************************************
+
+MatrixX3f Network::getNodeVertices() const
+{
+    if(m_storageMode != ObjectStorage) {
+        return m_matNodeVert;
+    }
+
+    MatrixX3f matVert = MatrixX3f::Zero(m_lNodes.size(), 3);
+
+    for(int i = 0; i < m_lNodes.size(); ++i) {
+        const RowVectorXf& vecVert = m_lNodes.at(i)->getVert();
+
+        for(int j = 0; j < 3 && j < vecVert.cols(); ++j) {
+            matVert(i,j) = vecVert(j);
+        }
+    }
+
+    return matVert;
+}
+
+
+//*************************************************************************************************************
+
+MatrixXi Network::getEdgeIndices(double dThreshold) const
+{
+    std::vector<int> vecIndices;
+
+    if(m_storageMode == DenseStorage) {
+        for(int i = 0; i < m_matWeights.rows(); ++i) {
+            for(int j = 0; j < m_matWeights.cols(); ++j) {
+                if(i != j && m_matWeights(i,j) != 0.0 && std::fabs(m_matWeights(i,j)) >= dThreshold) {
+                    vecIndices.push_back(i);
+                    vecIndices.push_back(j);
+                }
+            }
+        }
+    } else if(m_storageMode == SparseStorage) {
+        for(int i = 0; i < m_matSparseWeights.outerSize(); ++i) {
+            for(SparseMatrix<double,RowMajor>::InnerIterator it(m_matSparseWeights, i); it; ++it) {
+                if(it.row() != it.col() && std::fabs(it.value()) >= dThreshold) {
+                    vecIndices.push_back(it.row());
+                    vecIndices.push_back(it.col());
+                }
+            }
+        }
+    } else {
+        for(int i = 0; i < m_lEdges.size(); ++i) {
+            int iStart = m_lEdges.at(i)->getStartNode()->getId();
+            int iEnd = m_lEdges.at(i)->getEndNode()->getId();
+
+            if(iStart != iEnd && std::fabs(m_lEdges.at(i)->getWeight()) >= dThreshold) {
+                vecIndices.push_back(iStart);
+                vecIndices.push_back(iEnd);
+            }
+        }
+    }
+
+    MatrixXi matIndices(vecIndices.size()/2, 2);
+
+    for(int i = 0; i < matIndices.rows(); ++i) {
+        matIndices(i,0) = vecIndices[2*i];
+        matIndices(i,1) = vecIndices[2*i+1];
+    }
+
+    return matIndices;
+}
+
+
+//*************************************************************************************************************
+
+void Network::threshold(double dThreshold)
+{
+    SparseMatrix<double,RowMajor> matSparseWeights = getSparseConnectivityMatrix();
+
+    matSparseWeights.prune([dThreshold](const Index&, const Index&, const double& dValue) {
+        return std::fabs(dValue) >= dThreshold;
+    });
+
+    setSparseWeights(matSparseWeights);
+}
+
+
+//*************************************************************************************************************
+
+void Network::pruneTopK(int iK)
+{
+    SparseMatrix<double,RowMajor> matSparseWeights = getSparseConnectivityMatrix();
+
+    //Find the k-th largest absolute weight between different nodes
+    std::vector<double> vecAbsWeights;
+    vecAbsWeights.reserve(matSparseWeights.nonZeros());
+
+    for(int i = 0; i < matSparseWeights.outerSize(); ++i) {
+        for(SparseMatrix<double,RowMajor>::InnerIterator it(matSparseWeights, i); it; ++it) {
+            if(it.row() != it.col()) {
+                vecAbsWeights.push_back(std::fabs(it.value()));
+            }
+        }
+    }
+
+    if(iK < static_cast<int>(vecAbsWeights.size())) {
+        double dKth = 0.0;
+        int iNumAbove = 0;
+
+        if(iK > 0) {
+            std::nth_element(vecAbsWeights.begin(), vecAbsWeights.begin() + (iK - 1), vecAbsWeights.end(), std::greater<double>());
+            dKth = vecAbsWeights[iK - 1];
+            iNumAbove = std::count_if(vecAbsWeights.begin(), vecAbsWeights.end(), [dKth](double dValue) { return dValue > dKth; });
+        }
+
+        //Weights equal to the k-th one are kept in storage order until k edges are reached
+        int iNumTies = iK - iNumAbove;
+
+        matSparseWeights.prune([iK, dKth, &iNumTies](const Index& row, const Index& col, const double& dValue) {
+            if(row == col) {
+                return true;
+            }
+
+            if(iK <= 0) {
+                return false;
+            }
+
+            const double dAbs = std::fabs(dValue);
+
+            if(dAbs > dKth) {
+                return true;
+            }
+
+            if(dAbs == dKth && iNumTies > 0) {
+                --iNumTies;
+                return true;
+            }
+
+            return false;
+        });
+    }
+
+    setSparseWeights(matSparseWeights);
+}
+
+
+//*************************************************************************************************************
+
+int Network::getNumberNodes() const
+{
+    return m_storageMode == ObjectStorage ? m_lNodes.size() : m_matNodeVert.rows();
+}
+
+
+//*************************************************************************************************************
+
+bool Network::isEmpty() const
+{
+    return getNumberNodes() == 0;
+}
+
+
+//*************************************************************************************************************
+
+Network::StorageMode Network::getStorageMode() const
+{
+    return m_storageMode;
 }
 
 
@@ -95,6 +350,8 @@ MatrixXd Network::getConnectivityMatrix() const
 
 const QList<NetworkEdge::SPtr>& Network::getEdges() const
 {
+    createObjects();
+
     return m_lEdges;
 }
 
@@ -103,6 +360,8 @@ const QList<NetworkEdge::SPtr>& Network::getEdges() const
 
 const QList<NetworkNode::SPtr>& Network::getNodes() const
 {
+    createObjects();
+
     return m_lNodes;
 }
 
@@ -111,6 +370,8 @@ const QList<NetworkNode::SPtr>& Network::getNodes() const
 
 NetworkEdge::SPtr Network::getEdgeAt(int i)
 {
+    createObjects();
+
     return m_lEdges.at(i);
 }
 
@@ -119,6 +380,8 @@ NetworkEdge::SPtr Network::getEdgeAt(int i)
 
 NetworkNode::SPtr Network::getNodeAt(int i)
 {
+    createObjects();
+
     return m_lNodes.at(i);
 }
 
@@ -129,6 +392,14 @@ qint16 Network::getDistribution() const
 {
     qint16 distribution = 0;
 
+    if(m_storageMode != ObjectStorage) {
+        //Every edge is an outgoing edge of its start node, edges to itself are also incoming ones
+        SparseMatrix<double,RowMajor> matSparseWeights = getSparseConnectivityMatrix();
+        distribution = matSparseWeights.nonZeros() + (matSparseWeights.diagonal().array() != 0.0).count();
+
+        return distribution;
+    }
+
     for(NetworkNode::SPtr node : m_lNodes) {
         distribution += node->getDegree();
     }
@@ -157,6 +428,8 @@ QString Network::getConnectivityMethod() const
 
 Network& Network::operator<<(NetworkEdge::SPtr newEdge)
 {
+    toObjectStorage();
+
     m_lEdges << newEdge;
 
     return *this;
@@ -167,6 +440,8 @@ Network& Network::operator<<(NetworkEdge::SPtr newEdge)
 
 Network& Network::operator<<(NetworkNode::SPtr newNode)
 {
+    toObjectStorage();
+
     m_lNodes << newNode;
 
     return *this;
@@ -195,6 +470,73 @@ MatrixXd Network::generateConnectMat() const
 }
 
 
+//*************************************************************************************************************
+
+void Network::createObjects() const
+{
+    QMutexLocker locker(&m_mutexObjects);
+
+    if(m_bObjectsCreated) {
+        return;
+    }
+
+    m_lNodes.clear();
+    m_lEdges.clear();
 
+    for(int i = 0; i < m_matNodeVert.rows(); ++i) {
+        RowVectorXf rowVert = m_matNodeVert.row(i);
+        m_lNodes << NetworkNode::SPtr(new NetworkNode(i, rowVert));
+    }
+
+    //Create the edges in row order and add them to their start node
+    SparseMatrix<double,RowMajor> matSparseWeights = getSparseConnectivityMatrix();
+
+    for(int i = 0; i < matSparseWeights.outerSize(); ++i) {
+        for(SparseMatrix<double,RowMajor>::InnerIterator it(matSparseWeights, i); it; ++it) {
+            if(it.row() < m_lNodes.size() && it.col() < m_lNodes.size()) {
+                NetworkEdge::SPtr pEdge = NetworkEdge::SPtr(new NetworkEdge(m_lNodes.at(it.row()), m_lNodes.at(it.col()), it.value()));
 
+                *m_lNodes.at(it.row()) << pEdge;
+                m_lEdges << pEdge;
+            }
+        }
+    }
 
+    m_bObjectsCreated = true;
+}
+
+
+//*************************************************************************************************************
+
+void Network::toObjectStorage()
+{
+    if(m_storageMode == ObjectStorage) {
+        return;
+    }
+
+    createObjects();
+
+    m_storageMode = ObjectStorage;
+    m_matNodeVert.resize(0,3);
+    m_matWeights.resize(0,0);
+    m_matSparseWeights.resize(0,0);
+}
+
+
+//*************************************************************************************************************
+
+void Network::setSparseWeights(const SparseMatrix<double,RowMajor>& matSparseWeights)
+{
+    if(m_storageMode == ObjectStorage) {
+        m_matNodeVert = getNodeVertices();
+    }
+
+    m_matSparseWeights = matSparseWeights;
+    m_matSparseWeights.makeCompressed();
+    m_matWeights.resize(0,0);
+    m_storageMode = SparseStorage;
+
+    m_lNodes.clear();
+    m_lEdges.clear();
+    m_bObjectsCreated = false;
+}
@@ -51,6 +51,7 @@
 //=============================================================================================================
 
 #include <QSharedPointer>
+#include <QMutex>
 
 
 //*************************************************************************************************************
@@ -59,6 +60,7 @@
 //=============================================================================================================
 
 #include <Eigen/Core>
+#include <Eigen/SparseCore>
 
 
 //*************************************************************************************************************
@@ -86,9 +88,12 @@ class NetworkNode;
 
 //=============================================================================================================
 /**
-* Description of what this class is intended to do (in detail).
+* This class holds a network structure. The network is either stored as a list of node and edge objects or, which
+* is the way the connectivity measures create it, as a matrix of edge weights (start node x end node) together with
+* the node positions. Matrix backed networks keep the weights dense or, after thresholding or pruning, in compressed
+* row storage. Their node and edge objects are only created when they are first asked for.
 *
-* @brief Brief description of this class.
+* @brief This class holds a network structure.
 */
 
 class CONNECTIVITYSHARED_EXPORT Network
@@ -98,6 +103,12 @@ public:
     typedef QSharedPointer<Network> SPtr;            /**< Shared pointer type for Network. */
     typedef QSharedPointer<const Network> ConstSPtr; /**< Const shared pointer type for Network. */
 
+    enum StorageMode {
+        ObjectStorage,          /**< Lists of node and edge objects. */
+        DenseStorage,           /**< Dense weight matrix, node and edge objects are created on demand. */
+        SparseStorage           /**< Compressed row weight matrix, node and edge objects are created on demand. */
+    };
+
     //=========================================================================================================
     /**
     * Constructs a Network object.
@@ -106,6 +117,34 @@ public:
     */
     explicit Network(const QString& sConnectivityMethod = "Unknown");
 
+    //=========================================================================================================
+    /**
+    * Constructs a matrix backed Network object. Every non-zero weight is an edge from its row to its column node.
+    *
+    * @param[in] matWeights             The edge weights (nodes x nodes).
+    * @param[in] matNodeVert            The 3D position of each node (nodes x 3).
+    * @param[in] sConnectivityMethod    The connectivity measure method used to create the data of this network structure.
+    */
+    explicit Network(const Eigen::MatrixXd& matWeights, const Eigen::MatrixX3f& matNodeVert, const QString& sConnectivityMethod = "Unknown");
+
+    //=========================================================================================================
+    /**
+    * Copy constructor. Creating the node and edge objects of p_Network concurrently is safe.
+    *
+    * @param[in] p_Network      The network to copy.
+    */
+    Network(const Network& p_Network);
+
+    //=========================================================================================================
+    /**
+    * Assignment operator. Creating the node and edge objects of p_Network concurrently is safe.
+    *
+    * @param[in] p_Network      The network to copy.
+    *
+    * @return this network.
+    */
+    Network& operator=(const Network& p_Network);
+
     //=========================================================================================================
     /**
     * Returns the connectivity matrix for this network structure.
@@ -114,6 +153,74 @@ public:
     */
     Eigen::MatrixXd getConnectivityMatrix() const;
 
+    //=========================================================================================================
+    /**
+    * Returns the connectivity matrix for this network structure in compressed row storage.
+    *
+    * @return    The sparse connectivity matrix.
+    */
+    Eigen::SparseMatrix<double,Eigen::RowMajor> getSparseConnectivityMatrix() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the 3D positions of all nodes.
+    *
+    * @return    The node positions (nodes x 3).
+    */
+    Eigen::MatrixX3f getNodeVertices() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the start and end node of all edges between two different nodes whose absolute weight is at least
+    * dThreshold. For matrix backed networks no edge objects are created.
+    *
+    * @param[in] dThreshold     The minimal absolute edge weight.
+    *
+    * @return    The edge indices (edges x 2), first column start node, second column end node.
+    */
+    Eigen::MatrixXi getEdgeIndices(double dThreshold = 0.0) const;
+
+    //=========================================================================================================
+    /**
+    * Removes all edges whose absolute weight is below dThreshold. The network is stored sparse afterwards.
+    *
+    * @param[in] dThreshold     The minimal absolute edge weight.
+    */
+    void threshold(double dThreshold);
+
+    //=========================================================================================================
+    /**
+    * Keeps only the iK edges between different nodes with the largest absolute weight. Edges from a node to itself
+    * are kept. The network is stored sparse afterwards.
+    *
+    * @param[in] iK     The number of edges to keep.
+    */
+    void pruneTopK(int iK);
+
+    //=========================================================================================================
+    /**
+    * Returns the number of nodes.
+    *
+    * @return Returns the number of network nodes.
+    */
+    int getNumberNodes() const;
+
+    //=========================================================================================================
+    /**
+    * Returns whether the network has no nodes.
+    *
+    * @return Returns true if the network is empty.
+    */
+    bool isEmpty() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the storage mode of this network.
+    *
+    * @return Returns the storage mode.
+    */
+    StorageMode getStorageMode() const;
+
     //=========================================================================================================
     /**
     * Returns the edges.
@@ -191,12 +298,39 @@ public:
     Network &operator<<(QSharedPointer<NetworkNode> newNode);
 
 protected:
-    QList<QSharedPointer<NetworkEdge> >     m_lEdges;                   /**< List with all edges of the network.*/
-    QList<QSharedPointer<NetworkNode> >     m_lNodes;                   /**< List with all nodes of the network.*/
+    mutable QList<QSharedPointer<NetworkEdge> > m_lEdges;               /**< List with all edges of the network. Created on demand for matrix backed networks.*/
+    mutable QList<QSharedPointer<NetworkNode> > m_lNodes;               /**< List with all nodes of the network. Created on demand for matrix backed networks.*/
+    mutable bool                                m_bObjectsCreated;      /**< Whether the node and edge objects of a matrix backed network were created.*/
+    mutable QMutex                              m_mutexObjects;         /**< Guards the on demand creation of the node and edge objects, const getters may be called concurrently.*/
+
+    Eigen::MatrixXd                             m_matDistMatrix;        /**< The distance matrix.*/
+
+    StorageMode                                 m_storageMode;          /**< The storage mode of this network.*/
+    Eigen::MatrixX3f                            m_matNodeVert;          /**< The node positions of a matrix backed network.*/
+    Eigen::MatrixXd                             m_matWeights;           /**< The dense edge weights of a matrix backed network.*/
+    Eigen::SparseMatrix<double,Eigen::RowMajor> m_matSparseWeights;     /**< The compressed row edge weights of a matrix backed network.*/
+
+    QString                                     m_sConnectivityMethod;  /**< The connectivity measure method used to create the data of this network structure.*/
+
+    //=========================================================================================================
+    /**
+    * Creates the node and edge objects of a matrix backed network, if not done yet. Thread safe.
+    */
+    void createObjects() const;
 
-    Eigen::MatrixXd                         m_matDistMatrix;            /**< The distance matrix.*/
+    //=========================================================================================================
+    /**
+    * Converts the network to object storage. The node and edge objects are created first if needed.
+    */
+    void toObjectStorage();
 
-    QString                                 m_sConnectivityMethod;      /**< The connectivity measure method used to create the data of this network structure.*/
+    //=========================================================================================================
+    /**
+    * Switches the network to sparse storage with the given weights, the node positions are kept.
+    *
+    * @param[in] matSparseWeights   The compressed row edge weights.
+    */
+    void setSparseWeights(const Eigen::SparseMatrix<double,Eigen::RowMajor>& matSparseWeights);
 
     //=========================================================================================================
     /**
@@ -179,17 +179,9 @@ void NetworkTreeItem::onNetworkThresholdChanged(const QVariant& vecThresholds)
 void NetworkTreeItem::plotNetwork(const Network& tNetworkData, const QVector3D& vecThreshold)
 {
     //Create network vertices and normals
-    QList<NetworkNode::SPtr> lNetworkNodes = tNetworkData.getNodes();
+    MatrixX3f tMatVert = tNetworkData.getNodeVertices();
 
-    MatrixX3f tMatVert(lNetworkNodes.size(), 3);
-
-    for(int i = 0; i < lNetworkNodes.size(); ++i) {
-        tMatVert(i,0) = lNetworkNodes.at(i)->getVert()(0);
-        tMatVert(i,1) = lNetworkNodes.at(i)->getVert()(1);
-        tMatVert(i,2) = lNetworkNodes.at(i)->getVert()(2);
-    }
-
-    MatrixX3f tMatNorm(lNetworkNodes.size(), 3);
+    MatrixX3f tMatNorm(tMatVert.rows(), 3);
     tMatNorm.setZero();
 
     //Draw network nodes
@@ -233,40 +225,8 @@ void NetworkTreeItem::plotNetwork(const Network& tNetworkData, const QVector3D&
         m_bNodesPlotted = true;
     }
 
-    //Generate connection indices for Qt3D buffer
-    MatrixXi tMatLines;
-    int count = 0;
-    int start, end;
-
-    for(int i = 0; i < lNetworkNodes.size(); ++i) {
-        //Plot in edges
-        for(int j = 0; j < lNetworkNodes.at(i)->getEdgesIn().size(); ++j) {
-            start = lNetworkNodes.at(i)->getEdgesIn().at(j)->getStartNode()->getId();
-            end = lNetworkNodes.at(i)->getEdgesIn().at(j)->getEndNode()->getId();
-
-            if(std::fabs(lNetworkNodes.at(i)->getEdgesIn().at(j)->getWeight()) >= vecThreshold.x() &&
-                    start != end) {
-                tMatLines.conservativeResize(count+1,2);
-                tMatLines(count,0) = start;
-                tMatLines(count,1) = end;
-                ++count;
-            }
-        }
-
-        //Plot out edges
-        for(int j = 0; j < lNetworkNodes.at(i)->getEdgesOut().size(); ++j) {
-            start = lNetworkNodes.at(i)->getEdgesOut().at(j)->getStartNode()->getId();
-            end = lNetworkNodes.at(i)->getEdgesOut().at(j)->getEndNode()->getId();
-
-            if(std::fabs(lNetworkNodes.at(i)->getEdgesOut().at(j)->getWeight()) >= vecThreshold.x() &&
-                    start != end) {
-                tMatLines.conservativeResize(count+1,2);
-                tMatLines(count,0) = start;
-                tMatLines(count,1) = end;
-                ++count;
-            }
-        }
-    }
+    //Generate connection indices for Qt3D buffer directly from the network's weights
+    MatrixXi tMatLines = tNetworkData.getEdgeIndices(vecThreshold.x());
 
     //Generate colors for Qt3D buffer
     MatrixX3f matLineColor(tMatVert.rows(),3);
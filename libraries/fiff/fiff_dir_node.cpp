@@ -161,12 +161,8 @@ bool FiffDirNode::copy_tree(FiffStream::SPtr& p_pStreamIn, const FiffId& in_id,
             FiffStream::SPtr out = p_pStreamOut;
             out->setByteOrder(QDataStream::BigEndian);
 
-            *out << (qint32)tag->kind;
-            *out << (qint32)tag->type;
-            *out << (qint32)tag->size();
-            *out << (qint32)FIFFV_NEXT_SEQ;
-
-            out->writeRawData(tag->data(),tag->size());
+            tag->next = FIFFV_NEXT_SEQ;
+            out->write_tag(tag);
         }
         for(p = 0; p < p_Nodes[k]->nchild(); ++p)
         {
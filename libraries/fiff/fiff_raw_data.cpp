@@ -43,6 +43,8 @@
 #include "fiff_stream.h"
 #include "cstdlib"
 
+#include <algorithm>
+
 //*************************************************************************************************************
 //=============================================================================================================
 // USED NAMESPACES
@@ -89,8 +91,10 @@ FiffRawData::FiffRawData(const FiffRawData &p_FiffRawData)
 , last_samp(p_FiffRawData.last_samp)
 , cals(p_FiffRawData.cals)
 , rawdir(p_FiffRawData.rawdir)
+, rawdir_index(p_FiffRawData.rawdir_index)
 , proj(p_FiffRawData.proj)
 , comp(p_FiffRawData.comp)
+, mapped_reader(p_FiffRawData.mapped_reader)
 {
 
 }
@@ -113,8 +117,10 @@ void FiffRawData::clear()
     last_samp = -1;
     cals = RowVectorXd();
     rawdir.clear();
+    rawdir_index.clear();
     proj = MatrixXd();
     comp.clear();
+    mapped_reader.clear();
 }
 
 
@@ -240,112 +246,26 @@ bool FiffRawData::read_raw_segment(MatrixXd& data, MatrixXd& times, fiff_int_t f
 
     //
 
-    FiffStream::SPtr fid;
-    if (!this->file->device()->isOpen())
-    {
-        if (!this->file->device()->open(QIODevice::ReadOnly))
-        {
-            printf("Cannot open file %s",this->info.filename.toUtf8().constData());
-        }
-        fid = this->file;
-    }
-    else
-    {
-        fid = this->file;
-    }
+    FiffStream::SPtr fid = this->file;
+    bool bMapped = this->mapped_reader && this->mapped_reader->isValid();
+
+    //
+    //  Jump to the first buffer we need, only the overlapping buffers are visited
+    //
+    qint32 first_ent = this->find_rawdir_entry(from);
+    if (first_ent < 0)
+        first_ent = this->rawdir.size();
 
     MatrixXd one;
     fiff_int_t first_pick, last_pick, picksamp;
-    for(k = 0; k < this->rawdir.size(); ++k)
+    for(k = first_ent; k < this->rawdir.size(); ++k)
     {
-        FiffRawDir thisRawDir = this->rawdir[k];
+        const FiffRawDir& thisRawDir = this->rawdir[k];
         //
         //  Do we need this buffer
         //
-        if (thisRawDir.last > from)
+        if (thisRawDir.last >= from)
         {
-            if (thisRawDir.ent->kind == -1)
-            {
-                //
-                //  Take the easy route: skip is translated to zeros
-                //
-                if(do_debug)
-                    printf("S");
-                if (sel.cols() <= 0)
-                    one.resize(nchan,thisRawDir.nsamp);
-                else
-                    one.resize(sel.cols(),thisRawDir.nsamp);
-
-                one.setZero();
-            }
-            else
-            {
-                FiffTag::SPtr t_pTag;
-                fid->read_tag(t_pTag, thisRawDir.ent->pos);
-                //
-                //   Depending on the state of the projection and selection
-                //   we proceed a little bit differently
-                //
-                if (mult.cols() == 0)
-                {
-                    if (sel.cols() == 0)
-                    {
-                        if (t_pTag->type == FIFFT_DAU_PACK16)
-                            one = cal*(Map< MatrixDau16 >( t_pTag->toDauPack16(),nchan, thisRawDir.nsamp)).cast<double>();
-                        else if(t_pTag->type == FIFFT_INT)
-                            one = cal*(Map< MatrixXi >( t_pTag->toInt(),nchan, thisRawDir.nsamp)).cast<double>();
-                        else if(t_pTag->type == FIFFT_FLOAT)
-                            one = cal*(Map< MatrixXf >( t_pTag->toFloat(),nchan, thisRawDir.nsamp)).cast<double>();
-                        else
-                            printf("Data Storage Format not known jet [1]!! Type: %d\n", t_pTag->type);
-                    }
-                    else
-                    {
-
-                        //ToDo find a faster solution for this!! --> make cal and mul sparse like in MATLAB
-                        MatrixXd newData(sel.cols(), thisRawDir.nsamp); //ToDo this can be done much faster, without newData
-
-                        if (t_pTag->type == FIFFT_DAU_PACK16)
-                        {
-                            MatrixXd tmp_data = (Map< MatrixDau16 > ( t_pTag->toDauPack16(),nchan, thisRawDir.nsamp)).cast<double>();
-
-                            for(r = 0; r < sel.size(); ++r)
-                                newData.block(r,0,1,thisRawDir.nsamp) = tmp_data.block(sel[r],0,1,thisRawDir.nsamp);
-                        }
-                        else if(t_pTag->type == FIFFT_INT)
-                        {
-                            MatrixXd tmp_data = (Map< MatrixXi >( t_pTag->toInt(),nchan, thisRawDir.nsamp)).cast<double>();
-
-                            for(r = 0; r < sel.size(); ++r)
-                                newData.block(r,0,1,thisRawDir.nsamp) = tmp_data.block(sel[r],0,1,thisRawDir.nsamp);
-                        }
-                        else if(t_pTag->type == FIFFT_FLOAT)
-                        {
-                            MatrixXd tmp_data = (Map< MatrixXf > ( t_pTag->toFloat(),nchan, thisRawDir.nsamp)).cast<double>();
-
-                            for(r = 0; r < sel.size(); ++r)
-                                newData.block(r,0,1,thisRawDir.nsamp) = tmp_data.block(sel[r],0,1,thisRawDir.nsamp);
-                        }
-                        else
-                        {
-                            printf("Data Storage Format not known jet [2]!! Type: %d\n", t_pTag->type);
-                        }
-
-                        one = cal*newData;
-                    }
-                }
-                else
-                {
-                    if (t_pTag->type == FIFFT_DAU_PACK16)
-                        one = mult*(Map< MatrixDau16 >( t_pTag->toDauPack16(),nchan, thisRawDir.nsamp)).cast<double>();
-                    else if(t_pTag->type == FIFFT_INT)
-                        one = mult*(Map< MatrixXi >( t_pTag->toInt(),nchan, thisRawDir.nsamp)).cast<double>();
-                    else if(t_pTag->type == FIFFT_FLOAT)
-                        one = mult*(Map< MatrixXf >( t_pTag->toFloat(),nchan, thisRawDir.nsamp)).cast<double>();
-                    else
-                        printf("Data Storage Format not known jet [3]!! Type: %d\n", t_pTag->type);
-                }
-            }
             //
             //  The picking logic is a bit complicated
             //
@@ -406,10 +326,114 @@ bool FiffRawData::read_raw_segment(MatrixXd& data, MatrixXd& times, fiff_int_t f
 
             if (picksamp > 0)
             {
-//                    for(r = 0; r < data->rows(); ++r)
-//                        for(c = 0; c < picksamp; ++c)
-//                            (*data)(r,dest + c) = one(r,first_pick + c);
-                data.block(0,dest,data.rows(),picksamp) = one.block(0, first_pick, data.rows(), picksamp);
+                bool bDone = false;
+
+                if (!thisRawDir.ent || thisRawDir.ent->kind == -1)
+                {
+                    //
+                    //  Take the easy route: skip is translated to zeros
+                    //
+                    if(do_debug)
+                        printf("S");
+                    data.block(0,dest,data.rows(),picksamp).setZero();
+                    bDone = true;
+                }
+                else if (bMapped && FiffRawMappedReader::supportsType(thisRawDir.ent->type))
+                {
+                    //
+                    //  Decode straight from the file mapping, calibration and selection are fused into the decoding
+                    //
+                    if (mult.cols() == 0)
+                    {
+                        bDone = this->mapped_reader->read_buffer(thisRawDir.ent, nchan, first_pick, picksamp, this->cals, sel, data, dest);
+                    }
+                    else
+                    {
+                        one.resize(nchan, picksamp);
+                        bDone = this->mapped_reader->read_buffer(thisRawDir.ent, nchan, first_pick, picksamp, RowVectorXd(), defaultRowVectorXi, one, 0);
+                        if (bDone)
+                            data.block(0,dest,data.rows(),picksamp) = mult*one;
+                    }
+                }
+
+                if (!bDone)
+                {
+                    if (!fid->device()->isOpen())
+                    {
+                        if (!fid->device()->open(QIODevice::ReadOnly))
+                        {
+                            printf("Cannot open file %s",this->info.filename.toUtf8().constData());
+                        }
+                    }
+
+                    FiffTag::SPtr t_pTag;
+                    fid->read_tag(t_pTag, thisRawDir.ent->pos);
+                    //
+                    //   Depending on the state of the projection and selection
+                    //   we proceed a little bit differently
+                    //
+                    if (mult.cols() == 0)
+                    {
+                        if (sel.cols() == 0)
+                        {
+                            if (t_pTag->type == FIFFT_DAU_PACK16)
+                                one = cal*(Map< MatrixDau16 >( t_pTag->toDauPack16(),nchan, thisRawDir.nsamp)).cast<double>();
+                            else if(t_pTag->type == FIFFT_INT)
+                                one = cal*(Map< MatrixXi >( t_pTag->toInt(),nchan, thisRawDir.nsamp)).cast<double>();
+                            else if(t_pTag->type == FIFFT_FLOAT)
+                                one = cal*(Map< MatrixXf >( t_pTag->toFloat(),nchan, thisRawDir.nsamp)).cast<double>();
+                            else
+                                printf("Data Storage Format not known jet [1]!! Type: %d\n", t_pTag->type);
+                        }
+                        else
+                        {
+
+                            //ToDo find a faster solution for this!! --> make cal and mul sparse like in MATLAB
+                            MatrixXd newData(sel.cols(), thisRawDir.nsamp); //ToDo this can be done much faster, without newData
+
+                            if (t_pTag->type == FIFFT_DAU_PACK16)
+                            {
+                                MatrixXd tmp_data = (Map< MatrixDau16 > ( t_pTag->toDauPack16(),nchan, thisRawDir.nsamp)).cast<double>();
+
+                                for(r = 0; r < sel.size(); ++r)
+                                    newData.block(r,0,1,thisRawDir.nsamp) = tmp_data.block(sel[r],0,1,thisRawDir.nsamp);
+                            }
+                            else if(t_pTag->type == FIFFT_INT)
+                            {
+                                MatrixXd tmp_data = (Map< MatrixXi >( t_pTag->toInt(),nchan, thisRawDir.nsamp)).cast<double>();
+
+                                for(r = 0; r < sel.size(); ++r)
+                                    newData.block(r,0,1,thisRawDir.nsamp) = tmp_data.block(sel[r],0,1,thisRawDir.nsamp);
+                            }
+                            else if(t_pTag->type == FIFFT_FLOAT)
+                            {
+                                MatrixXd tmp_data = (Map< MatrixXf > ( t_pTag->toFloat(),nchan, thisRawDir.nsamp)).cast<double>();
+
+                                for(r = 0; r < sel.size(); ++r)
+                                    newData.block(r,0,1,thisRawDir.nsamp) = tmp_data.block(sel[r],0,1,thisRawDir.nsamp);
+                            }
+                            else
+                            {
+                                printf("Data Storage Format not known jet [2]!! Type: %d\n", t_pTag->type);
+                            }
+
+                            one = cal*newData;
+                        }
+                    }
+                    else
+                    {
+                        if (t_pTag->type == FIFFT_DAU_PACK16)
+                            one = mult*(Map< MatrixDau16 >( t_pTag->toDauPack16(),nchan, thisRawDir.nsamp)).cast<double>();
+                        else if(t_pTag->type == FIFFT_INT)
+                            one = mult*(Map< MatrixXi >( t_pTag->toInt(),nchan, thisRawDir.nsamp)).cast<double>();
+                        else if(t_pTag->type == FIFFT_FLOAT)
+                            one = mult*(Map< MatrixXf >( t_pTag->toFloat(),nchan, thisRawDir.nsamp)).cast<double>();
+                        else
+                            printf("Data Storage Format not known jet [3]!! Type: %d\n", t_pTag->type);
+                    }
+
+                    data.block(0,dest,data.rows(),picksamp) = one.block(0, first_pick, data.rows(), picksamp);
+                }
 
                 dest += picksamp;
             }
@@ -557,112 +581,26 @@ bool FiffRawData::read_raw_segment(MatrixXd& data, MatrixXd& times, SparseMatrix
 
     //
 
-    FiffStream::SPtr fid;
-    if (!this->file->device()->isOpen())
-    {
-        if (!this->file->device()->open(QIODevice::ReadOnly))
-        {
-            printf("Cannot open file %s",this->info.filename.toUtf8().constData());
-        }
-        fid = this->file;
-    }
-    else
-    {
-        fid = this->file;
-    }
+    FiffStream::SPtr fid = this->file;
+    bool bMapped = this->mapped_reader && this->mapped_reader->isValid();
+
+    //
+    //  Jump to the first buffer we need, only the overlapping buffers are visited
+    //
+    qint32 first_ent = this->find_rawdir_entry(from);
+    if (first_ent < 0)
+        first_ent = this->rawdir.size();
 
     MatrixXd one;
     fiff_int_t first_pick, last_pick, picksamp;
-    for(k = 0; k < this->rawdir.size(); ++k)
+    for(k = first_ent; k < this->rawdir.size(); ++k)
     {
-        FiffRawDir thisRawDir = this->rawdir[k];
+        const FiffRawDir& thisRawDir = this->rawdir[k];
         //
         //  Do we need this buffer
         //
-        if (thisRawDir.last > from)
+        if (thisRawDir.last >= from)
         {
-            if (thisRawDir.ent->kind == -1)
-            {
-                //
-                //  Take the easy route: skip is translated to zeros
-                //
-                if(do_debug)
-                    printf("S");
-                if (sel.cols() <= 0)
-                    one.resize(nchan,thisRawDir.nsamp);
-                else
-                    one.resize(sel.cols(),thisRawDir.nsamp);
-
-                one.setZero();
-            }
-            else
-            {
-                FiffTag::SPtr t_pTag;
-                fid->read_tag(t_pTag, thisRawDir.ent->pos);
-                //
-                //   Depending on the state of the projection and selection
-                //   we proceed a little bit differently
-                //
-                if (mult.cols() == 0)
-                {
-                    if (sel.cols() == 0)
-                    {
-                        if (t_pTag->type == FIFFT_DAU_PACK16)
-                            one = cal*(Map< MatrixDau16 >( t_pTag->toDauPack16(),nchan, thisRawDir.nsamp)).cast<double>();
-                        else if(t_pTag->type == FIFFT_INT)
-                            one = cal*(Map< MatrixXi >( t_pTag->toInt(),nchan, thisRawDir.nsamp)).cast<double>();
-                        else if(t_pTag->type == FIFFT_FLOAT)
-                            one = cal*(Map< MatrixXf >( t_pTag->toFloat(),nchan, thisRawDir.nsamp)).cast<double>();
-                        else
-                            printf("Data Storage Format not known jet [1]!! Type: %d\n", t_pTag->type);
-                    }
-                    else
-                    {
-
-                        //ToDo find a faster solution for this!! --> make cal and mul sparse like in MATLAB
-                        MatrixXd newData(sel.cols(), thisRawDir.nsamp); //ToDo this can be done much faster, without newData
-
-                        if (t_pTag->type == FIFFT_DAU_PACK16)
-                        {
-                            MatrixXd tmp_data = (Map< MatrixDau16 > ( t_pTag->toDauPack16(),nchan, thisRawDir.nsamp)).cast<double>();
-
-                            for(r = 0; r < sel.size(); ++r)
-                                newData.block(r,0,1,thisRawDir.nsamp) = tmp_data.block(sel[r],0,1,thisRawDir.nsamp);
-                        }
-                        else if(t_pTag->type == FIFFT_INT)
-                        {
-                            MatrixXd tmp_data = (Map< MatrixXi >( t_pTag->toInt(),nchan, thisRawDir.nsamp)).cast<double>();
-
-                            for(r = 0; r < sel.size(); ++r)
-                                newData.block(r,0,1,thisRawDir.nsamp) = tmp_data.block(sel[r],0,1,thisRawDir.nsamp);
-                        }
-                        else if(t_pTag->type == FIFFT_FLOAT)
-                        {
-                            MatrixXd tmp_data = (Map< MatrixXf > ( t_pTag->toFloat(),nchan, thisRawDir.nsamp)).cast<double>();
-
-                            for(r = 0; r < sel.size(); ++r)
-                                newData.block(r,0,1,thisRawDir.nsamp) = tmp_data.block(sel[r],0,1,thisRawDir.nsamp);
-                        }
-                        else
-                        {
-                            printf("Data Storage Format not known jet [2]!! Type: %d\n", t_pTag->type);
-                        }
-
-                        one = cal*newData;
-                    }
-                }
-                else
-                {
-                    if (t_pTag->type == FIFFT_DAU_PACK16)
-                        one = mult*(Map< MatrixDau16 >( t_pTag->toDauPack16(),nchan, thisRawDir.nsamp)).cast<double>();
-                    else if(t_pTag->type == FIFFT_INT)
-                        one = mult*(Map< MatrixXi >( t_pTag->toInt(),nchan, thisRawDir.nsamp)).cast<double>();
-                    else if(t_pTag->type == FIFFT_FLOAT)
-                        one = mult*(Map< MatrixXf >( t_pTag->toFloat(),nchan, thisRawDir.nsamp)).cast<double>();
-                    else
-                        printf("Data Storage Format not known jet [3]!! Type: %d\n", t_pTag->type);
-                }
-            }
             //
             //  The picking logic is a bit complicated
             //
@@ -723,10 +661,114 @@ bool FiffRawData::read_raw_segment(MatrixXd& data, MatrixXd& times, SparseMatrix
 
             if (picksamp > 0)
             {
-//                    for(r = 0; r < data->rows(); ++r)
-//                        for(c = 0; c < picksamp; ++c)
-//                            (*data)(r,dest + c) = one(r,first_pick + c);
-                data.block(0,dest,data.rows(),picksamp) = one.block(0, first_pick, data.rows(), picksamp);
+                bool bDone = false;
+
+                if (!thisRawDir.ent || thisRawDir.ent->kind == -1)
+                {
+                    //
+                    //  Take the easy route: skip is translated to zeros
+                    //
+                    if(do_debug)
+                        printf("S");
+                    data.block(0,dest,data.rows(),picksamp).setZero();
+                    bDone = true;
+                }
+                else if (bMapped && FiffRawMappedReader::supportsType(thisRawDir.ent->type))
+                {
+                    //
+                    //  Decode straight from the file mapping, calibration and selection are fused into the decoding
+                    //
+                    if (mult.cols() == 0)
+                    {
+                        bDone = this->mapped_reader->read_buffer(thisRawDir.ent, nchan, first_pick, picksamp, this->cals, sel, data, dest);
+                    }
+                    else
+                    {
+                        one.resize(nchan, picksamp);
+                        bDone = this->mapped_reader->read_buffer(thisRawDir.ent, nchan, first_pick, picksamp, RowVectorXd(), defaultRowVectorXi, one, 0);
+                        if (bDone)
+                            data.block(0,dest,data.rows(),picksamp) = mult*one;
+                    }
+                }
+
+                if (!bDone)
+                {
+                    if (!fid->device()->isOpen())
+                    {
+                        if (!fid->device()->open(QIODevice::ReadOnly))
+                        {
+                            printf("Cannot open file %s",this->info.filename.toUtf8().constData());
+                        }
+                    }
+
+                    FiffTag::SPtr t_pTag;
+                    fid->read_tag(t_pTag, thisRawDir.ent->pos);
+                    //
+                    //   Depending on the state of the projection and selection
+                    //   we proceed a little bit differently
+                    //
+                    if (mult.cols() == 0)
+                    {
+                        if (sel.cols() == 0)
+                        {
+                            if (t_pTag->type == FIFFT_DAU_PACK16)
+                                one = cal*(Map< MatrixDau16 >( t_pTag->toDauPack16(),nchan, thisRawDir.nsamp)).cast<double>();
+                            else if(t_pTag->type == FIFFT_INT)
+                                one = cal*(Map< MatrixXi >( t_pTag->toInt(),nchan, thisRawDir.nsamp)).cast<double>();
+                            else if(t_pTag->type == FIFFT_FLOAT)
+                                one = cal*(Map< MatrixXf >( t_pTag->toFloat(),nchan, thisRawDir.nsamp)).cast<double>();
+                            else
+                                printf("Data Storage Format not known jet [1]!! Type: %d\n", t_pTag->type);
+                        }
+                        else
+                        {
+
+                            //ToDo find a faster solution for this!! --> make cal and mul sparse like in MATLAB
+                            MatrixXd newData(sel.cols(), thisRawDir.nsamp); //ToDo this can be done much faster, without newData
+
+                            if (t_pTag->type == FIFFT_DAU_PACK16)
+                            {
+                                MatrixXd tmp_data = (Map< MatrixDau16 > ( t_pTag->toDauPack16(),nchan, thisRawDir.nsamp)).cast<double>();
+
+                                for(r = 0; r < sel.size(); ++r)
+                                    newData.block(r,0,1,thisRawDir.nsamp) = tmp_data.block(sel[r],0,1,thisRawDir.nsamp);
+                            }
+                            else if(t_pTag->type == FIFFT_INT)
+                            {
+                                MatrixXd tmp_data = (Map< MatrixXi >( t_pTag->toInt(),nchan, thisRawDir.nsamp)).cast<double>();
+
+                                for(r = 0; r < sel.size(); ++r)
+                                    newData.block(r,0,1,thisRawDir.nsamp) = tmp_data.block(sel[r],0,1,thisRawDir.nsamp);
+                            }
+                            else if(t_pTag->type == FIFFT_FLOAT)
+                            {
+                                MatrixXd tmp_data = (Map< MatrixXf > ( t_pTag->toFloat(),nchan, thisRawDir.nsamp)).cast<double>();
+
+                                for(r = 0; r < sel.size(); ++r)
+                                    newData.block(r,0,1,thisRawDir.nsamp) = tmp_data.block(sel[r],0,1,thisRawDir.nsamp);
+                            }
+                            else
+                            {
+                                printf("Data Storage Format not known jet [2]!! Type: %d\n", t_pTag->type);
+                            }
+
+                            one = cal*newData;
+                        }
+                    }
+                    else
+                    {
+                        if (t_pTag->type == FIFFT_DAU_PACK16)
+                            one = mult*(Map< MatrixDau16 >( t_pTag->toDauPack16(),nchan, thisRawDir.nsamp)).cast<double>();
+                        else if(t_pTag->type == FIFFT_INT)
+                            one = mult*(Map< MatrixXi >( t_pTag->toInt(),nchan, thisRawDir.nsamp)).cast<double>();
+                        else if(t_pTag->type == FIFFT_FLOAT)
+                            one = mult*(Map< MatrixXf >( t_pTag->toFloat(),nchan, thisRawDir.nsamp)).cast<double>();
+                        else
+                            printf("Data Storage Format not known jet [3]!! Type: %d\n", t_pTag->type);
+                    }
+
+                    data.block(0,dest,data.rows(),picksamp) = one.block(0, first_pick, data.rows(), picksamp);
+                }
 
                 dest += picksamp;
             }
@@ -756,6 +798,39 @@ bool FiffRawData::read_raw_segment(MatrixXd& data, MatrixXd& times, SparseMatrix
 }
 
 
+//*************************************************************************************************************
+
+void FiffRawData::build_rawdir_index()
+{
+    rawdir_index.resize(rawdir.size());
+    for(qint32 k = 0; k < rawdir.size(); ++k)
+        rawdir_index[k] = rawdir[k].last;
+}
+
+
+//*************************************************************************************************************
+
+qint32 FiffRawData::find_rawdir_entry(fiff_int_t sample) const
+{
+    if (rawdir_index.size() != rawdir.size())
+    {
+        //
+        //  The index is out of date, walk the directory
+        //
+        for(qint32 k = 0; k < rawdir.size(); ++k)
+            if (rawdir[k].last >= sample)
+                return k;
+        return -1;
+    }
+
+    QVector<fiff_int_t>::const_iterator it = std::lower_bound(rawdir_index.constBegin(), rawdir_index.constEnd(), sample);
+    if (it == rawdir_index.constEnd())
+        return -1;
+
+    return static_cast<qint32>(it - rawdir_index.constBegin());
+}
+
+
 //*************************************************************************************************************
 
 bool FiffRawData::read_raw_segment_times(MatrixXd& data, MatrixXd& times, float from, float to, const RowVectorXi& sel)
@@ -44,6 +44,7 @@
 #include "fiff_global.h"
 #include "fiff_info.h"
 #include "fiff_raw_dir.h"
+#include "fiff_raw_mapped_reader.h"
 #include "fiff_stream.h"
 
 
@@ -63,6 +64,7 @@
 
 #include <QList>
 #include <QSharedPointer>
+#include <QVector>
 
 
 //*************************************************************************************************************
@@ -190,6 +192,24 @@ public:
     */
     bool read_raw_segment_times(MatrixXd& data, MatrixXd& times, float from, float to, const RowVectorXi& sel = defaultRowVectorXi);
 
+    //=========================================================================================================
+    /**
+    * Builds the sample offset index of rawdir (the last sample of every entry, including skips), which is used
+    * to locate buffers by binary search. This is done by FiffStream::setup_read_raw; call it again whenever
+    * rawdir is modified.
+    */
+    void build_rawdir_index();
+
+    //=========================================================================================================
+    /**
+    * Locates the rawdir entry which contains the given sample in O(log n).
+    *
+    * @param[in] sample     The sample to look for (absolute, i.e. including first_samp).
+    *
+    * @return the index of the rawdir entry, -1 if the sample is behind the last entry.
+    */
+    qint32 find_rawdir_entry(fiff_int_t sample) const;
+
 public:
     FiffStream::SPtr file;      /**< replaces fid */
     FiffInfo info;              /**< Fiff measurement information */
@@ -197,8 +217,10 @@ public:
     fiff_int_t last_samp;       /**< Do we have a skip ToDo... */
     RowVectorXd cals;           /**< Calibration matrix: ToDo Check if RowVectorXd is enough */
     QList<FiffRawDir> rawdir;   /**< Special fiff diretory entry for raw data. */
+    QVector<fiff_int_t> rawdir_index;   /**< Last sample of each rawdir entry (sorted), see build_rawdir_index. */
     MatrixXd proj;              /**< SSP operator to apply to the data. */
     FiffCtfComp comp;           /**< Compensator. */
+    FiffRawMappedReader::SPtr mapped_reader;    /**< Memory-mapped buffer reader, set by setup_read_raw for local files. */
 };
 
 } // NAMESPACE
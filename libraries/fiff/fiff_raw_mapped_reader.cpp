@@ -0,0 +1,252 @@
+//=============================================================================================================
+/**
+* @file     fiff_raw_mapped_reader.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    FiffRawMappedReader class definition.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "fiff_raw_mapped_reader.h"
+#include "fiff_file.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QtEndian>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <cstring>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FIFFLIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+namespace
+{
+
+//=============================================================================================================
+/**
+* Reads one big endian sample of type T.
+*/
+template<typename T>
+inline double fromBigEndianSample(const uchar* p)
+{
+    return static_cast<double>(qFromBigEndian<T>(p));
+}
+
+template<>
+inline double fromBigEndianSample<float>(const uchar* p)
+{
+    quint32 t_iBits = qFromBigEndian<quint32>(p);
+    float t_fValue;
+    std::memcpy(&t_fValue, &t_iBits, sizeof(float));
+    return static_cast<double>(t_fValue);
+}
+
+
+//=============================================================================================================
+/**
+* Fused byte-swap, calibration and channel selection kernel. The raw buffer is stored sample by sample
+* (channels are the fast index), which matches the column major layout of the output matrix.
+*/
+template<typename T>
+void decodeBuffer(const uchar* pBuffer,
+                  fiff_int_t nchan,
+                  fiff_int_t first_pick,
+                  fiff_int_t picksamp,
+                  const VectorXi& vecOffsets,
+                  const VectorXd& vecCals,
+                  MatrixXd& data,
+                  fiff_int_t dest)
+{
+    const qint64 iStride = static_cast<qint64>(nchan) * sizeof(T);
+    const qint32 nrows = vecOffsets.size();
+
+    for(qint32 c = 0; c < picksamp; ++c) {
+        const uchar* pSample = pBuffer + (first_pick + c) * iStride;
+        double* pOut = data.col(dest + c).data();
+
+        for(qint32 r = 0; r < nrows; ++r) {
+            pOut[r] = vecCals[r] * fromBigEndianSample<T>(pSample + vecOffsets[r]);
+        }
+    }
+}
+
+} // anonymous namespace
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+FiffRawMappedReader::FiffRawMappedReader(const QString& p_sFileName)
+: m_file(p_sFileName)
+, m_pData(NULL)
+, m_iSize(0)
+{
+    if(!m_file.open(QIODevice::ReadOnly)) {
+        qWarning("FiffRawMappedReader::FiffRawMappedReader - Cannot open %s", p_sFileName.toUtf8().constData());
+        return;
+    }
+
+    m_iSize = m_file.size();
+    if(m_iSize > 0) {
+        m_pData = m_file.map(0, m_iSize);
+    }
+
+    if(!m_pData) {
+        qWarning("FiffRawMappedReader::FiffRawMappedReader - Cannot map %s, falling back to tag reading.", p_sFileName.toUtf8().constData());
+        m_iSize = 0;
+        m_file.close();
+    }
+}
+
+
+//*************************************************************************************************************
+
+FiffRawMappedReader::~FiffRawMappedReader()
+{
+    if(m_pData) {
+        m_file.unmap(m_pData);
+    }
+    m_file.close();
+}
+
+
+//*************************************************************************************************************
+
+bool FiffRawMappedReader::supportsType(fiff_int_t type)
+{
+    switch(type) {
+        case FIFFT_DAU_PACK16:
+        case FIFFT_SHORT:
+        case FIFFT_INT:
+        case FIFFT_FLOAT:
+            return true;
+        default:
+            return false;
+    }
+}
+
+
+//*************************************************************************************************************
+
+bool FiffRawMappedReader::read_buffer(const FiffDirEntry::SPtr& ent,
+                                      fiff_int_t nchan,
+                                      fiff_int_t first_pick,
+                                      fiff_int_t picksamp,
+                                      const RowVectorXd& cals,
+                                      const RowVectorXi& sel,
+                                      MatrixXd& data,
+                                      fiff_int_t dest) const
+{
+    if(!m_pData || !ent || nchan <= 0 || !supportsType(ent->type)) {
+        return false;
+    }
+
+    if(picksamp <= 0) {
+        return true;
+    }
+
+    qint32 iSampleSize = (ent->type == FIFFT_DAU_PACK16 || ent->type == FIFFT_SHORT) ? 2 : 4;
+
+    //
+    //  Make sure the requested samples are inside the tag and the tag is inside the mapping
+    //
+    qint64 iDataPos = static_cast<qint64>(ent->pos) + FiffDirEntry::storageSize();
+    qint64 iNeeded = static_cast<qint64>(first_pick + picksamp) * nchan * iSampleSize;
+    if(first_pick < 0 || iNeeded > ent->size || iDataPos + ent->size > m_iSize) {
+        qWarning("FiffRawMappedReader::read_buffer - Requested samples are out of the buffer range.");
+        return false;
+    }
+
+    qint32 nrows = sel.size() > 0 ? sel.size() : nchan;
+    if(data.rows() < nrows || data.cols() < dest + picksamp) {
+        qWarning("FiffRawMappedReader::read_buffer - Output matrix is too small.");
+        return false;
+    }
+
+    //
+    //  Resolve byte offsets and calibration factors of the output rows once per buffer
+    //
+    VectorXi vecOffsets(nrows);
+    VectorXd vecCals(nrows);
+    for(qint32 r = 0; r < nrows; ++r) {
+        qint32 ch = sel.size() > 0 ? sel[r] : r;
+        if(ch < 0 || ch >= nchan) {
+            qWarning("FiffRawMappedReader::read_buffer - Channel selection out of range.");
+            return false;
+        }
+        vecOffsets[r] = ch * iSampleSize;
+        vecCals[r] = cals.size() > 0 ? cals[ch] : 1.0;
+    }
+
+    const uchar* pBuffer = m_pData + iDataPos;
+
+    switch(ent->type) {
+        case FIFFT_DAU_PACK16:
+        case FIFFT_SHORT:
+            decodeBuffer<qint16>(pBuffer, nchan, first_pick, picksamp, vecOffsets, vecCals, data, dest);
+            break;
+        case FIFFT_INT:
+            decodeBuffer<qint32>(pBuffer, nchan, first_pick, picksamp, vecOffsets, vecCals, data, dest);
+            break;
+        case FIFFT_FLOAT:
+            decodeBuffer<float>(pBuffer, nchan, first_pick, picksamp, vecOffsets, vecCals, data, dest);
+            break;
+    }
+
+    return true;
+}
@@ -0,0 +1,169 @@
+//=============================================================================================================
+/**
+* @file     fiff_raw_mapped_reader.h
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    FiffRawMappedReader class declaration.
+*
+*/
+
+#ifndef FIFF_RAW_MAPPED_READER_H
+#define FIFF_RAW_MAPPED_READER_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "fiff_global.h"
+#include "fiff_types.h"
+#include "fiff_dir_entry.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QFile>
+#include <QSharedPointer>
+#include <QString>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE FIFFLIB
+//=============================================================================================================
+
+namespace FIFFLIB
+{
+
+
+//=============================================================================================================
+/**
+* Maps a raw fiff file once into memory and decodes raw data buffers (DAU_PACK16, SHORT, INT and FLOAT)
+* straight from the mapping into a caller provided matrix. Byte swapping, calibration and channel selection
+* are done in a single pass over the picked samples, no intermediate FiffTag is allocated.
+*
+* @brief Memory-mapped zero-copy reader for raw data buffers.
+*/
+class FIFFSHARED_EXPORT FiffRawMappedReader
+{
+public:
+    typedef QSharedPointer<FiffRawMappedReader> SPtr;              /**< Shared pointer type for FiffRawMappedReader. */
+    typedef QSharedPointer<const FiffRawMappedReader> ConstSPtr;   /**< Const shared pointer type for FiffRawMappedReader. */
+
+    //=========================================================================================================
+    /**
+    * Opens and maps the given file read only. Use isValid() to check whether mapping succeeded.
+    *
+    * @param[in] p_sFileName    The raw fiff file to map.
+    */
+    explicit FiffRawMappedReader(const QString& p_sFileName);
+
+    //=========================================================================================================
+    /**
+    * Unmaps and closes the file.
+    */
+    ~FiffRawMappedReader();
+
+    //=========================================================================================================
+    /**
+    * Returns whether the file is mapped.
+    *
+    * @return true if the file could be mapped, false otherwise.
+    */
+    inline bool isValid() const;
+
+    //=========================================================================================================
+    /**
+    * Returns whether buffers of the given fiff data type can be decoded by this reader.
+    *
+    * @param[in] type   The fiff data type (FIFFT_*).
+    *
+    * @return true if the type is supported.
+    */
+    static bool supportsType(fiff_int_t type);
+
+    //=========================================================================================================
+    /**
+    * Decodes picksamp samples starting at first_pick of the raw data buffer ent into the columns
+    * dest ... dest + picksamp - 1 of data. Row r of data receives channel sel[r] (or channel r if sel is empty),
+    * multiplied with cals of that channel (or 1 if cals is empty).
+    *
+    * @param[in] ent            Directory entry of the data buffer.
+    * @param[in] nchan          Number of channels stored in the buffer.
+    * @param[in] first_pick     First sample of the buffer to decode.
+    * @param[in] picksamp       Number of samples to decode.
+    * @param[in] cals           Calibration factors for all nchan channels (optional).
+    * @param[in] sel            Channel selection (optional).
+    * @param[out] data          The output matrix, has to be preallocated with enough rows and columns.
+    * @param[in] dest           First output column.
+    *
+    * @return true if succeeded, false otherwise.
+    */
+    bool read_buffer(const FiffDirEntry::SPtr& ent,
+                     fiff_int_t nchan,
+                     fiff_int_t first_pick,
+                     fiff_int_t picksamp,
+                     const Eigen::RowVectorXd& cals,
+                     const Eigen::RowVectorXi& sel,
+                     Eigen::MatrixXd& data,
+                     fiff_int_t dest) const;
+
+private:
+    FiffRawMappedReader(const FiffRawMappedReader&);              /**< Not copyable. */
+    FiffRawMappedReader& operator=(const FiffRawMappedReader&);   /**< Not copyable. */
+
+    QFile   m_file;     /**< The mapped file. */
+    uchar*  m_pData;    /**< Start of the mapping, NULL if not mapped. */
+    qint64  m_iSize;    /**< Size of the mapping in bytes. */
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline bool FiffRawMappedReader::isValid() const
+{
+    return m_pData != NULL;
+}
+
+} // NAMESPACE
+
+#endif // FIFF_RAW_MAPPED_READER_H
@@ -0,0 +1,384 @@
+//=============================================================================================================
+/**
+* @file     fiff_raw_recorder.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    FiffRawRecorder class definition.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "fiff_raw_recorder.h"
+#include "fiff_file.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QElapsedTimer>
+#include <QMutexLocker>
+#include <QDebug>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FIFFLIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+namespace
+{
+
+// Positions in a fiff file are signed 32 bit integers
+const qint64 c_iMaxFiffFileSize     = 2147483647;
+
+// Room for the FIFFB_REF link, the closing tags and the directory entries of the measurement info
+const qint64 c_iFinishReserve       = 1024 * 1024;
+
+// Size of a fiff tag header (kind, type, size, next)
+const qint64 c_iTagHeaderSize       = 4 * sizeof(fiff_int_t);
+
+} // NAMESPACE
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+FiffRawRecorder::FiffRawRecorder(int p_iQueueCapacity)
+: m_iQueueCapacity(p_iQueueCapacity > 0 ? p_iQueueCapacity : 1)
+, m_bRecording(false)
+, m_bStop(false)
+, m_statistics()
+, m_dTotalWriteMs(0.0)
+, m_bResetRange(false)
+, m_iSplitFileSize(c_iMaxFiffFileSize - c_iFinishReserve)
+, m_iSplitCount(0)
+, m_iFileFirstSample(0)
+, m_iFileBlocks(0)
+{
+}
+
+
+//*************************************************************************************************************
+
+FiffRawRecorder::~FiffRawRecorder()
+{
+    stopRecording();
+}
+
+
+//*************************************************************************************************************
+
+void FiffRawRecorder::setSplitFileSize(qint64 p_iSplitFileSize)
+{
+    m_iSplitFileSize = qMin(p_iSplitFileSize, c_iMaxFiffFileSize - c_iFinishReserve);
+}
+
+
+//*************************************************************************************************************
+
+bool FiffRawRecorder::startRecording(const QString& p_sFileName, const FiffInfo& p_FiffInfo, bool p_bResetRange)
+{
+    if(isRunning()) {
+        qWarning() << "FiffRawRecorder::startRecording - Recording is already running.";
+        return false;
+    }
+
+    m_sFileName = p_sFileName;
+    m_FiffInfo = p_FiffInfo;
+    m_bResetRange = p_bResetRange;
+    m_iSplitCount = 0;
+
+    {
+        QMutexLocker locker(&m_mutex);
+        m_lQueue.clear();
+        m_bStop = false;
+        m_statistics = Statistics();
+        m_dTotalWriteMs = 0.0;
+    }
+
+    // Open the first file here so that the caller learns about errors right away
+    if(!openFile())
+        return false;
+
+    {
+        QMutexLocker locker(&m_mutex);
+        m_bRecording = true;
+    }
+
+    start();
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool FiffRawRecorder::push(const MatrixXd& p_matData)
+{
+    Block t_block;
+    t_block.matDouble = p_matData;
+    return enqueue(t_block);
+}
+
+
+//*************************************************************************************************************
+
+bool FiffRawRecorder::push(const MatrixXf& p_matData)
+{
+    Block t_block;
+    t_block.matFloat = p_matData;
+    return enqueue(t_block);
+}
+
+
+//*************************************************************************************************************
+
+void FiffRawRecorder::stopRecording()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_bRecording = false;
+        m_bStop = true;
+        m_condQueue.wakeAll();
+    }
+
+    wait();
+}
+
+
+//*************************************************************************************************************
+
+bool FiffRawRecorder::isRecording() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_bRecording;
+}
+
+
+//*************************************************************************************************************
+
+FiffRawRecorder::Statistics FiffRawRecorder::statistics() const
+{
+    QMutexLocker locker(&m_mutex);
+    Statistics t_statistics = m_statistics;
+    t_statistics.iQueueDepth = m_lQueue.size();
+    return t_statistics;
+}
+
+
+//*************************************************************************************************************
+
+QString FiffRawRecorder::splitFileName(const QString& p_sFileName, int p_iSplitCount)
+{
+    if(p_iSplitCount <= 0)
+        return p_sFileName;
+
+    QString t_sBaseName = p_sFileName;
+    if(t_sBaseName.endsWith("_raw.fif"))
+        t_sBaseName.chop(8);
+    else if(t_sBaseName.endsWith(".fif"))
+        t_sBaseName.chop(4);
+
+    return t_sBaseName + QString("-%1_raw.fif").arg(p_iSplitCount);
+}
+
+
+//*************************************************************************************************************
+
+void FiffRawRecorder::run()
+{
+    QList<Block> t_lBlocks;
+
+    while(true) {
+        {
+            QMutexLocker locker(&m_mutex);
+            while(m_lQueue.isEmpty() && !m_bStop)
+                m_condQueue.wait(&m_mutex);
+
+            if(m_lQueue.isEmpty() && m_bStop)
+                break;
+
+            // Swap the filled queue against the drained one, the producer continues filling while we write
+            t_lBlocks.swap(m_lQueue);
+        }
+
+        for(int i = 0; i < t_lBlocks.size(); ++i) {
+            QElapsedTimer t_timer;
+            t_timer.start();
+
+            bool t_bWritten = writeBlock(t_lBlocks.at(i));
+
+            double t_dWriteMs = t_timer.nsecsElapsed() / 1000000.0;
+
+            QMutexLocker locker(&m_mutex);
+            if(t_bWritten) {
+                ++m_statistics.iBlocksWritten;
+                m_dTotalWriteMs += t_dWriteMs;
+                m_statistics.dLastWriteMs = t_dWriteMs;
+                m_statistics.dMeanWriteMs = m_dTotalWriteMs / m_statistics.iBlocksWritten;
+                m_statistics.dMaxWriteMs = qMax(m_statistics.dMaxWriteMs, t_dWriteMs);
+            } else {
+                ++m_statistics.iBlocksDropped;
+            }
+        }
+
+        t_lBlocks.clear();
+    }
+
+    if(m_pStream) {
+        m_pStream->finish_writing_raw();
+        m_pStream.clear();
+    }
+}
+
+
+//*************************************************************************************************************
+
+bool FiffRawRecorder::enqueue(const Block& p_block)
+{
+    QMutexLocker locker(&m_mutex);
+
+    if(!m_bRecording || m_lQueue.size() >= m_iQueueCapacity) {
+        ++m_statistics.iBlocksDropped;
+        return false;
+    }
+
+    m_lQueue.append(p_block);
+    m_statistics.iMaxQueueDepth = qMax(m_statistics.iMaxQueueDepth, m_lQueue.size());
+    m_condQueue.wakeOne();
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool FiffRawRecorder::writeBlock(const Block& p_block)
+{
+    const bool t_bFloat = p_block.matDouble.size() == 0;
+    const qint64 t_iRows = t_bFloat ? p_block.matFloat.rows() : p_block.matDouble.rows();
+    const qint64 t_iCols = t_bFloat ? p_block.matFloat.cols() : p_block.matDouble.cols();
+
+    if(!m_pStream || t_iRows != m_vecCals.cols())
+        return false;
+
+    const qint64 t_iTagSize = c_iTagHeaderSize + t_iRows * t_iCols * qint64(sizeof(float));
+
+    // The directory written on finish grows by one entry per block
+    const qint64 t_iDirSize = (m_iFileBlocks + 1) * FiffDirEntry::storageSize();
+
+    // Never split an empty file, a single block larger than the split size is written anyway
+    if(m_pStream->device()->pos() + t_iTagSize + t_iDirSize > m_iSplitFileSize
+            && m_statistics.iSamplesWritten > m_iFileFirstSample) {
+        if(!splitFile())
+            return false;
+    }
+
+    bool t_bWritten = t_bFloat ? m_pStream->write_raw_buffer(p_block.matFloat.cast<double>(), m_vecCals)
+                               : m_pStream->write_raw_buffer(p_block.matDouble, m_vecCals);
+
+    if(t_bWritten) {
+        ++m_iFileBlocks;
+
+        QMutexLocker locker(&m_mutex);
+        m_statistics.iSamplesWritten += t_iCols;
+        m_statistics.iBytesWritten += t_iTagSize;
+    }
+
+    return t_bWritten;
+}
+
+
+//*************************************************************************************************************
+
+bool FiffRawRecorder::openFile()
+{
+    m_file.setFileName(splitFileName(m_sFileName, m_iSplitCount));
+
+    m_pStream = FiffStream::start_writing_raw(m_file, m_FiffInfo, m_vecCals, defaultMatrixXi, m_bResetRange);
+    if(!m_pStream) {
+        qWarning() << "FiffRawRecorder::openFile - Could not open" << m_file.fileName();
+        return false;
+    }
+
+    // Split files continue the sample count of their predecessors
+    m_iFileFirstSample = m_statistics.iSamplesWritten;
+    m_iFileBlocks = 0;
+    fiff_int_t t_iFirstSample = static_cast<fiff_int_t>(m_iFileFirstSample);
+    m_pStream->write_int(FIFF_FIRST_SAMPLE, &t_iFirstSample);
+
+    QMutexLocker locker(&m_mutex);
+    ++m_statistics.iFileCount;
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool FiffRawRecorder::splitFile()
+{
+    ++m_iSplitCount;
+    QString t_sNextFileName = splitFileName(m_sFileName, m_iSplitCount);
+
+    //
+    // Write the link to the next file
+    //
+    fiff_int_t data;
+    m_pStream->start_block(FIFFB_REF);
+    data = FIFFV_ROLE_NEXT_FILE;
+    m_pStream->write_int(FIFF_REF_ROLE, &data);
+    m_pStream->write_string(FIFF_REF_FILE_NAME, t_sNextFileName);
+    m_pStream->write_id(FIFF_REF_FILE_ID, m_FiffInfo.meas_id);
+    data = m_iSplitCount - 1;
+    m_pStream->write_int(FIFF_REF_FILE_NUM, &data);
+    m_pStream->end_block(FIFFB_REF);
+
+    m_pStream->finish_writing_raw();
+    m_pStream.clear();
+
+    return openFile();
+}
@@ -0,0 +1,275 @@
+//=============================================================================================================
+/**
+* @file     fiff_raw_recorder.h
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    FiffRawRecorder class declaration.
+*
+*/
+
+
+#ifndef FIFF_RAW_RECORDER_H
+#define FIFF_RAW_RECORDER_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "fiff_global.h"
+#include "fiff_types.h"
+#include "fiff_info.h"
+#include "fiff_stream.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QFile>
+#include <QList>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QString>
+#include <QThread>
+#include <QWaitCondition>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE FIFFLIB
+//=============================================================================================================
+
+namespace FIFFLIB
+{
+
+
+//=============================================================================================================
+/**
+* Records raw data blocks to a fiff file without blocking the acquisition thread. The producer hands blocks
+* to push(), which only appends them to a bounded queue and never touches the disk. A dedicated writer thread
+* swaps the filled queue against its own (double buffering), converts and calibrates the blocks, frames them as
+* raw data buffer tags, splits the recording into linked files before the 2 GB fiff limit is reached and finally
+* calls finish_writing_raw. If the queue is full, push() drops the block and counts it instead of stalling.
+*
+* Any ISensor plugin can own a FiffRawRecorder: call startRecording() with the plugin's FiffInfo, push() every
+* acquired block from run() and stopRecording() once the user stops recording.
+*
+* @brief Asynchronous raw data recorder with a background writer thread.
+*/
+class FIFFSHARED_EXPORT FiffRawRecorder : public QThread
+{
+public:
+    typedef QSharedPointer<FiffRawRecorder> SPtr;              /**< Shared pointer type for FiffRawRecorder. */
+    typedef QSharedPointer<const FiffRawRecorder> ConstSPtr;   /**< Const shared pointer type for FiffRawRecorder. */
+
+    //=========================================================================================================
+    /**
+    * Recorder statistics, see statistics().
+    */
+    struct Statistics {
+        int     iQueueDepth;        /**< Blocks currently waiting in the queue. */
+        int     iMaxQueueDepth;     /**< Maximal queue depth since startRecording(). */
+        qint64  iBlocksWritten;     /**< Blocks written to disk. */
+        qint64  iBlocksDropped;     /**< Blocks dropped because the queue was full or the write failed. */
+        qint64  iSamplesWritten;    /**< Samples (columns) written to disk. */
+        qint64  iBytesWritten;      /**< Bytes of raw data buffer tags written to disk. */
+        int     iFileCount;         /**< Number of files written, including split files. */
+        double  dLastWriteMs;       /**< Write latency of the last block in ms. */
+        double  dMeanWriteMs;       /**< Mean write latency per block in ms. */
+        double  dMaxWriteMs;        /**< Maximal write latency per block in ms. */
+    };
+
+    //=========================================================================================================
+    /**
+    * Constructs a FiffRawRecorder.
+    *
+    * @param[in] p_iQueueCapacity   Maximal number of blocks waiting to be written before push() drops blocks.
+    */
+    explicit FiffRawRecorder(int p_iQueueCapacity = 64);
+
+    //=========================================================================================================
+    /**
+    * Stops a running recording and destroys the FiffRawRecorder.
+    */
+    ~FiffRawRecorder();
+
+    //=========================================================================================================
+    /**
+    * Sets the file size in bytes after which the recording is continued in a new file. The default stays just
+    * below the 2 GB limit of the fiff format. Has to be called before startRecording().
+    *
+    * @param[in] p_iSplitFileSize   The maximal file size in bytes.
+    */
+    void setSplitFileSize(qint64 p_iSplitFileSize);
+
+    //=========================================================================================================
+    /**
+    * Writes the measurement info to p_sFileName and starts the writer thread. Split files are named after
+    * p_sFileName, i.e. <name>_raw.fif is continued in <name>-1_raw.fif, <name>-2_raw.fif, ...
+    *
+    * @param[in] p_sFileName    The file to record to.
+    * @param[in] p_FiffInfo     The measurement info of the recorded data.
+    * @param[in] p_bResetRange  Whether the channel range should be reset to 1.0 (see FiffStream::start_writing_raw).
+    *
+    * @return true if the file could be opened and the writer thread was started, false otherwise.
+    */
+    bool startRecording(const QString& p_sFileName, const FiffInfo& p_FiffInfo, bool p_bResetRange = false);
+
+    //=========================================================================================================
+    /**
+    * Queues a data block (channels x samples) for writing. Never blocks on disk access.
+    *
+    * @param[in] p_matData      The data block.
+    *
+    * @return true if the block was queued, false if it was dropped because the queue is full or no recording is running.
+    */
+    bool push(const Eigen::MatrixXd& p_matData);
+
+    //=========================================================================================================
+    /**
+    * Queues a single precision data block (channels x samples) for writing. The conversion to double precision
+    * is done by the writer thread.
+    *
+    * @param[in] p_matData      The data block.
+    *
+    * @return true if the block was queued, false if it was dropped because the queue is full or no recording is running.
+    */
+    bool push(const Eigen::MatrixXf& p_matData);
+
+    //=========================================================================================================
+    /**
+    * Writes all queued blocks, finishes the current file and waits for the writer thread to return.
+    */
+    void stopRecording();
+
+    //=========================================================================================================
+    /**
+    * Returns whether a recording is running.
+    *
+    * @return true if recording.
+    */
+    bool isRecording() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the current recorder statistics.
+    *
+    * @return the statistics.
+    */
+    Statistics statistics() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the name of the n-th file of a recording started with p_sFileName.
+    *
+    * @param[in] p_sFileName    The file name passed to startRecording().
+    * @param[in] p_iSplitCount  The split count, 0 for the first file.
+    *
+    * @return the file name.
+    */
+    static QString splitFileName(const QString& p_sFileName, int p_iSplitCount);
+
+protected:
+    //=========================================================================================================
+    /**
+    * The writer thread, drains the queue until stopRecording() is called.
+    */
+    virtual void run();
+
+private:
+    //=========================================================================================================
+    /**
+    * A queued block, either in single or in double precision.
+    */
+    struct Block {
+        Eigen::MatrixXd matDouble;  /**< The block in double precision, empty if matFloat is used. */
+        Eigen::MatrixXf matFloat;   /**< The block in single precision, empty if matDouble is used. */
+    };
+
+    //=========================================================================================================
+    /**
+    * Queues a block, used by both push overloads.
+    */
+    bool enqueue(const Block& p_block);
+
+    //=========================================================================================================
+    /**
+    * Writes one block, splits the file beforehand if the block would exceed the split file size.
+    */
+    bool writeBlock(const Block& p_block);
+
+    //=========================================================================================================
+    /**
+    * Opens m_file with the current file name and writes the measurement info and the first sample.
+    */
+    bool openFile();
+
+    //=========================================================================================================
+    /**
+    * Links the current file to the next one, finishes it and continues in the next file.
+    */
+    bool splitFile();
+
+    FiffRawRecorder(const FiffRawRecorder&);              /**< Not copyable. */
+    FiffRawRecorder& operator=(const FiffRawRecorder&);   /**< Not copyable. */
+
+    mutable QMutex      m_mutex;            /**< Guards the queue, the stop flag and the statistics. */
+    QWaitCondition      m_condQueue;        /**< Wakes the writer thread when blocks are queued or the recording stops. */
+    QList<Block>        m_lQueue;           /**< Blocks waiting for the writer thread. */
+    int                 m_iQueueCapacity;   /**< Maximal number of queued blocks. */
+    bool                m_bRecording;       /**< Whether push() accepts blocks. */
+    bool                m_bStop;            /**< Tells the writer thread to drain the queue and return. */
+    Statistics          m_statistics;       /**< The recorder statistics. */
+    double              m_dTotalWriteMs;    /**< Summed write latency, used for the mean. */
+
+    // Only touched by the writer thread while it is running
+    FiffInfo            m_FiffInfo;         /**< The measurement info written to every file. */
+    bool                m_bResetRange;      /**< Passed to start_writing_raw. */
+    QString             m_sFileName;        /**< The file name passed to startRecording(). */
+    QFile               m_file;             /**< The file currently written. */
+    FiffStream::SPtr    m_pStream;          /**< The stream of m_file. */
+    Eigen::RowVectorXd  m_vecCals;          /**< The calibrations returned by start_writing_raw. */
+    qint64              m_iSplitFileSize;   /**< Maximal file size in bytes. */
+    int                 m_iSplitCount;      /**< Number of the current file, 0 for the first one. */
+    qint64              m_iFileFirstSample; /**< First sample of the current file. */
+    qint64              m_iFileBlocks;      /**< Number of blocks written to the current file. */
+};
+
+} // NAMESPACE
+
+#endif // FIFF_RAW_RECORDER_H
@@ -75,6 +75,12 @@
 
 #include <iostream>
 #include <time.h>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define FIFF_STREAM_SSE2
+#include <emmintrin.h>
+#endif
 
 
 //*************************************************************************************************************
@@ -92,7 +98,11 @@
 //=============================================================================================================
 
 #include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QSaveFile>
 #include <QTcpSocket>
+#include <QtEndian>
 
 
 //*************************************************************************************************************
@@ -104,6 +114,60 @@ using namespace FIFFLIB;
 using namespace UTILSLIB;
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+namespace
+{
+
+// Whether open() caches the directory of files without FIFF_DIR, see FiffStream::set_dir_cache_enabled
+bool g_bDirCacheEnabled = false;
+
+// Header of a directory cache file: "FDIR" and the format version
+const qint32 c_iDirCacheMagic   = 0x46444952;
+const qint32 c_iDirCacheVersion = 1;
+
+//=============================================================================================================
+/**
+* Copies nwords 32 bit words from src to dst and converts them from host to big endian byte order.
+* The buffers may be unaligned. On SSE2 capable hosts four words are swapped per instruction.
+*/
+void copyToBigEndian32(const void* src, void* dst, qint64 nwords)
+{
+#if Q_BYTE_ORDER == Q_BIG_ENDIAN
+    std::memcpy(dst, src, nwords * 4);
+#else
+    const uchar* pSrc = static_cast<const uchar*>(src);
+    uchar* pDst = static_cast<uchar*>(dst);
+    qint64 i = 0;
+
+#ifdef FIFF_STREAM_SSE2
+    for(; i + 8 <= nwords; i += 8) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + 4*i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrc + 4*i + 16));
+        //swap the bytes of each 16 bit half, then the halves of each word
+        a = _mm_or_si128(_mm_slli_epi16(a, 8), _mm_srli_epi16(a, 8));
+        b = _mm_or_si128(_mm_slli_epi16(b, 8), _mm_srli_epi16(b, 8));
+        a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(a, _MM_SHUFFLE(2,3,0,1)), _MM_SHUFFLE(2,3,0,1));
+        b = _mm_shufflehi_epi16(_mm_shufflelo_epi16(b, _MM_SHUFFLE(2,3,0,1)), _MM_SHUFFLE(2,3,0,1));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + 4*i), a);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDst + 4*i + 16), b);
+    }
+#endif
+
+    for(; i < nwords; ++i) {
+        quint32 t_iWord;
+        std::memcpy(&t_iWord, pSrc + 4*i, 4);
+        qToBigEndian<quint32>(t_iWord, pDst + 4*i);
+    }
+#endif
+}
+
+} // NAMESPACE
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS
@@ -111,6 +175,8 @@ using namespace UTILSLIB;
 
 FiffStream::FiffStream(QIODevice *p_pIODevice)
 : QDataStream(p_pIODevice)
+, m_bWriteDir(false)
+, m_iDirPointerPos(-1)
 {
     this->setFloatingPointPrecision(QDataStream::SinglePrecision);
     this->setByteOrder(QDataStream::BigEndian);
@@ -122,6 +188,8 @@ FiffStream::FiffStream(QIODevice *p_pIODevice)
 
 FiffStream::FiffStream(QByteArray * a, QIODevice::OpenMode mode)
 : QDataStream(a, mode)
+, m_bWriteDir(false)
+, m_iDirPointerPos(-1)
 {
     this->setFloatingPointPrecision(QDataStream::SinglePrecision);
     this->setByteOrder(QDataStream::BigEndian);
@@ -196,12 +264,58 @@ fiff_long_t FiffStream::end_block(fiff_int_t kind, fiff_int_t next)
 
 void FiffStream::end_file()
 {
+    fiff_long_t pos = this->device()->pos();
     fiff_int_t datasize = 0;
 
     *this << (qint32)FIFF_NOP;
     *this << (qint32)FIFFT_VOID;
     *this << (qint32)datasize;
     *this << (qint32)FIFFV_NEXT_NONE;
+    this->add_dir_entry(FIFF_NOP, FIFFT_VOID, datasize, pos);
+
+    if(!m_bWriteDir)
+        return;
+
+    //
+    //   Tags written without the FiffStream write functions are not in the directory. Only write it if the
+    //   collected tags cover the whole file.
+    //
+    fiff_long_t dirpos = this->device()->pos();
+    fiff_long_t dirsize = (m_writtenDir.size() + 2) * FiffDirEntry::storageSize();
+
+    fiff_long_t t_iNextPos = 0;
+    for(qint32 k = 0; k < m_writtenDir.size() && t_iNextPos >= 0; ++k) {
+        if(m_writtenDir[k]->pos == t_iNextPos)
+            t_iNextPos += FIFFC_DATA_OFFSET + m_writtenDir[k]->size;
+        else
+            t_iNextPos = -1;
+    }
+
+    //
+    //   Append the directory, terminated by its own entry and an empty one like in MNE-C
+    //
+    if(t_iNextPos == dirpos && !this->device()->isSequential() && m_iDirPointerPos >= 0 && dirpos + dirsize < 2147483647) {
+        FiffDirEntry::SPtr t_pDirEntry(new FiffDirEntry);
+        t_pDirEntry->kind = FIFF_DIR;
+        t_pDirEntry->type = FIFFT_DIR_ENTRY_STRUCT;
+        t_pDirEntry->size = (fiff_int_t)dirsize;
+        t_pDirEntry->pos = (fiff_int_t)dirpos;
+        m_writtenDir.append(t_pDirEntry);
+
+        t_pDirEntry = FiffDirEntry::SPtr(new FiffDirEntry);
+        t_pDirEntry->kind = -1;
+        t_pDirEntry->type = -1;
+        t_pDirEntry->size = -1;
+        t_pDirEntry->pos  = -1;
+        m_writtenDir.append(t_pDirEntry);
+
+        this->write_dir_entries(m_writtenDir, dirpos);
+        this->write_dir_pointer((fiff_int_t)dirpos, m_iDirPointerPos);
+        this->device()->seek(this->device()->size());
+    }
+
+    m_bWriteDir = false;
+    m_writtenDir.clear();
 }
 
 
@@ -321,11 +435,15 @@ bool FiffStream::open(QIODevice::OpenModeFlag mode)
     * Do we have a directory or not?
     */
     if (dirpos <= 0) {  /* Must do it in the hard way... */
-        bool ok = false;
-        m_dir = this->make_dir(&ok);
-        if (!ok) {
-          qCritical ("Could not create tag directory!");
-          return false;
+        if (!g_bDirCacheEnabled || !this->read_dir_cache()) {
+            bool ok = false;
+            m_dir = this->make_dir(&ok);
+            if (!ok) {
+              qCritical ("Could not create tag directory!");
+              return false;
+            }
+            if (g_bDirCacheEnabled)
+                this->write_dir_cache();
         }
     }
     else {              /* Just read the directory */
@@ -365,6 +483,30 @@ bool FiffStream::open(QIODevice::OpenModeFlag mode)
 }
 
 
+//*************************************************************************************************************
+
+void FiffStream::set_dir_cache_enabled(bool enabled)
+{
+    g_bDirCacheEnabled = enabled;
+}
+
+
+//*************************************************************************************************************
+
+bool FiffStream::dir_cache_enabled()
+{
+    return g_bDirCacheEnabled;
+}
+
+
+//*************************************************************************************************************
+
+QString FiffStream::dir_cache_file_name(const QString& p_sFileName)
+{
+    return p_sFileName + ".dir";
+}
+
+
 //*************************************************************************************************************
 
 bool FiffStream::close()
@@ -1738,6 +1880,15 @@ bool FiffStream::setup_read_raw(QIODevice &p_IODevice, FiffRawData& data, bool a
     data.clear();
     data.file = t_pStream;// fid;
     data.info = info;
+    //
+    //   Map local files once, buffers are then decoded straight from the mapping
+    //
+    if (QFile* t_pFile = qobject_cast<QFile*>(&p_IODevice))
+    {
+        data.mapped_reader = FiffRawMappedReader::SPtr(new FiffRawMappedReader(t_pFile->fileName()));
+        if (!data.mapped_reader->isValid())
+            data.mapped_reader.clear();
+    }
     data.first_samp = 0;
     data.last_samp  = 0;
     //
@@ -1860,6 +2011,7 @@ bool FiffStream::setup_read_raw(QIODevice &p_IODevice, FiffRawData& data, bool a
     //
     data.cals       = cals;
     data.rawdir     = rawdir;
+    data.build_rawdir_index();
     //data->proj       = [];
     //data.comp       = [];
     //
@@ -1905,11 +2057,13 @@ FiffStream::SPtr FiffStream::start_file(QIODevice& p_IODevice)
     }
 
     //
-    //   Write the compulsory items
+    //   Write the compulsory items, from now on all tags are collected for the directory written by end_file
     //
+    p_pStream->m_bWriteDir = true;
+    p_pStream->m_writtenDir.clear();
     p_pStream->write_id(FIFF_FILE_ID);//1
     int null_pointer = FIFFV_NEXT_NONE;
-    p_pStream->write_int(FIFF_DIR_POINTER,&null_pointer);//2
+    p_pStream->m_iDirPointerPos = p_pStream->write_int(FIFF_DIR_POINTER,&null_pointer);//2
     p_pStream->write_int(FIFF_FREE_LIST,&null_pointer);//3
     //
     //   Ready for more
@@ -2013,6 +2167,8 @@ FiffStream::SPtr FiffStream::start_writing_raw(QIODevice &p_IODevice, const Fiff
     //  Create the file and save the essentials
     //
     FiffStream::SPtr t_pStream = start_file(p_IODevice);//1, 2, 3
+    if(!t_pStream)
+        return t_pStream;
     t_pStream->start_block(FIFFB_MEAS);//4
     t_pStream->write_id(FIFF_BLOCK_ID);//5
     if(info.meas_id.version != -1)
@@ -2169,6 +2325,8 @@ FiffStream::SPtr FiffStream::start_writing_raw(QIODevice &p_IODevice, const Fiff
             t_pStream->write_ch_info(chs[k]);
         }
     }
+    t_pStream->m_vecCals = cals;
+    t_pStream->m_vecInvCals = cals.cwiseInverse();
     //
     //
     t_pStream->end_block(FIFFB_MEAS_INFO);
@@ -2185,6 +2343,8 @@ FiffStream::SPtr FiffStream::start_writing_raw(QIODevice &p_IODevice, const Fiff
 
 fiff_long_t FiffStream::write_tag(const QSharedPointer<FiffTag> &p_pTag, fiff_long_t pos)
 {
+    bool t_bAppend = pos < 0;
+
     /*
     * Write tag to specified position
     */
@@ -2204,6 +2364,8 @@ fiff_long_t FiffStream::write_tag(const QSharedPointer<FiffTag> &p_pTag, fiff_lo
     *this << (qint32)p_pTag->type;
     *this << (qint32)datasize;
     *this << (qint32)p_pTag->next;
+    if (t_bAppend)
+        this->add_dir_entry(p_pTag->kind, p_pTag->type, datasize, pos);
 
     /*
     * Do we have data?
@@ -2219,6 +2381,28 @@ fiff_long_t FiffStream::write_tag(const QSharedPointer<FiffTag> &p_pTag, fiff_lo
 }
 
 
+//*************************************************************************************************************
+
+fiff_long_t FiffStream::write_tag_words(fiff_int_t kind, fiff_int_t type, const void* data, fiff_int_t nwords, fiff_int_t next)
+{
+    fiff_long_t pos = this->device()->pos();
+
+    qint64 t_iNumWords = 4 + static_cast<qint64>(nwords);
+    if(m_vecTagBuffer.size() < t_iNumWords)
+        m_vecTagBuffer.resize(t_iNumWords);
+
+    fiff_int_t header[4] = {kind, type, nwords * 4, next};
+    copyToBigEndian32(header, m_vecTagBuffer.data(), 4);
+    if(nwords > 0)
+        copyToBigEndian32(data, m_vecTagBuffer.data() + 4, nwords);
+
+    this->writeRawData(reinterpret_cast<const char*>(m_vecTagBuffer.data()), static_cast<int>(t_iNumWords * 4));
+    this->add_dir_entry(kind, type, nwords * 4, pos);
+
+    return pos;
+}
+
+
 //*************************************************************************************************************
 
 fiff_long_t FiffStream::write_ch_info(const FiffChInfo& ch)
@@ -2252,6 +2436,8 @@ fiff_long_t FiffStream::write_ch_info(const FiffChInfo& ch)
     *this << (qint32)datasize;
     *this << (qint32)FIFFV_NEXT_SEQ;
 
+    this->add_dir_entry(FIFF_CH_INFO, FIFFT_CH_INFO_STRUCT, datasize, pos);
+
     //
     //   Start writing fiffChInfoRec
     //
@@ -2347,6 +2533,8 @@ fiff_long_t FiffStream::write_coord_trans(const FiffCoordTrans& trans)
     *this << (qint32)datasize;
     *this << (qint32)FIFFV_NEXT_SEQ;
 
+    this->add_dir_entry(FIFF_COORD_TRANS, FIFFT_COORD_TRANS_STRUCT, datasize, pos);
+
     //
     //   Start writing fiffCoordTransRec
     //
@@ -2509,6 +2697,8 @@ fiff_long_t FiffStream::write_dig_point(const FiffDigPoint& dig)
     *this << (qint32)datasize;
     *this << (qint32)FIFFV_NEXT_SEQ;
 
+    this->add_dir_entry(FIFF_DIG_POINT, FIFFT_DIG_POINT_STRUCT, datasize, pos);
+
     //
     //   Start writing fiffDigPointRec
     //
@@ -2581,7 +2771,7 @@ fiff_long_t FiffStream::write_dir_entries(const QList<FiffDirEntry::SPtr> &dir,
     pos = this->device()->pos();
 
     fiff_int_t nent = dir.size();
-    fiff_int_t datasize = nent * (fiff_int_t)sizeof(FiffDirEntry);
+    fiff_int_t datasize = nent * FiffDirEntry::storageSize();
 
     *this << (qint32)FIFF_DIR;
     *this << (qint32)FIFFT_DIR_ENTRY_STRUCT;
@@ -2615,6 +2805,8 @@ fiff_long_t FiffStream::write_double(fiff_int_t kind, const double* data, fiff_i
     *this << (qint32)datasize;
     *this << (qint32)FIFFV_NEXT_SEQ;
 
+    this->add_dir_entry(kind, FIFFT_DOUBLE, datasize, pos);
+
 //    this->setFloatingPointPrecision(QDataStream::SinglePrecision);
 
     for(qint32 i = 0; i < nel; ++i)
@@ -2628,21 +2820,7 @@ fiff_long_t FiffStream::write_double(fiff_int_t kind, const double* data, fiff_i
 
 fiff_long_t FiffStream::write_float(fiff_int_t kind, const float* data, fiff_int_t nel)
 {
-    fiff_long_t pos = this->device()->pos();
-
-    qint32 datasize = nel * 4;
-
-    *this << (qint32)kind;
-    *this << (qint32)FIFFT_FLOAT;
-    *this << (qint32)datasize;
-    *this << (qint32)FIFFV_NEXT_SEQ;
-
-//    this->setFloatingPointPrecision(QDataStream::SinglePrecision);
-
-    for(qint32 i = 0; i < nel; ++i)
-        *this << data[i];
-
-    return pos;
+    return this->write_tag_words(kind, FIFFT_FLOAT, data, nel);
 }
 
 
@@ -2661,6 +2839,8 @@ fiff_long_t FiffStream::write_float_matrix(fiff_int_t kind, const MatrixXf& mat)
     *this << (qint32)datasize;
     *this << (qint32)FIFFV_NEXT_SEQ;
 
+    this->add_dir_entry(kind, FIFFT_MATRIX_FLOAT, datasize, pos);
+
     qint32 i, j;
     // Storage order: row-major
     for(i = 0; i < mat.rows(); ++i)
@@ -2727,6 +2907,8 @@ fiff_long_t FiffStream::write_float_sparse_ccs(fiff_int_t kind, const SparseMatr
     *this << (qint32)datasize;
     *this << (qint32)FIFFV_NEXT_SEQ;
 
+    this->add_dir_entry(kind, FIFFT_CCS_MATRIX_FLOAT, datasize, pos);
+
     //
     //  The data values
     //
@@ -2823,6 +3005,7 @@ fiff_long_t FiffStream::write_float_sparse_rcs(fiff_int_t kind, const SparseMatr
     *this << (qint32)FIFFT_RCS_MATRIX_FLOAT;
     *this << (qint32)datasize;
     *this << (qint32)FIFFV_NEXT_SEQ;
+    this->add_dir_entry(kind, FIFFT_RCS_MATRIX_FLOAT, datasize, pos);
 
     //
     //  The data values
@@ -2896,6 +3079,8 @@ fiff_long_t FiffStream::write_id(fiff_int_t kind, const FiffId& id)
     *this << (qint32)FIFFT_ID_STRUCT;
     *this << (qint32)datasize;
     *this << (qint32)FIFFV_NEXT_SEQ;
+
+    this->add_dir_entry(kind, FIFFT_ID_STRUCT, datasize, pos);
     //
     // Collect the bits together for one write
     //
@@ -2986,19 +3171,7 @@ fiff_long_t FiffStream::write_info_base(const FiffInfoBase & p_FiffInfoBase)
 
 fiff_long_t FiffStream::write_int(fiff_int_t kind, const fiff_int_t* data, fiff_int_t nel, fiff_int_t next)
 {
-    fiff_long_t pos = this->device()->pos();
-
-    fiff_int_t datasize = nel * 4;
-
-    *this << (qint32)kind;
-    *this << (qint32)FIFFT_INT;
-    *this << (qint32)datasize;
-    *this << (qint32)next;
-
-    for(qint32 i = 0; i < nel; ++i)
-        *this << data[i];
-
-    return pos;
+    return this->write_tag_words(kind, FIFFT_INT, data, nel, next);
 }
 
 
@@ -3020,6 +3193,8 @@ fiff_long_t FiffStream::write_int_matrix(fiff_int_t kind, const MatrixXi& mat)
     *this << (qint32)datasize;
     *this << (qint32)FIFFV_NEXT_SEQ;
 
+    this->add_dir_entry(kind, FIFFT_MATRIX_INT, datasize, pos);
+
     qint32 i, j;
     // Storage order: row-major
     for(i = 0; i < mat.rows(); ++i)
@@ -3113,17 +3288,18 @@ bool FiffStream::write_raw_buffer(const MatrixXd& buf, const RowVectorXd& cals)
         return false;
     }
 
-    typedef Eigen::Triplet<double> T;
-    std::vector<T> tripletList;
-    tripletList.reserve(cals.cols());
-    for(qint32 i = 0; i < cals.cols(); ++i)
-        tripletList.push_back(T(i, i, 1.0/cals[i]));
+    //
+    //   The inverse calibrations are set up by start_writing_raw and only recomputed if other cals are used
+    //
+    if(m_vecCals.cols() != cals.cols() || m_vecCals != cals) {
+        m_vecCals = cals;
+        m_vecInvCals = cals.cwiseInverse();
+    }
 
-    SparseMatrix<double> inv_calsMat(cals.cols(), cals.cols());
-    inv_calsMat.setFromTriplets(tripletList.begin(), tripletList.end());
+    m_matRawBuffer.resize(buf.rows(), buf.cols());
+    m_matRawBuffer.noalias() = (m_vecInvCals.asDiagonal() * buf).cast<float>();
 
-    MatrixXf tmp = (inv_calsMat*buf).cast<float>();
-    this->write_float(FIFF_DATA_BUFFER,tmp.data(),tmp.rows()*tmp.cols());
+    this->write_float(FIFF_DATA_BUFFER,m_matRawBuffer.data(),m_matRawBuffer.rows()*m_matRawBuffer.cols());
     return true;
 }
 
@@ -3152,8 +3328,10 @@ bool FiffStream::write_raw_buffer(const MatrixXd& buf, const SparseMatrix<double
 
 bool FiffStream::write_raw_buffer(const MatrixXd& buf)
 {
-    MatrixXf tmp = buf.cast<float>();
-    this->write_float(FIFF_DATA_BUFFER,tmp.data(),tmp.rows()*tmp.cols());
+    m_matRawBuffer.resize(buf.rows(), buf.cols());
+    m_matRawBuffer.noalias() = buf.cast<float>();
+
+    this->write_float(FIFF_DATA_BUFFER,m_matRawBuffer.data(),m_matRawBuffer.rows()*m_matRawBuffer.cols());
     return true;
 }
 
@@ -3169,6 +3347,7 @@ fiff_long_t FiffStream::write_string(fiff_int_t kind, const QString& data)
     *this << (qint32)FIFFT_STRING;
     *this << (qint32)datasize;
     *this << (qint32)FIFFV_NEXT_SEQ;
+    this->add_dir_entry(kind, FIFFT_STRING, datasize, pos);
 
     this->writeRawData(data.toUtf8().constData(),datasize);
 
@@ -3263,3 +3442,119 @@ bool FiffStream::check_beginning(FiffTag::SPtr &p_pTag)
     //do not rewind since the data is contained in the returned tag; -> done for TCP IP reasosn, no rewind possible there
     return true;
 }
+
+
+//*************************************************************************************************************
+
+void FiffStream::add_dir_entry(fiff_int_t kind, fiff_int_t type, fiff_int_t size, fiff_long_t pos)
+{
+    if(!m_bWriteDir)
+        return;
+
+    FiffDirEntry::SPtr t_pFiffDirEntry(new FiffDirEntry);
+    t_pFiffDirEntry->kind = kind;
+    t_pFiffDirEntry->type = type;
+    t_pFiffDirEntry->size = size;
+    t_pFiffDirEntry->pos = (fiff_int_t)pos;
+    m_writtenDir.append(t_pFiffDirEntry);
+}
+
+
+//*************************************************************************************************************
+
+bool FiffStream::read_dir_cache()
+{
+    QFile* file = qobject_cast<QFile*>(this->device());
+    if(!file)
+        return false;
+
+    QFile t_cacheFile(dir_cache_file_name(file->fileName()));
+    if(!t_cacheFile.open(QIODevice::ReadOnly))
+        return false;
+
+    //
+    //   The cache is only valid for the very file it was created from
+    //
+    QDataStream t_stream(&t_cacheFile);
+    t_stream.setByteOrder(QDataStream::BigEndian);
+
+    qint32 magic, version, nent;
+    qint64 size, modified;
+    FiffId t_id;
+    t_stream >> magic >> version >> size >> modified;
+    t_stream >> t_id.version >> t_id.machid[0] >> t_id.machid[1] >> t_id.time.secs >> t_id.time.usecs;
+    t_stream >> nent;
+
+    if(t_stream.status() != QDataStream::Ok
+            || magic != c_iDirCacheMagic
+            || version != c_iDirCacheVersion
+            || size != file->size()
+            || modified != QFileInfo(*file).lastModified().toMSecsSinceEpoch()
+            || t_id.version != m_id.version
+            || t_id.machid[0] != m_id.machid[0]
+            || t_id.machid[1] != m_id.machid[1]
+            || t_id.time.secs != m_id.time.secs
+            || t_id.time.usecs != m_id.time.usecs
+            || nent <= 0) {
+        return false;
+    }
+
+    //
+    //   Read all entries at once
+    //
+    QByteArray t_data = t_cacheFile.read((qint64)nent * FiffDirEntry::storageSize());
+    if(t_data.size() != nent * FiffDirEntry::storageSize())
+        return false;
+
+    const uchar* t_pData = reinterpret_cast<const uchar*>(t_data.constData());
+    QList<FiffDirEntry::SPtr> dir;
+    dir.reserve(nent);
+    for(qint32 k = 0; k < nent; ++k, t_pData += FiffDirEntry::storageSize()) {
+        FiffDirEntry::SPtr t_pFiffDirEntry(new FiffDirEntry);
+        t_pFiffDirEntry->kind = qFromBigEndian<qint32>(t_pData);
+        t_pFiffDirEntry->type = qFromBigEndian<qint32>(t_pData + 4);
+        t_pFiffDirEntry->size = qFromBigEndian<qint32>(t_pData + 8);
+        t_pFiffDirEntry->pos  = qFromBigEndian<qint32>(t_pData + 12);
+        dir.append(t_pFiffDirEntry);
+    }
+
+    //
+    //   Like make_dir, the directory ends with an empty entry
+    //
+    if(dir.last()->kind != -1)
+        return false;
+
+    m_dir = dir;
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool FiffStream::write_dir_cache() const
+{
+    QFile* file = qobject_cast<QFile*>(this->device());
+    if(!file || m_dir.isEmpty())
+        return false;
+
+    QSaveFile t_cacheFile(dir_cache_file_name(file->fileName()));
+    if(!t_cacheFile.open(QIODevice::WriteOnly))
+        return false;
+
+    QDataStream t_stream(&t_cacheFile);
+    t_stream.setByteOrder(QDataStream::BigEndian);
+
+    t_stream << c_iDirCacheMagic << c_iDirCacheVersion;
+    t_stream << (qint64)file->size() << (qint64)QFileInfo(*file).lastModified().toMSecsSinceEpoch();
+    t_stream << m_id.version << m_id.machid[0] << m_id.machid[1] << m_id.time.secs << m_id.time.usecs;
+    t_stream << (qint32)m_dir.size();
+
+    for(qint32 k = 0; k < m_dir.size(); ++k) {
+        t_stream << (qint32)m_dir[k]->kind;
+        t_stream << (qint32)m_dir[k]->type;
+        t_stream << (qint32)m_dir[k]->size;
+        t_stream << (qint32)m_dir[k]->pos;
+    }
+
+    return t_cacheFile.commit();
+}
@@ -211,6 +211,9 @@ public:
     /**
     * Writes the closing tags to a fif file and closes the file
     * Refactored: fiff_end_file (MNE-C); fiff_end_file (MNE-MATLAB)
+    *
+    * If the file was started with start_file, the directory of all tags written since then is appended as
+    * FIFF_DIR and FIFF_DIR_POINTER is updated to point to it, so that open() does not need to scan the file.
     */
     void end_file();
 
@@ -255,6 +258,35 @@ public:
     */
     bool open(QIODevice::OpenModeFlag mode = QIODevice::ReadOnly);
 
+    //=========================================================================================================
+    /**
+    * Enables or disables the tag directory cache. Files without a directory (FIFF_DIR_POINTER <= 0) have to be
+    * scanned tag by tag by open(). With the cache enabled, open() stores the scanned directory next to the file
+    * (see dir_cache_file_name) and reuses it as long as size, modification time and file id match.
+    * The cache is disabled by default.
+    *
+    * @param[in] enabled    Whether the directory cache is used.
+    */
+    static void set_dir_cache_enabled(bool enabled);
+
+    //=========================================================================================================
+    /**
+    * Returns whether the tag directory cache is enabled, see set_dir_cache_enabled.
+    *
+    * @return true if enabled.
+    */
+    static bool dir_cache_enabled();
+
+    //=========================================================================================================
+    /**
+    * Returns the name of the directory cache of a fif file.
+    *
+    * @param[in] p_sFileName    The fif file.
+    *
+    * @return the name of the directory cache file.
+    */
+    static QString dir_cache_file_name(const QString& p_sFileName);
+
     //=========================================================================================================
     /**
     * Close stream
@@ -522,7 +554,7 @@ public:
     * @param[in] sel            Which channels will be included in the output file (optional)
     * @param[in] resetRange     Flag if the channel range is to be resetted to 1.0f (TODO: The flag was introduced due to conformity to the babyMEG system. See Limin commit from Oct 1st 2014)
     *
-    * @return the started fiff file
+    * @return the started fiff file, an empty pointer if the device could not be opened
     */
     static FiffStream::SPtr start_writing_raw(QIODevice &p_IODevice, const FiffInfo& info, RowVectorXd& cals, MatrixXi sel = defaultMatrixXi, bool resetRange = false);
 
@@ -539,6 +571,21 @@ public:
     */
     fiff_long_t write_tag(const QSharedPointer<FiffTag>& p_pTag, fiff_long_t pos = -1);
 
+    //=========================================================================================================
+    /**
+    * Writes a tag whose data consists of 32 bit words (ints or floats) in one piece. Header and data are
+    * byte-swapped into a reusable staging buffer, which is handed to the device with a single write.
+    *
+    * @param[in] kind       The tag kind
+    * @param[in] type       The tag type, i.e. FIFFT_INT or FIFFT_FLOAT
+    * @param[in] data       The data in host byte order
+    * @param[in] nwords     Number of 32 bit words to write
+    * @param[in] next       Next value (default FIFFV_NEXT_SEQ)
+    *
+    * @return the position where the tag was written to
+    */
+    fiff_long_t write_tag_words(fiff_int_t kind, fiff_int_t type, const void* data, fiff_int_t nwords, fiff_int_t next = FIFFV_NEXT_SEQ);
+
     //=========================================================================================================
     /**
     * Writes a channel information record to a fif file
@@ -890,6 +937,34 @@ private:
     QList<FiffDirEntry::SPtr> make_dir(bool *ok=Q_NULLPTR);
 
 private:
+    //=========================================================================================================
+    /**
+    * Adds a written tag to the directory which is written by end_file. Does nothing if the stream was not
+    * started with start_file.
+    *
+    * @param[in] kind   The tag kind.
+    * @param[in] type   The tag data type.
+    * @param[in] size   The size of the tag data in bytes.
+    * @param[in] pos    The position of the tag.
+    */
+    void add_dir_entry(fiff_int_t kind, fiff_int_t type, fiff_int_t size, fiff_long_t pos);
+
+    //=========================================================================================================
+    /**
+    * Reads the directory of the opened file from its directory cache.
+    *
+    * @return true if a cache matching the file was found and read into m_dir, false otherwise.
+    */
+    bool read_dir_cache();
+
+    //=========================================================================================================
+    /**
+    * Writes m_dir to the directory cache of the opened file. Failing to write the cache is not an error.
+    *
+    * @return true if the cache was written.
+    */
+    bool write_dir_cache() const;
+
 
 //    char         *file_name;    /**< Name of the file */ -> Use streamName() instead
 //    FILE         *fd;           /**< The normal file descriptor */ -> file descitpion is part of the stream: stream->device()
@@ -897,6 +972,14 @@ private:
     QList<FiffDirEntry::SPtr>   m_dir;  /**< This is the directory. If no directory exists, open automatically scans the file to create one. */
 //    int         nent;           /**< How many entries? */ -> Use nent() instead
     FiffDirNode::SPtr           m_dirtree; /**< Directory compiled into a tree */
+
+    Eigen::VectorXi             m_vecTagBuffer;     /**< Aligned staging buffer of write_tag_words, holds the big endian header and data. */
+    Eigen::MatrixXf             m_matRawBuffer;     /**< Calibrated single precision raw buffer, reused by write_raw_buffer. */
+    Eigen::RowVectorXd          m_vecCals;          /**< The calibrations the inverse calibrations were computed for. */
+    Eigen::RowVectorXd          m_vecInvCals;       /**< The inverse calibrations, set by start_writing_raw. */
+    bool                        m_bWriteDir;        /**< Whether written tags are collected and written as FIFF_DIR by end_file, set by start_file. */
+    QList<FiffDirEntry::SPtr>   m_writtenDir;       /**< The tags written since start_file. */
+    fiff_long_t                 m_iDirPointerPos;   /**< Position of the FIFF_DIR_POINTER tag written by start_file. */
 //    char        *ext_file_name; /**< Name of the file holding the external data */
 //    FILE        *ext_fd;        /**< The file descriptor of the above file if open  */
 
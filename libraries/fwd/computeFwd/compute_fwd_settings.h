@@ -145,6 +145,7 @@ public:
     bool scale_eeg_pos = false;     /**< Scale the electrode locations to scalp in the sphere model */
     bool use_equiv_eeg = true;      /**< Use the equivalent source approach for the EEG sphere model */
     bool use_threads = true;        /**< Parallelize? */
+    int nthreads = 0;               /**< Number of threads to use, 0 selects QThread::idealThreadCount() */
 
 private:
     void initMembers();
@@ -44,6 +44,7 @@
 #include <mne/c/mne_surface_old.h>
 #include <mne/c/mne_triangle.h>
 #include <mne/c/mne_source_space_old.h>
+#include <mne/c/mne_ctf_comp_data_set.h>
 
 #include "fwd_comp_data.h"
 #include "fwd_bem_model.h"
@@ -52,9 +53,17 @@
 
 #include <fiff/fiff_stream.h>
 
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QDir>
 #include <QFile>
+#include <QFileInfo>
 #include <QList>
+#include <QStandardPaths>
 #include <QThread>
+#include <QElapsedTimer>
+#include <QAtomicInt>
+#include <QVector>
 #include <QtConcurrent>
 
 #define _USE_MATH_DEFINES
@@ -212,15 +221,53 @@ void fromFloatEigenMatrix_40(const Eigen::MatrixXf& from_mat, float **& to_mat)
 
 
 
+#define LU_SOLVE_BLOCK_40 256     /* Number of right-hand side columns solved at once */
+
+typedef Eigen::Matrix<float,Eigen::Dynamic,Eigen::Dynamic,Eigen::RowMajor> RowMatrixXf_40;
+typedef Eigen::PartialPivLU<Eigen::Ref<RowMatrixXf_40> > InPlaceLU_40;
+
+/*
+ * A block of columns of the identity to be solved for
+ */
+typedef struct {
+    const InPlaceLU_40  *lu;        /* The factorization */
+    int                 start;      /* First column */
+    int                 n;          /* Number of columns */
+    Eigen::MatrixXf     *inv;       /* Output: the inverse */
+} luSolveBlock_40;
+
+
+static void lu_solve_block_40(luSolveBlock_40& job)
+{
+    int dim = job.inv->rows();
+    job.inv->middleCols(job.start,job.n) = job.lu->solve(Eigen::MatrixXf::Identity(dim,dim).middleCols(job.start,job.n));
+}
+
+
 float **mne_lu_invert_40(float **mat,int dim)
 /*
-      * Invert a matrix using the LU decomposition from
-      * LAPACK
+      * Invert a matrix using the LU decomposition
+      * The blocked factorization works in place in the (contiguous) matrix storage,
+      * the columns of the inverse are then obtained by parallel triangular solves
       */
 {
-    Eigen::MatrixXf eigen_mat = toFloatEigenMatrix_40(mat, dim, dim);
-    Eigen::MatrixXf eigen_mat_inv = eigen_mat.inverse();
-    fromFloatEigenMatrix_40(eigen_mat_inv, mat);
+    Eigen::Map<RowMatrixXf_40> eigen_mat(mat[0],dim,dim);
+    InPlaceLU_40 lu(eigen_mat);
+    Eigen::MatrixXf eigen_mat_inv(dim,dim);
+    QList<luSolveBlock_40> blocks;
+    int k;
+
+    for (k = 0; k < dim; k += LU_SOLVE_BLOCK_40) {
+        luSolveBlock_40 job;
+        job.lu    = &lu;
+        job.start = k;
+        job.n     = qMin(LU_SOLVE_BLOCK_40,dim-k);
+        job.inv   = &eigen_mat_inv;
+        blocks.append(job);
+    }
+    QtConcurrent::blockingMap(blocks, lu_solve_block_40);
+
+    eigen_mat = eigen_mat_inv;
     return mat;
 }
 
@@ -317,17 +364,12 @@ float **mne_mat_mat_mult_40 (float **m1,float **m2,int d1,int d2,int d3)
            &one,m2[0],&d3,m1[0],&d2,&zero,result[0],&d3);
     return (result);
 #else
+    /*
+     * Work directly on the contiguous storage of the matrices
+     */
     float **result = ALLOC_CMATRIX_40(d1,d3);
-    int j,k,p;
-    float sum;
-
-    for (j = 0; j < d1; j++)
-        for (k = 0; k < d3; k++) {
-            sum = 0.0;
-            for (p = 0; p < d2; p++)
-                sum = sum + m1[j][p]*m2[p][k];
-            result[j][k] = sum;
-        }
+    Eigen::Map<RowMatrixXf_40>(result[0],d1,d3).noalias() =
+            Eigen::Map<const RowMatrixXf_40>(m1[0],d1,d2)*Eigen::Map<const RowMatrixXf_40>(m2[0],d2,d3);
     return (result);
 #endif
 }
@@ -354,6 +396,8 @@ static struct {
 
 #define BEM_SUFFIX     "-bem.fif"
 #define BEM_SOL_SUFFIX "-bem-sol.fif"
+#define BEM_SOL_CACHE_ENV "MNE_BEM_SOL_CACHE"
+#define BEM_SOL_CACHE_VERSION 1     /* Increase whenever the computed solution or its file layout changes */
 
 
 
@@ -442,7 +486,6 @@ FwdBemModel::FwdBemModel()
 ,solution   (NULL)
 ,nsol       (0)
 ,head_mri_t (NULL)
-,v0         (NULL)
 ,use_ip_approach(false)
 ,ip_approach_limit(FWD_BEM_IP_APPROACH_LIMIT)
 {
@@ -474,7 +517,6 @@ void FwdBemModel::fwd_bem_free_solution()
 {
     FREE_CMATRIX_40(this->solution); this->solution = NULL;
     this->sol_name.clear();
-    FREE_40(this->v0); this->v0 = NULL;
     this->bem_method = FWD_BEM_UNKNOWN;
     this->nsol       = 0;
 
@@ -499,6 +541,127 @@ QString FwdBemModel::fwd_bem_make_bem_sol_name(const QString& name)
 }
 
 
+//*************************************************************************************************************
+
+QString FwdBemModel::fwd_bem_solution_hash(FwdBemModel *m, int bem_method)
+/*
+    * Hash everything the potential solution depends on:
+    * the surface geometry, the conductivities and the approximation method
+    */
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    MneSurfaceOld* surf;
+    int version = BEM_SOL_CACHE_VERSION;
+    int k,j;
+
+    hash.addData((const char*)&version,sizeof(int));
+    hash.addData((const char*)&bem_method,sizeof(int));
+    hash.addData((const char*)&m->nsurf,sizeof(int));
+    hash.addData((const char*)&m->ip_approach_limit,sizeof(float));
+    for (k = 0; k < m->nsurf; k++) {
+        surf = m->surfs[k];
+        hash.addData((const char*)&surf->id,sizeof(int));
+        hash.addData((const char*)&surf->np,sizeof(int));
+        hash.addData((const char*)&surf->ntri,sizeof(int));
+        hash.addData((const char*)&m->sigma[k],sizeof(float));
+        for (j = 0; j < surf->np; j++)
+            hash.addData((const char*)surf->rr[j],3*sizeof(float));
+        for (j = 0; j < surf->ntri; j++)
+            hash.addData((const char*)surf->itris[j],3*sizeof(int));
+    }
+    return QString(hash.result().toHex());
+}
+
+
+//*************************************************************************************************************
+
+QString FwdBemModel::fwd_bem_cache_sol_name(FwdBemModel *m, int bem_method)
+/*
+    * The solution cache is only used if $MNE_BEM_SOL_CACHE is set
+    * It names the cache directory, "default" selects mne-cpp/bem-sol in the user's cache directory
+    */
+{
+    QString dir = QString::fromLocal8Bit(qgetenv(BEM_SOL_CACHE_ENV));
+
+    if (dir.isEmpty())
+        return QString();
+    if (dir == "default") {
+        dir = QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation);
+        if (dir.isEmpty())
+            return QString();
+        dir = dir + "/mne-cpp/bem-sol";
+    }
+    return QString("%1/%2%3").arg(dir).arg(fwd_bem_solution_hash(m,bem_method)).arg(BEM_SOL_SUFFIX);
+}
+
+
+//*************************************************************************************************************
+
+int FwdBemModel::fwd_bem_write_solution(const QString &name, FwdBemModel *m)
+/*
+    * Write the potential solution matrix in the format read by fwd_bem_load_solution
+    * The file is first written under a temporary name so that concurrent readers never see a partial solution
+    */
+{
+    QString tmp_name = QString("%1.%2.tmp").arg(name).arg(QCoreApplication::applicationPid());
+    QFile file(tmp_name);
+    FiffStream::SPtr stream;
+    fiff_int_t approx;
+    qint32 dims[3];
+    int j,k;
+
+    if (!m || !m->solution || m->nsol <= 0) {
+        qCritical("No solution to write in fwd_bem_write_solution");
+        return FAIL;
+    }
+    if (m->bem_method == FWD_BEM_CONSTANT_COLL)
+        approx = FIFFV_BEM_APPROX_CONST;
+    else if (m->bem_method == FWD_BEM_LINEAR_COLL)
+        approx = FIFFV_BEM_APPROX_LINEAR;
+    else {
+        qCritical("Unknown BEM method : %d",m->bem_method);
+        return FAIL;
+    }
+    if (!QDir().mkpath(QFileInfo(name).absolutePath()))
+        return FAIL;
+    if (!(stream = FiffStream::start_file(file)))
+        return FAIL;
+
+    stream->start_block(FIFFB_BEM);
+    stream->write_int(FIFF_BEM_APPROX,&approx);
+    /*
+     * The matrix is streamed straight from the solution storage to avoid a copy of this large matrix,
+     * this is the layout of FiffStream::write_float_matrix for the transpose read back by fwd_bem_load_solution
+     */
+    *stream << (qint32)FIFF_BEM_POT_SOLUTION;
+    *stream << (qint32)FIFFT_MATRIX_FLOAT;
+    *stream << (qint32)(4*m->nsol*m->nsol + 4*3);
+    *stream << (qint32)FIFFV_NEXT_SEQ;
+    for (j = 0; j < m->nsol; j++)
+        for (k = 0; k < m->nsol; k++)
+            *stream << m->solution[j][k];
+    dims[0] = m->nsol;
+    dims[1] = m->nsol;
+    dims[2] = 2;
+    for (k = 0; k < 3; k++)
+        *stream << dims[k];
+    stream->end_block(FIFFB_BEM);
+    stream->end_file();
+    file.close();
+
+    if (stream->status() != QDataStream::Ok) {
+        QFile::remove(tmp_name);
+        return FAIL;
+    }
+    QFile::remove(name);
+    if (!QFile::rename(tmp_name,name)) {
+        QFile::remove(tmp_name);
+        return FAIL;
+    }
+    return OK;
+}
+
+
 //*************************************************************************************************************
 
 const QString& FwdBemModel::fwd_bem_explain_surface(int kind)
@@ -878,6 +1041,242 @@ out : {
 }
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// Parallel assembly of the BEM coefficient matrices
+//=============================================================================================================
+
+#define BEM_TRI_BLOCK_40 128    /* Number of triangles processed at once by the vectorized kernels */
+
+typedef Array<double,Dynamic,1,ColMajor,BEM_TRI_BLOCK_40,1> TriBlockArray_40;
+
+/*
+ * Structure-of-arrays copy of the triangles of one surface
+ */
+typedef struct {
+    int     ntri;               /* Number of triangles */
+    ArrayXf r1[3],r2[3],r3[3];  /* Corner locations */
+    ArrayXd nn[3];              /* Normal vectors */
+    ArrayXd area;               /* Areas */
+    ArrayXi vert[3];            /* Corner vertex indices */
+} bemTriangleSoA_40;
+
+/*
+ * One row of the linear collocation coefficient matrix
+ */
+typedef struct {
+    float                   *from;      /* The collocation point */
+    int                     node;       /* Index of the collocation point on the destination surface, -1 if it lies on another surface */
+    const bemTriangleSoA_40 *tris;      /* The destination triangles */
+    int                     np;         /* Number of nodes on the destination surface */
+    float                   *row;       /* Output: the matrix row */
+} linPotCoeffRow_40;
+
+/*
+ * One row (coil) of the field coefficient matrices
+ */
+typedef struct {
+    FwdBemModel                 *m;     /* The model */
+    FwdCoil                     *coil;  /* The coil */
+    FwdBemModel::linFieldIntFunc func;  /* Integration formula for the linear collocation, NULL for constant collocation */
+    float                       *row;   /* Output: the matrix row */
+} fieldCoeffRow_40;
+
+
+static void make_triangle_soa_40(MneSurfaceOld* surf, bemTriangleSoA_40& soa)
+{
+    MneTriangle* tri;
+    int k,c;
+
+    soa.ntri = surf->ntri;
+    for (c = 0; c < 3; c++) {
+        soa.r1[c].resize(soa.ntri);
+        soa.r2[c].resize(soa.ntri);
+        soa.r3[c].resize(soa.ntri);
+        soa.nn[c].resize(soa.ntri);
+        soa.vert[c].resize(soa.ntri);
+    }
+    soa.area.resize(soa.ntri);
+
+    for (k = 0, tri = surf->tris; k < soa.ntri; k++, tri++) {
+        for (c = 0; c < 3; c++) {
+            soa.r1[c][k]   = tri->r1[c];
+            soa.r2[c][k]   = tri->r2[c];
+            soa.r3[c][k]   = tri->r3[c];
+            soa.nn[c][k]   = tri->nn[c];
+            soa.vert[c][k] = tri->vert[c];
+        }
+        soa.area[k] = tri->area;
+    }
+}
+
+
+/*
+ * Vectorized version of calc_beta for a block of triangles
+ */
+static TriBlockArray_40 calc_beta_block_40(const TriBlockArray_40 rk[3], const TriBlockArray_40& lk,
+                                           const TriBlockArray_40 rk1[3], const TriBlockArray_40& lk1)
+{
+    TriBlockArray_40 rkk1[3];
+    TriBlockArray_40 size;
+
+    for (int c = 0; c < 3; c++)
+        rkk1[c] = rk1[c] - rk[c];
+    size = (rkk1[X_40]*rkk1[X_40] + rkk1[Y_40]*rkk1[Y_40] + rkk1[Z_40]*rkk1[Z_40]).sqrt();
+
+    return ((lk*size + (rk[X_40]*rkk1[X_40] + rk[Y_40]*rkk1[Y_40] + rk[Z_40]*rkk1[Z_40]))/
+            (lk1*size + (rk1[X_40]*rkk1[X_40] + rk1[Y_40]*rkk1[Y_40] + rk1[Z_40]*rkk1[Z_40]))).log()/size;
+}
+
+
+/*
+ * Vectorized version of FwdBemModel::lin_pot_coeff for the triangles start ... start+n-1
+ */
+static void lin_pot_coeff_block_40(const float *from, const bemTriangleSoA_40& t, int start, int n, TriBlockArray_40 omega[3])
+{
+    static const double solid_eps = 4.0*M_PI/1.0E6;
+    TriBlockArray_40 y1[3],y2[3],y3[3];
+    TriBlockArray_40 l1,l2,l3,triple,ss,solid;
+    TriBlockArray_40 beta[3],bbeta[3],vec_omega[3];
+    TriBlockArray_40 area2,n2,zn,dn;
+    const TriBlockArray_40 *yy[5];
+    int c,k;
+
+    for (c = 0; c < 3; c++) {
+        y1[c] = (t.r1[c].segment(start,n) - from[c]).cast<double>();
+        y2[c] = (t.r2[c].segment(start,n) - from[c]).cast<double>();
+        y3[c] = (t.r3[c].segment(start,n) - from[c]).cast<double>();
+    }
+    /*
+     * The standard solid angle computation
+     */
+    triple = (y1[Y_40]*y2[Z_40]-y2[Y_40]*y1[Z_40])*y3[X_40] +
+             (-(y1[X_40]*y2[Z_40]-y2[X_40]*y1[Z_40]))*y3[Y_40] +
+             (y1[X_40]*y2[Y_40]-y2[X_40]*y1[Y_40])*y3[Z_40];
+
+    l1 = (y1[X_40]*y1[X_40] + y1[Y_40]*y1[Y_40] + y1[Z_40]*y1[Z_40]).sqrt();
+    l2 = (y2[X_40]*y2[X_40] + y2[Y_40]*y2[Y_40] + y2[Z_40]*y2[Z_40]).sqrt();
+    l3 = (y3[X_40]*y3[X_40] + y3[Y_40]*y3[Y_40] + y3[Z_40]*y3[Z_40]).sqrt();
+    ss = (l1*l2*l3 +
+          (y1[X_40]*y2[X_40] + y1[Y_40]*y2[Y_40] + y1[Z_40]*y2[Z_40])*l3 +
+          (y1[X_40]*y3[X_40] + y1[Y_40]*y3[Y_40] + y1[Z_40]*y3[Z_40])*l2 +
+          (y2[X_40]*y3[X_40] + y2[Y_40]*y3[Y_40] + y2[Z_40]*y3[Z_40])*l1);
+    solid.resize(n);
+    for (k = 0; k < n; k++)
+        solid[k] = 2.0*atan2(triple[k],ss[k]);
+    /*
+     * Calculate the magic vector vec_omega
+     */
+    beta[0] = calc_beta_block_40(y1,l1,y2,l2);
+    beta[1] = calc_beta_block_40(y2,l2,y3,l3);
+    beta[2] = calc_beta_block_40(y3,l3,y1,l1);
+    bbeta[0] = beta[2] - beta[0];
+    bbeta[1] = beta[0] - beta[1];
+    bbeta[2] = beta[1] - beta[2];
+
+    for (c = 0; c < 3; c++)
+        vec_omega[c] = bbeta[0]*y1[c] + bbeta[1]*y2[c] + bbeta[2]*y3[c];
+    /*
+     * Put it all together...
+     */
+    area2 = 2.0*t.area.segment(start,n);
+    n2 = 1.0/(area2*area2);
+
+    yy[0] = y3;
+    yy[1] = y1;
+    yy[2] = y2;
+    yy[3] = y3;
+    yy[4] = y1;
+    for (k = 0; k < 3; k++) {
+        const TriBlockArray_40 *a = yy[k+2];
+        const TriBlockArray_40 *b = yy[k];
+        zn = (a[Y_40]*b[Z_40]-b[Y_40]*a[Z_40])*t.nn[X_40].segment(start,n) +
+             (-(a[X_40]*b[Z_40]-b[X_40]*a[Z_40]))*t.nn[Y_40].segment(start,n) +
+             (a[X_40]*b[Y_40]-b[X_40]*a[Y_40])*t.nn[Z_40].segment(start,n);
+        dn = (b[X_40]-a[X_40])*vec_omega[X_40] + (b[Y_40]-a[Y_40])*vec_omega[Y_40] + (b[Z_40]-a[Z_40])*vec_omega[Z_40];
+        omega[k] = (solid.abs() < solid_eps).select(0.0, n2*(-area2*zn*solid + triple*dn));
+    }
+}
+
+
+static void lin_pot_coeff_row_40(linPotCoeffRow_40& job)
+{
+    const bemTriangleSoA_40& t = *job.tris;
+    VectorXd row = VectorXd::Zero(job.np);
+    TriBlockArray_40 omega[3];
+    int start,n,k,c,tk;
+
+    for (start = 0; start < t.ntri; start += BEM_TRI_BLOCK_40) {
+        n = std::min(BEM_TRI_BLOCK_40,t.ntri-start);
+        lin_pot_coeff_block_40(job.from,t,start,n,omega);
+        for (k = 0; k < n; k++) {
+            tk = start+k;
+            /*
+             * No contribution from a triangle that this vertex belongs to
+             */
+            if (job.node >= 0 && (t.vert[0][tk] == job.node || t.vert[1][tk] == job.node || t.vert[2][tk] == job.node))
+                continue;
+            for (c = 0; c < 3; c++)
+                row[t.vert[c][tk]] = row[t.vert[c][tk]] - omega[c][k];
+        }
+    }
+    for (k = 0; k < job.np; k++)
+        job.row[k] = row[k];
+}
+
+
+static void field_coeff_row_40(fieldCoeffRow_40& job)
+{
+    FwdBemModel* m = job.m;
+    FwdCoil* coil  = job.coil;
+    MneSurfaceOld* surf;
+    MneTriangle* tri;
+    double res[3],one[3];
+    double mult;
+    int    s,k,p,pp,off;
+
+    if (job.func == NULL) {
+        /*
+         * Constant collocation: one coefficient per triangle
+         */
+        for (s = 0, off = 0; s < m->nsurf; s++) {
+            surf = m->surfs[s];
+            mult = m->field_mult[s];
+            for (k = 0, tri = surf->tris; k < surf->ntri; k++, tri++) {
+                res[0] = 0.0;
+                for (p = 0; p < coil->np; p++)
+                    res[0] = res[0] + coil->w[p]*FwdBemModel::one_field_coeff(coil->rmag[p],coil->cosmag[p],tri);
+                job.row[k+off] = mult*res[0];
+            }
+            off = off + surf->ntri;
+        }
+    }
+    else {
+        /*
+         * Linear collocation: accumulate the coefficients for each triangle node
+         */
+        for (k = 0; k < m->nsol; k++)
+            job.row[k] = 0.0;
+        for (s = 0, off = 0; s < m->nsurf; s++) {
+            surf = m->surfs[s];
+            mult = m->field_mult[s];
+            for (k = 0, tri = surf->tris; k < surf->ntri; k++, tri++) {
+                for (pp = 0; pp < 3; pp++)
+                    res[pp] = 0;
+                for (p = 0; p < coil->np; p++) {
+                    job.func(coil->rmag[p],coil->cosmag[p],tri,one);
+                    for (pp = 0; pp < 3; pp++)
+                        res[pp] = res[pp] + coil->w[p]*one[pp];
+                }
+                for (pp = 0; pp < 3; pp++)
+                    job.row[tri->vert[pp]+off] = job.row[tri->vert[pp]+off] + mult*res[pp];
+            }
+            off = off + surf->np;
+        }
+    }
+}
+
+
 //*************************************************************************************************************
 
 double FwdBemModel::calc_beta(double *rk, double *rk1)
@@ -1014,7 +1413,6 @@ void FwdBemModel::correct_auto_elements(MneSurfaceOld *surf, float **mat)
     float *row;
     float sum,miss;
     int   nnode = surf->np;
-    int   ntri  = surf->ntri;
     int   nmemb;
     int   j,k;
     float pi2 = 2.0*M_PI;
@@ -1049,7 +1447,8 @@ void FwdBemModel::correct_auto_elements(MneSurfaceOld *surf, float **mat)
          * The rest is divided evenly among the member nodes...
          */
         miss = miss/(4.0*nmemb);
-        for (k = 0,tri = surf->tris; k < ntri; k++,tri++) {
+        for (k = 0; k < nmemb; k++) {
+            tri = surf->tris + surf->neighbor_tri[j][k];
             if (tri->vert[0] == j) {
                 row[tri->vert[1]] = row[tri->vert[1]] + miss;
                 row[tri->vert[2]] = row[tri->vert[2]] + miss;
@@ -1081,31 +1480,34 @@ void FwdBemModel::correct_auto_elements(MneSurfaceOld *surf, float **mat)
 float **FwdBemModel::fwd_bem_lin_pot_coeff(const QList<MneSurfaceOld*>& surfs)
 /*
 * Calculate the coefficients for linear collocation approach
+*
+* The rows of each sub-block are computed in parallel. The triangles are
+* processed in blocks by a vectorized kernel working on a structure-of-arrays copy.
 */
 {
     float **mat = NULL;
     float **sub_mat = NULL;
-    int   np1,np2,ntri,np_tot,np_max;
+    int   np1,np2,np_tot,np_max;
     float **nodes;
-    MneTriangle*   tri;
-    double omega[3];
-    double *row = NULL;
-    int    j,k,p,q,c;
+    int    j,k,p,q;
     int    joff,koff;
     MneSurfaceOld* surf1;
     MneSurfaceOld* surf2;
+    QVector<bemTriangleSoA_40> tris(surfs.size());
+    QVector<linPotCoeffRow_40> rows;
+    QElapsedTimer timer;
 
     for (p = 0, np_tot = np_max = 0; p < surfs.size(); p++) {
         np_tot += surfs[p]->np;
         if (surfs[p]->np > np_max)
             np_max = surfs[p]->np;
+        make_triangle_soa_40(surfs[p],tris[p]);
     }
 
     mat = ALLOC_CMATRIX_40(np_tot,np_tot);
     for (j = 0; j < np_tot; j++)
         for (k = 0; k < np_tot; k++)
             mat[j][k] = 0.0;
-    row        = MALLOC_40(np_max,double);
     sub_mat = MALLOC_40(np_max,float *);
     for (p = 0, joff = 0; p < surfs.size(); p++, joff = joff + np1) {
         surf1 = surfs[p];
@@ -1114,41 +1516,30 @@ float **FwdBemModel::fwd_bem_lin_pot_coeff(const QList<MneSurfaceOld*>& surfs)
         for (q = 0, koff = 0; q < surfs.size(); q++, koff = koff + np2) {
             surf2 = surfs[q];
             np2   = surf2->np;
-            ntri  = surf2->ntri;
 
             fprintf(stderr,"\t\t%s (%d) -> %s (%d) ... ",
                     fwd_bem_explain_surface(surf1->id).toUtf8().constData(),np1,
                     fwd_bem_explain_surface(surf2->id).toUtf8().constData(),np2);
+            timer.start();
 
+            rows.resize(np1);
             for (j = 0; j < np1; j++) {
-                for (k = 0; k < np2; k++)
-                    row[k] = 0.0;
-                for (k = 0, tri = surf2->tris; k < ntri; k++,tri++) {
-                    /*
-               * No contribution from a triangle that
-               * this vertex belongs to
-               */
-                    if (p == q && (tri->vert[0] == j || tri->vert[1] == j || tri->vert[2] == j))
-                        continue;
-                    /*
-               * Otherwise do the hard job
-               */
-                    lin_pot_coeff (nodes[j],tri,omega);
-                    for (c = 0; c < 3; c++)
-                        row[tri->vert[c]] = row[tri->vert[c]] - omega[c];
-                }
-                for (k = 0; k < np2; k++)
-                    mat[j+joff][k+koff] = row[k];
+                rows[j].from = nodes[j];
+                rows[j].node = (p == q) ? j : -1;
+                rows[j].tris = &tris[q];
+                rows[j].np   = np2;
+                rows[j].row  = mat[j+joff]+koff;
             }
+            QtConcurrent::blockingMap(rows, lin_pot_coeff_row_40);
+
             if (p == q) {
                 for (j = 0; j < np1; j++)
                     sub_mat[j] = mat[j+joff]+koff;
                 correct_auto_elements (surf1,sub_mat);
             }
-            fprintf(stderr,"[done]\n");
+            fprintf(stderr,"[done] (%.2f s)\n",timer.elapsed()/1000.0);
         }
     }
-    FREE_40(row);
     FREE_40(sub_mat);
     return(mat);
 }
@@ -1537,6 +1928,7 @@ int FwdBemModel::fwd_bem_load_recompute_solution(const QString& name, int bem_me
 */
 {
     int solres;
+    QString cache_name;
 
     if (!m) {
         printf ("No model specified for fwd_bem_load_recompute_solution");
@@ -1560,7 +1952,27 @@ int FwdBemModel::fwd_bem_load_recompute_solution(const QString& name, int bem_me
     }
     if (bem_method == FWD_BEM_UNKNOWN)
         bem_method = FWD_BEM_LINEAR_COLL;
-    return fwd_bem_compute_solution(m,bem_method);
+    /*
+     * A solution for the same geometry, conductivities and method may have been computed before
+     */
+    cache_name = fwd_bem_cache_sol_name(m,bem_method);
+    if (!force_recompute && !cache_name.isEmpty() && QFile::exists(cache_name)) {
+        solres = fwd_bem_load_solution(cache_name,bem_method,m);
+        if (solres == TRUE) {
+            fprintf(stderr,"\nLoaded cached %s BEM solution from %s\n",fwd_bem_explain_method(m->bem_method).toUtf8().constData(),cache_name.toUtf8().constData());
+            return OK;
+        }
+        fprintf(stderr,"Ignoring the unusable cached BEM solution %s\n",cache_name.toUtf8().constData());
+    }
+    if (fwd_bem_compute_solution(m,bem_method) == FAIL)
+        return FAIL;
+    if (!cache_name.isEmpty()) {
+        if (fwd_bem_write_solution(cache_name,m) == OK)
+            fprintf(stderr,"BEM solution cached in %s\n",cache_name.toUtf8().constData());
+        else
+            fprintf(stderr,"Could not cache the BEM solution in %s\n",cache_name.toUtf8().constData());
+    }
+    return OK;
 }
 
 
@@ -1716,9 +2128,8 @@ void FwdBemModel::fwd_bem_pot_grad_calc(float *rd, float *Q, FwdBemModel* m, Fwd
     grads[1] = ygrad;
     grads[2] = zgrad;
 
-    if (!m->v0)
-        m->v0 = MALLOC_40(m->nsol,float);
-    v0 = m->v0;
+    VectorXf v0_work(m->nsol);
+    v0 = v0_work.data();
 
     VEC_COPY_40(mri_rd,rd);
     VEC_COPY_40(mri_Q,Q);
@@ -1773,9 +2184,8 @@ void FwdBemModel::fwd_bem_lin_pot_calc(float *rd, float *Q, FwdBemModel *m, FwdC
     float *v0;
     float **solution;
 
-    if (!m->v0)
-        m->v0 = MALLOC_40(m->nsol,float);
-    v0 = m->v0;
+    VectorXf v0_work(m->nsol);
+    v0 = v0_work.data();
 
     VEC_COPY_40(mri_rd,rd);
     VEC_COPY_40(mri_Q,Q);
@@ -1828,9 +2238,8 @@ void FwdBemModel::fwd_bem_lin_pot_grad_calc(float *rd, float *Q, FwdBemModel *m,
     grads[1] = ygrad;
     grads[2] = zgrad;
 
-    if (!m->v0)
-        m->v0 = MALLOC_40(m->nsol,float);
-    v0 = m->v0;
+    VectorXf v0_work(m->nsol);
+    v0 = v0_work.data();
 
     VEC_COPY_40(mri_rd,rd);
     VEC_COPY_40(mri_Q,Q);
@@ -1884,9 +2293,8 @@ void FwdBemModel::fwd_bem_pot_calc(float *rd, float *Q, FwdBemModel *m, FwdCoilS
     float       **solution;
     float       mri_rd[3],mri_Q[3];
 
-    if (!m->v0)
-        m->v0 = MALLOC_40(m->nsol,float);
-    v0 = m->v0;
+    VectorXf v0_work(m->nsol);
+    v0 = v0_work.data();
 
     VEC_COPY_40(mri_rd,rd);
     VEC_COPY_40(mri_Q,Q);
@@ -2196,15 +2604,10 @@ float **FwdBemModel::fwd_bem_field_coeff(FwdBemModel *m, FwdCoilSet *coils)	/* G
      * Compute the weighting factors to obtain the magnetic field
      */
 {
-    MneSurfaceOld*     surf;
-    MneTriangle*    tri;
-    FwdCoil*        coil;
     FwdCoilSet*     tcoils = NULL;
-    int            ntri;
     float          **coeff = NULL;
-    int            j,k,p,s,off;
-    double         res;
-    double         mult;
+    int            j;
+    QVector<fieldCoeffRow_40> rows;
 
     if (m->solution == NULL) {
         printf("Solution matrix missing in fwd_bem_field_coeff");
@@ -2238,26 +2641,19 @@ float **FwdBemModel::fwd_bem_field_coeff(FwdBemModel *m, FwdCoilSet *coils)	/* G
             return NULL;
         }
     }
-    ntri  = m->nsol;
-    coeff = ALLOC_CMATRIX_40(coils->ncoil,ntri);
-
-    for (s = 0, off = 0; s < m->nsurf; s++) {
-        surf = m->surfs[s];
-        ntri = surf->ntri;
-        tri  = surf->tris;
-        mult = m->field_mult[s];
-
-        for (k = 0; k < ntri; k++,tri++) {
-            for (j = 0; j < coils->ncoil; j++) {
-                coil = coils->coils[j];
-                res = 0.0;
-                for (p = 0; p < coil->np; p++)
-                    res = res + coil->w[p]*one_field_coeff(coil->rmag[p],coil->cosmag[p],tri);
-                coeff[j][k+off] = mult*res;
-            }
-        }
-        off = off + ntri;
+    coeff = ALLOC_CMATRIX_40(coils->ncoil,m->nsol);
+    /*
+     * Compute the rows (coils) in parallel
+     */
+    rows.resize(coils->ncoil);
+    for (j = 0; j < coils->ncoil; j++) {
+        rows[j].m    = m;
+        rows[j].coil = coils->coils[j];
+        rows[j].func = NULL;
+        rows[j].row  = coeff[j];
     }
+    QtConcurrent::blockingMap(rows, field_coeff_row_40);
+
     delete tcoils;
     return coeff;
 }
@@ -2419,16 +2815,11 @@ float **FwdBemModel::fwd_bem_lin_field_coeff(FwdBemModel *m, FwdCoilSet *coils,
           * in the linear potential approximation
           */
 {
-    MneSurfaceOld*  surf;
-    MneTriangle* tri;
-    FwdCoil*     coil;
     FwdCoilSet*  tcoils = NULL;
-    int         ntri;
     float       **coeff  = NULL;
-    int         j,k,p,pp,off,s;
-    double      res[3],one[3];
-    float       mult;
+    int         j;
     linFieldIntFunc func;
+    QVector<fieldCoeffRow_40> rows;
 
     if (m->solution == NULL) {
         printf("Solution matrix missing in fwd_bem_lin_field_coeff");
@@ -2470,41 +2861,18 @@ float **FwdBemModel::fwd_bem_lin_field_coeff(FwdBemModel *m, FwdCoilSet *coils,
         func = fwd_bem_one_lin_field_coeff_simple;
 
     coeff = ALLOC_CMATRIX_40(coils->ncoil,m->nsol);
-    for (k = 0; k < m->nsol; k++)
-        for (j = 0; j < coils->ncoil; j++)
-            coeff[j][k] = 0.0;
     /*
-       * Process each of the surfaces
+       * Compute the rows (coils) in parallel, each row accumulates the
+       * contributions of all triangles of all surfaces
        */
-    for (s = 0, off = 0; s < m->nsurf; s++) {
-        surf = m->surfs[s];
-        ntri = surf->ntri;
-        tri  = surf->tris;
-        mult = m->field_mult[s];
-
-        for (k = 0; k < ntri; k++,tri++) {
-            for (j = 0; j < coils->ncoil; j++) {
-                coil = coils->coils[j];
-                for (pp = 0; pp < 3; pp++)
-                    res[pp] = 0;
-                /*
-             * Accumulate the coefficients for each triangle node...
-             */
-                for (p = 0; p < coil->np; p++) {
-                    func(coil->rmag[p],coil->cosmag[p],tri,one);
-                    for (pp = 0; pp < 3; pp++)
-                        res[pp] = res[pp] + coil->w[p]*one[pp];
-                }
-                /*
-             * Add these to the corresponding coefficient matrix
-             * elements...
-             */
-                for (pp = 0; pp < 3; pp++)
-                    coeff[j][tri->vert[pp]+off] = coeff[j][tri->vert[pp]+off] + mult*res[pp];
-            }
-        }
-        off = off + surf->np;
+    rows.resize(coils->ncoil);
+    for (j = 0; j < coils->ncoil; j++) {
+        rows[j].m    = m;
+        rows[j].coil = coils->coils[j];
+        rows[j].func = func;
+        rows[j].row  = coeff[j];
     }
+    QtConcurrent::blockingMap(rows, field_coeff_row_40);
     /*
        * Discard the duplicate
        */
@@ -2548,7 +2916,7 @@ int FwdBemModel::fwd_bem_specify_coils(FwdBemModel *m, FwdCoilSet *coils)
 
     csol->ncoil     = coils->ncoil;
     csol->np        = m->nsol;
-    csol->solution  = mne_mat_mat_mult_40(sol,m->solution,coils->ncoil,m->nsol,m->nsol);//TODO: Suspicion, that this is slow - use Eigen
+    csol->solution  = mne_mat_mat_mult_40(sol,m->solution,coils->ncoil,m->nsol,m->nsol);
 
     FREE_CMATRIX_40(sol);
     return OK;
@@ -2578,9 +2946,8 @@ void FwdBemModel::fwd_bem_lin_field_calc(float *rd, float *Q, FwdCoilSet *coils,
     /*
        * Infinite-medium potentials
        */
-    if (!m->v0)
-        m->v0 = MALLOC_40(m->nsol,float);
-    v0 = m->v0;
+    VectorXf v0_work(m->nsol);
+    v0 = v0_work.data();
     /*
        * The dipole location and orientation must be transformed
        */
@@ -2641,9 +3008,8 @@ void FwdBemModel::fwd_bem_field_calc(float *rd, float *Q, FwdCoilSet *coils, Fwd
     /*
        * Infinite-medium potentials
        */
-    if (!m->v0)
-        m->v0 = MALLOC_40(m->nsol,float);
-    v0 = m->v0;
+    VectorXf v0_work(m->nsol);
+    v0 = v0_work.data();
     /*
        * The dipole location and orientation must be transformed
        */
@@ -2709,9 +3075,8 @@ void FwdBemModel::fwd_bem_field_grad_calc(float *rd, float *Q, FwdCoilSet* coils
     /*
        * Infinite-medium potentials
        */
-    if (!m->v0)
-        m->v0 = MALLOC_40(m->nsol,float);
-    v0 = m->v0;
+    VectorXf v0_work(m->nsol);
+    v0 = v0_work.data();
     /*
        * The dipole location and orientation must be transformed
        */
@@ -2834,9 +3199,8 @@ void FwdBemModel::fwd_bem_lin_field_grad_calc(float *rd, float *Q, FwdCoilSet *c
     /*
        * Space for infinite-medium potentials
        */
-    if (!m->v0)
-        m->v0 = MALLOC_40(m->nsol,float);
-    v0 = m->v0;
+    VectorXf v0_work(m->nsol);
+    v0 = v0_work.data();
     /*
        * The dipole location and orientation must be transformed
        */
@@ -2924,6 +3288,154 @@ int FwdBemModel::fwd_bem_field(float *rd, float *Q, FwdCoilSet *coils, float *B,
 }
 
 
+//*************************************************************************************************************
+
+#define BEM_FIELD_CHUNK_MIN_40 16   /* Smallest number of dipoles per chunk in fwd_bem_field_block */
+#define BEM_FIELD_CHUNK_MAX_40 256  /* Largest number of dipoles per chunk in fwd_bem_field_block */
+
+/*
+ * A chunk of consecutive dipoles for fwd_bem_field_block
+ */
+typedef struct {
+    const MatrixX3f *rd;        /* All dipole positions */
+    const MatrixX3f *Q;         /* All dipole moments */
+    int             start;      /* First dipole of this chunk */
+    int             n;          /* Number of dipoles in this chunk */
+    FwdCoilSet      *coils;     /* The coils */
+    FwdBemModel     *m;         /* The model (read only) */
+    MatrixXf        *B;         /* Output: the fields of all dipoles */
+} fieldBlockChunk_40;
+
+
+static void fwd_bem_field_chunk_40(fieldBlockChunk_40& job)
+{
+    FwdBemModel*    m   = job.m;
+    FwdCoilSet*     coils = job.coils;
+    FwdBemSolution* sol = (FwdBemSolution*)coils->user_data;
+    FwdCoil*        coil;
+    MneTriangle*    tri;
+    float           rd[3],Q[3],my_rd[3],my_Q[3];
+    float           mult,val;
+    int             j,s,k,p,ntri,np;
+    /*
+     * Thread-local infinite-medium potentials, one dipole per row
+     */
+    Matrix<float,Dynamic,Dynamic,RowMajor> V0(job.n,m->nsol);
+    MatrixXf Bprim(job.n,coils->ncoil);
+
+    for (j = 0; j < job.n; j++) {
+        for (k = 0; k < 3; k++) {
+            rd[k] = (*job.rd)(job.start+j,k);
+            Q[k]  = (*job.Q)(job.start+j,k);
+        }
+        /*
+         * The dipole location and orientation must be transformed
+         */
+        VEC_COPY_40(my_rd,rd);
+        VEC_COPY_40(my_Q,Q);
+        if (m->head_mri_t) {
+            FiffCoordTransOld::fiff_coord_trans(my_rd,m->head_mri_t,FIFFV_MOVE);
+            FiffCoordTransOld::fiff_coord_trans(my_Q,m->head_mri_t,FIFFV_NO_MOVE);
+        }
+        float *v0 = V0.row(j).data();
+        if (m->bem_method == FWD_BEM_LINEAR_COLL) {
+            /*
+             * At the vertices
+             */
+            for (s = 0, p = 0; s < m->nsurf; s++) {
+                np   = m->surfs[s]->np;
+                mult = m->source_mult[s];
+                for (k = 0; k < np; k++)
+                    v0[p++] = mult*FwdBemModel::fwd_bem_inf_pot(my_rd,my_Q,m->surfs[s]->rr[k]);
+            }
+        }
+        else {
+            /*
+             * At the centers of the triangles
+             */
+            for (s = 0, p = 0; s < m->nsurf; s++) {
+                ntri = m->surfs[s]->ntri;
+                tri  = m->surfs[s]->tris;
+                mult = m->source_mult[s];
+                for (k = 0; k < ntri; k++, tri++)
+                    v0[p++] = mult*FwdBemModel::fwd_bem_inf_pot(my_rd,my_Q,tri->cent);
+            }
+        }
+        /*
+         * Primary current contribution
+         * (can be calculated in the coil/dipole coordinates)
+         */
+        for (k = 0; k < coils->ncoil; k++) {
+            coil = coils->coils[k];
+            val  = 0.0;
+            for (p = 0; p < coil->np; p++)
+                val = val + coil->w[p]*FwdBemModel::fwd_bem_inf_field(rd,Q,coil->rmag[p],coil->cosmag[p]);
+            Bprim(j,k) = val;
+        }
+    }
+    /*
+     * Volume current contribution for the whole chunk at once
+     */
+    Map<const Matrix<float,Dynamic,Dynamic,RowMajor> > S(sol->solution[0],coils->ncoil,m->nsol);
+    Bprim.noalias() += V0*S.transpose();
+    /*
+     * Scale correctly
+     */
+    job.B->middleRows(job.start,job.n) = float(MAG_FACTOR)*Bprim;
+}
+
+
+//*************************************************************************************************************
+
+int FwdBemModel::fwd_bem_field_block(const MatrixX3f &rd, const MatrixX3f &Q, FwdCoilSet *coils, FwdBemModel *m, MatrixXf &B, int chunk)
+{
+    FwdBemSolution* sol = coils ? (FwdBemSolution*)coils->user_data : NULL;
+    int ndip = rd.rows();
+    int k;
+
+    if (!m) {
+        qCritical("No BEM model specified to fwd_bem_field_block");
+        return FAIL;
+    }
+    if (!sol || !sol->solution || sol->ncoil != coils->ncoil || sol->np != m->nsol) {
+        qCritical("No appropriate coil-specific data available in fwd_bem_field_block");
+        return FAIL;
+    }
+    if (m->bem_method != FWD_BEM_CONSTANT_COLL && m->bem_method != FWD_BEM_LINEAR_COLL) {
+        qCritical("Unknown BEM method : %d",m->bem_method);
+        return FAIL;
+    }
+    if (Q.rows() != ndip) {
+        qCritical("Dipole position and moment counts do not match in fwd_bem_field_block (%d vs. %d)",ndip,(int)Q.rows());
+        return FAIL;
+    }
+    B.resize(ndip,coils->ncoil);
+    if (ndip == 0)
+        return OK;
+    /*
+     * Give every thread a few chunks to balance the load but keep the chunks large enough for an efficient product
+     */
+    if (chunk <= 0) {
+        chunk = ndip/(4*qMax(1,QThread::idealThreadCount()));
+        chunk = qBound(BEM_FIELD_CHUNK_MIN_40,chunk,BEM_FIELD_CHUNK_MAX_40);
+    }
+    QList<fieldBlockChunk_40> chunks;
+    for (k = 0; k < ndip; k += chunk) {
+        fieldBlockChunk_40 job;
+        job.rd    = &rd;
+        job.Q     = &Q;
+        job.start = k;
+        job.n     = qMin(chunk,ndip-k);
+        job.coils = coils;
+        job.m     = m;
+        job.B     = &B;
+        chunks.append(job);
+    }
+    QtConcurrent::blockingMap(chunks, fwd_bem_field_chunk_40);
+    return OK;
+}
+
+
 //*************************************************************************************************************
 
 int FwdBemModel::fwd_bem_field_grad(float *rd, float Q[], FwdCoilSet *coils, float Bval[], float xgrad[], float ygrad[], float zgrad[], void *client)  /* Client data to be passed to some foward modelling routines */
@@ -2958,6 +3470,93 @@ int FwdBemModel::fwd_bem_field_grad(float *rd, float Q[], FwdCoilSet *coils, flo
 }
 
 
+//*************************************************************************************************************
+
+#define FWD_SOURCE_CHUNKS_PER_THREAD_40 8      /* Number of chunks queued per thread for load balancing */
+#define FWD_SOURCE_CHUNK_MAX_40         256    /* Largest number of source points in one chunk */
+
+/*
+ * A range of source space points processed as one task
+ */
+typedef struct {
+    MneSourceSpaceOld *s;       /* The source space */
+    int               from;     /* First point of the range */
+    int               to;       /* One past the last point of the range */
+    int               off;      /* Offset of the first point in use within the result */
+} fwdSourceChunk_40;
+
+/*
+ * One worker of the forward computation, takes chunks from the shared queue until it is empty
+ */
+typedef struct {
+    FwdThreadArg                    *arg;       /* Private copy of the thread argument (workspace) */
+    const QList<fwdSourceChunk_40>  *chunks;    /* The shared queue */
+    QAtomicInt                      *next;      /* Index of the next chunk to take */
+    QAtomicInt                      *failed;    /* Set by the first worker which fails */
+} fwdSourceWorker_40;
+
+
+static int source_chunk_size_40(int nsource, int nthread)
+{
+    return qBound(1,nsource/(FWD_SOURCE_CHUNKS_PER_THREAD_40*qMax(1,nthread)),FWD_SOURCE_CHUNK_MAX_40);
+}
+
+
+static QList<fwdSourceChunk_40> make_source_chunks_40(MneSourceSpaceOld **spaces, int nspace, bool fixed_ori, int chunk)
+/*
+ * Split the points in use into ranges of at most chunk points
+ */
+{
+    QList<fwdSourceChunk_40> chunks;
+    fwdSourceChunk_40 one;
+    int k,j,n,off;
+
+    for (k = 0, off = 0; k < nspace; k++) {
+        one.s    = spaces[k];
+        one.from = 0;
+        one.off  = off;
+        for (j = 0, n = 0; j < spaces[k]->np; j++) {
+            if (!spaces[k]->inuse[j])
+                continue;
+            off = fixed_ori ? off + 1 : off + 3;
+            if (++n == chunk) {
+                one.to = j + 1;
+                chunks.append(one);
+                one.from = j + 1;
+                one.off  = off;
+                n = 0;
+            }
+        }
+        if (n > 0) {
+            one.to = spaces[k]->np;
+            chunks.append(one);
+        }
+    }
+    return chunks;
+}
+
+
+static void fwd_source_worker_40(fwdSourceWorker_40& w)
+{
+    int c;
+
+    w.arg->stat = OK;
+    while (w.failed->loadAcquire() == 0 && (c = w.next->fetchAndAddOrdered(1)) < w.chunks->size()) {
+        const fwdSourceChunk_40& chunk = w.chunks->at(c);
+        w.arg->s    = chunk.s;
+        w.arg->from = chunk.from;
+        w.arg->to   = chunk.to;
+        w.arg->off  = chunk.off;
+        w.arg->comp = -1;
+        FwdBemModel::meg_eeg_fwd_one_source_space(w.arg);
+        if (w.arg->stat != OK) {
+            w.failed->storeRelease(1);
+            return;
+        }
+    }
+}
+
+
 //*************************************************************************************************************
 
 void *FwdBemModel::meg_eeg_fwd_one_source_space(void *arg)
@@ -2969,13 +3568,14 @@ void *FwdBemModel::meg_eeg_fwd_one_source_space(void *arg)
     FwdThreadArg* a = (FwdThreadArg*)arg;
     MneSourceSpaceOld* s = a->s;
     int            j,p,q;
+    int            last = (a->to < 0 || a->to > s->np) ? s->np : a->to;
     float          *xyz[3];
 
     p = a->off;
     q = 3*a->off;
     if (a->fixed_ori) {					  /* The normal source component only */
         if (a->field_pot_grad && a->res_grad) {                   /* Gradient requested? */
-            for (j = 0; j < s->np; j++)
+            for (j = a->from; j < last; j++)
                 if (s->inuse[j]) {
                     if (a->field_pot_grad(s->rr[j],s->nn[j],a->coils_els,a->res[p],
                                           a->res_grad[q],a->res_grad[q+1],a->res_grad[q+2],
@@ -2986,7 +3586,7 @@ void *FwdBemModel::meg_eeg_fwd_one_source_space(void *arg)
                 }
         }
         else {
-            for (j = 0; j < s->np; j++)
+            for (j = a->from; j < last; j++)
                 if (s->inuse[j])
                     if (a->field_pot(s->rr[j],s->nn[j],a->coils_els,a->res[p++],a->client) != OK)
                         goto bad;
@@ -2994,7 +3594,7 @@ void *FwdBemModel::meg_eeg_fwd_one_source_space(void *arg)
     }
     else {						  /* All source components */
         if (a->field_pot_grad && a->res_grad) {               /* Gradient requested? */
-            for (j = 0; j < s->np; j++) {
+            for (j = a->from; j < last; j++) {
                 if (s->inuse[j]) {
                     if (a->comp < 0) {				  /* Compute all components */
                         if (a->field_pot_grad(s->rr[j],Qx,a->coils_els,a->res[p],
@@ -3044,7 +3644,7 @@ void *FwdBemModel::meg_eeg_fwd_one_source_space(void *arg)
             }
         }
         else {
-            for (j = 0; j < s->np; j++) {
+            for (j = a->from; j < last; j++) {
                 if (s->inuse[j]) {
                     if (a->vec_field_pot) {
                         xyz[0] = a->res[p++];
@@ -3095,7 +3695,66 @@ bad : {
 
 //*************************************************************************************************************
 
-int FwdBemModel::compute_forward_meg(MneSourceSpaceOld **spaces, int nspace, FwdCoilSet *coils, FwdCoilSet *comp_coils, MneCTFCompDataSet *comp_data, bool fixed_ori, FwdBemModel *bem_model, Vector3f *r0, bool use_threads, MneNamedMatrix **resp, MneNamedMatrix **resp_grad)
+static int fwd_bem_meg_field_block_40(MneSourceSpaceOld **spaces, int nspace, bool fixed_ori, FwdCoilSet *coils, FwdCompData *comp, FwdBemModel *m, bool use_threads, float **res)
+/*
+ * Compute the BEM MEG forward solution of all sources at once with fwd_bem_field_block
+ * The rows of res are ordered as in meg_eeg_fwd_one_source_space
+ */
+{
+    MneSourceSpaceOld *s;
+    int     nrow,j,k,p,c;
+    bool    do_comp = comp->comp_coils && comp->comp_coils->ncoil > 0 && comp->set && comp->set->current;
+    int     chunk;
+
+    for (k = 0, nrow = 0; k < nspace; k++)
+        nrow += fixed_ori ? spaces[k]->nuse : 3*spaces[k]->nuse;
+    chunk = use_threads ? 0 : qMax(1,nrow);
+
+    MatrixX3f rd(nrow,3);
+    MatrixX3f Q(nrow,3);
+    MatrixXf  B,Bcomp;
+    VectorXf  comp_work;
+
+    for (k = 0, p = 0; k < nspace; k++) {
+        s = spaces[k];
+        for (j = 0; j < s->np; j++) {
+            if (!s->inuse[j])
+                continue;
+            if (fixed_ori) {
+                rd.row(p) = Map<const RowVector3f>(s->rr[j]);
+                Q.row(p)  = Map<const RowVector3f>(s->nn[j]);
+                p++;
+            }
+            else {
+                for (c = 0; c < 3; c++, p++) {
+                    rd.row(p) = Map<const RowVector3f>(s->rr[j]);
+                    Q.row(p)  = RowVector3f::Unit(c);
+                }
+            }
+        }
+    }
+    if (FwdBemModel::fwd_bem_field_block(rd,Q,coils,m,B,chunk) == FAIL)
+        return FAIL;
+    if (do_comp && FwdBemModel::fwd_bem_field_block(rd,Q,comp->comp_coils,m,Bcomp,chunk) == FAIL)
+        return FAIL;
+    /*
+     * Apply the compensation per source component as fwd_comp_field does
+     */
+    for (p = 0; p < nrow; p++) {
+        Map<RowVectorXf>(res[p],coils->ncoil) = B.row(p);
+        if (do_comp) {
+            comp_work = Bcomp.row(p).transpose();
+            if (MneCTFCompDataSet::mne_apply_ctf_comp(comp->set,TRUE,res[p],coils->ncoil,comp_work.data(),comp->comp_coils->ncoil) != OK)
+                return FAIL;
+        }
+    }
+    return OK;
+}
+
+
+//*************************************************************************************************************
+
+int FwdBemModel::compute_forward_meg(MneSourceSpaceOld **spaces, int nspace, FwdCoilSet *coils, FwdCoilSet *comp_coils, MneCTFCompDataSet *comp_data, bool fixed_ori, FwdBemModel *bem_model, Vector3f *r0, bool use_threads, MneNamedMatrix **resp, MneNamedMatrix **resp_grad, int nthreads)
 /*
 * Compute the MEG forward solution
 * Use either the sphere model or BEM in the calculations
@@ -3110,11 +3769,12 @@ int FwdBemModel::compute_forward_meg(MneSourceSpaceOld **spaces, int nspace, Fwd
                                              * for one dipole orientation */
     int                 nmeg = coils->ncoil;/* Number of channels */
     int                 nsource;            /* Total number of sources */
-    int                 k,p,q,off;
+    int                 k,off;
     QStringList         names;              /* Channel names */
     void                *client;
     FwdThreadArg*       one_arg = NULL;
     int                 nproc = QThread::idealThreadCount();
+    int                 nthread = nthreads > 0 ? nthreads : nproc;
     QStringList         emptyList;
 
     if (bem_model) {
@@ -3211,58 +3871,48 @@ int FwdBemModel::compute_forward_meg(MneSourceSpaceOld **spaces, int nspace, Fwd
     one_arg->vec_field_pot  = vec_field;
     one_arg->field_pot_grad = field_grad;
 
-    if (nproc < 2)
+    if (nthread < 2)
         use_threads = false;
 
-    if (use_threads) {
-        int            nthread  = (fixed_ori || vec_field || nproc < 6) ? nspace : 3*nspace;
-        QList <FwdThreadArg*> args; //fwdThreadArg   *args    = MALLOC_40(nthread,fwdThreadArg);
-        int            stat;
+    if (bem_model && !res_grad) {
         /*
-        * We need copies to allocate separate workspace for each thread
+        * Without gradients the BEM fields of all sources are evaluated in blocks
         */
-        if (fixed_ori || vec_field || nproc < 6) {
-            for (k = 0, off = 0; k < nthread; k++) {
-                FwdThreadArg* t_arg = FwdThreadArg::create_meg_multi_thread_duplicate(one_arg,bem_model != NULL);
-                t_arg->s   = spaces[k];
-                t_arg->off = off;
-                off = fixed_ori ? off + spaces[k]->nuse : off + 3*spaces[k]->nuse;
-                args.append(t_arg);
-            }
-            fprintf(stderr,"%d processors. I will use one thread for each of the %d source spaces.\n",
-                    nproc,nspace);
-        }
-        else {
-            for (k = 0, off = 0, q = 0; k < nspace; k++) {
-                for (p = 0; p < 3; p++,q++) {
-                    FwdThreadArg* t_arg = FwdThreadArg::create_meg_multi_thread_duplicate(one_arg,bem_model != NULL);
-                    t_arg->s    = spaces[k];
-                    t_arg->off  = off;
-                    t_arg->comp = p;
-                    args.append(t_arg);
-                }
-                off = fixed_ori ? off + spaces[k]->nuse : off + 3*spaces[k]->nuse;
-            }
-            fprintf(stderr,"%d processors. I will use %d threads : %d source spaces x 3 source components.\n",
-                    nproc,nthread,nspace);
+        fprintf(stderr,"Computing MEG at %d source locations (%s orientations, %s)...",
+                nsource,fixed_ori ? "fixed" : "free",use_threads ? "BEM field blocks" : "BEM field blocks, no threads");
+        if (fwd_bem_meg_field_block_40(spaces,nspace,fixed_ori,coils,comp,bem_model,use_threads,res) != OK)
+            goto bad;
+    }
+    else if (use_threads) {
+        QList<fwdSourceChunk_40>    chunks = make_source_chunks_40(spaces,nspace,fixed_ori,source_chunk_size_40(nsource,nthread));
+        QList<fwdSourceWorker_40>   workers;
+        QAtomicInt                  next(0);
+        QAtomicInt                  failed(0);
+        int                         nworker = qMin(nthread,chunks.size());
+        /*
+        * The coils and the BEM solution are shared, only the workspace is duplicated for each worker
+        */
+        for (k = 0; k < nworker; k++) {
+            fwdSourceWorker_40 w;
+            w.arg    = FwdThreadArg::create_meg_multi_thread_duplicate(one_arg,bem_model != NULL);
+            w.chunks = &chunks;
+            w.next   = &next;
+            w.failed = &failed;
+            workers.append(w);
         }
+        fprintf(stderr,"%d processors. I will use %d threads on %d chunks of source points.\n",nproc,nworker,chunks.size());
         fprintf(stderr,"Computing MEG at %d source locations (%s orientations)...",
                 nsource,fixed_ori ? "fixed" : "free");
         /*
         * Ready to start the threads & Wait for them to complete
         */
-        QtConcurrent::blockingMap(args, meg_eeg_fwd_one_source_space);
+        QtConcurrent::blockingMap(workers, fwd_source_worker_40);
         /*
         * Check the results
         */
-        for (k = 0, stat = OK; k < nthread; k++)
-            if (args[k]->stat != OK) {
-                stat = FAIL;
-                break;
-            }
-        for (k = 0; k < args.size(); k++)//nthread == args.size()
-            FwdThreadArg::free_meg_multi_thread_duplicate(args[k],bem_model != NULL);
-        if (stat != OK)
+        for (k = 0; k < workers.size(); k++)
+            FwdThreadArg::free_meg_multi_thread_duplicate(workers[k].arg,bem_model != NULL);
+        if (failed.loadAcquire() != 0)
             goto bad;
     }
     else {
@@ -3309,7 +3959,7 @@ bad : {
 
 //*************************************************************************************************************
 
-int FwdBemModel::compute_forward_eeg(MneSourceSpaceOld **spaces, int nspace, FwdCoilSet *els, bool fixed_ori, FwdBemModel *bem_model, FwdEegSphereModel *m, bool use_threads, MneNamedMatrix **resp, MneNamedMatrix **resp_grad)
+int FwdBemModel::compute_forward_eeg(MneSourceSpaceOld **spaces, int nspace, FwdCoilSet *els, bool fixed_ori, FwdBemModel *bem_model, FwdEegSphereModel *m, bool use_threads, MneNamedMatrix **resp, MneNamedMatrix **resp_grad, int nthreads)
 /*
     * Compute the EEG forward solution
     * Use either the sphere model or BEM in the calculations
@@ -3323,11 +3973,12 @@ int FwdBemModel::compute_forward_eeg(MneSourceSpaceOld **spaces, int nspace, Fwd
                                              * for one dipole orientation */
     int             nsource;                /* Total number of sources */
     int             neeg = els->ncoil;      /* Number of channels */
-    int             k,p,q,off;
+    int             k,off;
     QStringList     names;                  /* Channel names */
     void            *client;
     FwdThreadArg*   one_arg = NULL;
     int             nproc = QThread::idealThreadCount();
+    int             nthread = nthreads > 0 ? nthreads : nproc;
     QStringList     emptyList;
     /*
        * Count the sources
@@ -3395,56 +4046,39 @@ int FwdBemModel::compute_forward_eeg(MneSourceSpaceOld **spaces, int nspace, Fwd
     one_arg->vec_field_pot  = vec_pot;
     one_arg->field_pot_grad = pot_grad;
 
-    if (nproc < 2)
+    if (nthread < 2)
         use_threads = false;
 
     if (use_threads) {
-        int            nthread  = (fixed_ori || vec_pot || nproc < 6) ? nspace : 3*nspace;
-        QList <FwdThreadArg*> args; //FwdThreadArg*   *args    = MALLOC_40(nthread,FwdThreadArg*);
-        int            stat;
+        QList<fwdSourceChunk_40>    chunks = make_source_chunks_40(spaces,nspace,fixed_ori,source_chunk_size_40(nsource,nthread));
+        QList<fwdSourceWorker_40>   workers;
+        QAtomicInt                  next(0);
+        QAtomicInt                  failed(0);
+        int                         nworker = qMin(nthread,chunks.size());
         /*
-        * We need copies to allocate separate workspace for each thread
+        * The coils and the BEM solution are shared, only the workspace is duplicated for each worker
         */
-        if (fixed_ori || vec_pot || nproc < 6) {
-            for (k = 0, off = 0; k < nthread; k++) {
-                FwdThreadArg* t_arg = FwdThreadArg::create_eeg_multi_thread_duplicate(one_arg,bem_model != NULL);
-                t_arg->s   = spaces[k];
-                t_arg->off = off;
-                off = fixed_ori ? off + spaces[k]->nuse : off + 3*spaces[k]->nuse;
-                args.append(t_arg);
-            }
-            printf("%d processors. I will use one thread for each of the %d source spaces.\n",nproc,nspace);
-        }
-        else {
-            for (k = 0, off = 0, q = 0; k < nspace; k++) {
-                for (p = 0; p < 3; p++,q++) {
-                    FwdThreadArg* t_arg = FwdThreadArg::create_eeg_multi_thread_duplicate(one_arg,bem_model != NULL);
-                    t_arg->s    = spaces[k];
-                    t_arg->off  = off;
-                    t_arg->comp = p;
-                    args.append(t_arg);
-                }
-                off = fixed_ori ? off + spaces[k]->nuse : off + 3*spaces[k]->nuse;
-            }
-            printf("%d processors. I will use %d threads : %d source spaces x 3 source components.\n",nproc,nthread,nspace);
+        for (k = 0; k < nworker; k++) {
+            fwdSourceWorker_40 w;
+            w.arg    = FwdThreadArg::create_eeg_multi_thread_duplicate(one_arg,bem_model != NULL);
+            w.chunks = &chunks;
+            w.next   = &next;
+            w.failed = &failed;
+            workers.append(w);
         }
+        printf("%d processors. I will use %d threads on %d chunks of source points.\n",nproc,nworker,chunks.size());
         printf("Computing EEG at %d source locations (%s orientations)...",
                 nsource,fixed_ori ? "fixed" : "free");
         /*
         * Ready to start the threads & Wait for them to complete
         */
-        QtConcurrent::blockingMap(args, meg_eeg_fwd_one_source_space);
+        QtConcurrent::blockingMap(workers, fwd_source_worker_40);
         /*
         * Check the results
         */
-        for (k = 0, stat = OK; k < nthread; k++)
-            if (args[k]->stat != OK) {
-                stat = FAIL;
-                break;
-            }
-        for (k = 0; k < args.size(); k++)//nthread == args.size()
-            FwdThreadArg::free_eeg_multi_thread_duplicate(args[k],bem_model != NULL);
-        if (stat != OK)
+        for (k = 0; k < workers.size(); k++)
+            FwdThreadArg::free_eeg_multi_thread_duplicate(workers[k].arg,bem_model != NULL);
+        if (failed.loadAcquire() != 0)
             goto bad;
     }
     else {
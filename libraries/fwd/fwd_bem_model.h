@@ -111,6 +111,8 @@ class FwdEegSphereModel;
 //=============================================================================================================
 /**
 * Implements FwdBemModel (Replaces *FwdBemModel*,FwdBemModel*Rec struct of MNE-C fwd_types.h).
+* The field and potential routines keep the infinite-medium potentials in local workspaces, so a model is only
+* read during the evaluation and can be shared by several threads.
 *
 * @brief Holds the BEM model definition
 */
@@ -166,6 +168,42 @@ public:
 
     static QString fwd_bem_make_bem_sol_name(const QString& name);
 
+    //=========================================================================================================
+    /**
+    * Computes a hash of everything the potential solution depends on: the surface geometry, the
+    * conductivities and the approximation method. The hash is salted with the version of the cache format.
+    *
+    * @param[in] m              The BEM model.
+    * @param[in] bem_method     The approximation method.
+    *
+    * @return The hash as a hexadecimal string.
+    */
+    static QString fwd_bem_solution_hash(FwdBemModel* m, int bem_method);
+
+    //=========================================================================================================
+    /**
+    * Returns the name of the solution cache file for a model. The cache is opt-in: the cache directory is
+    * taken from the MNE_BEM_SOL_CACHE environment variable, the value "default" selects mne-cpp/bem-sol in the
+    * user's cache location.
+    *
+    * @param[in] m              The BEM model.
+    * @param[in] bem_method     The approximation method.
+    *
+    * @return The file name, empty if the cache is disabled or no cache location is available.
+    */
+    static QString fwd_bem_cache_sol_name(FwdBemModel* m, int bem_method);
+
+    //=========================================================================================================
+    /**
+    * Writes the potential solution matrix of a model so that it can be read with fwd_bem_load_solution.
+    *
+    * @param[in] name   The destination file.
+    * @param[in] m      The BEM model with a computed solution.
+    *
+    * @return OK on success, FAIL otherwise.
+    */
+    static int fwd_bem_write_solution(const QString& name, FwdBemModel* m);
+
 
 
     //============================= fwd_bem_model.c =============================
@@ -442,6 +480,29 @@ public:
                       float       *B,       /* Result */
                       void        *client);
 
+    //=========================================================================================================
+    /**
+    * Calculates the magnetic fields of a block of dipoles in a set of coils. The infinite-medium potentials
+    * of the dipoles are collected chunk by chunk into thread-local matrices and the coil-specific BEM solution
+    * is applied to each chunk as one matrix-matrix product. The model is only read, fwd_bem_specify_coils must
+    * have been called for the coils beforehand.
+    *
+    * @param[in] rd         The dipole positions (one dipole per row).
+    * @param[in] Q          The dipole moments (one dipole per row).
+    * @param[in] coils      The coil descriptors.
+    * @param[in] m          The BEM model.
+    * @param[out] B         The fields, number of dipoles x number of coils.
+    * @param[in] chunk      Number of dipoles handled by one thread at a time, 0 to select it automatically.
+    *
+    * @return OK on success, FAIL otherwise.
+    */
+    static int fwd_bem_field_block(const Eigen::MatrixX3f& rd,
+                                   const Eigen::MatrixX3f& Q,
+                                   FwdCoilSet*  coils,
+                                   FwdBemModel* m,
+                                   Eigen::MatrixXf& B,
+                                   int chunk = 0);
+
     static int fwd_bem_field_grad(float        *rd,      /* The dipole location */
                    float        Q[],      /* The dipole components (xyz) */
                    FwdCoilSet*  coils,    /* The coil definitions */
@@ -466,7 +527,8 @@ public:
                                     Eigen::Vector3f*    r0,         /* Sphere model origin */
                                     bool                use_threads, /* Parallelize with threads? */
                                     MNELIB::MneNamedMatrix*     *resp,       /* The results */
-                                    MNELIB::MneNamedMatrix*     *resp_grad);
+                                    MNELIB::MneNamedMatrix*     *resp_grad,
+                                    int                 nthreads = 0); /* Number of threads, 0 = QThread::idealThreadCount() */
 
     static int compute_forward_eeg( MNELIB::MneSourceSpaceOld*  *spaces,     /* Source spaces */
                                     int                 nspace,      /* How many? */
@@ -476,7 +538,8 @@ public:
                                     FwdEegSphereModel*  m,           /* Sphere model definition */
                                     bool                use_threads, /* Parallelize with threads? */
                                     MNELIB::MneNamedMatrix*     *resp,       /* The results */
-                                    MNELIB::MneNamedMatrix*     *resp_grad);
+                                    MNELIB::MneNamedMatrix*     *resp_grad,
+                                    int                 nthreads = 0); /* Number of threads, 0 = QThread::idealThreadCount() */
 
 
     //============================= fwd_spherefield.c =============================
@@ -531,7 +594,6 @@ public:
     QString     sol_name;       /* Name of the file where the solution was loaded from */
 
     float      **solution;      /* The potential solution matrix */
-    float      *v0;             /* Space for the infinite-medium potentials */
     int        nsol;            /* Size of the solution matrix */
 
     FIFFLIB::FiffCoordTransOld* head_mri_t;  /* Coordinate transformation from head to MRI coordinates */
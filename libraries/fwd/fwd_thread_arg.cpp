@@ -106,6 +106,8 @@ FwdThreadArg::FwdThreadArg()
 ,fixed_ori     (FALSE)
 ,stat          (FAIL)
 ,comp          (-1)
+,from          (0)
+,to            (-1)
 {
 
 }
@@ -129,15 +131,11 @@ FwdThreadArg *FwdThreadArg::create_eeg_multi_thread_duplicate(FwdThreadArg *one,
 {
     FwdThreadArg* res  = new FwdThreadArg;
 
+    Q_UNUSED(bem_model)
+    /*
+     * The BEM model is shared, the field computations keep their workspace local
+     */
     *res = *one;
-    if (bem_model) {
-        FwdBemModel*   new_bem  = new FwdBemModel;
-        FwdBemModel*   orig_bem = (FwdBemModel*)res->client;
-
-        *new_bem    = *orig_bem;
-        new_bem->v0 = NULL;
-        res->client = new_bem;
-    }
     return res;
 }
 
@@ -146,11 +144,8 @@ FwdThreadArg *FwdThreadArg::create_eeg_multi_thread_duplicate(FwdThreadArg *one,
 
 void FwdThreadArg::free_eeg_multi_thread_duplicate(FwdThreadArg *one, bool bem_model)
 {
-    if (bem_model) {
-        FwdBemModel*    bem = (FwdBemModel*) one->client;
-        FREE_80(bem->v0);
-        FREE_80(bem);
-    }
+    Q_UNUSED(bem_model)
+
     one->client = NULL;
     if(one)
         delete one;
@@ -175,15 +170,10 @@ FwdThreadArg *FwdThreadArg::create_meg_multi_thread_duplicate(FwdThreadArg* one,
     comp->work     = NULL;
     comp->vec_work = NULL;
     comp->set      = orig->set ? new MneCTFCompDataSet(*(orig->set)) : NULL;
-
-    if (bem_model) {
-        FwdBemModel*   new_bem  = new FwdBemModel();
-        FwdBemModel*   orig_bem = (FwdBemModel*)comp->client;
-
-        *new_bem     = *orig_bem;
-        new_bem->v0  = NULL;
-        comp->client = new_bem;
-    }
+    /*
+     * The BEM model is shared, the field computations keep their workspace local
+     */
+    Q_UNUSED(bem_model)
     return res;
 }
 
@@ -200,11 +190,7 @@ void FwdThreadArg::free_meg_multi_thread_duplicate(FwdThreadArg *one, bool bem_m
     if(comp->set)
         delete comp->set;
 
-    if (bem_model) {
-        FwdBemModel*    bem = (FwdBemModel*)comp->client;
-        FREE_80(bem->v0);
-        FREE_80(bem);
-    }
+    Q_UNUSED(bem_model)
     FREE_80(comp);
     one->client = NULL;
     if(one)
@@ -138,6 +138,8 @@ public:
     MNELIB::MneSourceSpaceOld   *s;                 /* The source space to process */
     int                 fixed_ori;         /* Compute fixed orientation solution? */
     int                 comp;              /* Which component to compute for free orientations */
+    int                 from;              /* First source space point to process */
+    int                 to;                /* One past the last source space point to process, -1 for all */
     int                 stat;
 
 // ### OLD STRUCT ###
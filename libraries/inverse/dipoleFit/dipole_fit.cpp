@@ -28,6 +28,8 @@ using namespace FWDLIB;
 // STATIC DEFINITIONS
 //=============================================================================================================
 
+#define FIT_BLOCK_SIZE 256     /* Number of time points whose initial guesses are searched at once */
+
 #ifndef PROGRAM_VERSION
 #define PROGRAM_VERSION     "1.00"
 #endif
@@ -638,6 +640,8 @@ ECDSet DipoleFit::calculateFit() const
         goto out;
 
     fit_data->fit_mag_dipoles = settings->fit_mag_dipoles;
+    fit_data->nthreads        = settings->nthreads;
+    fit_data->warm_start      = settings->warm_start;
     if (settings->is_raw) {
         int c;
         float t1,t2;
@@ -726,14 +730,41 @@ out : {
 }
 
 
+//*************************************************************************************************************
+
+void DipoleFit::fit_block(DipoleFitData* fit, GuessData* guess, Eigen::MatrixXf& block, QVector<float>& times, int verbose, int report_interval, ECDSet& set)
+{
+    QList<ECD> dips;
+    Eigen::MatrixXf B = block.leftCols(times.size());
+
+    if (times.isEmpty())
+        return;
+    DipoleFitData::fit_block(fit,guess,times,B,verbose,dips);
+    for (int t = 0; t < dips.size(); t++) {
+        if (!dips[t].valid)
+            qWarning("DipoleFit::fit_block - Dipole fit at t = %7.1f ms (time point %d of %d in this block) failed. Skipping it.",1000*times[t],t+1,times.size());
+        else {
+            set.addEcd(dips[t]);
+            if (verbose)
+                dips[t].print(stdout);
+            else {
+                if (set.size() % report_interval == 0)
+                    fprintf(stderr,"%d..",set.size());
+            }
+        }
+    }
+    times.clear();
+}
+
+
 //*************************************************************************************************************
 
 int DipoleFit::fit_dipoles( const QString& dataname, MneMeasData* data, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose, ECDSet& p_set)
 {
-    float *one = MALLOC(data->nchan,float);
+    Eigen::MatrixXf block(data->nchan,FIT_BLOCK_SIZE);
+    QVector<float> times;
     float time;
     ECDSet set;
-    ECD   dip;
     int   s;
     int   report_interval = 10;
 
@@ -745,26 +776,17 @@ int DipoleFit::fit_dipoles( const QString& dataname, MneMeasData* data, DipoleFi
      * Pick the data point
      */
         if (mne_get_values_from_data(time,integ,data->current->data,data->current->np,data->nchan,data->current->tmin,
-                                     1.0/data->current->tstep,FALSE,one) == FAIL) {
+                                     1.0/data->current->tstep,FALSE,block.col(times.size()).data()) == FAIL) {
             fprintf(stderr,"Cannot pick time: %7.1f ms\n",1000*time);
             continue;
         }
-
-        if (!DipoleFitData::fit_one(fit,guess,time,one,verbose,dip))
-            printf("t = %7.1f ms : %s\n",1000*time,"error (tbd: catch)");
-        else {
-            set.addEcd(dip);
-            if (verbose)
-                dip.print(stdout);
-            else {
-                if (set.size() % report_interval == 0)
-                    fprintf(stderr,"%d..",set.size());
-            }
-        }
+        times.append(time);
+        if (times.size() == FIT_BLOCK_SIZE)
+            fit_block(fit,guess,block,times,verbose,report_interval,set);
     }
+    fit_block(fit,guess,block,times,verbose,report_interval,set);
     if (!verbose)
         fprintf(stderr,"[done]\n");
-    FREE(one);
     p_set = set;
     return OK;
 }
@@ -774,7 +796,8 @@ int DipoleFit::fit_dipoles( const QString& dataname, MneMeasData* data, DipoleFi
 
 int DipoleFit::fit_dipoles_raw(const QString& dataname, MneRawData* raw, mneChSelection sel, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose, ECDSet& p_set)
 {
-    float *one    = MALLOC(sel->nchan,float);
+    Eigen::MatrixXf block(sel->nchan,FIT_BLOCK_SIZE);
+    QVector<float> times;
     float sfreq   = raw->info->sfreq;
     float myinteg = integ > 0.0 ? 2*integ : 0.1;
     int   overlap = ceil(myinteg*sfreq);
@@ -785,7 +808,6 @@ int DipoleFit::fit_dipoles_raw(const QString& dataname, MneRawData* raw, mneChSe
     int   s,picks;
     float time,stime;
     float **data  = ALLOC_CMATRIX(sel->nchan,length);
-    ECD    dip;
     ECDSet set;
     int    report_interval = 10;
 
@@ -810,35 +832,26 @@ int DipoleFit::fit_dipoles_raw(const QString& dataname, MneRawData* raw, mneChSe
         /*
      * Get the values
      */
-        if (mne_get_values_from_data_ch (time,integ,data,length,sel->nchan,stime,sfreq,FALSE,one) == FAIL) {
+        if (mne_get_values_from_data_ch (time,integ,data,length,sel->nchan,stime,sfreq,FALSE,block.col(times.size()).data()) == FAIL) {
             fprintf(stderr,"Cannot pick time: %8.3f s\n",time);
             continue;
         }
         /*
-     * Fit
+     * Fit once a block of time points is available
      */
-        if (!DipoleFitData::fit_one(fit,guess,time,one,verbose,dip))
-            qWarning() << "Error";
-        else {
-            set.addEcd(dip);
-            if (verbose)
-                dip.print(stdout);
-            else {
-                if (set.size() % report_interval == 0)
-                    fprintf(stderr,"%d..",set.size());
-            }
-        }
+        times.append(time);
+        if (times.size() == FIT_BLOCK_SIZE)
+            fit_block(fit,guess,block,times,verbose,report_interval,set);
     }
+    fit_block(fit,guess,block,times,verbose,report_interval,set);
     if (!verbose)
         fprintf(stderr,"[done]\n");
     FREE_CMATRIX(data);
-    FREE(one);
     p_set = set;
     return OK;
 
 bad : {
         FREE_CMATRIX(data);
-        FREE(one);
         return FAIL;
     }
 }
@@ -168,6 +168,20 @@ public:
     static int fit_dipoles_raw(const QString& dataname, MNELIB::MneRawData* raw, mneChSelection sel, DipoleFitData* fit, GuessData* guess, float tmin, float tmax, float tstep, float integ, int verbose);
 
 private:
+    //=========================================================================================================
+    /**
+    * Fit the collected block of time points and add the results to the set
+    *
+    * @param[in] fit                Precomputed fitting data
+    * @param[in] guess              The initial guesses
+    * @param[in] block              The data of the collected time points in the leading columns
+    * @param[in, out] times         The collected time points, cleared on return
+    * @param[in] verbose            Verbose output?
+    * @param[in] report_interval    How often to report the progress
+    * @param[in, out] set           The fitted dipoles are appended here
+    */
+    static void fit_block(DipoleFitData* fit, GuessData* guess, Eigen::MatrixXf& block, QVector<float>& times, int verbose, int report_interval, ECDSet& set);
+
     DipoleFitSettings* settings;
 
 };
@@ -21,6 +21,9 @@
 #include <QFile>
 #include <QCoreApplication>
 #include <QDebug>
+#include <QAtomicInt>
+#include <QThread>
+#include <QtConcurrent>
 
 
 
@@ -212,6 +215,8 @@ void mne_free_dcmatrix_3 (double **m)
 
 #define MIN_3(a,b) ((a) < (b) ? (a) : (b))
 
+#define GUESS_LIMIT_3 0.2       /* (pseudo) radial component omission limit */
+
 
 
 
@@ -3790,6 +3795,8 @@ DipoleFitData::DipoleFitData()
 , funcs (NULL)
 , column_norm (COLUMN_NORM_NONE)
 , fit_mag_dipoles (FALSE)
+, nthreads (0)
+, warm_start (false)
 {
     r0[0] = 0.0f;
     r0[1] = 0.0f;
@@ -4783,35 +4790,13 @@ static int find_best_guess(float     *B,         /* The whitened data */
  * Thanks to the precomputed SVD everything is really simple
  */
 {
-    int    k,c;
-    double B2,Bm2,this_good,one;
-    int    best = -1;
-    float  good = 0.0;
-    DipoleForward* fwd;
-    int    ncomp;
-
-    B2 = mne_dot_vectors_3(B,B,nch);
-    for (k = 0; k < guess->nguess; k++) {
-        fwd = guess->guess_fwd[k];
-        if (fwd->nch == nch) {
-            ncomp = fwd->sing[2]/fwd->sing[0] > limit ? 3 : 2;
-            for (c = 0, Bm2 = 0.0; c < ncomp; c++) {
-                one = mne_dot_vectors_3(fwd->uu[c],B,nch);
-                Bm2 = Bm2 + one*one;
-            }
-            this_good = 1.0 - (B2 - Bm2)/B2;
-            if (this_good > good) {
-                best = k;
-                good = this_good;
-            }
-        }
-    }
-    if (best < 0) {
-        printf("No reasonable initial guess found.");
+    VectorXi best;
+    VectorXf good;
+
+    if (!guess->find_best_guesses(Map<MatrixXf>(B,nch,1),limit,best,good))
         return FAIL;
-    }
-    *bestp = best;
-    *goodp = good;
+    *bestp = best[0];
+    *goodp = good[0];
     return OK;
 }
 
@@ -5119,10 +5104,52 @@ bool DipoleFitData::fit_one(DipoleFitData* fit,	            /* Precomputed fitti
                     int           verbose,
                     ECD&          res               /* The fitted dipole */
                     )
+{
+    int   best;
+    float good;
+
+    if (!project_and_whiten(fit,B))
+        return false;
+    /*
+   * Get the initial guess
+   */
+    if (find_best_guess(B,fit->nmeg+fit->neeg,guess,GUESS_LIMIT_3,&best,&good) < 0)
+        return false;
+
+    return fit_one(fit,guess,time,B,best,verbose,res);
+}
+
+
+//*************************************************************************************************************
+
+bool DipoleFitData::fit_one(DipoleFitData* fit,	            /* Precomputed fitting data */
+                    GuessData*     guess,	            /* The initial guesses */
+                    float         time,              /* Which time is it? */
+                    float         *B,	            /* The field to fit (projected and whitened) */
+                    int           best,              /* The initial guess */
+                    int           verbose,
+                    ECD&          res               /* The fitted dipole */
+                    )
+{
+    if (best < 0 || best >= guess->nguess)
+        return false;
+    return fit_one(fit,guess->rr[best],time,B,verbose,res);
+}
+
+
+//*************************************************************************************************************
+
+bool DipoleFitData::fit_one(DipoleFitData* fit,	            /* Precomputed fitting data */
+                    const float   *rd_start,         /* Where to start the simplex */
+                    float         time,              /* Which time is it? */
+                    float         *B,	            /* The field to fit (projected and whitened) */
+                    int           verbose,
+                    ECD&          res               /* The fitted dipole */
+                    )
 {
     float  **simplex       = NULL;	       /* The simplex */
     float  vals[4];			       /* Values at the vertices */
-    float  limit           = 0.2;	               /* (pseudo) radial component omission limit */
+    float  limit           = GUESS_LIMIT_3;	       /* (pseudo) radial component omission limit */
     float  size            = 1e-2;	       /* Size of the initial simplex */
     float  ftol[]          = { 1e-2, 1e-2 };     /* Tolerances on the the two passes */
     float  atol[]          = { 0.2e-3, 0.2e-3 }; /* If dipole movement between two iterations is less than this,
@@ -5131,8 +5158,7 @@ bool DipoleFitData::fit_one(DipoleFitData* fit,	            /* Precomputed fitti
     int    max_eval        = 1000;	       /* Limit for fit function evaluations */
     int    report_interval = verbose ? 1 : -1;   /* How often to report the intermediate result */
 
-    int        best;
-    float      good,rd_guess[3],rd_final[3],Q[3],final_val;
+    float      rd_guess[3],rd_final[3],Q[3],final_val;
     fitDipUserRec user;
     int        k,p,neval,neval_tot,nchan,ncomp;
     int        fit_fail;
@@ -5140,18 +5166,6 @@ bool DipoleFitData::fit_one(DipoleFitData* fit,	            /* Precomputed fitti
     nchan = fit->nmeg+fit->neeg;
     user.fwd = NULL;
 
-    if (MneProjOp::mne_proj_op_proj_vector(fit->proj,B,nchan,TRUE) == FAIL)
-        goto bad;
-
-    if (mne_whiten_one_data(B,B,nchan,fit->noise) == FAIL)
-        goto bad;
-    /*
-   * Get the initial guess
-   */
-    if (find_best_guess(B,nchan,guess,limit,&best,&good) < 0)
-        goto bad;
-
-
     user.limit = limit;
     user.B     = B;
     user.B2    = mne_dot_vectors_3(B,B,nchan);
@@ -5159,8 +5173,8 @@ bool DipoleFitData::fit_one(DipoleFitData* fit,	            /* Precomputed fitti
     user.report_dim = FALSE;
     fit->user  = &user;
 
-    VEC_COPY_3(rd_guess,guess->rr[best]);
-    VEC_COPY_3(rd_final,guess->rr[best]);
+    VEC_COPY_3(rd_guess,rd_start);
+    VEC_COPY_3(rd_final,rd_start);
 
     neval_tot = 0;
     fit_fail = FALSE;
@@ -5240,6 +5254,254 @@ bad : {
 }
 
 
+//*************************************************************************************************************
+
+#define FIT_CHUNK_3 16      /* Time points fitted in sequence as one task. Warm starts do not cross chunk boundaries. */
+
+/*
+ * A range of time points within a block fitted as one task
+ */
+typedef struct {
+    int from;       /* First time point of the range */
+    int to;         /* One past the last time point of the range */
+} fitChunk_3;
+
+/*
+ * One worker of the parallel fit, takes chunks from the shared queue until it is empty
+ */
+typedef struct {
+    DipoleFitData               *fit;       /* Private copy of the fitting data (workspace) */
+    GuessData                   *guess;     /* The initial guesses */
+    const QVector<float>        *times;     /* The time points */
+    MatrixXf                    *B;         /* The projected and whitened data */
+    const QVector<bool>         *ready;     /* Could the data be projected and whitened? */
+    const VectorXi              *best;      /* The best initial guesses */
+    ECD                         *res;       /* The results, one per time point */
+    int                         verbose;
+    const QList<fitChunk_3>     *chunks;    /* The shared queue */
+    QAtomicInt                  *next;      /* Index of the next chunk to take */
+} fitWorker_3;
+
+
+static dipoleFitFuncs dup_dipole_fit_funcs(dipoleFitFuncs f, DipoleFitData* orig, DipoleFitData* dup)
+/*
+ * Duplicate the forward functions for one thread.
+ * The MEG client is always compensated field computation data, its workspace is made private.
+ */
+{
+    dipoleFitFuncs res;
+    FwdCompData*   comp;
+
+    if (!f)
+        return NULL;
+    res = new_dipole_fit_funcs();
+    *res = *f;
+    res->meg_client_free = NULL;
+    res->eeg_client_free = NULL;
+    if (f->meg_client) {
+        res->meg_client = comp = new FwdCompData;
+        *comp = *((FwdCompData*)f->meg_client);
+        comp->work     = NULL;
+        comp->vec_work = NULL;
+        comp->set      = comp->set ? new MneCTFCompDataSet(*(comp->set)) : NULL;
+    }
+    if (f->eeg_client && f->eeg_client == orig->eeg_model)
+        res->eeg_client = dup->eeg_model;
+    return res;
+}
+
+
+static void free_dup_dipole_fit_funcs(dipoleFitFuncs f)
+
+{
+    FwdCompData* comp;
+
+    if (!f)
+        return;
+    if ((comp = (FwdCompData*)f->meg_client) != NULL) {
+        comp->comp_coils  = NULL;       /* These are shared with the original */
+        comp->client      = NULL;
+        comp->client_free = NULL;
+        delete comp;
+    }
+    FREE_3(f);
+}
+
+
+static DipoleFitData* create_fit_thread_duplicate(DipoleFitData* fit)
+/*
+ * Create a duplicate to make the fitting thread safe
+ * Do not duplicate read-only parts of the relevant structures
+ */
+{
+    DipoleFitData* res = new DipoleFitData;
+
+    *res = *fit;
+    res->user      = NULL;
+    res->user_free = NULL;
+    /*
+     * The EEG sphere model computes its expansion coefficients on first use
+     */
+    res->eeg_model = fit->eeg_model ? new FwdEegSphereModel(*(fit->eeg_model)) : NULL;
+
+    res->sphere_funcs     = dup_dipole_fit_funcs(fit->sphere_funcs,fit,res);
+    res->bem_funcs        = dup_dipole_fit_funcs(fit->bem_funcs,fit,res);
+    res->mag_dipole_funcs = dup_dipole_fit_funcs(fit->mag_dipole_funcs,fit,res);
+    if (fit->funcs == fit->bem_funcs)
+        res->funcs = res->bem_funcs;
+    else if (fit->funcs == fit->mag_dipole_funcs)
+        res->funcs = res->mag_dipole_funcs;
+    else
+        res->funcs = res->sphere_funcs;
+    return res;
+}
+
+
+static void free_fit_thread_duplicate(DipoleFitData* one)
+
+{
+    if (!one)
+        return;
+    free_dup_dipole_fit_funcs(one->sphere_funcs);
+    free_dup_dipole_fit_funcs(one->bem_funcs);
+    free_dup_dipole_fit_funcs(one->mag_dipole_funcs);
+    one->sphere_funcs = one->bem_funcs = one->mag_dipole_funcs = one->funcs = NULL;
+    /*
+     * Everything else but the EEG sphere model is shared with the original
+     */
+    one->mri_head_t = NULL;
+    one->meg_head_t = NULL;
+    one->chs        = NULL;
+    one->meg_coils  = NULL;
+    one->eeg_els    = NULL;
+    one->pick       = NULL;
+    one->bem_model  = NULL;
+    one->noise      = NULL;
+    one->noise_orig = NULL;
+    one->proj       = NULL;
+    delete one;
+}
+
+
+static void fit_range(DipoleFitData* fit, GuessData* guess, const QVector<float>& times, MatrixXf& B,
+                      const QVector<bool>& ready, const VectorXi& best, int from, int to, int verbose, ECD *res)
+/*
+ * Fit the time points from...to-1 in sequence. With warm starts each fit begins
+ * from the preceding solution in the range instead of the best initial guess.
+ */
+{
+    float rd_prev[3];
+    int   have_prev = FALSE;
+    int   t;
+
+    for (t = from; t < to; t++) {
+        if (!ready[t] || best[t] < 0) {
+            have_prev = FALSE;
+            continue;
+        }
+        if (fit->warm_start && have_prev) {
+            if (!DipoleFitData::fit_one(fit,rd_prev,times[t],B.col(t).data(),verbose,res[t]))
+                res[t].valid = false;
+        }
+        else if (!DipoleFitData::fit_one(fit,guess,times[t],B.col(t).data(),best[t],verbose,res[t]))
+            res[t].valid = false;
+        if ((have_prev = res[t].valid))
+            VEC_COPY_3(rd_prev,res[t].rd);
+    }
+}
+
+
+static void fit_worker(fitWorker_3& w)
+{
+    int c;
+
+    while ((c = w.next->fetchAndAddOrdered(1)) < w.chunks->size()) {
+        const fitChunk_3& chunk = w.chunks->at(c);
+        fit_range(w.fit,w.guess,*w.times,*w.B,*w.ready,*w.best,chunk.from,chunk.to,w.verbose,w.res);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void DipoleFitData::fit_block(DipoleFitData* fit, GuessData* guess, const QVector<float>& times, MatrixXf& B, int verbose, QList<ECD>& res)
+{
+    QVector<bool>     ready(B.cols());
+    QVector<ECD>      dips(B.cols());
+    QList<fitChunk_3> chunks;
+    VectorXi best;
+    VectorXf good;
+    int      nthread = fit->nthreads > 0 ? fit->nthreads : QThread::idealThreadCount();
+    int      nworker,t,k;
+
+    res.clear();
+    for (t = 0; t < B.cols(); t++)
+        ready[t] = project_and_whiten(fit,B.col(t).data());
+    /*
+   * Initial guesses for all time points in one pass
+   */
+    guess->find_best_guesses(B,GUESS_LIMIT_3,best,good);
+    /*
+   * The chunks do not depend on the number of threads so that neither do the warm starts
+   */
+    for (t = 0; t < B.cols(); t += FIT_CHUNK_3) {
+        fitChunk_3 one;
+        one.from = t;
+        one.to   = qMin(t + FIT_CHUNK_3,(int)B.cols());
+        chunks.append(one);
+    }
+    nworker = qMin(nthread,chunks.size());
+    /*
+   * Verbose output from several threads would be interleaved
+   */
+    if (nworker < 2 || verbose) {
+        for (k = 0; k < chunks.size(); k++)
+            fit_range(fit,guess,times,B,ready,best,chunks[k].from,chunks[k].to,verbose,dips.data());
+    }
+    else {
+        QList<fitWorker_3> workers;
+        QAtomicInt         next(0);
+        /*
+     * The coils, the BEM, the noise covariance and the projection are shared,
+     * only the forward computation workspace is duplicated for each worker
+     */
+        for (k = 0; k < nworker; k++) {
+            fitWorker_3 w;
+            w.fit     = create_fit_thread_duplicate(fit);
+            w.guess   = guess;
+            w.times   = &times;
+            w.B       = &B;
+            w.ready   = &ready;
+            w.best    = &best;
+            w.res     = dips.data();
+            w.verbose = verbose;
+            w.chunks  = &chunks;
+            w.next    = &next;
+            workers.append(w);
+        }
+        QtConcurrent::blockingMap(workers, fit_worker);
+        for (k = 0; k < workers.size(); k++)
+            free_fit_thread_duplicate(workers[k].fit);
+    }
+    for (t = 0; t < dips.size(); t++)
+        res.append(dips[t]);
+}
+
+
+//*************************************************************************************************************
+
+bool DipoleFitData::project_and_whiten(DipoleFitData* fit, float *B)
+{
+    int nchan = fit->nmeg+fit->neeg;
+
+    if (MneProjOp::mne_proj_op_proj_vector(fit->proj,B,nchan,TRUE) == FAIL)
+        return false;
+    if (mne_whiten_one_data(B,B,nchan,fit->noise) == FAIL)
+        return false;
+    return true;
+}
+
+
 
 
 
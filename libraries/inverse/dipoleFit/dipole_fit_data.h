@@ -65,6 +65,8 @@
 //=============================================================================================================
 
 #include <QSharedPointer>
+#include <QList>
+#include <QVector>
 
 // ToDo move to cpp
 #define COLUMN_NORM_NONE 0	    /* No column normalization requested */
@@ -214,6 +216,60 @@ public:
     */
     static bool fit_one(DipoleFitData* fit, GuessData* guess, float time, float *B, int verbose, ECD& res);
 
+    //=========================================================================================================
+    /**
+    * Fit a single dipole starting from a given initial guess
+    *
+    * @param[in] fit        Precomputed fitting data
+    * @param[in] guess      The initial guesses
+    * @param[in] time       Which time is it?
+    * @param[in] B          The field to fit, already projected and whitened
+    * @param[in] best       Index of the initial guess to start from
+    * @param[in] verbose
+    * @param[in] res        The fitted dipole
+    */
+    static bool fit_one(DipoleFitData* fit, GuessData* guess, float time, float *B, int best, int verbose, ECD& res);
+
+    //=========================================================================================================
+    /**
+    * Fit a single dipole starting from a given location
+    *
+    * @param[in] fit        Precomputed fitting data
+    * @param[in] rd_start   The location to start the simplex from
+    * @param[in] time       Which time is it?
+    * @param[in] B          The field to fit, already projected and whitened
+    * @param[in] verbose
+    * @param[in] res        The fitted dipole
+    */
+    static bool fit_one(DipoleFitData* fit, const float *rd_start, float time, float *B, int verbose, ECD& res);
+
+    //=========================================================================================================
+    /**
+    * Fit dipoles to a block of time points. The data are projected and whitened and the initial guesses
+    * for all time points are found in one pass before the individual fits. The fits run in parallel on
+    * nthreads threads, each with a private copy of the forward computation workspace. The results do not
+    * depend on the number of threads.
+    *
+    * @param[in] fit        Precomputed fitting data
+    * @param[in] guess      The initial guesses
+    * @param[in] times      The time points
+    * @param[in, out] B     The fields to fit, one time point per column. Projected and whitened on return.
+    * @param[in] verbose
+    * @param[out] res       The fitted dipoles, one per time point. Failed fits are marked as not valid.
+    */
+    static void fit_block(DipoleFitData* fit, GuessData* guess, const QVector<float>& times, Eigen::MatrixXf& B, int verbose, QList<ECD>& res);
+
+    //=========================================================================================================
+    /**
+    * Apply the projection and the noise whitening to the data of one time point
+    *
+    * @param[in] fit        Precomputed fitting data
+    * @param[in, out] B     The field, projected and whitened on return
+    *
+    * @return true when successful
+    */
+    static bool project_and_whiten(DipoleFitData* fit, float *B);
+
 
 
 //============================= dipole_forward.c
@@ -261,6 +317,8 @@ public:
       MNELIB::MneProjOp*        proj;               /**< The projection operator to use */
       int               column_norm;        /**< What kind of column normalization to apply to the forward solution */
       int               fit_mag_dipoles;    /**< Fit magnetic dipoles? */
+      int               nthreads;           /**< Number of threads to fit with (0 = number of processors) */
+      bool              warm_start;         /**< Start each fit from the solution at the preceding time point? */
       void              *user;              /**< User data for anything we need */
       fitUserFreeFunc   user_free;          /**< Function to free the above */
 
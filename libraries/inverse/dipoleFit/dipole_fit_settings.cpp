@@ -237,6 +237,8 @@ void DipoleFitSettings::usage(char *name)
     printf("\t--mindist dist/mm Exclude points which are closer than this distance from the inner skull surface  (default = %6.1f mm).\n",1000*guess_mindist);
     printf("\t--grid    dist/mm Source space grid size (default = %6.1f mm).\n",1000*guess_grid);
     printf("\t--magdip          Fit magnetic dipoles instead of current dipoles.\n");
+    printf("\t--warmstart       Start each fit from the solution at the preceding time point instead of the best initial guess.\n");
+    printf("\t--threads n       number of threads to use in the fitting (default : number of cores)\n");
     printf("\nOutput:\n\n");
     printf("\t--dip     name    xfit dip format output file name\n");
     printf("\t--bdip    name    xfit bdip format output file name\n");
@@ -783,6 +785,23 @@ bool DipoleFitSettings::check_args (int *argc,char **argv)
             found = 1;
             fit_mag_dipoles = true;
         }
+        else if (strcmp(argv[k],"--warmstart") == 0) {
+            found = 1;
+            warm_start = true;
+        }
+        else if (strcmp(argv[k],"--threads") == 0) {
+            found = 2;
+            if (k == *argc - 1) {
+                qCritical ("--threads: argument required.");
+                return false;
+            }
+            if (sscanf(argv[k+1],"%d",&nthreads) != 1) {
+                qCritical() << "Illegal number:" << argv[k+1];
+                return false;
+            }
+            if (nthreads < 0)
+                nthreads = 0;
+        }
         else if (strcmp(argv[k],"--dip") == 0) {
             found = 2;
             if (k == *argc - 1) {
@@ -179,6 +179,8 @@ public:
     bool    scale_eeg_pos  = false;     /**< Scale the electrode locations to scalp in the sphere model */
     float  mag_reg      = 0.1f;         /**< Noise-covariance matrix regularization for MEG (magnetometers and axial gradiometers)  */
     bool   fit_mag_dipoles = false;
+    int    nthreads     = 0;            /**< Number of threads to fit with, 0 selects QThread::idealThreadCount() */
+    bool   warm_start   = false;        /**< Start each fit from the solution at the preceding time point */
 
     float  grad_reg     = 0.1f;         /**< Noise-covariance matrix regularization for EEG (planar gradiometers) */
     float  eeg_reg      = 0.1f;         /**< Noise-covariance matrix regularization for EEG  */
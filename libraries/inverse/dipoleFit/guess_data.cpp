@@ -294,6 +294,7 @@ GuessData::GuessData(const QString &guessname, const QString &guess_surfname, fl
 #endif
     }
     f->funcs = orig;
+    pack_guess_fields();
 
     fprintf(stderr,"[done %d sources]\n",p);
 
@@ -460,7 +461,70 @@ bool GuessData::compute_guess_fields(DipoleFitData* f)
 #endif
     }
     f->funcs = orig;
+    pack_guess_fields();
     printf("[done %d sources]\n",this->nguess);
 
     return true;
 }
+
+
+//*************************************************************************************************************
+
+bool GuessData::find_best_guesses(const MatrixXf& B, float limit, VectorXi& best, VectorXf& good) const
+{
+    int k,t;
+    bool found = true;
+
+    best = VectorXi::Constant(B.cols(),-1);
+    good = VectorXf::Zero(B.cols());
+
+    if (this->nguess == 0 || guess_uu.rows() != B.rows()) {
+        printf("No reasonable initial guess found.");
+        return false;
+    }
+    /*
+     * Projections onto the singular vectors of all guesses for all time points
+     */
+    MatrixXd Bd = B.cast<double>();
+    ArrayXXd proj = (guess_uu.transpose()*Bd).array().square();
+    VectorXd B2 = Bd.colwise().squaredNorm().transpose();
+    /*
+     * Signal power explained by each guess, the pseudoradial component is omitted if it is too small
+     */
+    MatrixXd Bm2(this->nguess,B.cols());
+    for (k = 0; k < this->nguess; k++) {
+        Bm2.row(k) = proj.row(3*k) + proj.row(3*k+1);
+        if (guess_sing_ratio[k] > limit)
+            Bm2.row(k) += proj.row(3*k+2).matrix();
+    }
+    for (t = 0; t < B.cols(); t++) {
+        int k_max;
+        double max_good = 1.0 - (B2[t] - Bm2.col(t).maxCoeff(&k_max))/B2[t];
+        if (max_good > 0.0) {
+            best[t] = k_max;
+            good[t] = max_good;
+        }
+        else
+            found = false;
+    }
+    if (!found)
+        printf("No reasonable initial guess found.");
+    return found;
+}
+
+
+//*************************************************************************************************************
+
+void GuessData::pack_guess_fields()
+{
+    int nch = (this->nguess > 0 && this->guess_fwd[0]) ? this->guess_fwd[0]->nch : 0;
+
+    guess_uu.resize(nch,3*this->nguess);
+    guess_sing_ratio.resize(this->nguess);
+    for (int k = 0; k < this->nguess; k++) {
+        DipoleForward* fwd = this->guess_fwd[k];
+        for (int c = 0; c < 3; c++)
+            guess_uu.col(3*k+c) = Map<VectorXf>(fwd->uu[c],nch).cast<double>();
+        guess_sing_ratio[k] = fwd->sing[2]/fwd->sing[0];
+    }
+}
@@ -144,11 +144,36 @@ public:
     */
     bool compute_guess_fields(DipoleFitData* f);
 
+    //=========================================================================================================
+    /**
+    * Scores all guesses for a block of time points at once and picks the best one for each time point.
+    * The projections of the data onto the singular vectors of all guesses are obtained with a single
+    * matrix product followed by a column-wise arg-max.
+    *
+    * @param[in] B      The projected and whitened data, one time point per column.
+    * @param[in] limit  Pseudoradial component omission limit.
+    * @param[out] best  The index of the best guess for each time point, -1 if no reasonable guess was found.
+    * @param[out] good  The goodness of fit of the best guess for each time point.
+    *
+    * @return true when a reasonable guess was found for all time points.
+    */
+    bool find_best_guesses(const Eigen::MatrixXf& B, float limit, Eigen::VectorXi& best, Eigen::VectorXf& good) const;
+
+private:
+    //=========================================================================================================
+    /**
+    * Packs the left singular vectors of all guess forward solutions into one contiguous matrix.
+    */
+    void pack_guess_fields();
+
 public:
     float          **rr;            /**< These are the guess dipole locations */
     DipoleForward** guess_fwd;      /**< Forward solutions for the guesses */
     int            nguess;          /**< How many sources */
 
+    Eigen::MatrixXd guess_uu;       /**< The left singular vectors of all guesses, three consecutive columns per guess */
+    Eigen::VectorXd guess_sing_ratio;   /**< Ratio of the smallest to the largest singular value of each guess */
+
 // ### OLD STRUCT ###
 //    typedef struct {
 //        float          **rr;                    /**< These are the guess dipole locations */
@@ -0,0 +1,399 @@
+//=============================================================================================================
+/**
+* @file     hpifitter.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    HPIFitter class defintion.
+*
+*/
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "hpifitter.h"
+
+#include <fiff/fiff_info.h>
+#include <fiff/fiff_dig_point_set.h>
+
+#include <utils/mnemath.h>
+
+#include <iostream>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Dense>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QElapsedTimer>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace Eigen;
+using namespace INVERSELIB;
+using namespace FIFFLIB;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+HPIFitter::HPIFitter(FiffInfo::SPtr pFiffInfo)
+: m_pFiffInfo(pFiffInfo)
+, m_bModelValid(false)
+, m_iNumChannels(0)
+, m_dSFreq(0.0)
+, m_iNumSamples(0)
+, m_iNumCoils(0)
+, m_bWarmStart(true)
+, m_dWarmStartMaxError(0.1)
+, m_bHasLastFit(false)
+{
+    m_timing.dSetup = 0.0;
+    m_timing.dDemod = 0.0;
+    m_timing.dDipfit = 0.0;
+    m_timing.dTrans = 0.0;
+    m_timing.dTotal = 0.0;
+}
+
+
+//*************************************************************************************************************
+
+bool HPIFitter::fit(const MatrixXd& t_mat,
+                    const MatrixXd& t_matProjectors,
+                    FiffCoordTrans& transDevHead,
+                    const QVector<int>& vFreqs,
+                    QVector<double>& vGof,
+                    FiffDigPointSet& fittedPointSet)
+{
+    vGof.clear();
+    fittedPointSet.clear();
+
+    //Check if data was passed
+    if(t_mat.rows() == 0 || t_mat.cols() == 0 ) {
+        std::cout<<std::endl<< "HPIFitter::fit - No data passed. Returning.";
+        return false;
+    }
+
+    //Check if projector was passed
+    if(t_matProjectors.rows() != t_mat.rows() || t_matProjectors.cols() != t_mat.rows()) {
+        std::cout<<std::endl<< "HPIFitter::fit - Projector does not match the data. Returning.";
+        return false;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    qint64 iLast = 0;
+    qint64 iNow = 0;
+
+    m_timing.dSetup = 0.0;
+
+    if(!updateModel(t_matProjectors, vFreqs, t_mat.cols())) {
+        return false;
+    }
+
+    iNow = timer.nsecsElapsed();
+    m_timing.dSetup = (iNow - iLast) / 1.0e6;
+    iLast = iNow;
+
+    //Demodulate all channels with one product and keep the good inner ones
+    MatrixXd topoAll = t_mat * m_matDemod;              // # of channels x 2*numCoils
+    MatrixXd amp(m_vInnerInd.size(), m_iNumCoils);
+
+    for(int j = 0; j < m_iNumCoils; ++j) {
+        double nS = 0.0;
+        double nC = 0.0;
+        for(int i = 0; i < m_vInnerInd.size(); ++i) {
+            nS += topoAll(m_vInnerInd.at(i),j) * topoAll(m_vInnerInd.at(i),j);
+            nC += topoAll(m_vInnerInd.at(i),j+m_iNumCoils) * topoAll(m_vInnerInd.at(i),j+m_iNumCoils);
+        }
+
+        // Select sine or cosine component depending on the relative size
+        int iCol = nC > nS ? j + m_iNumCoils : j;
+        for(int i = 0; i < m_vInnerInd.size(); ++i) {
+            amp(i,j) = topoAll(m_vInnerInd.at(i),iCol);
+        }
+    }
+
+    iNow = timer.nsecsElapsed();
+    m_timing.dDemod = (iNow - iLast) / 1.0e6;
+    iLast = iNow;
+
+    //Start from the previous positions of the coils which were fitted well, seed all others
+    struct CoilParam coil;
+    coil.pos = MatrixXd::Zero(m_iNumCoils,3);
+    coil.mom = MatrixXd::Zero(m_iNumCoils,3);
+    coil.dpfiterror = VectorXd::Zero(m_iNumCoils);
+    coil.dpfitnumitr = VectorXd::Zero(m_iNumCoils);
+
+    for(int j = 0; j < m_iNumCoils; ++j) {
+        if(m_bWarmStart && m_bHasLastFit && m_lastCoil.dpfiterror(j) < m_dWarmStartMaxError) {
+            coil.pos.row(j) = m_lastCoil.pos.row(j);
+        } else {
+            coil.pos.row(j) = seedPosition(amp, j);
+        }
+    }
+
+    coil = dipfit(coil, m_sensors, amp, m_iNumCoils, m_matProjInner);
+
+    m_lastCoil = coil;
+    m_bHasLastFit = true;
+
+    iNow = timer.nsecsElapsed();
+    m_timing.dDipfit = (iNow - iLast) / 1.0e6;
+    iLast = iNow;
+
+    Matrix4d trans = computeTransformation(m_matHeadHPI, coil.pos);
+
+    // Set final device/head matrix and its inverse
+    transDevHead.from = 1;
+    transDevHead.to = 4;
+
+    for(int r = 0; r < 4; ++r) {
+        for(int c = 0; c < 4 ; ++c) {
+            transDevHead.trans(r,c) = trans(r,c);
+        }
+    }
+
+    transDevHead.invtrans = transDevHead.trans.inverse();
+
+    //Calculate GOF
+    MatrixXd temp(4, m_iNumCoils);
+    temp.topRows(3) = coil.pos.transpose();
+    temp.row(3).setOnes();
+
+    MatrixXd testPos = trans * temp;
+    MatrixXd diffPos = testPos.topRows(3) - m_matHeadHPI.transpose();
+
+    for(int i = 0; i < diffPos.cols(); ++i) {
+        vGof.append(diffPos.col(i).norm());
+    }
+
+    //Generate final fitted points and store in digitizer set
+    for(int i = 0; i < coil.pos.rows(); ++i) {
+        FiffDigPoint digPoint;
+        digPoint.kind = FIFFV_POINT_EEG;
+        digPoint.ident = i;
+        digPoint.r[0] = coil.pos(i,0);
+        digPoint.r[1] = coil.pos(i,1);
+        digPoint.r[2] = coil.pos(i,2);
+
+        fittedPointSet << digPoint;
+    }
+
+    iNow = timer.nsecsElapsed();
+    m_timing.dTrans = (iNow - iLast) / 1.0e6;
+    m_timing.dTotal = iNow / 1.0e6;
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+void HPIFitter::reset()
+{
+    m_bModelValid = false;
+    m_bHasLastFit = false;
+}
+
+
+//*************************************************************************************************************
+
+void HPIFitter::setWarmStart(bool bWarmStart, double dMaxError)
+{
+    m_bWarmStart = bWarmStart;
+    m_dWarmStartMaxError = dMaxError;
+}
+
+
+//*************************************************************************************************************
+
+bool HPIFitter::updateModel(const MatrixXd& t_matProjectors,
+                            const QVector<int>& vFreqs,
+                            int iNumSamples)
+{
+    if(!m_pFiffInfo) {
+        std::cout<<std::endl<< "HPIFitter::updateModel - No measurement info set. Returning.";
+        return false;
+    }
+
+    if(m_bModelValid
+            && m_iNumChannels == m_pFiffInfo->nchan
+            && m_dSFreq == m_pFiffInfo->sfreq
+            && m_iNumSamples == iNumSamples
+            && m_lBads == m_pFiffInfo->bads
+            && m_vFreqs == vFreqs
+            && m_matProjectors.rows() == t_matProjectors.rows()
+            && m_matProjectors.cols() == t_matProjectors.cols()
+            && m_matProjectors == t_matProjectors) {
+        return true;
+    }
+
+    //A changed channel setup invalidates the previous positions as starting points
+    if(m_iNumChannels != m_pFiffInfo->nchan || m_lBads != m_pFiffInfo->bads) {
+        m_bHasLastFit = false;
+    }
+
+    m_bModelValid = false;
+    m_iNumChannels = m_pFiffInfo->nchan;
+    m_dSFreq = m_pFiffInfo->sfreq;
+    m_iNumSamples = iNumSamples;
+    m_lBads = m_pFiffInfo->bads;
+    m_vFreqs = vFreqs;
+    m_matProjectors = t_matProjectors;
+
+    //Get HPI coils from digitizers and set number of coils
+    QList<FiffDigPoint> lHPIPoints;
+
+    for(int i = 0; i < m_pFiffInfo->dig.size(); ++i) {
+        if(m_pFiffInfo->dig[i].kind == FIFFV_POINT_HPI) {
+            lHPIPoints.append(m_pFiffInfo->dig[i]);
+        }
+    }
+
+    if(m_iNumCoils != lHPIPoints.size()) {
+        m_bHasLastFit = false;
+    }
+
+    m_iNumCoils = lHPIPoints.size();
+
+    if(m_iNumCoils == 0) {
+        std::cout<<std::endl<< "HPIFitter::updateModel - No HPI coils digitized. Returning.";
+        return false;
+    }
+
+    if(vFreqs.size() < m_iNumCoils) {
+        std::cout<<std::endl<< "HPIFitter::updateModel - Not enough coil frequencies specified. Returning.";
+        return false;
+    }
+
+    // Create digitized HPI coil position matrix
+    m_matHeadHPI.resize(m_iNumCoils,3);
+
+    for (int i = 0; i < m_iNumCoils; ++i) {
+        m_matHeadHPI(i,0) = lHPIPoints.at(i).r[0];
+        m_matHeadHPI(i,1) = lHPIPoints.at(i).r[1];
+        m_matHeadHPI(i,2) = lHPIPoints.at(i).r[2];
+    }
+
+    // Get the indices of inner layer channels and exclude bad channels.
+    //TODO: Only supports babymeg and vectorview gradiometeres for hpi fitting.
+    m_vInnerInd.clear();
+
+    for (int i = 0; i < m_iNumChannels; ++i) {
+        if(m_pFiffInfo->chs[i].chpos.coil_type == FIFFV_COIL_BABY_MAG ||
+                m_pFiffInfo->chs[i].chpos.coil_type == FIFFV_COIL_VV_PLANAR_T1 ||
+                m_pFiffInfo->chs[i].chpos.coil_type == FIFFV_COIL_VV_PLANAR_T2 ||
+                m_pFiffInfo->chs[i].chpos.coil_type == FIFFV_COIL_VV_PLANAR_T3) {
+            if(!(m_pFiffInfo->bads.contains(m_pFiffInfo->ch_names.at(i)))) {
+                m_vInnerInd.append(i);
+            }
+        }
+    }
+
+    if(m_vInnerInd.isEmpty()) {
+        std::cout<<std::endl<< "HPIFitter::updateModel - No good inner layer channels found. Returning.";
+        return false;
+    }
+
+    //Restrict the projectors to the inner channels
+    m_matProjInner.resize(m_vInnerInd.size(), m_vInnerInd.size());
+
+    for (int c = 0; c < m_vInnerInd.size(); ++c) {
+        for (int r = 0; r < m_vInnerInd.size(); ++r) {
+            m_matProjInner(r,c) = t_matProjectors(m_vInnerInd.at(r), m_vInnerInd.at(c));
+        }
+    }
+
+    // Initialize inner layer sensors
+    m_sensors.coilpos = MatrixXd::Zero(m_vInnerInd.size(),3);
+    m_sensors.coilori = MatrixXd::Zero(m_vInnerInd.size(),3);
+    m_sensors.tra = MatrixXd::Identity(m_vInnerInd.size(),m_vInnerInd.size());
+
+    for(int i = 0; i < m_vInnerInd.size(); i++) {
+        m_sensors.coilpos(i,0) = m_pFiffInfo->chs[m_vInnerInd.at(i)].chpos.r0[0];
+        m_sensors.coilpos(i,1) = m_pFiffInfo->chs[m_vInnerInd.at(i)].chpos.r0[1];
+        m_sensors.coilpos(i,2) = m_pFiffInfo->chs[m_vInnerInd.at(i)].chpos.r0[2];
+        m_sensors.coilori(i,0) = m_pFiffInfo->chs[m_vInnerInd.at(i)].chpos.ez[0];
+        m_sensors.coilori(i,1) = m_pFiffInfo->chs[m_vInnerInd.at(i)].chpos.ez[1];
+        m_sensors.coilori(i,2) = m_pFiffInfo->chs[m_vInnerInd.at(i)].chpos.ez[2];
+    }
+
+    // Generate the sin/cos reference signals and store the demodulation operator, so that the least
+    // squares amplitudes of a block are a single product data * m_matDemod
+    MatrixXd simsig(iNumSamples, m_iNumCoils*2);
+
+    for(int i = 0; i < m_iNumCoils; ++i) {
+        for(int j = 0; j < iNumSamples; ++j) {
+            double t = j*1.0/m_dSFreq;
+            simsig(j,i) = sin(2*M_PI*vFreqs.at(i)*t);
+            simsig(j,i+m_iNumCoils) = cos(2*M_PI*vFreqs.at(i)*t);
+        }
+    }
+
+    m_matDemod = UTILSLIB::MNEMath::pinv(simsig).transpose();
+
+    m_bModelValid = true;
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+RowVector3d HPIFitter::seedPosition(const MatrixXd& amp, int iCoil) const
+{
+    //Find biggest amplitude and project the corresponding sensor position 3cm inwards
+    int iMax = 0;
+    amp.col(iCoil).cwiseAbs().maxCoeff(&iMax);
+
+    const FiffChInfo& chInfo = m_pFiffInfo->chs.at(m_vInnerInd.at(iMax));
+
+    RowVector3d pos;
+    for(int k = 0; k < 3; ++k) {
+        pos(k) = -1 * chInfo.chpos.ez[k] * 0.03 + chInfo.chpos.r0[k];
+    }
+
+    return pos;
+}
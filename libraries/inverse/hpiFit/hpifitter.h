@@ -0,0 +1,265 @@
+//=============================================================================================================
+/**
+* @file     hpifitter.h
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    HPIFitter class declaration.
+*
+*/
+
+#ifndef HPIFITTER_H
+#define HPIFITTER_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../inverse_global.h"
+#include "hpifit.h"
+#include "hpifitdata.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// EIGEN INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+#include <QStringList>
+#include <QVector>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// FORWARD DECLARATIONS
+//=============================================================================================================
+
+namespace FIFFLIB{
+    class FiffInfo;
+    class FiffCoordTrans;
+    class FiffDigPointSet;
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE INVERSELIB
+//=============================================================================================================
+
+namespace INVERSELIB
+{
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Declare all structures to be used
+//=============================================================================================================
+/**
+* The struct holding the wall clock times of the last fit in milliseconds.
+*/
+struct HPIFitterTiming {
+    double dSetup;      /**< Time spent rebuilding the cached sensor model. Zero if the cache was reused. */
+    double dDemod;      /**< Time spent demodulating the coil amplitudes. */
+    double dDipfit;     /**< Time spent fitting the coil dipoles. */
+    double dTrans;      /**< Time spent computing the dev/head transformation and the GOF. */
+    double dTotal;      /**< Total time of the fit. */
+};
+
+
+//=============================================================================================================
+/**
+* Stateful HPI fitter for continuous head position estimation. Everything which only depends on the
+* measurement info, the coil frequencies, the projectors and the block length (reference signals, inner
+* channel selection, projector submatrix and sensor model) is built once and reused until one of these
+* changes. Coils which were fitted well in the previous block are used as starting points for the next fit.
+*
+* @brief Stateful HPI fitter.
+*/
+class INVERSESHARED_EXPORT HPIFitter : public HPIFit
+{
+
+public:
+    typedef QSharedPointer<HPIFitter> SPtr;             /**< Shared pointer type for HPIFitter. */
+    typedef QSharedPointer<const HPIFitter> ConstSPtr;  /**< Const shared pointer type for HPIFitter. */
+
+    //=========================================================================================================
+    /**
+    * Constructs the fitter for the given measurement info.
+    *
+    * @param[in] pFiffInfo       Associated Fiff Information.
+    */
+    explicit HPIFitter(QSharedPointer<FIFFLIB::FiffInfo> pFiffInfo);
+
+    //=========================================================================================================
+    /**
+    * Perform one HPI fit. The cached sensor model is rebuilt if the channel count, the bad channels, the
+    * sampling frequency, the coil frequencies, the projectors or the number of samples changed.
+    *
+    * @param[in] t_mat           Data to estimate the HPI positions from
+    * @param[in] t_matProjectors The projectors to apply. Bad channels are still included.
+    * @param[out] transDevHead   The final dev head transformation matrix
+    * @param[in] vFreqs          The frequencies for each coil.
+    * @param[out] vGof           The goodness of fit in mm for each fitted HPI coil.
+    * @param[out] fittedPointSet The final fitted positions in form of a digitizer set.
+    *
+    * @return Returns true if the fit was performed, false otherwise.
+    */
+    bool fit(const Eigen::MatrixXd& t_mat,
+             const Eigen::MatrixXd& t_matProjectors,
+             FIFFLIB::FiffCoordTrans &transDevHead,
+             const QVector<int>& vFreqs,
+             QVector<double> &vGof,
+             FIFFLIB::FiffDigPointSet& fittedPointSet);
+
+    //=========================================================================================================
+    /**
+    * Drops the cached sensor model and the previous coil positions. The next fit starts from scratch.
+    */
+    void reset();
+
+    //=========================================================================================================
+    /**
+    * Enables or disables starting the fit from the previous coil positions.
+    *
+    * @param[in] bWarmStart      Whether to start from the previous coil positions.
+    * @param[in] dMaxError       Coils whose previous relative fit error exceeds this value are seeded again.
+    */
+    void setWarmStart(bool bWarmStart, double dMaxError = 0.1);
+
+    //=========================================================================================================
+    /**
+    * Returns the measurement info the fitter was created for.
+    *
+    * @return The measurement info.
+    */
+    inline QSharedPointer<FIFFLIB::FiffInfo> fiffInfo() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the coil parameters of the last fit.
+    *
+    * @return The coil parameters.
+    */
+    inline const CoilParam& lastCoilParam() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the timing of the last fit.
+    *
+    * @return The timing of the last fit.
+    */
+    inline const HPIFitterTiming& lastTiming() const;
+
+protected:
+    //=========================================================================================================
+    /**
+    * Checks whether the cached sensor model still matches the inputs and rebuilds it if not.
+    *
+    * @param[in] t_matProjectors The projectors to apply. Bad channels are still included.
+    * @param[in] vFreqs          The frequencies for each coil.
+    * @param[in] iNumSamples     The number of samples per fit.
+    *
+    * @return Returns true if a usable sensor model is available, false otherwise.
+    */
+    bool updateModel(const Eigen::MatrixXd& t_matProjectors,
+                     const QVector<int>& vFreqs,
+                     int iNumSamples);
+
+    //=========================================================================================================
+    /**
+    * Computes a seed point for a coil by moving the channel with the largest amplitude 3cm inwards.
+    *
+    * @param[in] amp             The coil amplitudes of the inner channels (inner channels x coils).
+    * @param[in] iCoil           The coil to compute the seed point for.
+    *
+    * @return Returns the seed point.
+    */
+    Eigen::RowVector3d seedPosition(const Eigen::MatrixXd& amp, int iCoil) const;
+
+    QSharedPointer<FIFFLIB::FiffInfo>   m_pFiffInfo;            /**< Holds the fiff measurement information. */
+
+    bool                m_bModelValid;          /**< Whether the cached sensor model can be used. */
+    int                 m_iNumChannels;         /**< The channel count the model was built for. */
+    double              m_dSFreq;               /**< The sampling frequency the model was built for. */
+    int                 m_iNumSamples;          /**< The number of samples the model was built for. */
+    QStringList         m_lBads;                /**< The bad channels the model was built for. */
+    QVector<int>        m_vFreqs;               /**< The coil frequencies the model was built for. */
+    Eigen::MatrixXd     m_matProjectors;        /**< The full projectors the model was built for. */
+
+    int                 m_iNumCoils;            /**< The number of HPI coils. */
+    QVector<int>        m_vInnerInd;            /**< The good inner layer channels used for fitting. */
+    Eigen::MatrixXd     m_matDemod;             /**< The transposed pseudo inverse of the sin/cos reference signals (samples x 2*coils). */
+    Eigen::MatrixXd     m_matProjInner;         /**< The projectors restricted to the inner channels. */
+    Eigen::MatrixXd     m_matHeadHPI;           /**< The digitized HPI coil positions (coils x 3). */
+    SensorInfo          m_sensors;              /**< The sensor model of the inner channels. */
+
+    bool                m_bWarmStart;           /**< Whether to start from the previous coil positions. */
+    double              m_dWarmStartMaxError;   /**< The maximum previous fit error for which a coil is warm started. */
+    bool                m_bHasLastFit;          /**< Whether m_lastCoil holds a previous fit. */
+    CoilParam           m_lastCoil;             /**< The coil parameters of the last fit. */
+    HPIFitterTiming     m_timing;               /**< The timing of the last fit. */
+};
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline QSharedPointer<FIFFLIB::FiffInfo> HPIFitter::fiffInfo() const
+{
+    return m_pFiffInfo;
+}
+
+
+//*************************************************************************************************************
+
+inline const CoilParam& HPIFitter::lastCoilParam() const
+{
+    return m_lastCoil;
+}
+
+
+//*************************************************************************************************************
+
+inline const HPIFitterTiming& HPIFitter::lastTiming() const
+{
+    return m_timing;
+}
+
+} //NAMESPACE
+
+#endif // HPIFITTER_H
@@ -112,6 +112,7 @@ SOURCES += \
     c/mne_meas_data.cpp \
     c/mne_meas_data_set.cpp \
     hpiFit/hpifit.cpp \
+    hpiFit/hpifitter.cpp \
     hpiFit/hpifitdata.cpp
 
 
@@ -134,6 +135,7 @@ HEADERS +=\
     c/mne_meas_data.h \
     c/mne_meas_data_set.h \
     hpiFit/hpifit.h \
+    hpiFit/hpifitter.h \
     hpiFit/hpifitdata.h
 
 
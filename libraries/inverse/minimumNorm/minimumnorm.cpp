@@ -70,6 +70,54 @@ using namespace MNELIB;
 using namespace INVERSELIB;
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+namespace {
+
+//=============================================================================================================
+/**
+* Combines the current components of free orientation solutions and applies the noise normalization in one pass.
+*
+* @param[in] matSol         The kernel applied to the data.
+* @param[in] bCombineXyz    Whether three consecutive rows form one source.
+* @param[in] vecNoiseNorm   The noise normalization factors, empty for MNE.
+*
+* @return the source estimate data, empty if the noise normalization does not match the sources
+*/
+template<typename T>
+MatrixXd finalizeSolution(const Matrix<T,Dynamic,Dynamic>& matSol, bool bCombineXyz, const VectorXd& vecNoiseNorm)
+{
+    const int iSources = bCombineXyz ? matSol.rows()/3 : matSol.rows();
+    const bool bNoiseNorm = vecNoiseNorm.size() > 0;
+
+    if(bNoiseNorm && vecNoiseNorm.size() != iSources) {
+        qWarning("MinimumNorm: %d noise normalization factors do not match %d sources, no dSPM/sLORETA result is computed.", static_cast<int>(vecNoiseNorm.size()), iSources);
+        return MatrixXd();
+    }
+
+    MatrixXd matResult(iSources, matSol.cols());
+
+    for(int t = 0; t < matSol.cols(); ++t) {
+        if(bCombineXyz) {
+            matResult.col(t) = Map<const Matrix<T,3,Dynamic> >(matSol.col(t).data(), 3, iSources).colwise().norm().transpose().template cast<double>();
+        } else {
+            matResult.col(t) = matSol.col(t).template cast<double>();
+        }
+
+        if(bNoiseNorm) {
+            matResult.col(t).array() *= vecNoiseNorm.array();
+        }
+    }
+
+    return matResult;
+}
+
+} // NAMESPACE
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS
@@ -78,6 +126,9 @@ using namespace INVERSELIB;
 MinimumNorm::MinimumNorm(const MNEInverseOperator &p_inverseOperator, float lambda, const QString method)
 : m_inverseOperator(p_inverseOperator)
 , inverseSetup(false)
+, m_bFactoredKernel(false)
+, m_bSinglePrecision(false)
+, m_bPickNormal(false)
 {
     this->setRegularization(lambda);
     this->setMethod(method);
@@ -88,6 +139,9 @@ MinimumNorm::MinimumNorm(const MNEInverseOperator &p_inverseOperator, float lamb
 MinimumNorm::MinimumNorm(const MNEInverseOperator &p_inverseOperator, float lambda, bool dSPM, bool sLORETA)
 : m_inverseOperator(p_inverseOperator)
 , inverseSetup(false)
+, m_bFactoredKernel(false)
+, m_bSinglePrecision(false)
+, m_bPickNormal(false)
 {
     this->setRegularization(lambda);
     this->setMethod(dSPM, sLORETA);
@@ -201,32 +255,46 @@ MNESourceEstimate MinimumNorm::calculateInverse(const MatrixXd &data, float tmin
         return MNESourceEstimate();
     }
 
-    MatrixXd sol = K * data; //apply imaging kernel
+    bool bCombineXyz = inv.source_ori == FIFFV_MNE_FREE_ORI && !m_bPickNormal;
 
-    if (inv.source_ori == FIFFV_MNE_FREE_ORI)
-    {
+    if (bCombineXyz)
         printf("combining the current components...");
-        MatrixXd sol1(sol.rows()/3,sol.cols());
-        for(qint32 i = 0; i < sol.cols(); ++i)
-        {
-            VectorXd* tmp = MNEMath::combine_xyz(sol.block(0,i,sol.rows(),1));
-            sol1.block(0,i,sol.rows()/3,1) = tmp->cwiseSqrt();
-            delete tmp;
-        }
-        sol.resize(sol1.rows(),sol1.cols());
-        sol = sol1;
-    }
 
     if (m_bdSPM)
-    {
         printf("(dSPM)...");
-        sol = inv.noisenorm*sol;
-    }
     else if (m_bsLORETA)
-    {
         printf("(sLORETA)...");
-        sol = inv.noisenorm*sol;
+
+    //apply imaging kernel, combine the current components and noise normalize in one pass
+    MatrixXd sol;
+
+    if(m_bSinglePrecision)
+    {
+        MatrixXf dataFloat = data.cast<float>();
+        MatrixXf solFloat;
+
+        if(m_bFactoredKernel)
+            solFloat.noalias() = m_matKernelLeadsFloat * (m_matKernelTransFloat * dataFloat);
+        else
+            solFloat.noalias() = m_matKernelFloat * dataFloat;
+
+        sol = finalizeSolution(solFloat, bCombineXyz, m_vecNoiseNorm);
     }
+    else
+    {
+        MatrixXd solDouble;
+
+        if(m_bFactoredKernel)
+            solDouble.noalias() = m_matKernelLeads * (m_matKernelTrans * data);
+        else
+            solDouble.noalias() = K * data;
+
+        sol = finalizeSolution(solDouble, bCombineXyz, m_vecNoiseNorm);
+    }
+
+    if(sol.size() == 0)
+        return MNESourceEstimate();
+
     printf("[done]\n");
 
     //Results
@@ -252,9 +320,47 @@ void MinimumNorm::doInverseSetup(qint32 nave, bool pick_normal)
     inv = m_inverseOperator.prepare_inverse_operator(nave, m_fLambda, m_bdSPM, m_bsLORETA);
 
     printf("Computing inverse...");
-    inv.assemble_kernel(label, m_sMethod, pick_normal, K, noise_norm, vertno);
 
-    std::cout << "K " << K.rows() << " x " << K.cols() << std::endl;
+    m_bPickNormal = pick_normal;
+
+    K.resize(0,0);
+    m_matKernelLeads.resize(0,0);
+    m_matKernelTrans.resize(0,0);
+    m_matKernelFloat.resize(0,0);
+    m_matKernelLeadsFloat.resize(0,0);
+    m_matKernelTransFloat.resize(0,0);
+
+    if(m_bFactoredKernel)
+    {
+        inv.assemble_kernel_factored(label, m_sMethod, pick_normal, m_matKernelLeads, m_matKernelTrans, noise_norm, vertno);
+
+        std::cout << "K " << m_matKernelLeads.rows() << " x " << m_matKernelLeads.cols() << " * " << m_matKernelTrans.rows() << " x " << m_matKernelTrans.cols() << std::endl;
+
+        if(m_bSinglePrecision)
+        {
+            m_matKernelLeadsFloat = m_matKernelLeads.cast<float>();
+            m_matKernelTransFloat = m_matKernelTrans.cast<float>();
+            m_matKernelLeads.resize(0,0);
+            m_matKernelTrans.resize(0,0);
+        }
+    }
+    else
+    {
+        inv.assemble_kernel(label, m_sMethod, pick_normal, K, noise_norm, vertno);
+
+        std::cout << "K " << K.rows() << " x " << K.cols() << std::endl;
+
+        if(m_bSinglePrecision)
+        {
+            m_matKernelFloat = K.cast<float>();
+            K.resize(0,0);
+        }
+    }
+
+    if(m_bdSPM || m_bsLORETA)
+        m_vecNoiseNorm = inv.noisenorm.diagonal();
+    else
+        m_vecNoiseNorm.resize(0);
 
     inverseSetup = true;
 }
@@ -327,3 +433,19 @@ void MinimumNorm::setRegularization(float lambda)
 {
     m_fLambda = lambda;
 }
+
+
+//*************************************************************************************************************
+
+void MinimumNorm::setFactoredKernel(bool bFactoredKernel)
+{
+    m_bFactoredKernel = bFactoredKernel;
+}
+
+
+//*************************************************************************************************************
+
+void MinimumNorm::setSinglePrecision(bool bSinglePrecision)
+{
+    m_bSinglePrecision = bSinglePrecision;
+}
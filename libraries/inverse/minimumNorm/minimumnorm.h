@@ -167,6 +167,31 @@ public:
     */
     void setRegularization(float lambda);
 
+    //=========================================================================================================
+    /**
+    * Keep the imaging kernel in factored form, i.e., the weighted eigenleads and the transformation from the
+    * channels to the eigenlead weights, instead of multiplying them out. Each block then costs two thin products.
+    * Takes effect with the next call of doInverseSetup.
+    *
+    * @param[in] bFactoredKernel    Whether to use the factored kernel.
+    */
+    void setFactoredKernel(bool bFactoredKernel);
+
+    //=========================================================================================================
+    /**
+    * Apply the imaging kernel in single precision, which halves its memory and bandwidth. The solution is
+    * returned in double precision. Takes effect with the next call of doInverseSetup.
+    *
+    * @param[in] bSinglePrecision   Whether to apply the kernel in single precision.
+    */
+    void setSinglePrecision(bool bSinglePrecision);
+
+    //=========================================================================================================
+    /**
+    * Returns the full imaging kernel. The kernel is empty if the factored kernel is used.
+    *
+    * @return the imaging kernel
+    */
     inline MatrixXd& getKernel();
 
 private:
@@ -183,6 +208,16 @@ private:
     Label label;                            /**< The corresponding labels */
     MatrixXd K;                             /**< Imaging kernel */
 
+    bool m_bFactoredKernel;                 /**< Keep the kernel in factored form */
+    bool m_bSinglePrecision;                /**< Apply the kernel in single precision */
+    bool m_bPickNormal;                     /**< Only the normal components were kept during the setup */
+    MatrixXd m_matKernelLeads;              /**< Weighted eigenleads of the factored kernel (sources x eigenvalues) */
+    MatrixXd m_matKernelTrans;              /**< Channel transformation of the factored kernel (eigenvalues x channels) */
+    MatrixXf m_matKernelFloat;              /**< Imaging kernel in single precision */
+    MatrixXf m_matKernelLeadsFloat;         /**< Weighted eigenleads of the factored kernel in single precision */
+    MatrixXf m_matKernelTransFloat;         /**< Channel transformation of the factored kernel in single precision */
+    VectorXd m_vecNoiseNorm;                /**< Diagonal of the noise normalization, empty for MNE */
+
 };
 
 //*************************************************************************************************************
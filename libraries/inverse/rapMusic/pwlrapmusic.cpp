@@ -198,6 +198,10 @@ MNESourceEstimate PwlRapMusic::calculateInverse(const MatrixXd& p_matMeasurement
         VectorXT t_vecRoh(m_iNumLeadFieldCombinations,1);
         t_vecRoh.setZero();
 
+        //Orthonormal basis of the projected gain of each grid point, shared by all pairs containing the point
+        MatrixXT t_matQ, t_matP;
+        calcPointBases(t_matProj_LeadField, t_matU_B, t_matQ, t_matP);
+
         //subcorr benchmark
         //Stop the time
         clock_t start_subcorr, end_subcorr;
@@ -235,16 +239,11 @@ MNESourceEstimate PwlRapMusic::calculateInverse(const MatrixXd& p_matMeasurement
                 for(int i = 0; i < t_iNumVecElements; i++)
                 {
                     int k = t_pVecIdxElements(i);
-                    //new Version: calculate matrix multiplication before
-                    //Create Lead Field combinations -> It would be better to use a pointer construction, to increase performance
-                    MatrixX6T t_matProj_G(t_matProj_LeadField.rows(),6);
-
-                    int idx1 = m_ppPairIdxCombinations[k]->x1;
-                    int idx2 = m_ppPairIdxCombinations[k]->x2;
 
-                    RapMusic::getGainMatrixPair(t_matProj_LeadField, t_matProj_G, idx1, idx2);
+                    int idx1, idx2;
+                    RapMusic::getPointPair(m_iNumGridPoints, k, idx1, idx2);
 
-                    t_vecRoh(k) = RapMusic::subcorr(t_matProj_G, t_matU_B);//t_vecRoh holds the correlations roh_k
+                    t_vecRoh(k) = RapMusic::subcorr(t_matQ, t_matP, idx1, idx2);//t_vecRoh holds the correlations roh_k
                 }
             }
 
@@ -279,8 +278,7 @@ MNESourceEstimate PwlRapMusic::calculateInverse(const MatrixXd& p_matMeasurement
             {
                 t_iMaxIdx_old = t_iMaxIdx;
                 //get positions in sparsed leadfield from index combinations;
-                t_iIdx1 = m_ppPairIdxCombinations[t_iMaxIdx]->x1;
-                t_iIdx2 = m_ppPairIdxCombinations[t_iMaxIdx]->x2;
+                RapMusic::getPointPair(m_iNumGridPoints, (int)t_iMaxIdx, t_iIdx1, t_iIdx2);
             }
 
 
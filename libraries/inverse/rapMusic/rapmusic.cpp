@@ -65,7 +65,6 @@ RapMusic::RapMusic()
 , m_iNumGridPoints(0)
 , m_iNumChannels(0)
 , m_iNumLeadFieldCombinations(0)
-, m_ppPairIdxCombinations(NULL)
 , m_iMaxNumThreads(1)
 , m_bIsInit(false)
 , m_iSamplesStcWindow(-1)
@@ -82,7 +81,6 @@ RapMusic::RapMusic(MNEForwardSolution& p_pFwd, bool p_bSparsed, int p_iN, double
 , m_iNumGridPoints(0)
 , m_iNumChannels(0)
 , m_iNumLeadFieldCombinations(0)
-, m_ppPairIdxCombinations(NULL)
 , m_iMaxNumThreads(1)
 , m_bIsInit(false)
 , m_iSamplesStcWindow(-1)
@@ -97,8 +95,6 @@ RapMusic::RapMusic(MNEForwardSolution& p_pFwd, bool p_bSparsed, int p_iN, double
 
 RapMusic::~RapMusic()
 {
-    if(m_ppPairIdxCombinations != NULL)
-        free(m_ppPairIdxCombinations);
 }
 
 
@@ -153,20 +149,9 @@ bool RapMusic::init(MNEForwardSolution& p_pFwd, bool p_bSparsed, int p_iN, doubl
 
     m_ForwardSolution = p_pFwd;
 
-    //##### Calc lead field combination #####
-
-    std::cout << "Calculate gain matrix combinations. \n";
-
+    //Lead field combinations are not stored, the pair indices are computed from the combination index
     m_iNumLeadFieldCombinations = MNEMath::nchoose2(m_iNumGridPoints+1);
 
-    m_ppPairIdxCombinations = (Pair **)malloc(m_iNumLeadFieldCombinations * sizeof(Pair *));
-
-    calcPairCombinations(m_iNumGridPoints, m_iNumLeadFieldCombinations, m_ppPairIdxCombinations);
-
-    std::cout << "Gain matrix combinations calculated. \n\n";
-
-    //##### Calc lead field combination end #####
-
     std::cout << "Number of grid points: " << m_iNumGridPoints << "\n\n";
 
     std::cout << "Number of combinated points: " << m_iNumLeadFieldCombinations << "\n\n";
@@ -478,28 +463,12 @@ MNESourceEstimate RapMusic::calculateInverse(const MatrixXd& p_matMeasurement, Q
         clock_t start_subcorr, end_subcorr;
         start_subcorr = clock();
 
-        //Multithreading correlation calculation
-        #ifdef _OPENMP
-        #pragma omp parallel num_threads(m_iMaxNumThreads)
-        #endif
-        {
-        #ifdef _OPENMP
-        #pragma omp for
-        #endif
-            for(int i = 0; i < m_iNumLeadFieldCombinations; i++)
-            {
-                //new Version: calculate matrix multiplication before
-                //Create Lead Field combinations -> It would be better to use a pointer construction, to increase performance
-                MatrixX6T t_matProj_G(t_matProj_LeadField.rows(),6);
-
-                int idx1 = m_ppPairIdxCombinations[i]->x1;
-                int idx2 = m_ppPairIdxCombinations[i]->x2;
-
-                RapMusic::getGainMatrixPair(t_matProj_LeadField, t_matProj_G, idx1, idx2);
+        //Orthonormal basis of the projected gain of each grid point, shared by all pairs containing the point
+        MatrixXT t_matQ, t_matP;
+        calcPointBases(t_matProj_LeadField, t_matU_B, t_matQ, t_matP);
 
-                t_vecRoh(i) = RapMusic::subcorr(t_matProj_G, t_matU_B);//t_vecRoh holds the correlations roh_k
-            }
-        }
+        //Multithreading correlation calculation over tiles of pairs
+        calcPairCorrelations(t_matQ, t_matP, t_vecRoh);//t_vecRoh holds the correlations roh_k
 
 
 //         if(r==0)
@@ -532,8 +501,8 @@ MNESourceEstimate RapMusic::calculateInverse(const MatrixXd& p_matMeasurement, Q
         t_val_roh_k = t_vecRoh.maxCoeff(&t_iMaxIdx);//p_vecCor = ^roh_k
 
         //get positions in sparsed leadfield from index combinations;
-        int t_iIdx1 = m_ppPairIdxCombinations[t_iMaxIdx]->x1;
-        int t_iIdx2 = m_ppPairIdxCombinations[t_iMaxIdx]->x2;
+        int t_iIdx1, t_iIdx2;
+        RapMusic::getPointPair(m_iNumGridPoints, (int)t_iMaxIdx, t_iIdx1, t_iIdx2);
 
         // (Idx+1) because of MATLAB positions -> starting with 1 not with 0
         std::cout << "Iteration: " << r+1 << " of " << t_iMaxSearch
@@ -812,30 +781,154 @@ void RapMusic::calcOrthProj(const MatrixXT& p_matA_k_1, MatrixXT& p_matOrthProj)
 
 //*************************************************************************************************************
 
-void RapMusic::calcPairCombinations(    const int p_iNumPoints,
-                                        const int p_iNumCombinations,
-                                        Pair** p_ppPairIdxCombinations) const
+double RapMusic::subcorr(const MatrixXT& p_matQ, const MatrixXT& p_matP, int p_iIdx1, int p_iIdx2)
 {
-    int idx1 = 0;
-    int idx2 = 0;
+    const int m = (int)p_matQ.rows();
+
+    Matrix3T t_matC = p_matQ.block(0, 3*p_iIdx1, m, 3).transpose() * p_matQ.block(0, 3*p_iIdx2, m, 3);
+    Matrix3T t_matG_22 = p_matQ.block(0, 3*p_iIdx2, m, 3).transpose() * p_matQ.block(0, 3*p_iIdx2, m, 3);
+
+    Matrix3T t_matA_11 = p_matP.middleRows(3*p_iIdx1, 3) * p_matP.middleRows(3*p_iIdx1, 3).transpose();
+    Matrix3T t_matA_12 = p_matP.middleRows(3*p_iIdx1, 3) * p_matP.middleRows(3*p_iIdx2, 3).transpose();
+    Matrix3T t_matA_22 = p_matP.middleRows(3*p_iIdx2, 3) * p_matP.middleRows(3*p_iIdx2, 3).transpose();
+
+    return subcorr(t_matC, t_matG_22, t_matA_11, t_matA_12, t_matA_22);
+}
+
+
+//*************************************************************************************************************
+
+double RapMusic::subcorr(   const Matrix3T& p_matC,
+                            const Matrix3T& p_matG_22,
+                            const Matrix3T& p_matA_11,
+                            const Matrix3T& p_matA_12,
+                            const Matrix3T& p_matA_22)
+{
+    //Orthogonalize Q_2 against Q_1: M = Q_2 - Q_1*C with M^T*M = G_22 - C^T*C.
+    //The eigenvalues are the squared sines of the principal angles -> directions of Q_2 already in span(Q_1) are dropped
+    Eigen::SelfAdjointEigenSolver<Matrix3T> t_eigM(p_matG_22 - p_matC.transpose()*p_matC);
+
+    Matrix3T t_matT = Matrix3T::Zero();//Q_2_orth = M*T^T
+    for(int k = 0; k < 3; ++k)
+        if(t_eigM.eigenvalues()(k) > RAP_PAIR_RANK_TOL)
+            t_matT.row(k) = t_eigM.eigenvectors().col(k).transpose() / sqrt(t_eigM.eigenvalues()(k));
+
+    //K = [P_1; T*(P_2 - C^T*P_1)] -> the correlation is the largest singular value of K, i.e. sqrt of the largest eigenvalue of K*K^T
+    Matrix3T t_matK_12 = (p_matA_12 - p_matA_11*p_matC) * t_matT.transpose();
+    Matrix3T t_matK_22 = t_matT * (p_matA_22
+                                   - p_matC.transpose()*p_matA_12
+                                   - p_matA_12.transpose()*p_matC
+                                   + p_matC.transpose()*p_matA_11*p_matC) * t_matT.transpose();
+
+    Matrix6T t_matKK;
+    t_matKK << p_matA_11, t_matK_12,
+               t_matK_12.transpose(), t_matK_22;
+
+    Eigen::SelfAdjointEigenSolver<Matrix6T> t_eigKK(t_matKK, Eigen::EigenvaluesOnly);
+
+    return sqrt(std::max(t_eigKK.eigenvalues()(5), 0.0));//Eigenvalues are sorted in increasing order
+}
+
+
+//*************************************************************************************************************
+
+void RapMusic::calcPointBases(  const MatrixXT& p_matProj_LeadField,
+                                const MatrixXT& p_matU_B,
+                                MatrixXT& p_matQ,
+                                MatrixXT& p_matP) const
+{
+    const int m = (int)p_matProj_LeadField.rows();
+
+    p_matQ = MatrixXT::Zero(m, 3*m_iNumGridPoints);
+
+    //The rank is decided relative to the largest projected gain, points of already found sources are projected out
+    double t_dTol = RAP_RANK_TOL * p_matProj_LeadField.colwise().norm().maxCoeff();
 
-    //Process Code in {m_max_num_threads} threads -> When compile with Intel Compiler -> probably obsolete
     #ifdef _OPENMP
-    #pragma omp parallel num_threads(m_iMaxNumThreads) private(idx1, idx2)
+    #pragma omp parallel num_threads(m_iMaxNumThreads)
     #endif
     {
     #ifdef _OPENMP
     #pragma omp for
     #endif
-        for (int i = 0; i < p_iNumCombinations; ++i)
+        for(int i = 0; i < m_iNumGridPoints; ++i)
+        {
+            Eigen::ColPivHouseholderQR<MatrixX3T> t_qrG(p_matProj_LeadField.block(0, 3*i, m, 3));
+
+            int t_iRank = 0;
+            while(t_iRank < 3 && std::fabs(t_qrG.matrixQR()(t_iRank, t_iRank)) > t_dTol)
+                ++t_iRank;
+
+            if(t_iRank > 0)
+            {
+                MatrixXT t_matQ_i = t_qrG.householderQ() * MatrixXT::Identity(m, t_iRank);
+                p_matQ.block(0, 3*i, m, t_iRank) = t_matQ_i;
+            }
+        }
+    }
+
+    p_matP = p_matQ.transpose() * p_matU_B;
+}
+
+
+//*************************************************************************************************************
+
+void RapMusic::calcPairCorrelations(const MatrixXT& p_matQ, const MatrixXT& p_matP, VectorXT& p_vecRoh) const
+{
+    const int m = (int)p_matQ.rows();
+    const int t_iNumTiles = (m_iNumGridPoints + RAP_TILE_SIZE - 1) / RAP_TILE_SIZE;
+    const int t_iNumTilePairs = MNEMath::nchoose2(t_iNumTiles+1);
+
+    p_vecRoh.resize(m_iNumLeadFieldCombinations);
+
+    //Per point terms Q_k^T*Q_k and P_k*P_k^T
+    MatrixXT t_matG_diag(3, 3*m_iNumGridPoints);
+    MatrixXT t_matA_diag(3, 3*m_iNumGridPoints);
+    for(int k = 0; k < m_iNumGridPoints; ++k)
+    {
+        t_matG_diag.block<3,3>(0, 3*k) = p_matQ.block(0, 3*k, m, 3).transpose() * p_matQ.block(0, 3*k, m, 3);
+        t_matA_diag.block<3,3>(0, 3*k) = p_matP.middleRows(3*k, 3) * p_matP.middleRows(3*k, 3).transpose();
+    }
+
+    #ifdef _OPENMP
+    #pragma omp parallel num_threads(m_iMaxNumThreads)
+    #endif
+    {
+    #ifdef _OPENMP
+    #pragma omp for schedule(dynamic)
+    #endif
+        for(int t = 0; t < t_iNumTilePairs; ++t)
         {
-            RapMusic::getPointPair(p_iNumPoints, i, idx1, idx2);
+            //Tiles are combined like the points
+            int t_iTile1, t_iTile2;
+            RapMusic::getPointPair(t_iNumTiles, t, t_iTile1, t_iTile2);
 
-            Pair* t_pairCombination = new Pair();
-            t_pairCombination->x1 = idx1;
-            t_pairCombination->x2 = idx2;
+            int t_iFirst1 = t_iTile1*RAP_TILE_SIZE;
+            int t_iFirst2 = t_iTile2*RAP_TILE_SIZE;
+            int t_iNum1 = std::min(RAP_TILE_SIZE, m_iNumGridPoints - t_iFirst1);
+            int t_iNum2 = std::min(RAP_TILE_SIZE, m_iNumGridPoints - t_iFirst2);
 
-            p_ppPairIdxCombinations[i] = t_pairCombination;
+            //Cross terms of all points of the two tiles
+            MatrixXT t_matC = p_matQ.block(0, 3*t_iFirst1, m, 3*t_iNum1).transpose() * p_matQ.block(0, 3*t_iFirst2, m, 3*t_iNum2);
+            MatrixXT t_matA = p_matP.middleRows(3*t_iFirst1, 3*t_iNum1) * p_matP.middleRows(3*t_iFirst2, 3*t_iNum2).transpose();
+
+            for(int j = 0; j < t_iNum2; ++j)
+            {
+                int t_iIdx2 = t_iFirst2 + j;
+
+                for(int i = 0; i < t_iNum1; ++i)
+                {
+                    int t_iIdx1 = t_iFirst1 + i;
+                    if(t_iIdx1 > t_iIdx2)
+                        break;
+
+                    p_vecRoh(getPairIndex(m_iNumGridPoints, t_iIdx1, t_iIdx2)) = RapMusic::subcorr(t_matC.block<3,3>(3*i, 3*j),
+                                                                                                    t_matG_diag.block<3,3>(0, 3*t_iIdx2),
+                                                                                                    t_matA_diag.block<3,3>(0, 3*t_iIdx1),
+                                                                                                    t_matA.block<3,3>(3*i, 3*j),
+                                                                                                    t_matA_diag.block<3,3>(0, 3*t_iIdx2));
+                }
+            }
         }
     }
 }
@@ -845,12 +938,13 @@ void RapMusic::calcPairCombinations(    const int p_iNumPoints,
 
 void RapMusic::getPointPair(const int p_iPoints, const int p_iCurIdx, int &p_iIdx1, int &p_iIdx2)
 {
-    int ii = p_iPoints*(p_iPoints+1)/2-1-p_iCurIdx;
-    int K = (int)floor((sqrt((double)(8*ii+1))-1)/2);
+    qint64 t_iNumPairs = (qint64)p_iPoints*(p_iPoints+1)/2;
+    qint64 ii = t_iNumPairs-1-p_iCurIdx;
+    qint64 K = (qint64)floor((sqrt((double)(8*ii+1))-1)/2);
 
-    p_iIdx1 = p_iPoints-1-K;
+    p_iIdx1 = (int)(p_iPoints-1-K);
 
-    p_iIdx2 = (p_iCurIdx-p_iPoints*(p_iPoints+1)/2 + (K+1)*(K+2)/2)+p_iIdx1;
+    p_iIdx2 = (int)((p_iCurIdx-t_iNumPairs + (K+1)*(K+2)/2)+p_iIdx1);
 }
 
 
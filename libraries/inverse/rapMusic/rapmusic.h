@@ -61,6 +61,8 @@
 #include <Eigen/Core>
 #include <Eigen/SVD>
 #include <Eigen/LU>
+#include <Eigen/QR>
+#include <Eigen/Eigenvalues>
 
 
 //*************************************************************************************************************
@@ -87,6 +89,10 @@ using namespace MNELIB;
 #define NOT_TRANSPOSED   0  /**< Defines NOT_TRANSPOSED */
 #define IS_TRANSPOSED   1   /**< Defines IS_TRANSPOSED */
 
+#define RAP_TILE_SIZE       64      /**< Number of grid points per tile of the pair correlation kernel */
+#define RAP_RANK_TOL        1e-5    /**< Relative tolerance of the rank of the projected gain of one grid point */
+#define RAP_PAIR_RANK_TOL   1e-10   /**< Tolerance on the squared sine of the principal angles between the two gain subspaces of a pair */
+
 
 //=============================================================================================================
 /**
@@ -129,6 +135,10 @@ public:
                                                                              1> as VectorXT type. */
     typedef Eigen::Matrix<double, 6, 1> Vector6T;                            /**< Defines Eigen::Matrix<T, 6, 1>
                                                                              as Vector6T type. */
+    typedef Eigen::Matrix<double, Eigen::Dynamic, 3> MatrixX3T;              /**< Defines Eigen::Matrix<T, Eigen::Dynamic,
+                                                                             3> as MatrixX3T type. */
+    typedef Eigen::Matrix<double, 3, 3> Matrix3T;                            /**< Defines Eigen::Matrix<T, 3, 3>
+                                                                             as Matrix3T type. */
 
 
     //=========================================================================================================
@@ -228,6 +238,64 @@ protected:
     */
     static double subcorr(MatrixX6T& p_matProj_G, const MatrixXT& p_matU_B, Vector6T& p_vec_phi_k_1);
 
+    //=========================================================================================================
+    /**
+    * Computes the subspace correlation of the grid point pair (p_iIdx1, p_iIdx2) from the cached orthonormal
+    * bases of the projected gain of each grid point (see calcPointBases).
+    *
+    * @param[in] p_matQ     The orthonormal bases of the projected gain, m x 3 per grid point.
+    * @param[in] p_matP     The bases projected onto U_B (p_matQ^T * U_B), 3 x r per grid point.
+    * @param[in] p_iIdx1    first Lead Field index point
+    * @param[in] p_iIdx2    second Lead Field index point
+    * @return   The maximal correlation c_1 of the subspace correlation of the pair and the projected measurement.
+    */
+    static double subcorr(const MatrixXT& p_matQ, const MatrixXT& p_matP, int p_iIdx1, int p_iIdx2);
+
+    //=========================================================================================================
+    /**
+    * Computes the subspace correlation of a grid point pair from 3 x 3 cross terms only. With the orthonormal
+    * bases Q_1, Q_2 of the two projected gains and P_k = Q_k^T * U_B, the second basis is orthogonalized
+    * against the first and the correlation is the largest singular value of the stacked 6 x r projection.
+    *
+    * @param[in] p_matC     Q_1^T * Q_2
+    * @param[in] p_matG_22  Q_2^T * Q_2 (identity, with zeros for the directions not in the rank)
+    * @param[in] p_matA_11  P_1 * P_1^T
+    * @param[in] p_matA_12  P_1 * P_2^T
+    * @param[in] p_matA_22  P_2 * P_2^T
+    * @return   The maximal correlation c_1 of the subspace correlation of the pair and the projected measurement.
+    */
+    static double subcorr(  const Matrix3T& p_matC,
+                            const Matrix3T& p_matG_22,
+                            const Matrix3T& p_matA_11,
+                            const Matrix3T& p_matA_12,
+                            const Matrix3T& p_matA_22);
+
+    //=========================================================================================================
+    /**
+    * Computes an orthonormal basis (thin QR) of the projected gain of every grid point once, to be reused by
+    * all pairs containing that point. Directions beyond the rank of a point are left zero.
+    *
+    * @param[in] p_matProj_LeadField    The projected Lead Field (m x 3 per grid point).
+    * @param[in] p_matU_B               The matrix U is the subspace projection of the orthogonal projected Phi_s
+    * @param[out] p_matQ                The orthonormal bases, m x 3 per grid point.
+    * @param[out] p_matP                The bases projected onto U_B (p_matQ^T * U_B), 3 x r per grid point.
+    */
+    void calcPointBases(const MatrixXT& p_matProj_LeadField,
+                        const MatrixXT& p_matU_B,
+                        MatrixXT& p_matQ,
+                        MatrixXT& p_matP) const;
+
+    //=========================================================================================================
+    /**
+    * Computes the subspace correlation of all grid point pairs. The pairs are processed in tiles of
+    * RAP_TILE_SIZE x RAP_TILE_SIZE grid points, the cross terms of a tile are computed with two matrix products.
+    *
+    * @param[in] p_matQ     The orthonormal bases of the projected gain (see calcPointBases).
+    * @param[in] p_matP     The bases projected onto U_B (see calcPointBases).
+    * @param[out] p_vecRoh  The correlations, indexed like getPointPair.
+    */
+    void calcPairCorrelations(const MatrixXT& p_matQ, const MatrixXT& p_matP, VectorXT& p_vecRoh) const;
+
     //=========================================================================================================
     /**
     * Calculates the accumulated manifold vectors A_{k1}
@@ -252,21 +320,6 @@ protected:
     */
     void calcOrthProj(const MatrixXT& p_matA_k_1, MatrixXT& p_matOrthProj) const;
 
-    //=========================================================================================================
-    /**
-    * Pre-Calculates the gain matrix index combinations to search for a two dipole independent topography
-    * (IT = source).
-    *
-    * @param[in] p_iNumPoints   The number of Lead Field points -> for dimension check
-    * @param[in] p_iNumCombinations The number of pair index combinations.
-    * @param[out] p_ppPairIdxCombinations   The destination which contains pointer to pointer of index
-    *                                       combinations of Lead Field indices -> Number of pointers =
-    *                                       Combination (number of grid points over 2 = Num + 1 C 2)
-    */
-    void calcPairCombinations(  const int p_iNumPoints,
-                                const int p_iNumCombinations,
-                                Pair** p_ppPairIdxCombinations) const;
-
     //=========================================================================================================
     /**
     * Calculates the combination indices Idx1 and Idx2 of n points.\n
@@ -285,6 +338,17 @@ protected:
     */
     static void getPointPair(const int p_iPoints, const int p_iCurIdx, int &p_iIdx1, int &p_iIdx2);
 
+    //=========================================================================================================
+    /**
+    * Calculates the combination index of the points Idx1 <= Idx2 of n points, the inverse of getPointPair.
+    *
+    * @param[in] p_iPoints  The number of points n which are combined with each other.
+    * @param[in] p_iIdx1    The index 1.
+    * @param[in] p_iIdx2    The index 2.
+    * @return   The combination index (between 0 and nchoosek(n+1,2)).
+    */
+    static inline int getPairIndex(const int p_iPoints, const int p_iIdx1, const int p_iIdx2);
+
     //=========================================================================================================
     /**
     * Returns a gain matrix pair for the given indices
@@ -322,9 +386,8 @@ protected:
 
     int m_iNumGridPoints;               /**< Number of Grid points. */
     int m_iNumChannels;                 /**< Number of channels */
-    int m_iNumLeadFieldCombinations;    /**< Number of Lead Filed combinations (grid points + 1 over 2)*/
-
-    Pair** m_ppPairIdxCombinations; /**< Index combination vector with grid pair indices. */
+    int m_iNumLeadFieldCombinations;    /**< Number of Lead Filed combinations (grid points + 1 over 2). The
+                                             pair indices are computed from the combination index (getPointPair). */
 
     int m_iMaxNumThreads;   /**< Number of available CPU threads. */
 
@@ -389,6 +452,14 @@ inline int RapMusic::getRank(const MatrixXT& p_matSigma)
 }
 
 
+//*************************************************************************************************************
+
+inline int RapMusic::getPairIndex(const int p_iPoints, const int p_iIdx1, const int p_iIdx2)
+{
+    return (int)((qint64)p_iIdx1*p_iPoints - (qint64)p_iIdx1*(p_iIdx1-1)/2 + (p_iIdx2 - p_iIdx1));
+}
+
+
 //*************************************************************************************************************
 
 inline int RapMusic::useFullRank(   const MatrixXT& p_Mat,
@@ -478,10 +478,11 @@ int MneProjOp::mne_proj_op_proj_vector(MneProjOp *op, float *vec, int nvec, int
 /*
     * Apply projection operator to a vector (floats)
     * Assume that all dimension checking etc. has been done before
+    * The operator is only read, so several threads may project with it at once
     */
 {
-    static float *res = NULL;
-    int    res_size   = 0;
+    VectorXf res_work;
+    float *res;
     float *pvec;
     float  w;
     int k,p;
@@ -494,13 +495,8 @@ int MneProjOp::mne_proj_op_proj_vector(MneProjOp *op, float *vec, int nvec, int
         return FAIL;
     }
 
-    if (op->nch > res_size) {
-        res = REALLOC_23(res,op->nch,float);
-        res_size = op->nch;
-    }
-
-    for (k = 0; k < op->nch; k++)
-        res[k] = 0.0;
+    res_work = VectorXf::Zero(op->nch);
+    res = res_work.data();
 
     for (p = 0; p < op->nvec; p++) {
         pvec = op->proj_data[p];
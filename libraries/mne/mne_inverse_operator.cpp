@@ -159,6 +159,25 @@ MNEInverseOperator::~MNEInverseOperator()
 //*************************************************************************************************************
 
 bool MNEInverseOperator::assemble_kernel(const Label &label, QString method, bool pick_normal, MatrixXd &K, SparseMatrix<double> &noise_norm, QList<VectorXi> &vertno)
+{
+    MatrixXd matLeads;
+    MatrixXd matTrans;
+
+    if(!assemble_kernel_factored(label, method, pick_normal, matLeads, matTrans, noise_norm, vertno))
+        return false;
+
+    K = matLeads*matTrans;
+
+    //store assembled kernel
+    m_K = K;
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool MNEInverseOperator::assemble_kernel_factored(const Label &label, QString method, bool pick_normal, MatrixXd &matLeads, MatrixXd &matTrans, SparseMatrix<double> &noise_norm, QList<VectorXi> &vertno)
 {
     MatrixXd t_eigen_leads = this->eigen_leads->data;
     MatrixXd t_source_cov = this->source_cov->data;
@@ -262,7 +281,7 @@ bool MNEInverseOperator::assemble_kernel(const Label &label, QString method, boo
     SparseMatrix<double> t_reginv(reginv.rows(),reginv.rows());
     t_reginv.setFromTriplets(tripletList.begin(), tripletList.end());
 
-    MatrixXd trans = t_reginv*eigen_fields->data*whitener*proj;
+    matTrans = t_reginv*eigen_fields->data*whitener*proj;
     //
     //   Transformation into current distributions by weighting the eigenleads
     //   with the weights computed above
@@ -273,7 +292,7 @@ bool MNEInverseOperator::assemble_kernel(const Label &label, QString method, boo
         //     R^0.5 has been already factored in
         //
         printf("(eigenleads already weighted)...");
-        K = t_eigen_leads*trans;
+        matLeads = t_eigen_leads;
     }
     else
     {
@@ -289,15 +308,40 @@ bool MNEInverseOperator::assemble_kernel(const Label &label, QString method, boo
        SparseMatrix<double> t_sourceCov(t_source_cov.rows(),t_source_cov.rows());
        t_sourceCov.setFromTriplets(tripletList2.begin(), tripletList2.end());
 
-       K = t_sourceCov*t_eigen_leads*trans;
+       matLeads = t_sourceCov*t_eigen_leads;
+    }
+
+    //
+    //   Components with a zero regularized inverse (e.g., removed by the projectors) do not contribute
+    //
+    qint32 nzero = 0;
+    for(qint32 i = 0; i < reginv.rows(); ++i)
+        if(reginv(i,0) == 0)
+            ++nzero;
+
+    if(nzero > 0 && matTrans.rows() == reginv.rows() && matLeads.cols() == reginv.rows())
+    {
+        MatrixXd matLeadsReduced(matLeads.rows(), reginv.rows() - nzero);
+        MatrixXd matTransReduced(reginv.rows() - nzero, matTrans.cols());
+
+        qint32 count = 0;
+        for(qint32 i = 0; i < reginv.rows(); ++i)
+        {
+            if(reginv(i,0) != 0)
+            {
+                matLeadsReduced.col(count) = matLeads.col(i);
+                matTransReduced.row(count) = matTrans.row(i);
+                ++count;
+            }
+        }
+
+        matLeads = matLeadsReduced;
+        matTrans = matTransReduced;
     }
 
     if(method.compare("MNE") == 0)
         noise_norm = SparseMatrix<double>();
 
-    //store assembled kernel
-    m_K = K;
-
     return true;
 }
 
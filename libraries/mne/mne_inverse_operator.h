@@ -230,6 +230,25 @@ public:
     */
     bool assemble_kernel(const Label &label, QString method, bool pick_normal, MatrixXd &K, SparseMatrix<double> &noise_norm, QList<VectorXi> &vertno);
 
+    //=========================================================================================================
+    /**
+    * Assembles the kernel in factored form K = matLeads * matTrans, without multiplying the factors out. matLeads
+    * holds the (weighted) eigenleads (sources x eigenvalues), matTrans the regularized inverse of the eigenfields
+    * including whitener and projector (eigenvalues x channels). Applying the factors costs two thin products
+    * instead of one with the full kernel.
+    *
+    * @param[in] label          labels.
+    * @param[in] method         The applied normals. ("MNE" | "dSPM" | "sLORETA")
+    * @param[in] pick_normal    Pick normals.
+    * @param[out] matLeads      The weighted eigenleads.
+    * @param[out] matTrans      The transformation from channels to eigenlead weights.
+    * @param[out] noise_norm    Noise normals.
+    * @param[out] vertno        Vertices of the hemispheres.
+    *
+    * @return true when successful, false otherwise
+    */
+    bool assemble_kernel_factored(const Label &label, QString method, bool pick_normal, MatrixXd &matLeads, MatrixXd &matTrans, SparseMatrix<double> &noise_norm, QList<VectorXi> &vertno);
+
     //=========================================================================================================
     /**
     * Check that channels in inverse operator are measurements.
@@ -96,8 +96,10 @@ SOURCES += \
     rtCommand/commandparser.cpp \
     rtCommand/rawcommand.cpp \
     rtProcessing/rtcov.cpp \
+    rtProcessing/rtcovaccumulator.cpp \
     rtProcessing/rtinvop.cpp \
     rtProcessing/rtave.cpp \
+    rtProcessing/rtrunningaverage.cpp \
     rtProcessing/rtnoise.cpp \
     rtProcessing/rthpis.cpp \
     rtProcessing/rtfilter.cpp
@@ -112,8 +114,10 @@ HEADERS +=  \
     rtCommand/commandparser.h \
     rtCommand/rawcommand.h \
     rtProcessing/rtcov.h \
+    rtProcessing/rtcovaccumulator.h \
     rtProcessing/rtinvop.h \
     rtProcessing/rtave.h \
+    rtProcessing/rtrunningaverage.h \
     rtProcessing/rtnoise.h \
     rtProcessing/rthpis.h \
     rtProcessing/rtfilter.h
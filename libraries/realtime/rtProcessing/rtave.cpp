@@ -386,7 +386,7 @@ void RtAve::doAveraging(const MatrixXd& rawSegment)
                 generateEvoked(dTriggerType);
 
                 //If number of averages was reached emit new average
-                if(m_mapStimAve[dTriggerType].size() > 0) {
+                if(m_mapStimAve.contains(dTriggerType) && !m_mapStimAve[dTriggerType].isEmpty()) {
                     emit evokedStim(m_pStimEvokedSet);
                 }
 
@@ -394,7 +394,7 @@ void RtAve::doAveraging(const MatrixXd& rawSegment)
 
                 //qDebug()<<"RtAve::run() - Number of calculated averages:" << m_iNumberCalcAverages[dTriggerType];
                 //qDebug()<<"RtAve::run() - dTriggerType:" << dTriggerType;
-                //qDebug()<<"RtAve::run() - m_mapStimAve[dTriggerType].size():" << m_mapStimAve[dTriggerType].size();
+                //qDebug()<<"RtAve::run() - m_mapStimAve[dTriggerType].count():" << m_mapStimAve[dTriggerType].count();
             } else {
                 //qDebug()<<"4";
                 fillBackBuffer(rawSegment, dTriggerType);
@@ -516,18 +516,13 @@ void RtAve::mergeData(double dTriggerType)
     bool bArtifactedDetected = checkForArtifact(mergedData);
 
     if(bArtifactedDetected == false) {
-        //Add cut data to average buffer
-        m_mapStimAve[dTriggerType].append(mergedData);
-
-        //Pop data from buffer
-        if(m_mapStimAve[dTriggerType].size() > m_iNumAverages && m_iNumAverages >= 1) {
-            m_mapStimAve[dTriggerType].pop_front();
+        //Running mode keeps the last m_iNumAverages epochs (at least one), cumulative mode keeps all
+        if(!m_mapStimAve.contains(dTriggerType)) {
+            m_mapStimAve.insert(dTriggerType, RtRunningAverage(m_iAverageMode == 0 ? qMax(1, m_iNumAverages) : 0));
         }
 
-        //Proceed a bit different if we use zero number of averages
-        if(m_mapStimAve[dTriggerType].size() > 1 && m_iNumAverages == 0) {
-            m_mapStimAve[dTriggerType].pop_front();
-        }
+        //Add cut data to the running average, the oldest epoch is evicted in place
+        m_mapStimAve[dTriggerType].append(mergedData);
     }
 }
 
@@ -647,7 +642,7 @@ void RtAve::generateEvoked(double dTriggerType)
 {
     QMutexLocker locker(&m_qMutex);
 
-    if(m_mapStimAve[dTriggerType].isEmpty()) {
+    if(!m_mapStimAve.contains(dTriggerType) || m_mapStimAve[dTriggerType].isEmpty()) {
         return;
     }
 
@@ -679,19 +674,9 @@ void RtAve::generateEvoked(double dTriggerType)
     }
 
     // Generate final evoked
-    MatrixXd finalAverage = MatrixXd::Zero(m_mapStimAve[dTriggerType].first().rows(), m_iPreStimSamples+m_iPostStimSamples);
+    MatrixXd finalAverage = m_mapStimAve[dTriggerType].average();
 
     if(m_iAverageMode == 0) {
-        for(int i = 0; i < m_mapStimAve[dTriggerType].size(); ++i) {
-            finalAverage += m_mapStimAve[dTriggerType].at(i);
-        }
-
-        if(m_mapStimAve[dTriggerType].isEmpty()) {
-            finalAverage = finalAverage/1;
-        } else {
-            finalAverage = finalAverage/m_mapStimAve[dTriggerType].size();
-        }
-
         if(m_bDoBaselineCorrection) {
             finalAverage = MNEMath::rescale(finalAverage, evoked.times, m_pairBaselineSec, QString("mean"));
         }
@@ -704,15 +689,15 @@ void RtAve::generateEvoked(double dTriggerType)
 
         evoked.nave = m_mapNumberCalcAverages[dTriggerType];
     } else if(m_iAverageMode == 1) {
-        MatrixXd tempMatrix = m_mapStimAve[dTriggerType].last();
-
+        //The mean baseline correction is linear, so correcting the average equals averaging the corrected epochs
         if(m_bDoBaselineCorrection) {
-            tempMatrix = MNEMath::rescale(tempMatrix, evoked.times, m_pairBaselineSec, QString("mean"));
+            finalAverage = MNEMath::rescale(finalAverage, evoked.times, m_pairBaselineSec, QString("mean"));
         }
 
-        evoked += tempMatrix;
+        evoked.data = finalAverage;
+        evoked.nave = m_mapStimAve[dTriggerType].count();
 
-        m_mapNumberCalcAverages[dTriggerType]++;
+        m_mapNumberCalcAverages[dTriggerType] = evoked.nave;
     }
 
     //Add new data to evoked data set
@@ -802,6 +787,34 @@ void RtAve::reset()
 }
 
 
+//*************************************************************************************************************
+
+MatrixXd RtAve::getVariance(double dTriggerType)
+{
+    QMutexLocker locker(&m_qMutex);
+
+    if(!m_mapStimAve.contains(dTriggerType)) {
+        return MatrixXd();
+    }
+
+    return m_mapStimAve[dTriggerType].variance();
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd RtAve::getSnr(double dTriggerType)
+{
+    QMutexLocker locker(&m_qMutex);
+
+    if(!m_mapStimAve.contains(dTriggerType)) {
+        return MatrixXd();
+    }
+
+    return m_mapStimAve[dTriggerType].snr();
+}
+
+
 //*************************************************************************************************************
 
 void RtAve::init()
@@ -43,6 +43,7 @@
 //=============================================================================================================
 
 #include "../realtime_global.h"
+#include "rtrunningaverage.h"
 
 #include <fiff/fiff_evoked_set.h>
 #include <fiff/fiff_info.h>
@@ -245,6 +246,27 @@ public:
     */
     void reset();
 
+    //=========================================================================================================
+    /**
+    * Returns the per sample variance of the epochs contributing to the current average of a trigger type.
+    *
+    * @param[in] dTriggerType   The trigger type.
+    *
+    * @return the variance, an empty matrix if no epoch was averaged for the trigger type yet.
+    */
+    Eigen::MatrixXd getVariance(double dTriggerType);
+
+    //=========================================================================================================
+    /**
+    * Returns the per sample signal to noise ratio (absolute average over standard error) of the current average
+    * of a trigger type.
+    *
+    * @param[in] dTriggerType   The trigger type.
+    *
+    * @return the signal to noise ratio, an empty matrix if no epoch was averaged for the trigger type yet.
+    */
+    Eigen::MatrixXd getSnr(double dTriggerType);
+
 protected:
     //=========================================================================================================
     /**
@@ -345,7 +367,7 @@ private:
     FIFFLIB::FiffEvokedSet::SPtr                    m_pStimEvokedSet;           /**< Holds the evoked information. */
 
     QMap<int,QList<int> >                           m_qMapDetectedTrigger;      /**< Detected trigger for each trigger channel. */
-    QMap<double,QList<Eigen::MatrixXd> >            m_mapStimAve;               /**< the current stimulus average buffer. Holds m_iNumAverages vectors */
+    QMap<double,RtRunningAverage>                   m_mapStimAve;               /**< The running averages of each trigger type. Holds up to m_iNumAverages epochs in running mode. */
     QMap<double,Eigen::MatrixXd>                    m_mapDataPre;               /**< The matrix holding the pre stim data. */
     QMap<double,Eigen::MatrixXd>                    m_mapDataPost;              /**< The matrix holding the post stim data. */
     QMap<double,qint32>                             m_mapMatDataPostIdx;        /**< Current index inside of the matrix m_matDataPost */
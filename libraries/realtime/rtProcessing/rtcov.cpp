@@ -52,6 +52,8 @@
 //=============================================================================================================
 
 #include <QDebug>
+#include <QMetaMethod>
+#include <QMutexLocker>
 
 
 //*************************************************************************************************************
@@ -74,8 +76,10 @@ RtCov::RtCov(qint32 p_iMaxSamples, FiffInfo::SPtr p_pFiffInfo, QObject *parent)
 , m_iNewMaxSamples(0)
 , m_pFiffInfo(p_pFiffInfo)
 , m_bIsRunning(false)
+, m_bAccumulatorChanged(false)
 {
     qRegisterMetaType<FiffCov::SPtr>("FiffCov::SPtr");
+    qRegisterMetaType<RtCovAccumulator::SPtr>("RtCovAccumulator::SPtr");
 }
 
 
@@ -105,10 +109,24 @@ void RtCov::append(const MatrixXd &p_DataSegment)
 
 void RtCov::setSamples(qint32 samples)
 {
+    QMutexLocker locker(&mutex);
     m_iNewMaxSamples = samples;
 }
 
 
+//*************************************************************************************************************
+
+void RtCov::setAccumulationMode(RtCovAccumulator::Mode mode, qint32 iWindowSamples, double dForgettingFactor)
+{
+    QMutexLocker locker(&mutex);
+
+    m_newCovAccumulator.setMode(mode);
+    m_newCovAccumulator.setWindowSize(iWindowSamples);
+    m_newCovAccumulator.setForgettingFactor(dForgettingFactor);
+    m_bAccumulatorChanged = true;
+}
+
+
 //*************************************************************************************************************
 
 bool RtCov::start()
@@ -142,19 +160,12 @@ bool RtCov::stop()
 
 void RtCov::run()
 {
-    //SETUP
-    QStringList exclude;
-    for(int i = 0; i<m_pFiffInfo->chs.size(); i++) {
-        if(m_pFiffInfo->chs.at(i).kind == FIFFV_STIM_CH) {
-            exclude << m_pFiffInfo->chs.at(i).ch_name;
-        }
-    }
-    bool doProj = true;
-
     quint32 n_samples = 0;
 
-    FiffCov::SPtr cov(new FiffCov());
-    VectorXd mu;
+    m_covAccumulator.reset();
+    m_partialCovAccumulator.reset();
+
+    const QMetaMethod t_partialSignal = QMetaMethod::fromSignal(&RtCov::covAccumulatorCalculated);
 
     while(m_bIsRunning)
     {
@@ -162,55 +173,49 @@ void RtCov::run()
         {
             MatrixXd rawSegment = m_pRawMatrixBuffer->pop();
 
-            if(n_samples == 0)
+            mutex.lock();
+            if(m_iNewMaxSamples > 0)
             {
-                mu = rawSegment.rowwise().sum();
-                cov->data = rawSegment * rawSegment.transpose();
+                m_iMaxSamples = m_iNewMaxSamples;
+                m_iNewMaxSamples = 0;
             }
-            else
+            if(m_bAccumulatorChanged)
             {
-                mu.array() += rawSegment.rowwise().sum().array();
-                cov->data += rawSegment * rawSegment.transpose();
+                m_covAccumulator = m_newCovAccumulator;
+                m_partialCovAccumulator.reset();
+                m_bAccumulatorChanged = false;
+                n_samples = 0;
             }
+            mutex.unlock();
+
+            //A cumulative accumulator is reset after each estimate and thus is the partial state itself
+            const bool t_bCumulative = m_covAccumulator.mode() == RtCovAccumulator::Cumulative;
+            const bool t_bEmitPartial = isSignalConnected(t_partialSignal);
+
+            m_covAccumulator.append(rawSegment);
+            if(t_bEmitPartial && !t_bCumulative)
+                m_partialCovAccumulator.append(rawSegment);
             n_samples += rawSegment.cols();
 
             if(n_samples > m_iMaxSamples)
             {
-                mu /= (float)n_samples;
-                cov->data.array() -= n_samples * (mu * mu.transpose()).array();
-                cov->data.array() /= (n_samples - 1);
-
-                cov->kind = FIFFV_MNE_NOISE_COV;
-                cov->diag = false;
-                cov->dim = cov->data.rows();
-
-                //ToDo do picks
-                cov->names = m_pFiffInfo->ch_names;
-                cov->projs = m_pFiffInfo->projs;
-                cov->bads = m_pFiffInfo->bads;
-                cov->nfree = n_samples;
-
                 // regularize noise covariance
-                *cov.data() = cov->regularize(*m_pFiffInfo, 0.05, 0.05, 0.1, doProj, exclude);
+                FiffCov::SPtr cov(new FiffCov(m_covAccumulator.toFiffCov(*m_pFiffInfo, true)));
 
                 emit covCalculated(cov);
 
-                cov = FiffCov::SPtr(new FiffCov());
-                n_samples = 0;
-            }
-
-
-//            qint32 samples = rawSegment.cols();
-//            VectorXf mu = rawSegment.rowwise().sum().array() / (float)samples;
-
-//            MatrixXf noise_covariance = rawSegment * rawSegment.transpose();// noise_covariance == raw_covariance
-//            noise_covariance.array() -= samples * (mu * mu.transpose()).array();
-//            noise_covariance.array() /= (samples - 1);
+                if(t_bEmitPartial)
+                {
+                    const RtCovAccumulator& t_partial = t_bCumulative ? m_covAccumulator : m_partialCovAccumulator;
+                    emit covAccumulatorCalculated(RtCovAccumulator::SPtr(new RtCovAccumulator(t_partial)));
+                }
 
-//            std::cout << "Noise Covariance:\n" << noise_covariance.block(0,0,10,10) << std::endl;
-
-//            printf("%d raw buffer (%d x %d) generated\r\n", count, tmp.rows(), tmp.cols());
+                n_samples = 0;
+                m_partialCovAccumulator.reset();
 
+                if(t_bCumulative)
+                    m_covAccumulator.reset();
+            }
         }
     }
 }
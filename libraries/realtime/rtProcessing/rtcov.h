@@ -42,6 +42,7 @@
 //=============================================================================================================
 
 #include "../realtime_global.h"
+#include "rtcovaccumulator.h"
 
 
 //*************************************************************************************************************
@@ -151,6 +152,19 @@ public:
     */
     void setSamples(qint32 samples);
 
+    //=========================================================================================================
+    /**
+    * Sets how the incoming samples are accumulated. In Cumulative mode the estimation is restarted after each
+    * emitted covariance, i.e. the estimates are based on disjoint chunks of data. In SlidingWindow and
+    * ExponentialDecay mode the estimate is updated incrementally and emitted every time the number of estimation
+    * samples was received. The change is applied with the next incoming data segment.
+    *
+    * @param[in] mode               The accumulation mode.
+    * @param[in] iWindowSamples     The sliding window size in samples (SlidingWindow mode only).
+    * @param[in] dForgettingFactor  The per sample forgetting factor in (0,1] (ExponentialDecay mode only).
+    */
+    void setAccumulationMode(RtCovAccumulator::Mode mode, qint32 iWindowSamples = 0, double dForgettingFactor = 1.0);
+
     //=========================================================================================================
     /**
     * Starts the RtCov by starting the producer's thread.
@@ -176,6 +190,16 @@ signals:
     */
     void covCalculated(FIFFLIB::FiffCov::SPtr p_pCov);
 
+    //=========================================================================================================
+    /**
+    * Signal which is emitted together with covCalculated. It carries the sufficient statistics of the samples
+    * received since the last estimate, which can be merged by RtInvOp::appendCovAccumulator. The partial states
+    * are only accumulated while this signal is connected.
+    *
+    * @param[out] p_pCovAccumulator  The partial covariance state
+    */
+    void covAccumulatorCalculated(REALTIMELIB::RtCovAccumulator::SPtr p_pCovAccumulator);
+
 protected:
     //=========================================================================================================
     /**
@@ -196,6 +220,11 @@ private:
 
     bool        m_bIsRunning;           /**< Holds if real-time Covariance estimation is running.*/
 
+    RtCovAccumulator    m_covAccumulator;       /**< The incremental covariance accumulator. */
+    RtCovAccumulator    m_newCovAccumulator;    /**< Holds the new accumulation settings until they are applied. */
+    RtCovAccumulator    m_partialCovAccumulator;/**< The samples since the last estimate, if the accumulator is not reset after each estimate. */
+    bool                m_bAccumulatorChanged;  /**< Whether new accumulation settings are pending. */
+
     CircularMatrixBuffer<double>::SPtr m_pRawMatrixBuffer;   /**< The Circular Raw Matrix Buffer. */
 };
 
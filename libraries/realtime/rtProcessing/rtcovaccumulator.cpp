@@ -0,0 +1,310 @@
+//=============================================================================================================
+/**
+* @file     rtcovaccumulator.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Definition of the RtCovAccumulator Class.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "rtcovaccumulator.h"
+
+#include <cmath>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace REALTIMELIB;
+using namespace FIFFLIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+RtCovAccumulator::RtCovAccumulator(Mode mode)
+: m_mode(mode)
+, m_iWindowSize(0)
+, m_dForgettingFactor(1.0)
+, m_dCount(0.0)
+, m_iWindowSamples(0)
+, m_iNumDowndates(0)
+{
+}
+
+
+//*************************************************************************************************************
+
+void RtCovAccumulator::setMode(Mode mode)
+{
+    m_mode = mode;
+    reset();
+}
+
+
+//*************************************************************************************************************
+
+void RtCovAccumulator::setWindowSize(qint32 iSamples)
+{
+    m_iWindowSize = iSamples;
+}
+
+
+//*************************************************************************************************************
+
+void RtCovAccumulator::setForgettingFactor(double dLambda)
+{
+    if(dLambda <= 0.0 || dLambda > 1.0) {
+        qWarning("RtCovAccumulator::setForgettingFactor - Forgetting factor %f is not in (0,1]. Returning.", dLambda);
+        return;
+    }
+
+    m_dForgettingFactor = dLambda;
+}
+
+
+//*************************************************************************************************************
+
+void RtCovAccumulator::reset()
+{
+    m_dCount = 0.0;
+    m_vecMean.resize(0);
+    m_matScatter.resize(0,0);
+
+    m_lWindowBlocks.clear();
+    m_iWindowSamples = 0;
+    m_iNumDowndates = 0;
+}
+
+
+//*************************************************************************************************************
+
+void RtCovAccumulator::append(const MatrixXd& matData)
+{
+    if(matData.cols() == 0)
+        return;
+
+    if(!isEmpty() && matData.rows() != m_vecMean.rows()) {
+        qWarning("RtCovAccumulator::append - Number of channels changed from %d to %d. Resetting.", (int)m_vecMean.rows(), (int)matData.rows());
+        reset();
+    }
+
+    switch(m_mode) {
+        case ExponentialDecay:
+            if(!isEmpty() && m_dForgettingFactor < 1.0) {
+                double dWeight = std::pow(m_dForgettingFactor, (double)matData.cols());
+                m_dCount *= dWeight;
+                m_matScatter *= dWeight;
+            }
+            addBlock(matData);
+            break;
+
+        case SlidingWindow:
+            addBlock(matData);
+            m_lWindowBlocks.append(matData);
+            m_iWindowSamples += matData.cols();
+
+            //Evict the oldest blocks as long as the remaining ones still fill the window
+            while(m_lWindowBlocks.size() > 1 && m_iWindowSamples - m_lWindowBlocks.first().cols() >= m_iWindowSize) {
+                removeBlock(m_lWindowBlocks.first());
+                m_iWindowSamples -= m_lWindowBlocks.first().cols();
+                m_lWindowBlocks.removeFirst();
+                ++m_iNumDowndates;
+            }
+
+            //Refresh once the window has been turned over completely
+            if(m_iNumDowndates >= m_lWindowBlocks.size())
+                recomputeWindow();
+            break;
+
+        default:
+            addBlock(matData);
+            break;
+    }
+}
+
+
+//*************************************************************************************************************
+
+void RtCovAccumulator::merge(const RtCovAccumulator& p_other)
+{
+    if(p_other.isEmpty())
+        return;
+
+    if(isEmpty()) {
+        m_dCount = p_other.m_dCount;
+        m_vecMean = p_other.m_vecMean;
+        m_matScatter = p_other.m_matScatter;
+        return;
+    }
+
+    if(p_other.m_vecMean.rows() != m_vecMean.rows()) {
+        qWarning("RtCovAccumulator::merge - Number of channels does not match (%d vs. %d). Returning.", (int)m_vecMean.rows(), (int)p_other.m_vecMean.rows());
+        return;
+    }
+
+    double dCount = m_dCount + p_other.m_dCount;
+    VectorXd vecDelta = p_other.m_vecMean - m_vecMean;
+
+    m_matScatter.triangularView<Lower>() += p_other.m_matScatter;
+    m_matScatter.selfadjointView<Lower>().rankUpdate(vecDelta, m_dCount * p_other.m_dCount / dCount);
+    m_vecMean += vecDelta * (p_other.m_dCount / dCount);
+    m_dCount = dCount;
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd RtCovAccumulator::scatter() const
+{
+    return m_matScatter.selfadjointView<Lower>();
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd RtCovAccumulator::covariance() const
+{
+    if(m_dCount <= 1.0)
+        return MatrixXd::Zero(m_matScatter.rows(), m_matScatter.cols());
+
+    MatrixXd matCov = m_matScatter.selfadjointView<Lower>();
+    matCov /= (m_dCount - 1.0);
+
+    return matCov;
+}
+
+
+//*************************************************************************************************************
+
+FiffCov RtCovAccumulator::toFiffCov(const FiffInfo& p_info, bool bRegularize) const
+{
+    FiffCov cov;
+
+    cov.kind = FIFFV_MNE_NOISE_COV;
+    cov.diag = false;
+    cov.data = covariance();
+    cov.dim = cov.data.rows();
+
+    //ToDo do picks
+    cov.names = p_info.ch_names;
+    cov.projs = p_info.projs;
+    cov.bads = p_info.bads;
+    cov.nfree = (fiff_int_t)m_dCount;
+
+    if(bRegularize) {
+        QStringList exclude;
+        for(int i = 0; i < p_info.chs.size(); ++i) {
+            if(p_info.chs.at(i).kind == FIFFV_STIM_CH) {
+                exclude << p_info.chs.at(i).ch_name;
+            }
+        }
+
+        cov = cov.regularize(p_info, 0.05, 0.05, 0.1, true, exclude);
+    }
+
+    return cov;
+}
+
+
+//*************************************************************************************************************
+
+void RtCovAccumulator::addBlock(const MatrixXd& matData)
+{
+    double dBlockCount = matData.cols();
+    VectorXd vecBlockMean = matData.rowwise().mean();
+    MatrixXd matCentered = matData.colwise() - vecBlockMean;
+
+    if(isEmpty()) {
+        m_dCount = dBlockCount;
+        m_vecMean = vecBlockMean;
+        m_matScatter = MatrixXd::Zero(matData.rows(), matData.rows());
+        m_matScatter.selfadjointView<Lower>().rankUpdate(matCentered);
+        return;
+    }
+
+    double dCount = m_dCount + dBlockCount;
+    VectorXd vecDelta = vecBlockMean - m_vecMean;
+
+    m_matScatter.selfadjointView<Lower>().rankUpdate(matCentered);
+    m_matScatter.selfadjointView<Lower>().rankUpdate(vecDelta, m_dCount * dBlockCount / dCount);
+    m_vecMean += vecDelta * (dBlockCount / dCount);
+    m_dCount = dCount;
+}
+
+
+//*************************************************************************************************************
+
+void RtCovAccumulator::removeBlock(const MatrixXd& matData)
+{
+    double dBlockCount = matData.cols();
+    double dCount = m_dCount - dBlockCount;
+
+    if(dCount <= 0.0) {
+        m_dCount = 0.0;
+        m_vecMean.resize(0);
+        m_matScatter.resize(0,0);
+        return;
+    }
+
+    VectorXd vecBlockMean = matData.rowwise().mean();
+    MatrixXd matCentered = matData.colwise() - vecBlockMean;
+    VectorXd vecMean = (m_dCount * m_vecMean - dBlockCount * vecBlockMean) / dCount;
+    VectorXd vecDelta = vecBlockMean - vecMean;
+
+    m_matScatter.selfadjointView<Lower>().rankUpdate(matCentered, -1.0);
+    m_matScatter.selfadjointView<Lower>().rankUpdate(vecDelta, -dCount * dBlockCount / m_dCount);
+    m_vecMean = vecMean;
+    m_dCount = dCount;
+}
+
+
+//*************************************************************************************************************
+
+void RtCovAccumulator::recomputeWindow()
+{
+    m_dCount = 0.0;
+    m_vecMean.resize(0);
+    m_matScatter.resize(0,0);
+
+    for(int i = 0; i < m_lWindowBlocks.size(); ++i)
+        addBlock(m_lWindowBlocks.at(i));
+
+    m_iNumDowndates = 0;
+}
@@ -0,0 +1,300 @@
+//=============================================================================================================
+/**
+* @file     rtcovaccumulator.h
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    RtCovAccumulator class declaration.
+*
+*/
+
+#ifndef RTCOVACCUMULATOR_H
+#define RTCOVACCUMULATOR_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../realtime_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// FIFF INCLUDES
+//=============================================================================================================
+
+#include <fiff/fiff_cov.h>
+#include <fiff/fiff_info.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QList>
+#include <QMetaType>
+#include <QSharedPointer>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE REALTIMELIB
+//=============================================================================================================
+
+namespace REALTIMELIB
+{
+
+
+//=============================================================================================================
+/**
+* Incremental covariance accumulator. The accumulator keeps the sufficient statistics (sample weight, mean and
+* scatter matrix) of the data seen so far. New data blocks are folded in with symmetric rank-k updates, so an
+* updated estimate is available at any time without a full recompute. Partial states of different threads can be
+* combined with merge(). The accumulator is not thread safe itself.
+*
+* @brief Incremental covariance accumulator with mergeable partial states
+*/
+class REALTIMESHARED_EXPORT RtCovAccumulator
+{
+public:
+    typedef QSharedPointer<RtCovAccumulator> SPtr;             /**< Shared pointer type for RtCovAccumulator. */
+    typedef QSharedPointer<const RtCovAccumulator> ConstSPtr;  /**< Const shared pointer type for RtCovAccumulator. */
+
+    /**
+    * The accumulation modes.
+    */
+    enum Mode {
+        Cumulative,         /**< All samples since the last reset contribute with equal weight. */
+        SlidingWindow,      /**< Only the most recent blocks covering the window size contribute. */
+        ExponentialDecay    /**< Older samples are down-weighted by the forgetting factor per sample. */
+    };
+
+    //=========================================================================================================
+    /**
+    * Constructs an empty accumulator.
+    *
+    * @param[in] mode       The accumulation mode.
+    */
+    explicit RtCovAccumulator(Mode mode = Cumulative);
+
+    //=========================================================================================================
+    /**
+    * Sets the accumulation mode and resets the accumulator.
+    *
+    * @param[in] mode       The accumulation mode.
+    */
+    void setMode(Mode mode);
+
+    //=========================================================================================================
+    /**
+    * Returns the accumulation mode.
+    *
+    * @return the accumulation mode.
+    */
+    inline Mode mode() const;
+
+    //=========================================================================================================
+    /**
+    * Sets the number of samples covered by the sliding window. Whole blocks are evicted, so the window holds at
+    * least the given number of samples. Only used in SlidingWindow mode.
+    *
+    * @param[in] iSamples   The window size in samples.
+    */
+    void setWindowSize(qint32 iSamples);
+
+    //=========================================================================================================
+    /**
+    * Sets the per sample forgetting factor in (0,1]. Only used in ExponentialDecay mode.
+    *
+    * @param[in] dLambda    The forgetting factor.
+    */
+    void setForgettingFactor(double dLambda);
+
+    //=========================================================================================================
+    /**
+    * Discards all accumulated samples. Mode, window size and forgetting factor are kept.
+    */
+    void reset();
+
+    //=========================================================================================================
+    /**
+    * Folds a new data block (channels x samples) into the accumulator.
+    *
+    * @param[in] matData    The data block.
+    */
+    void append(const Eigen::MatrixXd& matData);
+
+    //=========================================================================================================
+    /**
+    * Merges the sufficient statistics of another accumulator into this one. The window bookkeeping of p_other is
+    * not taken over, i.e. merged samples are never evicted from a sliding window.
+    *
+    * @param[in] p_other    The partial state to merge.
+    */
+    void merge(const RtCovAccumulator& p_other);
+
+    //=========================================================================================================
+    /**
+    * Returns the (effective) number of accumulated samples.
+    *
+    * @return the sample weight.
+    */
+    inline double count() const;
+
+    //=========================================================================================================
+    /**
+    * Returns true if no samples were accumulated yet.
+    *
+    * @return true if empty, false otherwise.
+    */
+    inline bool isEmpty() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the channel mean.
+    *
+    * @return the channel mean.
+    */
+    inline const Eigen::VectorXd& mean() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the symmetric scatter matrix, i.e. the sum of the centered outer products.
+    *
+    * @return the scatter matrix.
+    */
+    Eigen::MatrixXd scatter() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the unbiased covariance estimate.
+    *
+    * @return the covariance matrix.
+    */
+    Eigen::MatrixXd covariance() const;
+
+    //=========================================================================================================
+    /**
+    * Creates a noise covariance from the current estimate.
+    *
+    * @param[in] p_info         The measurement info the data belongs to.
+    * @param[in] bRegularize    Whether to regularize the covariance, excluding the stimulus channels.
+    *
+    * @return the noise covariance.
+    */
+    FIFFLIB::FiffCov toFiffCov(const FIFFLIB::FiffInfo& p_info, bool bRegularize = true) const;
+
+private:
+    //=========================================================================================================
+    /**
+    * Adds a data block to the sufficient statistics.
+    *
+    * @param[in] matData    The data block.
+    */
+    void addBlock(const Eigen::MatrixXd& matData);
+
+    //=========================================================================================================
+    /**
+    * Removes a previously added data block from the sufficient statistics.
+    *
+    * @param[in] matData    The data block.
+    */
+    void removeBlock(const Eigen::MatrixXd& matData);
+
+    //=========================================================================================================
+    /**
+    * Recomputes the sufficient statistics from the blocks of the sliding window. This bounds the round-off
+    * accumulated by the rank-k downdates.
+    */
+    void recomputeWindow();
+
+    Mode                    m_mode;                 /**< The accumulation mode. */
+    qint32                  m_iWindowSize;          /**< The sliding window size in samples. */
+    double                  m_dForgettingFactor;    /**< The per sample forgetting factor. */
+
+    double                  m_dCount;               /**< The (effective) number of accumulated samples. */
+    Eigen::VectorXd         m_vecMean;              /**< The channel mean. */
+    Eigen::MatrixXd         m_matScatter;           /**< The scatter matrix, only the lower triangle is valid. */
+
+    QList<Eigen::MatrixXd>  m_lWindowBlocks;        /**< The blocks of the sliding window. */
+    qint32                  m_iWindowSamples;       /**< The number of samples in the sliding window. */
+    qint32                  m_iNumDowndates;        /**< The number of downdates since the last recompute. */
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline RtCovAccumulator::Mode RtCovAccumulator::mode() const
+{
+    return m_mode;
+}
+
+
+//*************************************************************************************************************
+
+inline double RtCovAccumulator::count() const
+{
+    return m_dCount;
+}
+
+
+//*************************************************************************************************************
+
+inline bool RtCovAccumulator::isEmpty() const
+{
+    return m_dCount <= 0.0;
+}
+
+
+//*************************************************************************************************************
+
+inline const Eigen::VectorXd& RtCovAccumulator::mean() const
+{
+    return m_vecMean;
+}
+
+} // NAMESPACE
+
+#ifndef metatype_rtcovaccumulatorsptr
+#define metatype_rtcovaccumulatorsptr
+Q_DECLARE_METATYPE(REALTIMELIB::RtCovAccumulator::SPtr); /**< Provides QT META type declaration of the REALTIMELIB::RtCovAccumulator type. For signal/slot usage.*/
+#endif
+
+#endif // RTCOVACCUMULATOR_H
@@ -41,6 +41,22 @@
 #include "rtfilter.h"
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <algorithm>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QThread>
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // USED NAMESPACES
@@ -52,19 +68,84 @@ using namespace UTILSLIB;
 using namespace FIFFLIB;
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE REALTIMELIB STRUCTS
+//=============================================================================================================
+
+namespace REALTIMELIB
+{
+
+/**
+* Per-thread FFT object and buffers. The kissfft backend keeps scratch memory inside the FFT object, hence every
+* worker gets its own one. The twiddles are computed on the first transform and reused afterwards.
+*/
+struct RtFilterWorkspace
+{
+    RtFilterWorkspace()
+    {
+        fft.SetFlag(Eigen::FFT<double>::HalfSpectrum);
+        fft.SetFlag(Eigen::FFT<double>::Unscaled);
+    }
+
+    Eigen::FFT<double>  fft;            /**< The FFT object of this worker. */
+    RowVectorXd         vecTime;        /**< Zero padded time domain buffer. */
+    RowVectorXcd        vecFreq;        /**< Half spectrum buffer. */
+};
+
+} // NAMESPACE
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE GLOBAL METHODS
 //=============================================================================================================
 
-void doFilterPerChannelRTMSA(QPair<QList<FilterData>,QPair<int,RowVectorXd> > &channelDataTime)
+namespace {
+
+/**
+* One chunk of rows which is convolved by one worker.
+*/
+struct RtFilterJob
+{
+    RtFilterWorkspace*      pWorkspace;
+    const MatrixXd*         pMatIn;
+    const QVector<int>*     pRows;
+    const RowVectorXcd*     pSpectrum;
+    MatrixXd*               pMatOut;
+    int                     iBegin;
+    int                     iEnd;
+    int                     iFFTLength;
+};
+
+void doFilterRowsRtFilter(RtFilterJob& job)
 {
-    for(int i = 0; i < channelDataTime.first.size(); ++i) {
-        //channelDataTime.second.second = channelDataTime.first.at(i).applyConvFilter(channelDataTime.second.second, true, FilterData::ZeroPad);
-        channelDataTime.second.second = channelDataTime.first.at(i).applyFFTFilter(channelDataTime.second.second, true, FilterData::ZeroPad); //FFT Convolution for rt is not suitable. FFT make the signal filtering non causal.
+    RtFilterWorkspace& ws = *job.pWorkspace;
+    const int iSamples = job.pMatIn->cols();
+    const int iOutCols = job.pMatOut->cols();
+
+    if(ws.vecTime.cols() != job.iFFTLength) {
+        ws.vecTime.resize(job.iFFTLength);
+        ws.vecFreq.resize(job.iFFTLength/2+1);
+    }
+
+    //Unscaled transforms, the 1/N normalisation is folded into the planned spectrum
+    for(int k = job.iBegin; k < job.iEnd; ++k) {
+        const int iRow = job.pRows->at(k);
+
+        ws.vecTime.head(iSamples) = job.pMatIn->row(iRow);
+        ws.vecTime.tail(job.iFFTLength - iSamples).setZero();
+
+        ws.fft.fwd(ws.vecFreq.data(), ws.vecTime.data(), job.iFFTLength);
+        ws.vecFreq.array() *= job.pSpectrum->array();
+        ws.fft.inv(ws.vecTime.data(), ws.vecFreq.data(), job.iFFTLength);
+
+        job.pMatOut->row(iRow) = ws.vecTime.head(iOutCols);
     }
 }
 
+} // NAMESPACE
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -72,6 +153,7 @@ void doFilterPerChannelRTMSA(QPair<QList<FilterData>,QPair<int,RowVectorXd> > &c
 //=============================================================================================================
 
 RtFilter::RtFilter()
+: m_mode(FFTOverlapAdd)
 {
 }
 
@@ -85,70 +167,244 @@ RtFilter::~RtFilter()
 
 //*************************************************************************************************************
 
-MatrixXd RtFilter::filterChannelsConcurrently(const MatrixXd& matDataIn, int iMaxFilterLength, const QVector<int>& lFilterChannelList, const QList<FilterData>& lFilterData)
+void RtFilter::setFilters(const QList<FilterData>& lFilterData, FilterMode mode)
+{
+    m_lFilterData = lFilterData;
+    m_mode = mode;
+    m_mapFilterSpectra.clear();
+
+    //Cascade all filters into one impulse response
+    m_vecCoeff.resize(0);
+
+    for(int i = 0; i < lFilterData.size(); ++i) {
+        const RowVectorXd& vecCoeff = lFilterData.at(i).m_dCoeffA;
+
+        if(vecCoeff.cols() == 0) {
+            continue;
+        }
+
+        if(m_vecCoeff.cols() == 0) {
+            m_vecCoeff = vecCoeff;
+            continue;
+        }
+
+        RowVectorXd vecCascade = RowVectorXd::Zero(m_vecCoeff.cols() + vecCoeff.cols() - 1);
+        for(int k = 0; k < vecCoeff.cols(); ++k) {
+            vecCascade.segment(k, m_vecCoeff.cols()) += vecCoeff(k) * m_vecCoeff;
+        }
+        m_vecCoeff = vecCascade;
+    }
+
+    reset();
+}
+
+
+//*************************************************************************************************************
+
+void RtFilter::reset()
+{
+    m_matOverlap.resize(0,0);
+    m_matDelay.resize(0,0);
+}
+
+
+//*************************************************************************************************************
+
+void RtFilter::filterData(MatrixXd& matData, const QVector<int>& lFilterChannelList)
 {
-    //Initialise the overlay matrix
-    if(m_matOverlap.cols() != iMaxFilterLength || m_matOverlap.rows() < matDataIn.rows()) {
-        m_matOverlap.resize(matDataIn.rows(), iMaxFilterLength);
-        m_matOverlap.setZero();
+    const int iTaps = filterLength();
+
+    if(iTaps == 0 || matData.cols() == 0) {
+        return;
     }
 
-    if(m_matDelay.cols() != iMaxFilterLength/2 || m_matOverlap.rows() < matDataIn.rows()) {
-        m_matDelay.resize(matDataIn.rows(), iMaxFilterLength/2);
-        m_matDelay.setZero();
+    const int iSamples = matData.cols();
+    const int iDelay = delay();
+
+    prepareState(matData.rows());
+
+    QVector<int> lRows;
+    lRows.reserve(lFilterChannelList.size());
+    for(int i = 0; i < lFilterChannelList.size(); ++i) {
+        if(lFilterChannelList.at(i) >= 0 && lFilterChannelList.at(i) < matData.rows()) {
+            lRows.append(lFilterChannelList.at(i));
+        }
     }
 
-    //Resize output matrix to match input matrix
-    MatrixXd matDataOut(matDataIn.rows(), matDataIn.cols());
+    //Filter the selected rows before the block is overwritten by the delay line
+    if(!lRows.isEmpty()) {
+        if(m_mode == FFTOverlapAdd) {
+            convolve(matData, lRows, m_matBlockBuffer);
+        } else {
+            //Direct form: y[n] = sum_k h[k]*x[n-k], the history holds the last taps-1 input samples
+            MatrixXd matExt(lRows.size(), iTaps - 1 + iSamples);
+            for(int k = 0; k < lRows.size(); ++k) {
+                matExt.row(k) << m_matOverlap.row(lRows.at(k)), matData.row(lRows.at(k));
+            }
+
+            if(m_matBlockBuffer.rows() != lRows.size() || m_matBlockBuffer.cols() != iSamples) {
+                m_matBlockBuffer.resize(lRows.size(), iSamples);
+            }
+            m_matBlockBuffer.setZero();
+
+            for(int k = 0; k < iTaps; ++k) {
+                m_matBlockBuffer.noalias() += m_vecCoeff(k) * matExt.middleCols(iTaps - 1 - k, iSamples);
+            }
+
+            for(int k = 0; k < lRows.size(); ++k) {
+                m_matOverlap.row(lRows.at(k)) = matExt.row(k).tail(iTaps - 1);
+            }
+        }
+    }
 
-    //Generate QList structure which can be handled by the QConcurrent framework
-    QList<QPair<QList<FilterData>,QPair<int,RowVectorXd> > > timeData;
-    QList<int> notFilterChannelIndex;
+    //Delay all rows by the group delay of the filter so that unfiltered channels stay aligned
+    if(iDelay > 0) {
+        MatrixXd matDelayed(matData.rows(), iDelay + iSamples);
+        matDelayed << m_matDelay, matData;
+        matData = matDelayed.leftCols(iSamples);
+        m_matDelay = matDelayed.rightCols(iDelay);
+    }
 
-    //Only select channels specified in lFilterChannelList
-    for(qint32 i = 0; i < matDataIn.rows(); ++i) {
-        int pos = lFilterChannelList.indexOf(i);
-        if(pos != -1 && pos < matDataIn.rows()) {
-            timeData.append(QPair<QList<FilterData>,QPair<int,RowVectorXd> >(lFilterData,QPair<int,RowVectorXd>(pos,matDataIn.row(pos))));
+    //Write the filtered rows
+    if(!lRows.isEmpty()) {
+        if(m_mode == FFTOverlapAdd) {
+            //Overlap-add: the first taps-1 samples of the convolution receive the tail of the previous block
+            for(int k = 0; k < lRows.size(); ++k) {
+                const int iRow = lRows.at(k);
+                m_matBlockBuffer.row(iRow).head(iTaps - 1) += m_matOverlap.row(iRow);
+                matData.row(iRow) = m_matBlockBuffer.row(iRow).head(iSamples);
+                m_matOverlap.row(iRow) = m_matBlockBuffer.row(iRow).segment(iSamples, iTaps - 1);
+            }
         } else {
-            notFilterChannelIndex.append(i);
+            for(int k = 0; k < lRows.size(); ++k) {
+                matData.row(lRows.at(k)) = m_matBlockBuffer.row(k);
+            }
         }
     }
+}
 
-    //Do the concurrent filtering
-    if(!timeData.isEmpty()) {
-        QFuture<void> future = QtConcurrent::map(timeData,
-                                             doFilterPerChannelRTMSA);
 
-        future.waitForFinished();
+//*************************************************************************************************************
+
+void RtFilter::convolve(const MatrixXd& matDataIn, const QVector<int>& lFilterChannelList, MatrixXd& matDataOut)
+{
+    const int iTaps = filterLength();
+    const int iOutCols = matDataIn.cols() + std::max(iTaps, 1) - 1;
 
-        //Do the overlap add method and store in matDataOut
-        int iFilteredNumberCols = timeData.at(0).second.second.cols();
+    if(matDataOut.rows() != matDataIn.rows() || matDataOut.cols() != iOutCols) {
+        matDataOut.resize(matDataIn.rows(), iOutCols);
+    }
+
+    if(iTaps == 0 || lFilterChannelList.isEmpty()) {
+        for(int i = 0; i < lFilterChannelList.size(); ++i) {
+            matDataOut.row(lFilterChannelList.at(i)) = matDataIn.row(lFilterChannelList.at(i));
+        }
+        return;
+    }
 
-        for(int r = 0; r < timeData.size(); r++) {
-            //Get the currently filtered data. This data has a delay of filterLength/2 in front and back.
-            RowVectorXd tempData = timeData.at(r).second.second;
+    //Smallest power of two which holds the linear convolution without wrap around
+    int iFFTLength = 2;
+    while(iFFTLength < iOutCols) {
+        iFFTLength *= 2;
+    }
 
-            //Perform the actual overlap add by adding the last filterlength data to the newly filtered one
-            tempData.head(iMaxFilterLength) += m_matOverlap.row(timeData.at(r).second.first);
+    const RowVectorXcd& vecSpectrum = filterSpectrum(iFFTLength);
 
-            //Write the newly calulated filtered data to the filter data matrix. Keep in mind that the current block also effect last part of the last block (begin at dataIndex-iFilterDelay).
-            int start = 0;
-            matDataOut.row(timeData.at(r).second.first).segment(start,iFilteredNumberCols-iMaxFilterLength) = tempData.head(iFilteredNumberCols-iMaxFilterLength);
+    //Distribute the rows in contiguous chunks over persistent workspaces
+    const int iNumThreads = std::max(1, std::min(QThread::idealThreadCount(), lFilterChannelList.size()));
+    while(m_lWorkspaces.size() < iNumThreads) {
+        m_lWorkspaces.append(QSharedPointer<RtFilterWorkspace>(new RtFilterWorkspace()));
+    }
 
-            //Refresh the m_matOverlap with the new calculated filtered data.
-            m_matOverlap.row(timeData.at(r).second.first) = timeData.at(r).second.second.tail(iMaxFilterLength);
+    QList<RtFilterJob> lJobs;
+    const int iChunk = (lFilterChannelList.size() + iNumThreads - 1) / iNumThreads;
+
+    for(int t = 0; t < iNumThreads; ++t) {
+        RtFilterJob job;
+        job.pWorkspace = m_lWorkspaces.at(t).data();
+        job.pMatIn = &matDataIn;
+        job.pRows = &lFilterChannelList;
+        job.pSpectrum = &vecSpectrum;
+        job.pMatOut = &matDataOut;
+        job.iBegin = t * iChunk;
+        job.iEnd = std::min(job.iBegin + iChunk, lFilterChannelList.size());
+        job.iFFTLength = iFFTLength;
+
+        if(job.iBegin < job.iEnd) {
+            lJobs.append(job);
         }
     }
 
-    //Fill filtered data with raw data if the channel was not filtered
-    for(int i = 0; i < notFilterChannelIndex.size(); ++i) {
-        matDataOut.row(notFilterChannelIndex.at(i)) << m_matDelay.row(notFilterChannelIndex.at(i)), matDataIn.row(notFilterChannelIndex.at(i)).head(matDataIn.cols() - iMaxFilterLength/2);
+    if(lJobs.size() == 1) {
+        doFilterRowsRtFilter(lJobs.first());
+    } else {
+        QtConcurrent::blockingMap(lJobs, doFilterRowsRtFilter);
+    }
+}
+
+
+//*************************************************************************************************************
 
-        //matDataOut.row(notFilterChannelIndex.at(i)).segment(0, matDataIn.row(notFilterChannelIndex.at(i)).cols()) = matDataIn.row(notFilterChannelIndex.at(i));
+MatrixXd RtFilter::filterChannelsConcurrently(const MatrixXd& matDataIn, int iMaxFilterLength, const QVector<int>& lFilterChannelList, const QList<FilterData>& lFilterData)
+{
+    Q_UNUSED(iMaxFilterLength);
+
+    //Only re-plan if the filters changed
+    bool bChanged = lFilterData.size() != m_lFilterData.size();
+    for(int i = 0; !bChanged && i < lFilterData.size(); ++i) {
+        bChanged = lFilterData.at(i).m_sName != m_lFilterData.at(i).m_sName
+                   || lFilterData.at(i).m_dCoeffA.cols() != m_lFilterData.at(i).m_dCoeffA.cols()
+                   || lFilterData.at(i).m_dCoeffA != m_lFilterData.at(i).m_dCoeffA;
+    }
+
+    if(bChanged) {
+        setFilters(lFilterData, m_mode);
     }
 
-    m_matDelay = matDataIn.block(0, matDataIn.cols()-iMaxFilterLength/2, matDataIn.rows(), iMaxFilterLength/2);
+    MatrixXd matDataOut = matDataIn;
+    filterData(matDataOut, lFilterChannelList);
 
     return matDataOut;
 }
+
+
+//*************************************************************************************************************
+
+const RowVectorXcd& RtFilter::filterSpectrum(int iFFTLength)
+{
+    QMap<int, RowVectorXcd>::iterator it = m_mapFilterSpectra.find(iFFTLength);
+
+    if(it == m_mapFilterSpectra.end()) {
+        RowVectorXd vecCoeffZeroPad = RowVectorXd::Zero(iFFTLength);
+        vecCoeffZeroPad.head(m_vecCoeff.cols()) = m_vecCoeff;
+
+        Eigen::FFT<double> fft;
+        fft.SetFlag(fft.HalfSpectrum);
+
+        RowVectorXcd vecSpectrum;
+        fft.fwd(vecSpectrum, vecCoeffZeroPad);
+
+        //The inverse transforms of the workspaces are unscaled
+        vecSpectrum /= static_cast<double>(iFFTLength);
+
+        it = m_mapFilterSpectra.insert(iFFTLength, vecSpectrum);
+    }
+
+    return it.value();
+}
+
+
+//*************************************************************************************************************
+
+void RtFilter::prepareState(int iRows)
+{
+    const int iTaps = filterLength();
+
+    if(m_matOverlap.rows() != iRows || m_matOverlap.cols() != iTaps - 1) {
+        m_matOverlap = MatrixXd::Zero(iRows, iTaps - 1);
+    }
+
+    if(m_matDelay.rows() != iRows || m_matDelay.cols() != delay()) {
+        m_matDelay = MatrixXd::Zero(iRows, delay());
+    }
+}
@@ -52,6 +52,9 @@
 //=============================================================================================================
 
 #include <QSharedPointer>
+#include <QList>
+#include <QMap>
+#include <QVector>
 #include <QtConcurrent/QtConcurrent>
 #include <QFuture>
 
@@ -76,15 +79,23 @@ namespace REALTIMELIB
 
 //*************************************************************************************************************
 //=============================================================================================================
-// USED NAMESPACES
+// REALTIMELIB FORWARD DECLARATIONS
 //=============================================================================================================
 
+struct RtFilterWorkspace;
+
 
 //=============================================================================================================
 /**
-* Real-time noise Spectrum estimation
+* Stateful multichannel streaming filter. The active filters are combined into one FIR impulse response once.
+* In FFTOverlapAdd mode its spectrum is planned once per FFT length and blocks are filtered with real-to-complex
+* transforms, distributed over per-thread workspaces which are kept between blocks. In CausalDirectForm mode the
+* blocks are convolved in the time domain against a per-channel history of the last taps-1 input samples, so no
+* FFT buffers are needed and the cost grows with the number of taps. Both modes return the same samples with the
+* same delay, the group delay of the filter. In both modes the per-channel state lives in one contiguous matrix
+* and the selected channels are filtered in place.
 *
-* @brief Real-time Noise estimation
+* @brief Real-time streaming filter
 */
 class REALTIMESHARED_EXPORT RtFilter
 {
@@ -93,41 +104,145 @@ public:
     typedef QSharedPointer<RtFilter> SPtr;             /**< Shared pointer type for RtFilter. */
     typedef QSharedPointer<const RtFilter> ConstSPtr;  /**< Const shared pointer type for RtFilter. */
 
+    enum FilterMode {
+        FFTOverlapAdd,          /**< Overlap-add with planned FFTs, cost independent of the number of taps. */
+        CausalDirectForm        /**< Time domain convolution with per-channel history, no FFT buffers, cost proportional to the number of taps. Same group delay as FFTOverlapAdd. */
+    };
+
     //=========================================================================================================
     /**
-    * Creates the real-time covariance estimation object.
+    * Creates the real-time filter object.
     */
     explicit RtFilter();
 
     //=========================================================================================================
     /**
-    * Destroys the Real-time noise estimation object.
+    * Destroys the real-time filter object.
     */
     ~RtFilter();
 
     //=========================================================================================================
     /**
-    * Calculates the filtered version of the raw input data
+    * Sets the filters to apply. The filters are cascaded into a single impulse response, the filter state is reset.
+    *
+    * @param [in] lFilterData   The filters.
+    * @param [in] mode          The filter mode.
+    */
+    void setFilters(const QList<UTILSLIB::FilterData>& lFilterData, FilterMode mode = FFTOverlapAdd);
+
+    //=========================================================================================================
+    /**
+    * Resets the per-channel filter state, the filters and FFT plans are kept.
+    */
+    void reset();
+
+    //=========================================================================================================
+    /**
+    * Filters the rows given in lFilterChannelList in place and keeps the overlap/history for the next block. The
+    * output is the causal filter output, i.e. delayed by delay() samples. All other rows are delayed by delay()
+    * samples as well, so the block stays aligned.
+    *
+    * @param [in, out] matData          The data block (channels x samples).
+    * @param [in] lFilterChannelList    The rows to filter.
+    */
+    void filterData(Eigen::MatrixXd& matData, const QVector<int>& lFilterChannelList);
+
+    //=========================================================================================================
+    /**
+    * Computes the full linear convolution of the rows given in lFilterChannelList with the filter, without
+    * touching the filter state. matDataOut has as many rows as matDataIn and matDataIn.cols() + filterLength() - 1
+    * columns, rows which are not filtered are left untouched.
+    *
+    * @param [in] matDataIn             The data block (channels x samples).
+    * @param [in] lFilterChannelList    The rows to filter.
+    * @param [out] matDataOut           The convolved rows.
+    */
+    void convolve(const Eigen::MatrixXd& matDataIn, const QVector<int>& lFilterChannelList, Eigen::MatrixXd& matDataOut);
+
+    //=========================================================================================================
+    /**
+    * Calculates the filtered version of the raw input data. Kept for compatibility, the filters are only
+    * re-planned if lFilterData changed since the last call.
     *
-    * @param [in] matDataIn     data which is to be filtered
-    * @param [out] matDataOut    data which is to be filtered
-    * @param [in] iDataIndex    current position in the global data matrix
+    * @param [in] matDataIn             Data which is to be filtered.
+    * @param [in] iMaxFilterLength      Ignored, the length is taken from the filters.
+    * @param [in] lFilterChannelList    The rows to filter.
+    * @param [in] lFilterData           The filters.
+    *
+    * @return the filtered data.
     */
     Eigen::MatrixXd filterChannelsConcurrently(const Eigen::MatrixXd& matDataIn, int iMaxFilterLength, const QVector<int>& lFilterChannelList, const QList<UTILSLIB::FilterData> &lFilterData);
 
+    //=========================================================================================================
+    /**
+    * Returns the number of taps of the combined filter.
+    */
+    inline int filterLength() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the delay of the output in samples.
+    */
+    inline int delay() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the current filter mode.
+    */
+    inline FilterMode mode() const;
+
 protected:
-    Eigen::MatrixXd                 m_matOverlap;                   /**< Last overlap block */
-    Eigen::MatrixXd                 m_matDelay;                     /**< Last delay block */
+    //=========================================================================================================
+    /**
+    * Returns the planned half spectrum of the combined filter for the given FFT length.
+    */
+    const Eigen::RowVectorXcd& filterSpectrum(int iFFTLength);
 
-private:
+    //=========================================================================================================
+    /**
+    * Makes sure the state matrices match the block size.
+    */
+    void prepareState(int iRows);
+
+    Eigen::MatrixXd                 m_matOverlap;                   /**< Per-channel overlap (FFT mode) or history (direct form), (channels x taps-1). */
+    Eigen::MatrixXd                 m_matDelay;                     /**< Last delay block of the channels which are not filtered. */
 
+private:
+    Eigen::RowVectorXd                          m_vecCoeff;                 /**< Combined impulse response of all filters. */
+    QMap<int, Eigen::RowVectorXcd>              m_mapFilterSpectra;         /**< Planned filter spectra per FFT length. */
+    QList<QSharedPointer<RtFilterWorkspace> >   m_lWorkspaces;              /**< Per-thread FFT objects and buffers. */
+    QList<UTILSLIB::FilterData>                 m_lFilterData;              /**< The filters currently planned. */
+    FilterMode                                  m_mode;                     /**< The filter mode. */
+    Eigen::MatrixXd                             m_matBlockBuffer;           /**< Scratch block of the filtered rows. */
 };
 
+
 //*************************************************************************************************************
 //=============================================================================================================
 // INLINE DEFINITIONS
 //=============================================================================================================
 
+inline int RtFilter::filterLength() const
+{
+    return m_vecCoeff.cols();
+}
+
+
+//*************************************************************************************************************
+
+inline int RtFilter::delay() const
+{
+    return m_vecCoeff.cols()/2;
+}
+
+
+//*************************************************************************************************************
+
+inline RtFilter::FilterMode RtFilter::mode() const
+{
+    return m_mode;
+}
+
 } // NAMESPACE
 
 #endif // RTFILTER_H
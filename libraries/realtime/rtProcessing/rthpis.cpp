@@ -44,7 +44,7 @@
 
 #include "rthpis.h"
 
-#include <inverse/hpiFit/hpifit.h>
+#include <inverse/hpiFit/hpifitter.h>
 #include <fiff/fiff_info.h>
 
 
@@ -88,14 +88,20 @@ void RtHPISWorker::doWork(const Eigen::MatrixXd& matData,
     FittingResult fitResult;
     fitResult.devHeadTrans.from = 1;
     fitResult.devHeadTrans.to = 4;
-
-    HPIFit::fitHPI(matData,
-                    m_matProjectors,
-                    fitResult.devHeadTrans,
-                    vFreqs,
-                    fitResult.errorDistances,
-                    fitResult.fittedCoils,
-                    pFiffInfo);
+    fitResult.fitTime = 0.0;
+
+    if(!m_pHPIFitter || m_pHPIFitter->fiffInfo() != pFiffInfo) {
+        m_pHPIFitter = HPIFitter::SPtr(new HPIFitter(pFiffInfo));
+    }
+
+    if(m_pHPIFitter->fit(matData,
+                         m_matProjectors,
+                         fitResult.devHeadTrans,
+                         vFreqs,
+                         fitResult.errorDistances,
+                         fitResult.fittedCoils)) {
+        fitResult.fitTime = m_pHPIFitter->lastTiming().dTotal;
+    }
 
     emit resultReady(fitResult);
 }
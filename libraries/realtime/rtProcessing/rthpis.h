@@ -80,6 +80,10 @@ namespace FIFFLIB{
     class FiffInfo;
 }
 
+namespace INVERSELIB{
+    class HPIFitter;
+}
+
 
 //*************************************************************************************************************
 //=============================================================================================================
@@ -102,6 +106,7 @@ struct FittingResult {
     FIFFLIB::FiffDigPointSet fittedCoils;
     FIFFLIB::FiffCoordTrans devHeadTrans;
     QVector<double> errorDistances;
+    double fitTime;         /**< The time the fit took in milliseconds. */
 };
 
 //=============================================================================================================
@@ -117,7 +122,8 @@ class RtHPISWorker : public QObject
 public:
     //=========================================================================================================
     /**
-    * Perform one single HPI fit.
+    * Perform one single HPI fit. The fitter and its cached sensor model are kept between calls and are
+    * only recreated if the measurement info changes.
     *
     * @param[in] t_mat           Data to estimate the HPI positions from
     * @param[in] t_matProjectors The projectors to apply. Bad channels are still included.
@@ -129,6 +135,9 @@ public:
                 const QVector<int>& vFreqs,
                 QSharedPointer<FIFFLIB::FiffInfo> pFiffInfo);
 
+protected:
+    QSharedPointer<INVERSELIB::HPIFitter>   m_pHPIFitter;      /**< The stateful HPI fitter. */
+
 signals:
     void resultReady(const REALTIMELIB::FittingResult &fitResult);
 };
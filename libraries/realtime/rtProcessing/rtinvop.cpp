@@ -66,10 +66,12 @@ using namespace REALTIMELIB;
 RtInvOp::RtInvOp(FiffInfo::SPtr &p_pFiffInfo, MNEForwardSolution::SPtr &p_pFwd, QObject *parent)
 : QThread(parent)
 , m_bIsRunning(false)
+, m_bCovAccumulatorUpdated(false)
 , m_pFiffInfo(p_pFiffInfo)
 , m_pFwd(p_pFwd)
 {
     qRegisterMetaType<MNEInverseOperator::SPtr>("MNEInverseOperator::SPtr");
+    qRegisterMetaType<RtCovAccumulator::SPtr>("RtCovAccumulator::SPtr");
 }
 
 
@@ -91,15 +93,61 @@ void RtInvOp::appendNoiseCov(FiffCov &p_noiseCov)
 
     qDebug() << "RtInvOp m_vecNoiseCov" << m_vecNoiseCov.size();
 
+    m_waitCondition.wakeOne();
     mutex.unlock();
 }
 
 
+//*************************************************************************************************************
+
+void RtInvOp::appendCovAccumulator(RtCovAccumulator::SPtr p_pCovAccumulator)
+{
+    if(!p_pCovAccumulator)
+        return;
+
+    mutex.lock();
+    m_covAccumulator.merge(*p_pCovAccumulator);
+    m_bCovAccumulatorUpdated = true;
+    m_waitCondition.wakeOne();
+    mutex.unlock();
+}
+
+
+//*************************************************************************************************************
+
+void RtInvOp::resetCovAccumulator()
+{
+    mutex.lock();
+    m_covAccumulator.reset();
+    m_bCovAccumulatorUpdated = false;
+    mutex.unlock();
+}
+
+
+//*************************************************************************************************************
+
+bool RtInvOp::start()
+{
+    //Check if the thread is still stopping
+    if(QThread::isRunning())
+        QThread::wait();
+
+    m_bIsRunning = true;
+    QThread::start();
+
+    return true;
+}
+
+
 //*************************************************************************************************************
 
 bool RtInvOp::stop()
 {
+    mutex.lock();
     m_bIsRunning = false;
+    m_waitCondition.wakeOne();
+    mutex.unlock();
+
     QThread::wait();
 
     return true;
@@ -110,19 +158,43 @@ bool RtInvOp::stop()
 
 void RtInvOp::run()
 {
-    m_bIsRunning = true;
-
     while(m_bIsRunning)
     {
+        //Only the most recent estimate is of interest, older ones are skipped
+        FiffCov t_noiseCov;
+        RtCovAccumulator t_covAccumulator;
+        bool t_bHasNoiseCov = false;
+
+        mutex.lock();
+        //Sleep until a covariance arrived or the thread is stopped
+        while(m_bIsRunning && m_vecNoiseCov.isEmpty() && !(m_bCovAccumulatorUpdated && m_covAccumulator.count() > 1.0))
+            m_waitCondition.wait(&mutex);
+
         if(m_vecNoiseCov.size() > 0)
+        {
+            t_noiseCov = m_vecNoiseCov.last();
+            m_vecNoiseCov.clear();
+            t_bHasNoiseCov = true;
+        }
+        else if(m_bCovAccumulatorUpdated && m_covAccumulator.count() > 1.0)
+        {
+            t_covAccumulator = m_covAccumulator;
+            m_bCovAccumulatorUpdated = false;
+        }
+        mutex.unlock();
+
+        if(!t_covAccumulator.isEmpty())
+        {
+            t_noiseCov = t_covAccumulator.toFiffCov(*m_pFiffInfo.data(), true);
+            t_bHasNoiseCov = true;
+        }
+
+        if(t_bHasNoiseCov)
         {
             // Restrict forward solution as necessary for MEG
             MNEForwardSolution t_forwardMeg = m_pFwd->pick_types(true, false);
 
-            mutex.lock();
-            MNEInverseOperator::SPtr t_invOpMeg(new MNEInverseOperator(*m_pFiffInfo.data(), t_forwardMeg, m_vecNoiseCov[0], 0.2f, 0.8f));
-            m_vecNoiseCov.pop_front();
-            mutex.unlock();
+            MNEInverseOperator::SPtr t_invOpMeg(new MNEInverseOperator(*m_pFiffInfo.data(), t_forwardMeg, t_noiseCov, 0.2f, 0.8f));
 
             emit invOperatorCalculated(t_invOpMeg);
         }
@@ -42,6 +42,7 @@
 //=============================================================================================================
 
 #include "../realtime_global.h"
+#include "rtcovaccumulator.h"
 
 
 //*************************************************************************************************************
@@ -68,6 +69,7 @@
 #include <QThread>
 #include <QMutex>
 #include <QSharedPointer>
+#include <QWaitCondition>
 
 
 //*************************************************************************************************************
@@ -134,6 +136,29 @@ public:
     */
     void appendNoiseCov(FiffCov &p_NoiseCov);
 
+    //=========================================================================================================
+    /**
+    * Slot to receive partial covariance states, e.g. RtCov::covAccumulatorCalculated of several producer threads.
+    * The states are merged into a running estimate, which is regularized and used for the next inverse operator.
+    *
+    * @param[in] p_pCovAccumulator  Partial covariance state of data not appended before
+    */
+    void appendCovAccumulator(RtCovAccumulator::SPtr p_pCovAccumulator);
+
+    //=========================================================================================================
+    /**
+    * Discards the running covariance estimate of the merged partial states.
+    */
+    void resetCovAccumulator();
+
+    //=========================================================================================================
+    /**
+    * Starts the RtInv by starting the producer's thread.
+    *
+    * @return true if succeeded, false otherwise
+    */
+    virtual bool start();
+
     //=========================================================================================================
     /**
     * Stops the RtInv by stopping the producer's thread.
@@ -170,9 +195,12 @@ protected:
 
 private:
     QMutex      mutex;                  /**< Provides access serialization between threads. */
+    QWaitCondition m_waitCondition;     /**< Wakes the thread when a covariance arrived or the thread is stopped. */
     bool        m_bIsRunning;           /**< Whether RtInv is running. */
 
     QVector<FiffCov> m_vecNoiseCov;     /**< Noise covariance matrices. */
+    RtCovAccumulator m_covAccumulator;  /**< Running covariance estimate of the merged partial states. */
+    bool        m_bCovAccumulatorUpdated;   /**< Whether partial states were merged since the last inverse operator. */
 
     FiffInfo::SPtr m_pFiffInfo;         /**< The fiff measurement information. */
     MNEForwardSolution::SPtr m_pFwd;    /**< The forward solution. */
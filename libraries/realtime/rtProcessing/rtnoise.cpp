@@ -85,7 +85,7 @@ RtNoise::RtNoise(qint32 p_iMaxSamples, FiffInfo::SPtr p_pFiffInfo, qint32 p_data
 
     m_Fs = m_pFiffInfo->sfreq;
 
-    m_bSendDataToBuffer = true;
+    m_iSendDataToBuffer.store(1);
 
     m_fWin.clear();
 
@@ -159,7 +159,7 @@ void RtNoise::append(const MatrixXd &p_DataSegment)
     if(!m_pRawMatrixBuffer)
         m_pRawMatrixBuffer = CircularMatrixBuffer<double>::SPtr(new CircularMatrixBuffer<double>(8, p_DataSegment.rows(), p_DataSegment.cols()));
 
-    if (m_bSendDataToBuffer)
+    if (m_iSendDataToBuffer.loadAcquire())
         m_pRawMatrixBuffer->push(&p_DataSegment);
 }
 
@@ -185,10 +185,9 @@ bool RtNoise::stop()
 {
     m_bIsRunning = false;
 
+    //run() drains the buffer when it returns, clear() must not race with append()
     m_pRawMatrixBuffer->releaseFromPop();
 
-    m_pRawMatrixBuffer->clear();
-
     qDebug()<<" RtNoise Thread is stopped.";
 
     return true;
@@ -230,7 +229,7 @@ void RtNoise::run()
 
                 //m_pRawMatrixBuffer.clear(); //empty the buffer
 
-                m_bSendDataToBuffer = false;
+                m_iSendDataToBuffer.storeRelease(0);
                 //stop collect block and start to calculate the spectrum
                 m_iBlockIndex = 0;
 
@@ -298,15 +297,23 @@ void RtNoise::run()
 
                 qDebug()<<"Send spectrum to Noise Estimator";
                 emit SpecCalculated(t_psdx); //send back the spectrum result
-                if(m_pRawMatrixBuffer->size()>0)
-                    m_pRawMatrixBuffer->clear();
+                //drop the blocks which arrived during the computation, popping is safe next to a concurrent push
+                MatrixXd t_matDropped;
+                while(m_pRawMatrixBuffer->tryPop(t_matDropped))
+                    ;
 
-                m_bSendDataToBuffer = true;
+                m_iSendDataToBuffer.storeRelease(1);
             }
 
         }
 
     }
 
+    if(m_pRawMatrixBuffer)
+    {
+        MatrixXd t_matDropped;
+        while(m_pRawMatrixBuffer->tryPop(t_matDropped))
+            ;
+    }
 }
 
@@ -69,6 +69,7 @@
 
 #include <QThread>
 #include <QMutex>
+#include <QAtomicInt>
 #include <QSharedPointer>
 #include <QVector>
 
@@ -210,7 +211,7 @@ public:
     MatrixXd m_matSpecData;
     QMutex ReadMutex;
 
-    bool m_bSendDataToBuffer;
+    QAtomicInt m_iSendDataToBuffer;     /**< Set while append() passes blocks on, cleared while run() computes a spectrum. */
 
 };
 
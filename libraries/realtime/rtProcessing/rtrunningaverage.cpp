@@ -0,0 +1,186 @@
+//=============================================================================================================
+/**
+* @file     rtrunningaverage.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Definition of the RtRunningAverage Class.
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "rtrunningaverage.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace REALTIMELIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+RtRunningAverage::RtRunningAverage(qint32 iMaxEpochs)
+: m_iMaxEpochs(iMaxEpochs > 0 ? iMaxEpochs : 0)
+, m_iCount(0)
+, m_iOldest(0)
+, m_iNumReplaced(0)
+{
+}
+
+
+//*************************************************************************************************************
+
+void RtRunningAverage::setMaxEpochs(qint32 iMaxEpochs)
+{
+    m_iMaxEpochs = iMaxEpochs > 0 ? iMaxEpochs : 0;
+    m_matRing.resize(0,0);
+    reset();
+}
+
+
+//*************************************************************************************************************
+
+void RtRunningAverage::reset()
+{
+    m_iCount = 0;
+    m_iOldest = 0;
+    m_iNumReplaced = 0;
+}
+
+
+//*************************************************************************************************************
+
+void RtRunningAverage::append(const MatrixXd& matEpoch)
+{
+    const qint32 iCols = matEpoch.cols();
+
+    //(Re)allocate if this is the first epoch or the epoch size changed
+    if(m_iCount == 0 || matEpoch.rows() != m_matMean.rows() || iCols != m_matMean.cols()) {
+        reset();
+        m_matMean.resize(matEpoch.rows(), iCols);
+        m_matM2.resize(matEpoch.rows(), iCols);
+
+        if(m_iMaxEpochs > 0 && (m_matRing.rows() != matEpoch.rows() || m_matRing.cols() != iCols * m_iMaxEpochs)) {
+            m_matRing.resize(matEpoch.rows(), iCols * m_iMaxEpochs);
+        }
+    }
+
+    if(m_iMaxEpochs > 0 && m_iCount == m_iMaxEpochs) {
+        //Replace the oldest epoch: x_new enters, x_old leaves, the number of epochs stays the same
+        Block<MatrixXd, Dynamic, Dynamic, true> matOldest = m_matRing.middleCols(m_iOldest * iCols, iCols);
+
+        ArrayXXd arrDelta = matEpoch.array() - matOldest.array();
+        ArrayXXd arrMeanOld = m_matMean.array();
+
+        m_matMean.array() += arrDelta / m_iCount;
+        m_matM2.array() += arrDelta * (matEpoch.array() - m_matMean.array() + matOldest.array() - arrMeanOld);
+
+        matOldest = matEpoch;
+        m_iOldest = (m_iOldest + 1) % m_iMaxEpochs;
+
+        if(++m_iNumReplaced >= m_iMaxEpochs) {
+            recompute();
+        }
+
+        return;
+    }
+
+    //Add a new epoch
+    if(m_iMaxEpochs > 0) {
+        m_matRing.middleCols(((m_iOldest + m_iCount) % m_iMaxEpochs) * iCols, iCols) = matEpoch;
+    }
+
+    ++m_iCount;
+
+    if(m_iCount == 1) {
+        m_matMean = matEpoch;
+        m_matM2.setZero();
+    } else {
+        ArrayXXd arrDelta = matEpoch.array() - m_matMean.array();
+        m_matMean.array() += arrDelta / m_iCount;
+        m_matM2.array() += arrDelta * (matEpoch.array() - m_matMean.array());
+    }
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd RtRunningAverage::variance() const
+{
+    if(m_iCount < 2) {
+        return MatrixXd::Zero(m_matMean.rows(), m_matMean.cols());
+    }
+
+    return (m_matM2.array().max(0.0) / (m_iCount - 1)).matrix();
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd RtRunningAverage::snr() const
+{
+    if(m_iCount < 2) {
+        return MatrixXd::Zero(m_matMean.rows(), m_matMean.cols());
+    }
+
+    ArrayXXd arrStdErr = (m_matM2.array().max(0.0) / (double(m_iCount - 1) * m_iCount)).sqrt();
+
+    return (arrStdErr > 0.0).select(m_matMean.array().abs() / arrStdErr, 0.0).matrix();
+}
+
+
+//*************************************************************************************************************
+
+void RtRunningAverage::recompute()
+{
+    const qint32 iCols = m_matMean.cols();
+
+    m_matMean.setZero();
+    for(qint32 i = 0; i < m_iCount; ++i) {
+        m_matMean += m_matRing.middleCols(i * iCols, iCols);
+    }
+    m_matMean /= m_iCount;
+
+    m_matM2.setZero();
+    for(qint32 i = 0; i < m_iCount; ++i) {
+        m_matM2.array() += (m_matRing.middleCols(i * iCols, iCols) - m_matMean).array().square();
+    }
+
+    m_iNumReplaced = 0;
+}
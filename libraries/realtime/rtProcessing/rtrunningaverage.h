@@ -0,0 +1,219 @@
+//=============================================================================================================
+/**
+* @file     rtrunningaverage.h
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    RtRunningAverage class declaration.
+*
+*/
+
+#ifndef RTRUNNINGAVERAGE_H
+#define RTRUNNINGAVERAGE_H
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../realtime_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QSharedPointer>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Eigen INCLUDES
+//=============================================================================================================
+
+#include <Eigen/Core>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE REALTIMELIB
+//=============================================================================================================
+
+namespace REALTIMELIB
+{
+
+
+//=============================================================================================================
+/**
+* Incremental epoch averaging. The running mean and the per sample running variance (Welford) are updated in
+* place with every new epoch. If a maximal number of epochs is set, the epochs are kept in a preallocated ring and
+* the oldest epoch is replaced in a single O(1) update (per sample). Otherwise all epochs contribute
+* (cumulative average) and no epochs are stored.
+*
+* @brief Running average and variance of epochs
+*/
+class REALTIMESHARED_EXPORT RtRunningAverage
+{
+public:
+    typedef QSharedPointer<RtRunningAverage> SPtr;             /**< Shared pointer type for RtRunningAverage. */
+    typedef QSharedPointer<const RtRunningAverage> ConstSPtr;  /**< Const shared pointer type for RtRunningAverage. */
+
+    //=========================================================================================================
+    /**
+    * Constructs an empty running average.
+    *
+    * @param[in] iMaxEpochs     Number of epochs in the moving average, 0 for a cumulative average.
+    */
+    explicit RtRunningAverage(qint32 iMaxEpochs = 0);
+
+    //=========================================================================================================
+    /**
+    * Sets the number of epochs in the moving average and resets the average.
+    *
+    * @param[in] iMaxEpochs     Number of epochs in the moving average, 0 for a cumulative average.
+    */
+    void setMaxEpochs(qint32 iMaxEpochs);
+
+    //=========================================================================================================
+    /**
+    * Returns the number of epochs in the moving average, 0 for a cumulative average.
+    *
+    * @return the maximal number of epochs.
+    */
+    inline qint32 maxEpochs() const;
+
+    //=========================================================================================================
+    /**
+    * Discards all epochs.
+    */
+    void reset();
+
+    //=========================================================================================================
+    /**
+    * Adds an epoch (channels x samples). If the moving average is full, the oldest epoch is evicted.
+    *
+    * @param[in] matEpoch   The epoch to add.
+    */
+    void append(const Eigen::MatrixXd& matEpoch);
+
+    //=========================================================================================================
+    /**
+    * Returns the number of epochs currently contributing to the average.
+    *
+    * @return the number of epochs.
+    */
+    inline qint32 count() const;
+
+    //=========================================================================================================
+    /**
+    * Returns true if no epoch was added yet.
+    *
+    * @return true if empty, false otherwise.
+    */
+    inline bool isEmpty() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the average of the contributing epochs.
+    *
+    * @return the average.
+    */
+    inline const Eigen::MatrixXd& average() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the per sample variance of the contributing epochs.
+    *
+    * @return the unbiased variance, zero if less than two epochs contribute.
+    */
+    Eigen::MatrixXd variance() const;
+
+    //=========================================================================================================
+    /**
+    * Returns the per sample signal to noise ratio, i.e. the absolute average divided by its standard error.
+    *
+    * @return the signal to noise ratio, zero if less than two epochs contribute.
+    */
+    Eigen::MatrixXd snr() const;
+
+private:
+    //=========================================================================================================
+    /**
+    * Recomputes average and variance from the epochs in the ring. This bounds the round-off accumulated by the
+    * replace updates.
+    */
+    void recompute();
+
+    qint32              m_iMaxEpochs;       /**< Number of epochs in the moving average, 0 for a cumulative average. */
+    qint32              m_iCount;           /**< Number of contributing epochs. */
+    qint32              m_iOldest;          /**< Ring slot of the oldest epoch. */
+    qint32              m_iNumReplaced;     /**< Number of replace updates since the last recompute. */
+
+    Eigen::MatrixXd     m_matMean;          /**< The running average. */
+    Eigen::MatrixXd     m_matM2;            /**< The running sum of squared deviations from the average. */
+    Eigen::MatrixXd     m_matRing;          /**< The preallocated epoch ring, epochs are stored next to each other. */
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INLINE DEFINITIONS
+//=============================================================================================================
+
+inline qint32 RtRunningAverage::maxEpochs() const
+{
+    return m_iMaxEpochs;
+}
+
+
+//*************************************************************************************************************
+
+inline qint32 RtRunningAverage::count() const
+{
+    return m_iCount;
+}
+
+
+//*************************************************************************************************************
+
+inline bool RtRunningAverage::isEmpty() const
+{
+    return m_iCount == 0;
+}
+
+
+//*************************************************************************************************************
+
+inline const Eigen::MatrixXd& RtRunningAverage::average() const
+{
+    return m_matMean;
+}
+
+} // NAMESPACE
+
+#endif // RTRUNNINGAVERAGE_H
@@ -43,6 +43,7 @@
 //=============================================================================================================
 
 #include "../utils_global.h"
+#include "spscringbuffer.h"
 
 
 //*************************************************************************************************************
@@ -51,7 +52,6 @@
 //=============================================================================================================
 
 #include <QPair>
-#include <QSemaphore>
 #include <QSharedPointer>
 
 
@@ -74,7 +74,8 @@ namespace IOBUFFER
 /**
 * TEMPLATE CIRCULAR BUFFER
 *
-* @brief The TEMPLATE CIRCULAR BUFFER provides a template for thread safe circular buffers.
+* @brief The TEMPLATE CIRCULAR BUFFER provides a template for thread safe circular buffers. It is a thin adapter over
+* a lock-free SpscRingBuffer, i.e. there must be only one thread pushing and one thread popping.
 */
 template<typename _Tp>
 class CircularBuffer
@@ -122,6 +123,38 @@ public:
     */
     inline _Tp pop();
 
+    //=========================================================================================================
+    /**
+    * Pops the first element if one is available. Never blocks.
+    *
+    * @param [out] element  The popped element.
+    *
+    * @return true if an element was popped, false if the buffer was empty.
+    */
+    inline bool tryPop(_Tp& element);
+
+    //=========================================================================================================
+    /**
+    * Pops the first element, waits at most iMSecs milliseconds for it.
+    *
+    * @param [out] element  The popped element.
+    * @param [in] iMSecs    Timeout in milliseconds.
+    *
+    * @return true if an element was popped, false on timeout or release.
+    */
+    inline bool pop(_Tp& element, int iMSecs);
+
+    //=========================================================================================================
+    /**
+    * Pops the next size elements into pArray, blocks until all of them are available.
+    *
+    * @param [out] pArray   Destination, has to hold at least size elements.
+    * @param [in] size      Number of elements to pop.
+    *
+    * @return true if the elements were popped, false if released or paused.
+    */
+    inline bool pop(_Tp* pArray, unsigned int size);
+
     //=========================================================================================================
     /**
     * Clears the buffer.
@@ -149,22 +182,9 @@ public:
     inline bool releaseFromPush();
 
 private:
-    //=========================================================================================================
-    /**
-    * Returns the current circular index to the corresponding given index.
-    *
-    * @param [in] index which should be mapped.
-    * @return the mapped index.
-    */
-    inline unsigned int mapIndex(int& index);
-    unsigned int    m_uiMaxNumElements;     /**< Holds the maximal number of buffer elements.*/
-    _Tp*            m_pBuffer;              /**< Holds the circular buffer.*/
-    int             m_iCurrentReadIndex;    /**< Holds the current read index.*/
-    int             m_iCurrentWriteIndex;   /**< Holds the current write index.*/
-    QSemaphore*     m_pFreeElements;        /**< Holds a semaphore which acquires free elements for thread safe writing. A semaphore is a generalization of a mutex.*/
-    QSemaphore*     m_pUsedElements;        /**< Holds a semaphore which acquires written semaphore for thread safe reading.*/
-
-    bool            m_bPause;
+    SpscRingBuffer<_Tp>     m_ringBuffer;       /**< Holds the lock-free ring storing the elements.*/
+
+    bool                    m_bPause;
 };
 
 
@@ -175,12 +195,7 @@ private:
 
 template<typename _Tp>
 CircularBuffer<_Tp>::CircularBuffer(unsigned int uiMaxNumElements)
-: m_uiMaxNumElements(uiMaxNumElements)
-, m_pBuffer(new _Tp[m_uiMaxNumElements])
-, m_iCurrentReadIndex(-1)
-, m_iCurrentWriteIndex(-1)
-, m_pFreeElements(new QSemaphore(m_uiMaxNumElements))
-, m_pUsedElements(new QSemaphore(0))
+: m_ringBuffer(uiMaxNumElements)
 , m_bPause(false)
 {
 
@@ -192,9 +207,6 @@ CircularBuffer<_Tp>::CircularBuffer(unsigned int uiMaxNumElements)
 template<typename _Tp>
 CircularBuffer<_Tp>::~CircularBuffer()
 {
-    delete m_pFreeElements;
-    delete m_pUsedElements;
-    delete [] m_pBuffer;
 }
 
 
@@ -204,12 +216,7 @@ template<typename _Tp>
 inline void CircularBuffer<_Tp>::push(const _Tp* pArray, unsigned int size)
 {
     if(!m_bPause)
-    {
-        m_pFreeElements->acquire(size);
-        for(unsigned int i = 0; i < size; ++i)
-            m_pBuffer[mapIndex(m_iCurrentWriteIndex)] = pArray[i];
-        m_pUsedElements->release(size);
-    }
+        m_ringBuffer.push(pArray, size);
 }
 
 
@@ -218,9 +225,7 @@ inline void CircularBuffer<_Tp>::push(const _Tp* pArray, unsigned int size)
 template<typename _Tp>
 inline void CircularBuffer<_Tp>::push(const _Tp& newElement)
 {
-    m_pFreeElements->acquire();
-    m_pBuffer[mapIndex(m_iCurrentWriteIndex)] = newElement;
-    m_pUsedElements->release();
+    m_ringBuffer.push(&newElement, 1);
 }
 
 
@@ -230,13 +235,7 @@ template<typename _Tp>
 inline _Tp CircularBuffer<_Tp>::pop()
 {
     _Tp element;
-    if(!m_bPause)
-    {
-        m_pUsedElements->acquire();
-        element = m_pBuffer[mapIndex(m_iCurrentReadIndex)];
-        m_pFreeElements->release();
-    }
-    else
+    if(m_bPause || !m_ringBuffer.pop(&element, 1))
         element = 0;
 
     return element;
@@ -246,25 +245,36 @@ inline _Tp CircularBuffer<_Tp>::pop()
 //*************************************************************************************************************
 
 template<typename _Tp>
-inline unsigned int CircularBuffer<_Tp>::mapIndex(int& index)
+inline bool CircularBuffer<_Tp>::tryPop(_Tp& element)
 {
-    int aux = index;
-    return index = ++aux % m_uiMaxNumElements;
+    return !m_bPause && m_ringBuffer.tryPop(&element, 1);
 }
 
 
 //*************************************************************************************************************
 
 template<typename _Tp>
-inline void CircularBuffer<_Tp>::clear()
+inline bool CircularBuffer<_Tp>::pop(_Tp& element, int iMSecs)
+{
+    return !m_bPause && m_ringBuffer.pop(&element, 1, iMSecs);
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline bool CircularBuffer<_Tp>::pop(_Tp* pArray, unsigned int size)
 {
-    delete m_pFreeElements;
-    m_pFreeElements = new QSemaphore(m_uiMaxNumElements);
-    delete m_pUsedElements;
-    m_pUsedElements = new QSemaphore(0);
+    return !m_bPause && m_ringBuffer.pop(pArray, size);
+}
+
+
+//*************************************************************************************************************
 
-    m_iCurrentReadIndex = -1;
-    m_iCurrentWriteIndex = -1;
+template<typename _Tp>
+inline void CircularBuffer<_Tp>::clear()
+{
+    m_ringBuffer.clear();
 }
 
 
@@ -282,13 +292,10 @@ inline void CircularBuffer<_Tp>::pause(bool bPause)
 template<typename _Tp>
 inline bool CircularBuffer<_Tp>::releaseFromPop()
 {
-    if((uint)m_pUsedElements->available() < 1)
+    if(m_ringBuffer.usedElements() < 1)
     {
-        //The last value which is to be popped from the buffer is supposed to be a zero
-        m_pBuffer[mapIndex(m_iCurrentWriteIndex)] = 0;
-
-        //Release (create) values from m_pUsedElements so that the pop function can leave the acquire statement in the pop function
-        m_pUsedElements->release(1);
+        //The pop waiting for a value returns a zero
+        m_ringBuffer.releaseFromPop();
 
         return true;
     }
@@ -302,13 +309,10 @@ inline bool CircularBuffer<_Tp>::releaseFromPop()
 template<typename _Tp>
 inline bool CircularBuffer<_Tp>::releaseFromPush()
 {
-    if((uint)m_pFreeElements->available() < 1)
+    if(m_ringBuffer.freeElements() < 1)
     {
-        //The last value which is to be pushed to the buffer is supposed to be a zero
-        m_pBuffer[mapIndex(m_iCurrentWriteIndex)] = 0;
-
-        //Release (create) value from m_pFreeElements so that the push function can leave the acquire statement in the push function
-        m_pFreeElements->release(1);
+        //The push waiting for space drops its value
+        m_ringBuffer.releaseFromPush();
 
         return true;
     }
@@ -44,6 +44,7 @@
 
 #include "../utils_global.h"
 #include "buffer.h"
+#include "spscringbuffer.h"
 
 
 //*************************************************************************************************************
@@ -68,7 +69,6 @@
 //=============================================================================================================
 
 #include <QPair>
-#include <QSemaphore>
 #include <QSharedPointer>
 
 
@@ -91,7 +91,9 @@ using namespace Eigen;
 
 //=============================================================================================================
 /**
-* Circular Matrix buffer provides a template for thread safe circular matrix buffers.
+* Circular Matrix buffer provides a template for thread safe circular matrix buffers. It is a thin adapter over a
+* lock-free SpscRingBuffer, i.e. there must be only one thread pushing and one thread popping. Whole matrices are
+* copied in at most two contiguous spans.
 *
 * @brief The circular matrix buffer
 */
@@ -129,12 +131,44 @@ public:
 
     //=========================================================================================================
     /**
-    * Returns the first matrix (first in first out).
+    * Returns the first matrix (first in first out). Blocks until a matrix is available.
     *
     * @return the first matrix
     */
     inline Matrix<_Tp, Dynamic, Dynamic> pop();
 
+    //=========================================================================================================
+    /**
+    * Pops the first matrix if one is available. Never blocks.
+    *
+    * @param [out] matrix   The popped matrix.
+    *
+    * @return true if a matrix was popped, false if the buffer was empty.
+    */
+    inline bool tryPop(Matrix<_Tp, Dynamic, Dynamic>& matrix);
+
+    //=========================================================================================================
+    /**
+    * Pops the first matrix, waits at most iMSecs milliseconds for it.
+    *
+    * @param [out] matrix   The popped matrix.
+    * @param [in] iMSecs    Timeout in milliseconds.
+    *
+    * @return true if a matrix was popped, false on timeout or release.
+    */
+    inline bool pop(Matrix<_Tp, Dynamic, Dynamic>& matrix, int iMSecs);
+
+    //=========================================================================================================
+    /**
+    * Returns the next uiNumMatrices matrices concatenated column wise (rows x uiNumMatrices*cols), blocks until
+    * all of them are available. uiNumMatrices must not exceed size().
+    *
+    * @param [in] uiNumMatrices     Number of matrices to pop.
+    *
+    * @return the concatenated matrices.
+    */
+    inline Matrix<_Tp, Dynamic, Dynamic> popBatch(quint32 uiNumMatrices);
+
     //=========================================================================================================
     /**
     * Clears the buffer.
@@ -180,25 +214,11 @@ public:
     inline bool releaseFromPush();
 
 private:
-    //=========================================================================================================
-    /**
-    * Returns the current circular index to the corresponding given index.
-    *
-    * @param [in] index which should be mapped.
-    * @return the mapped index.
-    */
-    inline unsigned int mapIndex(int& index);
-
-    unsigned int    m_uiMaxNumMatrices;         /**< Holds the maximal number of matrices.*/
-    unsigned int    m_uiRows;                   /**< Holds the number rows.*/
-    unsigned int    m_uiCols;                   /**< Holds the number cols.*/
-    unsigned int    m_uiMaxNumElements;         /**< Holds the maximal number of buffer elements.*/
-    _Tp*            m_pBuffer;                  /**< Holds the circular buffer.*/
-    int             m_iCurrentReadIndex;        /**< Holds the current read index.*/
-    int             m_iCurrentWriteIndex;       /**< Holds the current write index.*/
-    QSemaphore*     m_pFreeElements;            /**< Holds a semaphore which acquires free elements for thread safe writing. A semaphore is a generalization of a mutex.*/
-    QSemaphore*     m_pUsedElements;            /**< Holds a semaphore which acquires written semaphore for thread safe reading.*/
-    bool            m_bPause;
+    unsigned int            m_uiMaxNumMatrices;     /**< Holds the maximal number of matrices.*/
+    unsigned int            m_uiRows;               /**< Holds the number rows.*/
+    unsigned int            m_uiCols;               /**< Holds the number cols.*/
+    SpscRingBuffer<_Tp>     m_ringBuffer;           /**< Holds the lock-free ring storing the matrix elements.*/
+    bool                    m_bPause;               /**< Whether the buffer is paused.*/
 };
 
 
@@ -213,12 +233,7 @@ CircularMatrixBuffer<_Tp>::CircularMatrixBuffer(unsigned int uiMaxNumMatrices, u
 , m_uiMaxNumMatrices(uiMaxNumMatrices)
 , m_uiRows(uiRows)
 , m_uiCols(uiCols)
-, m_uiMaxNumElements(m_uiMaxNumMatrices*m_uiRows*m_uiCols)
-, m_pBuffer(new _Tp[m_uiMaxNumElements])
-, m_iCurrentReadIndex(-1)
-, m_iCurrentWriteIndex(-1)
-, m_pFreeElements(new QSemaphore(m_uiMaxNumElements))
-, m_pUsedElements(new QSemaphore(0))
+, m_ringBuffer(uiMaxNumMatrices*uiRows*uiCols)
 , m_bPause(false)
 {
 
@@ -230,9 +245,6 @@ CircularMatrixBuffer<_Tp>::CircularMatrixBuffer(unsigned int uiMaxNumMatrices, u
 template<typename _Tp>
 CircularMatrixBuffer<_Tp>::~CircularMatrixBuffer()
 {
-    delete m_pFreeElements;
-    delete m_pUsedElements;
-    delete [] m_pBuffer;
 }
 
 
@@ -246,10 +258,7 @@ inline void CircularMatrixBuffer<_Tp>::push(const Matrix<_Tp, Dynamic, Dynamic>*
         unsigned int t_size = pMatrix->size();
         if(t_size == m_uiRows*m_uiCols)
         {
-            m_pFreeElements->acquire(t_size);
-            for(unsigned int i = 0; i < t_size; ++i)
-                m_pBuffer[mapIndex(m_iCurrentWriteIndex)] = pMatrix->data()[i];
-            m_pUsedElements->release(t_size);
+            m_ringBuffer.push(pMatrix->data(), t_size);
         }
 
         else {
@@ -266,14 +275,7 @@ inline Matrix<_Tp, Dynamic, Dynamic> CircularMatrixBuffer<_Tp>::pop()
 {
     Matrix<_Tp, Dynamic, Dynamic> matrix(m_uiRows, m_uiCols);
 
-    if(!m_bPause)
-    {
-        m_pUsedElements->acquire(m_uiRows*m_uiCols);
-        for(quint32 i = 0; i < m_uiRows*m_uiCols; ++i)
-            matrix.data()[i] = m_pBuffer[mapIndex(m_iCurrentReadIndex)];
-        m_pFreeElements->release(m_uiRows*m_uiCols);
-    }
-    else
+    if(m_bPause || !m_ringBuffer.pop(matrix.data(), m_uiRows*m_uiCols))
         matrix.setZero();
 
     return matrix;
@@ -283,27 +285,50 @@ inline Matrix<_Tp, Dynamic, Dynamic> CircularMatrixBuffer<_Tp>::pop()
 //*************************************************************************************************************
 
 template<typename _Tp>
-inline unsigned int CircularMatrixBuffer<_Tp>::mapIndex(int& index)
+inline bool CircularMatrixBuffer<_Tp>::tryPop(Matrix<_Tp, Dynamic, Dynamic>& matrix)
 {
-    int AuxIndex;
-    AuxIndex = ++index;
-    return index = AuxIndex % m_uiMaxNumElements;
+    if(m_bPause)
+        return false;
 
+    matrix.resize(m_uiRows, m_uiCols);
+    return m_ringBuffer.tryPop(matrix.data(), m_uiRows*m_uiCols);
 }
 
 
 //*************************************************************************************************************
 
 template<typename _Tp>
-void CircularMatrixBuffer<_Tp>::clear()
+inline bool CircularMatrixBuffer<_Tp>::pop(Matrix<_Tp, Dynamic, Dynamic>& matrix, int iMSecs)
 {
-    delete m_pFreeElements;
-    m_pFreeElements = new QSemaphore(m_uiMaxNumElements);
-    delete m_pUsedElements;
-    m_pUsedElements = new QSemaphore(0);
+    if(m_bPause)
+        return false;
 
-    m_iCurrentReadIndex = -1;
-    m_iCurrentWriteIndex = -1;
+    matrix.resize(m_uiRows, m_uiCols);
+    return m_ringBuffer.pop(matrix.data(), m_uiRows*m_uiCols, iMSecs);
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline Matrix<_Tp, Dynamic, Dynamic> CircularMatrixBuffer<_Tp>::popBatch(quint32 uiNumMatrices)
+{
+    //Consecutive column major matrices with equal row count form one column major matrix
+    Matrix<_Tp, Dynamic, Dynamic> matrix(m_uiRows, m_uiCols*uiNumMatrices);
+
+    if(m_bPause || !m_ringBuffer.pop(matrix.data(), m_uiRows*m_uiCols*uiNumMatrices))
+        matrix.setZero();
+
+    return matrix;
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+void CircularMatrixBuffer<_Tp>::clear()
+{
+    m_ringBuffer.clear();
 }
 
 
@@ -348,15 +373,10 @@ inline void CircularMatrixBuffer<_Tp>::pause(bool bPause)
 template<typename _Tp>
 inline bool CircularMatrixBuffer<_Tp>::releaseFromPop()
 {
-   if((uint)m_pUsedElements->available() < m_uiRows*m_uiCols)
+    if(m_ringBuffer.usedElements() < m_uiRows*m_uiCols)
     {
-        //The last matrix which is to be popped from the buffer is supposed to be a zero matrix
-        unsigned int t_size = m_uiRows*m_uiCols;
-        for(unsigned int i = 0; i < t_size; ++i)
-            m_pBuffer[mapIndex(m_iCurrentWriteIndex)] = 0;
-
-        //Release (create) values from m_pUsedElements so that the pop function can leave the acquire statement in the pop function
-        m_pUsedElements->release(m_uiRows*m_uiCols);
+        //The pop waiting for a matrix returns a zero matrix
+        m_ringBuffer.releaseFromPop();
 
         return true;
     }
@@ -370,15 +390,10 @@ inline bool CircularMatrixBuffer<_Tp>::releaseFromPop()
 template<typename _Tp>
 inline bool CircularMatrixBuffer<_Tp>::releaseFromPush()
 {
-    if((uint)m_pFreeElements->available() < m_uiRows*m_uiCols)
+    if(m_ringBuffer.freeElements() < m_uiRows*m_uiCols)
     {
-        //The last matrix which is to be pushed to the buffer is supposed to be a zero matrix
-        unsigned int t_size = m_uiRows*m_uiCols;
-        for(unsigned int i = 0; i < t_size; ++i)
-            m_pBuffer[mapIndex(m_iCurrentWriteIndex)] = 0;
-
-        //Release (create) values from m_pFreeElements so that the push function can leave the acquire statement in the push function
-        m_pFreeElements->release(m_uiRows*m_uiCols);
+        //The push waiting for space drops its matrix
+        m_ringBuffer.releaseFromPush();
 
         return true;
     }
@@ -0,0 +1,576 @@
+//=============================================================================================================
+/**
+* @file     spscringbuffer.h
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    SpscRingBuffer class declaration.
+*
+*/
+
+#ifndef SPSCRINGBUFFER_H
+#define SPSCRINGBUFFER_H
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "../utils_global.h"
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// STL INCLUDES
+//=============================================================================================================
+
+#include <algorithm>
+#include <climits>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// Qt INCLUDES
+//=============================================================================================================
+
+#include <QAtomicInt>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QSharedPointer>
+#include <QThread>
+#include <QWaitCondition>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINES
+//=============================================================================================================
+
+#ifndef SPSCRINGBUFFER_CACHE_LINE_SIZE
+#define SPSCRINGBUFFER_CACHE_LINE_SIZE 64      /**< Padding used to keep producer and consumer state on separate cache lines. */
+#endif
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE NAMESPACE IOBUFFER
+//=============================================================================================================
+
+namespace IOBUFFER
+{
+
+
+//=============================================================================================================
+/**
+* Lock-free single-producer/single-consumer ring buffer. Exactly one thread may push and exactly one thread may
+* pop at a time. Blocks of elements are copied in at most two contiguous spans. The producer and consumer
+* indices live on separate cache lines and each side caches the last seen index of the other side, so the
+* shared indices are only touched when the cached value is not sufficient.
+*
+* Blocking calls spin shortly and yield, then sleep on a wait condition until the other side made progress. The
+* lock is only taken by a waiting call and by the other side when it sees that somebody waits.
+*
+* @brief Lock-free single-producer/single-consumer ring buffer.
+*/
+template<typename _Tp>
+class SpscRingBuffer
+{
+public:
+    typedef QSharedPointer<SpscRingBuffer> SPtr;              /**< Shared pointer type for SpscRingBuffer. */
+    typedef QSharedPointer<const SpscRingBuffer> ConstSPtr;   /**< Const shared pointer type for SpscRingBuffer. */
+
+    //=========================================================================================================
+    /**
+    * Constructs a SpscRingBuffer.
+    *
+    * @param [in] uiCapacity    Number of elements the buffer can hold.
+    */
+    explicit SpscRingBuffer(unsigned int uiCapacity);
+
+    //=========================================================================================================
+    /**
+    * Destroys the SpscRingBuffer.
+    */
+    ~SpscRingBuffer();
+
+    //=========================================================================================================
+    /**
+    * Appends uiSize elements if there is enough space. Never blocks.
+    *
+    * @param [in] pData     The elements to append.
+    * @param [in] uiSize    Number of elements.
+    *
+    * @return true if the elements were appended, false if there was not enough space.
+    */
+    inline bool tryPush(const _Tp* pData, unsigned int uiSize);
+
+    //=========================================================================================================
+    /**
+    * Appends uiSize elements, blocks until there is enough space.
+    *
+    * @param [in] pData     The elements to append.
+    * @param [in] uiSize    Number of elements.
+    *
+    * @return true if the elements were appended, false if the call was released by releaseFromPush().
+    */
+    inline bool push(const _Tp* pData, unsigned int uiSize);
+
+    //=========================================================================================================
+    /**
+    * Removes the first uiSize elements if available. Never blocks.
+    *
+    * @param [out] pData    Destination of the elements.
+    * @param [in] uiSize    Number of elements.
+    *
+    * @return true if the elements were popped, false if not enough elements were available.
+    */
+    inline bool tryPop(_Tp* pData, unsigned int uiSize);
+
+    //=========================================================================================================
+    /**
+    * Removes the first uiSize elements, blocks until they are available.
+    *
+    * @param [out] pData    Destination of the elements.
+    * @param [in] uiSize    Number of elements.
+    *
+    * @return true if the elements were popped, false if the call was released by releaseFromPop().
+    */
+    inline bool pop(_Tp* pData, unsigned int uiSize);
+
+    //=========================================================================================================
+    /**
+    * Removes the first uiSize elements, blocks at most iMSecs milliseconds until they are available.
+    *
+    * @param [out] pData    Destination of the elements.
+    * @param [in] uiSize    Number of elements.
+    * @param [in] iMSecs    Timeout in milliseconds.
+    *
+    * @return true if the elements were popped, false on timeout or if the call was released by releaseFromPop().
+    */
+    inline bool pop(_Tp* pData, unsigned int uiSize, int iMSecs);
+
+    //=========================================================================================================
+    /**
+    * Resets the buffer. Must not be called while a push or pop is in progress. Pending releases are kept, so a
+    * releaseFromPop() directly followed by clear() still releases the waiting pop.
+    */
+    inline void clear();
+
+    //=========================================================================================================
+    /**
+    * Number of elements the buffer can hold.
+    */
+    inline unsigned int capacity() const;
+
+    //=========================================================================================================
+    /**
+    * Number of elements which can currently be popped. This is a snapshot only.
+    */
+    inline unsigned int usedElements() const;
+
+    //=========================================================================================================
+    /**
+    * Number of elements which can currently be pushed. This is a snapshot only.
+    */
+    inline unsigned int freeElements() const;
+
+    //=========================================================================================================
+    /**
+    * Lets the next blocking pop, which has to wait for data, return false. The release stays pending until a
+    * waiting pop consumed it.
+    */
+    inline void releaseFromPop();
+
+    //=========================================================================================================
+    /**
+    * Lets the next blocking push, which has to wait for space, return false. The release stays pending until a
+    * waiting push consumed it.
+    */
+    inline void releaseFromPush();
+
+private:
+    SpscRingBuffer(const SpscRingBuffer&);              /**< Not copyable. */
+    SpscRingBuffer& operator=(const SpscRingBuffer&);   /**< Not copyable. */
+
+    //=========================================================================================================
+    /**
+    * Waits a little, escalating from spinning to yielding.
+    *
+    * @param [in, out] iSpin    Number of previous waits, is incremented.
+    *
+    * @return false if the spin budget is used up and the caller should block.
+    */
+    static inline bool backoff(int& iSpin);
+
+    //=========================================================================================================
+    /**
+    * Blocks until uiSize elements could be pushed, a release is pending or the timeout expired.
+    *
+    * @param [in] uiSize    Number of elements to push.
+    * @param [in] iMSecs    Timeout in milliseconds, negative to wait without timeout.
+    */
+    inline void waitForSpace(unsigned int uiSize, int iMSecs);
+
+    //=========================================================================================================
+    /**
+    * Blocks until uiSize elements could be popped, a release is pending or the timeout expired.
+    *
+    * @param [in] uiSize    Number of elements to pop.
+    * @param [in] iMSecs    Timeout in milliseconds, negative to wait without timeout.
+    */
+    inline void waitForData(unsigned int uiSize, int iMSecs);
+
+    //=========================================================================================================
+    /**
+    * Wakes a blocked call if there is one. The waiter count is read with an ordered read-modify-write, which
+    * pairs with the ordered increment of the waiter so that either the waiter sees the new index or it is woken.
+    *
+    * @param [in] iWaiting      The waiter count of the other side.
+    * @param [in] waitCondition The wait condition the other side sleeps on.
+    */
+    inline void wake(QAtomicInt& iWaiting, QWaitCondition& waitCondition);
+
+    inline unsigned int used(unsigned int uiWrite, unsigned int uiRead) const;
+
+    const unsigned int  m_uiNumSlots;           /**< Number of slots, one more than the capacity to tell full from empty. */
+    _Tp*                m_pBuffer;              /**< The ring storage. */
+    char                m_padding0[SPSCRINGBUFFER_CACHE_LINE_SIZE];
+
+    QAtomicInt          m_iWriteIndex;          /**< Next slot to write, owned by the producer. */
+    unsigned int        m_uiCachedReadIndex;    /**< Producer side copy of the read index. */
+    char                m_padding1[SPSCRINGBUFFER_CACHE_LINE_SIZE];
+
+    QAtomicInt          m_iReadIndex;           /**< Next slot to read, owned by the consumer. */
+    unsigned int        m_uiCachedWriteIndex;   /**< Consumer side copy of the write index. */
+    char                m_padding2[SPSCRINGBUFFER_CACHE_LINE_SIZE];
+
+    QAtomicInt          m_iReleasePop;          /**< Set by releaseFromPop. */
+    QAtomicInt          m_iReleasePush;         /**< Set by releaseFromPush. */
+
+    QAtomicInt          m_iPopWaiting;          /**< Number of pops sleeping on m_waitData. */
+    QAtomicInt          m_iPushWaiting;         /**< Number of pushes sleeping on m_waitSpace. */
+    QMutex              m_mutex;                /**< Guards sleeping only, never the data. */
+    QWaitCondition      m_waitData;             /**< Signaled when elements were pushed or a pop was released. */
+    QWaitCondition      m_waitSpace;            /**< Signaled when elements were popped or a push was released. */
+};
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE MEMBER METHODS
+//=============================================================================================================
+
+template<typename _Tp>
+SpscRingBuffer<_Tp>::SpscRingBuffer(unsigned int uiCapacity)
+: m_uiNumSlots(uiCapacity + 1)
+, m_pBuffer(new _Tp[uiCapacity + 1])
+, m_iWriteIndex(0)
+, m_uiCachedReadIndex(0)
+, m_iReadIndex(0)
+, m_uiCachedWriteIndex(0)
+, m_iReleasePop(0)
+, m_iReleasePush(0)
+, m_iPopWaiting(0)
+, m_iPushWaiting(0)
+{
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+SpscRingBuffer<_Tp>::~SpscRingBuffer()
+{
+    delete [] m_pBuffer;
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline bool SpscRingBuffer<_Tp>::tryPush(const _Tp* pData, unsigned int uiSize)
+{
+    const unsigned int uiWrite = static_cast<unsigned int>(m_iWriteIndex.load());
+
+    if(m_uiNumSlots - 1 - used(uiWrite, m_uiCachedReadIndex) < uiSize) {
+        m_uiCachedReadIndex = static_cast<unsigned int>(m_iReadIndex.loadAcquire());
+        if(m_uiNumSlots - 1 - used(uiWrite, m_uiCachedReadIndex) < uiSize) {
+            return false;
+        }
+    }
+
+    //Copy in at most two contiguous spans
+    const unsigned int uiFirst = std::min(uiSize, m_uiNumSlots - uiWrite);
+    std::copy(pData, pData + uiFirst, m_pBuffer + uiWrite);
+    std::copy(pData + uiFirst, pData + uiSize, m_pBuffer);
+
+    m_iWriteIndex.storeRelease(static_cast<int>((uiWrite + uiSize) % m_uiNumSlots));
+
+    wake(m_iPopWaiting, m_waitData);
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline bool SpscRingBuffer<_Tp>::push(const _Tp* pData, unsigned int uiSize)
+{
+    if(uiSize > capacity()) {
+        qWarning("SpscRingBuffer::push - Block of %u elements exceeds the capacity of %u.", uiSize, capacity());
+        return false;
+    }
+
+    int iSpin = 0;
+    while(!tryPush(pData, uiSize)) {
+        if(m_iReleasePush.testAndSetOrdered(1, 0)) {
+            return false;
+        }
+        if(!backoff(iSpin)) {
+            waitForSpace(uiSize, -1);
+        }
+    }
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline bool SpscRingBuffer<_Tp>::tryPop(_Tp* pData, unsigned int uiSize)
+{
+    const unsigned int uiRead = static_cast<unsigned int>(m_iReadIndex.load());
+
+    if(used(m_uiCachedWriteIndex, uiRead) < uiSize) {
+        m_uiCachedWriteIndex = static_cast<unsigned int>(m_iWriteIndex.loadAcquire());
+        if(used(m_uiCachedWriteIndex, uiRead) < uiSize) {
+            return false;
+        }
+    }
+
+    //Copy out in at most two contiguous spans
+    const unsigned int uiFirst = std::min(uiSize, m_uiNumSlots - uiRead);
+    std::copy(m_pBuffer + uiRead, m_pBuffer + uiRead + uiFirst, pData);
+    std::copy(m_pBuffer, m_pBuffer + (uiSize - uiFirst), pData + uiFirst);
+
+    m_iReadIndex.storeRelease(static_cast<int>((uiRead + uiSize) % m_uiNumSlots));
+
+    wake(m_iPushWaiting, m_waitSpace);
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline bool SpscRingBuffer<_Tp>::pop(_Tp* pData, unsigned int uiSize)
+{
+    if(uiSize > capacity()) {
+        qWarning("SpscRingBuffer::pop - Block of %u elements exceeds the capacity of %u.", uiSize, capacity());
+        return false;
+    }
+
+    int iSpin = 0;
+    while(!tryPop(pData, uiSize)) {
+        if(m_iReleasePop.testAndSetOrdered(1, 0)) {
+            return false;
+        }
+        if(!backoff(iSpin)) {
+            waitForData(uiSize, -1);
+        }
+    }
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline bool SpscRingBuffer<_Tp>::pop(_Tp* pData, unsigned int uiSize, int iMSecs)
+{
+    if(uiSize > capacity()) {
+        return false;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    int iSpin = 0;
+    while(!tryPop(pData, uiSize)) {
+        const qint64 iRemaining = iMSecs - timer.elapsed();
+        if(m_iReleasePop.testAndSetOrdered(1, 0) || iRemaining <= 0) {
+            return false;
+        }
+        if(!backoff(iSpin)) {
+            waitForData(uiSize, static_cast<int>(iRemaining));
+        }
+    }
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline void SpscRingBuffer<_Tp>::clear()
+{
+    m_iWriteIndex.storeRelease(0);
+    m_iReadIndex.storeRelease(0);
+    m_uiCachedReadIndex = 0;
+    m_uiCachedWriteIndex = 0;
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline unsigned int SpscRingBuffer<_Tp>::capacity() const
+{
+    return m_uiNumSlots - 1;
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline unsigned int SpscRingBuffer<_Tp>::usedElements() const
+{
+    return used(static_cast<unsigned int>(m_iWriteIndex.loadAcquire()), static_cast<unsigned int>(m_iReadIndex.loadAcquire()));
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline unsigned int SpscRingBuffer<_Tp>::freeElements() const
+{
+    return capacity() - usedElements();
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline void SpscRingBuffer<_Tp>::releaseFromPop()
+{
+    m_iReleasePop.storeRelease(1);
+
+    //Taking the lock orders the release before a waiter's last check
+    QMutexLocker locker(&m_mutex);
+    m_waitData.wakeAll();
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline void SpscRingBuffer<_Tp>::releaseFromPush()
+{
+    m_iReleasePush.storeRelease(1);
+
+    QMutexLocker locker(&m_mutex);
+    m_waitSpace.wakeAll();
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline bool SpscRingBuffer<_Tp>::backoff(int& iSpin)
+{
+    if(iSpin < 64) {
+        //Busy wait, data usually arrives within a few hundred cycles under load
+    } else if(iSpin < 128) {
+        QThread::yieldCurrentThread();
+    } else {
+        return false;
+    }
+    ++iSpin;
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline void SpscRingBuffer<_Tp>::waitForSpace(unsigned int uiSize, int iMSecs)
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_iPushWaiting.fetchAndAddOrdered(1);
+    if(freeElements() < uiSize && m_iReleasePush.loadAcquire() == 0) {
+        m_waitSpace.wait(&m_mutex, iMSecs < 0 ? ULONG_MAX : static_cast<unsigned long>(iMSecs));
+    }
+    m_iPushWaiting.fetchAndAddOrdered(-1);
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline void SpscRingBuffer<_Tp>::waitForData(unsigned int uiSize, int iMSecs)
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_iPopWaiting.fetchAndAddOrdered(1);
+    if(usedElements() < uiSize && m_iReleasePop.loadAcquire() == 0) {
+        m_waitData.wait(&m_mutex, iMSecs < 0 ? ULONG_MAX : static_cast<unsigned long>(iMSecs));
+    }
+    m_iPopWaiting.fetchAndAddOrdered(-1);
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline void SpscRingBuffer<_Tp>::wake(QAtomicInt& iWaiting, QWaitCondition& waitCondition)
+{
+    if(iWaiting.fetchAndAddOrdered(0) > 0) {
+        QMutexLocker locker(&m_mutex);
+        waitCondition.wakeAll();
+    }
+}
+
+
+//*************************************************************************************************************
+
+template<typename _Tp>
+inline unsigned int SpscRingBuffer<_Tp>::used(unsigned int uiWrite, unsigned int uiRead) const
+{
+    return (uiWrite + m_uiNumSlots - uiRead) % m_uiNumSlots;
+}
+
+} // NAMESPACE
+
+#endif // SPSCRINGBUFFER_H
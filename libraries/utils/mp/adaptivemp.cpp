@@ -82,6 +82,213 @@
 using namespace UTILSLIB;
 
 
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+namespace {
+
+//=============================================================================================================
+/**
+* One scale/modulation pair of the dyadic sampling used in the search for the best matching atom.
+*/
+struct ScaleModulation
+{
+    qreal scale;            /**< Scale of the atom. */
+    qreal modulation;       /**< Modulation of the atom. */
+    qint32 envelope;        /**< Index of the envelope spectrum belonging to the scale. */
+};
+
+//=============================================================================================================
+/**
+* Workspace and result of the search in one channel. The workspaces are created once per matching_pursuit call,
+* so the FFT plans and the buffers are reused in all iterations.
+*/
+struct ChannelSearch
+{
+    qint32 chn;                                     /**< The channel to search. */
+    const MatrixXd* residuum;                       /**< The current residuum of all channels. */
+    const QVector<ScaleModulation>* grid;           /**< The scale/modulation pairs to test. */
+    const QList<VectorXcd>* conj_fft_envelopes;     /**< The conjugated spectra of the envelopes per scale. */
+    const VectorXcd* fft_phase_resid;               /**< Spectrum of the summed residuum used for the phase if fix_phase is set. */
+    qint32 no_envelope_j;                           /**< Dyadic level of the modulation steps of atoms without envelope. */
+    bool fix_phase;                                 /**< Whether the phase is fitted to all channels. */
+
+    Eigen::FFT<double> fft;                         /**< FFT holding the plans of this channel. */
+    VectorXd resid;                                 /**< The residuum of the channel. */
+    VectorXcd fft_resid;                            /**< The spectrum of the residuum of the channel. */
+    VectorXcd modulated_resid;                      /**< The modulated residuum, only used for non integer modulations. */
+    VectorXcd fft_modulated_resid;                  /**< The spectrum of the modulated residuum. */
+    VectorXcd fft_m_e_resid;                        /**< The product of the modulated residuum and the envelope spectrum. */
+    VectorXd corr_coeffs;                           /**< The correlation of the modulated residuum and the envelope. */
+    VectorXd folded_resid;                          /**< The residuum folded to the length of the no-envelope spectrum. */
+    VectorXcd fft_folded_resid;                     /**< The spectrum of the folded residuum. */
+
+    VectorXd best_params;                           /**< scale, translation, modulation, phase and scalar product of the best atom. */
+    qint32 best_index;                              /**< The pair or modulation step the best atom was found at, -1 if none. */
+};
+
+
+//*************************************************************************************************************
+
+qint32 no_envelope_fft_length(qint32 no_envelope_j)
+{
+    //the modulation steps 2^(-j)*N/2 of atoms without envelope are the bins of a DFT of length 2^(j+1)
+    return qint32(pow(2.0, no_envelope_j + 1));
+}
+
+
+//*************************************************************************************************************
+
+void init_channel_search(ChannelSearch& search, qint32 sample_count, qint32 no_envelope_j)
+{
+    qint32 fft_length = no_envelope_fft_length(no_envelope_j);
+
+    search.resid = VectorXd::Zero(sample_count);
+    search.fft_resid = VectorXcd::Zero(sample_count);
+    search.modulated_resid = VectorXcd::Zero(sample_count);
+    search.fft_modulated_resid = VectorXcd::Zero(sample_count);
+    search.fft_m_e_resid = VectorXcd::Zero(sample_count);
+    search.corr_coeffs = VectorXd::Zero(sample_count);
+    search.folded_resid = VectorXd::Zero(fft_length);
+    search.fft_folded_resid = VectorXcd::Zero(fft_length);
+    search.best_params = VectorXd::Zero(5);
+    search.best_index = -1;
+}
+
+
+//*************************************************************************************************************
+
+void search_envelope_atoms(ChannelSearch& search)
+{
+    const MatrixXd& residuum = *search.residuum;
+    const QVector<ScaleModulation>& grid = *search.grid;
+    qint32 sample_count = residuum.rows();
+    qreal norm = 1 / sqrt(qreal(sample_count));
+
+    //the residuum is transformed once, the modulation by an integer k is a circular shift of its spectrum
+    search.resid = residuum.col(search.chn);
+    search.fft.fwd(search.fft_resid, search.resid);
+
+    search.best_params.setZero();
+    search.best_index = -1;
+
+    for(qint32 i = 0; i < grid.size(); i++)
+    {
+        const VectorXcd& conj_fft_envelope = search.conj_fft_envelopes->at(grid[i].envelope);
+        qreal k = grid[i].modulation;
+        qint32 shift = qint32(k);
+
+        //complex correlation of signal and sinus-modulated gaussfunction
+        if(shift == k)
+        {
+            for(qint32 m = 0; m < shift; m++)
+                search.fft_m_e_resid[m] = search.fft_resid[m - shift + sample_count] * norm * conj_fft_envelope[m];
+            for(qint32 m = shift; m < sample_count; m++)
+                search.fft_m_e_resid[m] = search.fft_resid[m - shift] * norm * conj_fft_envelope[m];
+        }
+        else
+        {
+            for(qint32 l = 0; l < sample_count; l++)
+                search.modulated_resid[l] = search.resid[l] * std::polar(norm, 2 * PI * k / qreal(sample_count) * qreal(l));
+
+            search.fft.fwd(search.fft_modulated_resid, search.modulated_resid);
+
+            for(qint32 m = 0; m < sample_count; m++)
+                search.fft_m_e_resid[m] = search.fft_modulated_resid[m] * conj_fft_envelope[m];
+        }
+
+        search.fft.inv(search.corr_coeffs, search.fft_m_e_resid);
+
+        //find index of maximum correlation-coefficient to use in translation
+        qint32 max_index = 0;
+        qreal maximum = search.corr_coeffs[0];
+
+        for(qint32 l = 1; l < sample_count; l++)
+            if(maximum < search.corr_coeffs[l])
+            {
+                maximum = search.corr_coeffs[l];
+                max_index = l;
+            }
+
+        //adapting translation p to create atomtranslation correctly
+        qint32 p = floor(sample_count / 2);//here is difference to dr. gratkowski´s code (he didn´t reset parameter p)
+        if(max_index >= p) p = max_index - p + 1;
+        else p = max_index + p;
+
+        VectorXd atom_parameters = AdaptiveMp::calculate_atom(sample_count, grid[i].scale, p, k, search.chn, residuum, RETURNPARAMETERS, search.fix_phase);
+
+        //keep the last pair reaching the highest scalarproduct, as the sequential search does
+        if(std::fabs(atom_parameters[4]) >= std::fabs(search.best_params[4]))
+        {
+            search.best_params = atom_parameters;
+            search.best_index = i;
+        }
+    }
+}
+
+
+//*************************************************************************************************************
+
+void search_no_envelope_atoms(ChannelSearch& search)
+{
+    const MatrixXd& residuum = *search.residuum;
+    qint32 sample_count = residuum.rows();
+    qint32 fft_length = search.folded_resid.rows();
+    qint32 p = floor(sample_count / 2);
+
+    //inner products with exp(i*2*pi*k*n/N) for all modulation steps k at once
+    search.folded_resid.setZero();
+    for(qint32 n = 0; n < sample_count; n++)
+        search.folded_resid[n % fft_length] += residuum(n, search.chn);
+    search.fft.fwd(search.fft_folded_resid, search.folded_resid);
+
+    search.best_params.setZero();
+    search.best_index = -1;
+
+    qreal k = 0;
+    qint32 m = 0;
+
+    while(k < sample_count / 2)
+    {
+        const std::complex<double>& inner_product = search.fix_phase ? (*search.fft_phase_resid)[m] : search.fft_folded_resid[m];
+
+        //calculate phase to create realGaborAtoms
+        qreal phase = std::arg(inner_product);
+        if (phase < 0) phase = 2 * PI - phase;
+
+        //scalar product with the normalized real atom cos(w*n + phase)
+        qreal w = 2 * PI * qreal(m) / qreal(fft_length);
+        std::complex<double> rotation = std::polar(1.0, phase);
+        qreal scalar_product = rotation.real() * search.fft_folded_resid[m].real() + rotation.imag() * search.fft_folded_resid[m].imag();
+
+        std::complex<double> power_sum(sample_count, 0);
+        if((2 * m) % fft_length != 0)
+            power_sum = (1.0 - std::polar(1.0, 2 * w * sample_count)) / (1.0 - std::polar(1.0, 2 * w));
+
+        qreal norm = 0.5 * sample_count + 0.5 * (std::polar(1.0, 2 * phase) * power_sum).real();
+        if(norm > 0) scalar_product /= sqrt(norm);
+
+        //keep the first modulation reaching the highest scalarproduct, as the sequential search does
+        if(search.best_index < 0 || std::fabs(scalar_product) > std::fabs(search.best_params[4]))
+        {
+            search.best_params[0] = sample_count;
+            search.best_params[1] = p;
+            search.best_params[2] = k;
+            search.best_params[3] = phase;
+            search.best_params[4] = scalar_product;
+            search.best_index = m;
+        }
+
+        k += pow(2.0,(-search.no_envelope_j))*sample_count/2;
+        m++;
+    }
+}
+
+} // NAMESPACE
+
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS
@@ -129,155 +336,155 @@ QList<QList<GaborAtom> > AdaptiveMp::matching_pursuit(MatrixXd signal, qint32 ma
     }
     std::cout << "absolute energy of signal: " << residuum_energy << "\n";
 
+    //dyadic sampling of scale and modulation, the envelopes only depend on the scale and are transformed once
+    QVector<ScaleModulation> grid;
+    QList<VectorXcd> conj_fft_envelopes;
+    qreal s = 1;                                //scale
+    qint32 j = 1;
+
+    while(s < sample_count)
+    {
+        qreal k = 0;                            //for modulation 2*pi*k/N
+        qint32 p = floor(sample_count / 2);     //translation
+        VectorXd envelope = GaborAtom::gauss_function(sample_count, s, p);
+        VectorXcd fft_envelope = RowVectorXcd::Zero(sample_count);
+        fft.fwd(fft_envelope, envelope);
+        conj_fft_envelopes.append(fft_envelope.conjugate());
+
+        while(k < sample_count/2)
+        {
+            ScaleModulation pair = {s, k, qint32(conj_fft_envelopes.size()) - 1};
+            grid.append(pair);
+            k += pow(2.0,(-j))*sample_count/2;
+        }
+        j++;
+        s = pow(2.0,j);
+    }
+
+    qint32 no_envelope_j = floor(log10(sample_count)/log10(2));//log(sample_count) / log(2));
+    VectorXd folded_sum = VectorXd::Zero(no_envelope_fft_length(no_envelope_j));
+    VectorXcd fft_phase_resid;
+
+    //one workspace per observed channel, searched in parallel
+    QList<ChannelSearch> searches;
+
     while(it < max_iterations && (energy_threshold < residuum_energy) && sample_count > 1)
     {
         channel_count = channel_count * (boost / 100.0); //reducing the number of observed channels in the algorithm to increase speed performance
         if(boost == 0 || channel_count == 0)
             channel_count = 1;
 
-        //variables for dyadic sampling
-        qreal s = 1;                             //scale
-        qint32 j = 1;
+        if(searches.size() != channel_count)
+        {
+            searches.clear();
+            for(qint32 chn = 0; chn < channel_count; chn++)
+            {
+                ChannelSearch search;
+                search.chn = chn;
+                search.residuum = &residuum;
+                search.grid = &grid;
+                search.conj_fft_envelopes = &conj_fft_envelopes;
+                search.fft_phase_resid = &fft_phase_resid;
+                search.no_envelope_j = no_envelope_j;
+                search.fix_phase = fix_phase;
+                init_channel_search(search, sample_count, no_envelope_j);
+                searches.append(search);
+            }
+        }
+
         VectorXd max_scalar_product = VectorXd::Zero(channel_count);            //inner product for choosing the best matching atom
-        qreal k = 0;                             //for modulation 2*pi*k/N
-        qint32 p = floor(sample_count / 2);      //translation
         GaborAtom *gabor_Atom = new GaborAtom();
         gabor_Atom->sample_count = sample_count;
         gabor_Atom->energy = 0;
-        qreal phase = 0;
-
-        while(s < sample_count)
-        {
-            k = 0;                               //for modulation 2*pi*k/N
-            p = floor(sample_count / 2);         //translation
-            VectorXd envelope = GaborAtom::gauss_function(sample_count, s, p);
-            VectorXcd fft_envelope = RowVectorXcd::Zero(sample_count);
-            fft.fwd(fft_envelope, envelope);
-
-            while(k < sample_count/2)
-            {
-                p = floor(sample_count/2);
-                VectorXcd modulation = modulation_function(sample_count, k);
-                VectorXcd modulated_resid = VectorXcd::Zero(sample_count);
-                VectorXcd fft_modulated_resid = VectorXcd::Zero(sample_count);
-                VectorXcd fft_m_e_resid = VectorXcd::Zero(sample_count);
-                VectorXd corr_coeffs = VectorXd::Zero(sample_count);
-
-                //iteration for multichannel, depending on boost setting
-                for(qint32 chn = 0; chn < channel_count; chn++)
-                {
-                    qint32 max_index = 0;
-                    qreal maximum = 0;
-                    phase = 0;
-                    p = floor(sample_count/2);//here is difference to dr. gratkowski´s code (he didn´t reset parameter p)
-
-                    //complex correlation of signal and sinus-modulated gaussfunction
-                    for(qint32 l = 0; l< sample_count; l++)
-                        modulated_resid[l] = residuum(l, chn) * modulation[l];
-
-                    fft.fwd(fft_modulated_resid, modulated_resid);
-
-                    for( qint32 m = 0; m < sample_count; m++)
-                        fft_m_e_resid[m] = fft_modulated_resid[m] * conj(fft_envelope[m]);
-
-                    fft.inv(corr_coeffs, fft_m_e_resid);
-                    maximum = corr_coeffs[0];
 
-                    //find index of maximum correlation-coefficient to use in translation
-                    for(qint32 i = 1; i < corr_coeffs.rows(); i++)
-                        if(maximum < corr_coeffs[i])
-                        {
-                            maximum = corr_coeffs[i];
-                            max_index = i;
-                        }
+        QtConcurrent::blockingMap(searches, search_envelope_atoms);
 
-                    //adapting translation p to create atomtranslation correctly
-                    if(max_index >= p) p = max_index - p + 1;
-                    else p = max_index + p;
+        //merge the channels in the order in which the sequential search accepted their best atoms last
+        QVector<QPair<qint32, qint32> > accept_order;
+        for(qint32 chn = 0; chn < channel_count; chn++)
+            if(searches.at(chn).best_index >= 0)
+                accept_order.append(qMakePair(searches.at(chn).best_index, chn));
+        std::sort(accept_order.begin(), accept_order.end());
 
-                    VectorXd atom_parameters = calculate_atom(sample_count, s, p, k, chn, residuum, RETURNPARAMETERS, fix_phase);
-                    qreal temp_scalar_product = 0;
-                    if(trial_separation) temp_scalar_product = max_scalar_product[chn];
-                    else temp_scalar_product = max_scalar_product[0];
+        if(trial_separation)
+            for(qint32 chn = 0; chn < channel_count; chn++)
+                atoms_in_chns.append(*gabor_Atom);
 
-                    if(std::fabs(atom_parameters[4]) >= std::fabs(temp_scalar_product))
-                    {
-                        //set highest scalarproduct, in comparison to best matching atom
-                        gabor_Atom->scale              = atom_parameters[0];
-                        gabor_Atom->translation        = atom_parameters[1];
-                        gabor_Atom->modulation         = atom_parameters[2];
-                        gabor_Atom->phase              = atom_parameters[3];
-                        gabor_Atom->max_scalar_product = atom_parameters[4];
-                        gabor_Atom->bm_channel         = chn;
-
-                        if(trial_separation)
-                        {
-                            max_scalar_product[chn]    = atom_parameters[4];
-
-                            if(atoms_in_chns.length() < channel_count)
-                                atoms_in_chns.append(*gabor_Atom);
-                            else
-                                atoms_in_chns.replace(chn, *gabor_Atom);
-                        }
-                        else
-                            max_scalar_product[0]      = atom_parameters[4];
+        for(qint32 i = 0; i < accept_order.size(); i++)
+        {
+            qint32 chn = accept_order.at(i).second;
+            const VectorXd& atom_parameters = searches.at(chn).best_params;
 
-                    }
+            qreal temp_scalar_product = 0;
+            if(trial_separation) temp_scalar_product = max_scalar_product[chn];
+            else temp_scalar_product = max_scalar_product[0];
 
+            if(std::fabs(atom_parameters[4]) >= std::fabs(temp_scalar_product))
+            {
+                //set highest scalarproduct, in comparison to best matching atom
+                gabor_Atom->scale              = atom_parameters[0];
+                gabor_Atom->translation        = atom_parameters[1];
+                gabor_Atom->modulation         = atom_parameters[2];
+                gabor_Atom->phase              = atom_parameters[3];
+                gabor_Atom->max_scalar_product = atom_parameters[4];
+                gabor_Atom->bm_channel         = chn;
+
+                if(trial_separation)
+                {
+                    max_scalar_product[chn]    = atom_parameters[4];
+                    atoms_in_chns.replace(chn, *gabor_Atom);
                 }
-                k += pow(2.0,(-j))*sample_count/2;
-
+                else
+                    max_scalar_product[0]      = atom_parameters[4];
             }
-            j++;
-            s = pow(2.0,j);
         }
         std::cout << "\n" << "===============" << " found parameters " << it + 1 << "===============" << ":\n\n"<<
                      "scale: " << gabor_Atom->scale << " trans: " << gabor_Atom->translation <<
                      " modu: " << gabor_Atom->modulation << " phase: " << gabor_Atom->phase << " sclr_prdct: " << gabor_Atom->max_scalar_product << "\n";
 
         //replace atoms with s==N and p = floor(N/2) by such atoms that do not have an envelope
-        k = 0;
-        s = sample_count;
-        p = floor(sample_count / 2);
-        j = floor(log10(sample_count)/log10(2));//log(sample_count) / log(2));
-        phase = 0;
+        if(fix_phase)
+        {
+            folded_sum.setZero();
+            for(qint32 chn = 0; chn < residuum.cols(); chn++)
+                for(qint32 n = 0; n < sample_count; n++)
+                    folded_sum[n % folded_sum.rows()] += residuum(n, chn);
+            fft.fwd(fft_phase_resid, folded_sum);
+        }
+
+        QtConcurrent::blockingMap(searches, search_no_envelope_atoms);
 
         //iteration for multichannel, depending on boost setting
         for(qint32 chn = 0; chn < channel_count; chn++)
         {
-            k = 0;
+            if(searches.at(chn).best_index < 0)
+                continue;
 
-            while(k < sample_count / 2)
-            {
-                VectorXd parameters_no_envelope = calculate_atom(sample_count, s, p, k, chn, residuum, RETURNPARAMETERS, fix_phase);
-
-                qreal temp_scalar_product = 0;
-                if(trial_separation) temp_scalar_product = max_scalar_product[chn];
-                else temp_scalar_product = max_scalar_product[0];
-                if(std::fabs(parameters_no_envelope[4]) > std::fabs(temp_scalar_product))
-                {
-                    //set highest scalarproduct, in comparison to best matching atom
+            const VectorXd& parameters_no_envelope = searches.at(chn).best_params;
 
-                    gabor_Atom->scale              = parameters_no_envelope[0];
-                    gabor_Atom->translation        = parameters_no_envelope[1];
-                    gabor_Atom->modulation         = parameters_no_envelope[2];
-                    gabor_Atom->phase              = parameters_no_envelope[3];
-                    gabor_Atom->max_scalar_product = parameters_no_envelope[4];
-                    gabor_Atom->bm_channel         = chn;
+            qreal temp_scalar_product = 0;
+            if(trial_separation) temp_scalar_product = max_scalar_product[chn];
+            else temp_scalar_product = max_scalar_product[0];
+            if(std::fabs(parameters_no_envelope[4]) > std::fabs(temp_scalar_product))
+            {
+                //set highest scalarproduct, in comparison to best matching atom
 
-                    if(trial_separation)
-                    {
-                        max_scalar_product[chn]    = parameters_no_envelope[4];
-                        atoms_in_chns.replace(chn, *gabor_Atom);
-                    }
-                    else
-                        max_scalar_product[0]      = parameters_no_envelope[4];
+                gabor_Atom->scale              = parameters_no_envelope[0];
+                gabor_Atom->translation        = parameters_no_envelope[1];
+                gabor_Atom->modulation         = parameters_no_envelope[2];
+                gabor_Atom->phase              = parameters_no_envelope[3];
+                gabor_Atom->max_scalar_product = parameters_no_envelope[4];
+                gabor_Atom->bm_channel         = chn;
 
+                if(trial_separation)
+                {
+                    max_scalar_product[chn]    = parameters_no_envelope[4];
+                    atoms_in_chns.replace(chn, *gabor_Atom);
                 }
-                k += pow(2.0,(-j))*sample_count/2;
+                else
+                    max_scalar_product[0]      = parameters_no_envelope[4];
 
             }
-
         }
         std::cout << "      after comparison to NoEnvelope " << ":\n"<< "scale: " << gabor_Atom->scale << " trans: " << gabor_Atom->translation <<
                      " modu: " << gabor_Atom->modulation << " phase: " << gabor_Atom->phase << " sclr_prdct: " << gabor_Atom->max_scalar_product << "\n\n";
@@ -399,7 +606,7 @@ VectorXcd AdaptiveMp::modulation_function(qint32 N, qreal k)
 
 //*************************************************************************************************************
 
-VectorXd AdaptiveMp::calculate_atom(qint32 sample_count, qreal scale, qint32 translation, qreal modulation, qint32 channel, MatrixXd residuum, ReturnValue return_value = RETURNATOM, bool fix_phase = false)
+VectorXd AdaptiveMp::calculate_atom(qint32 sample_count, qreal scale, qint32 translation, qreal modulation, qint32 channel, const MatrixXd& residuum, ReturnValue return_value = RETURNATOM, bool fix_phase = false)
 {
     GaborAtom *gabor_Atom = new GaborAtom();
     qreal phase = 0;
@@ -463,7 +670,7 @@ VectorXd AdaptiveMp::calculate_atom(qint32 sample_count, qreal scale, qint32 tra
 //*************************************************************************************************************
 
 void AdaptiveMp::simplex_maximisation(qint32 simplex_it, qreal simplex_reflection, qreal simplex_expansion, qreal simplex_contraction, qreal simplex_full_contraction,
-                                      GaborAtom *gabor_Atom, VectorXd max_scalar_product, qint32 sample_count, bool fix_phase, MatrixXd residuum, bool trial_separation, qint32 chn)
+                                      GaborAtom *gabor_Atom, const VectorXd& max_scalar_product, qint32 sample_count, bool fix_phase, const MatrixXd& residuum, bool trial_separation, qint32 chn)
 {
     //Maximisation Simplex Algorithm implemented by Botao Jia, adapted to the MP Algorithm by Martin Henfling. Copyright (C) 2010 Botao Jia
     //ToDo: change to clean use of EIGEN, @present its mixed with Namespace std and <vector>
@@ -516,28 +723,20 @@ void AdaptiveMp::simplex_maximisation(qint32 simplex_it, qreal simplex_reflectio
         std::transform(init.begin(), init.end(), xcentroid_old.begin(), std::bind2nd(std::multiplies<double>(), N+1) );
     }//constructing the simplex finished
 
-    //optimization begins
-    for(cnt=0; cnt<iterations; ++cnt)
-    {
-        for(qint32 i=0; i < N+1; ++i)
-        {
-            VectorXd atom_fx = VectorXd::Zero(sample_count);
-
-            if(gabor_Atom->scale == sample_count && gabor_Atom->translation == floor(sample_count / 2))
-                atom_fx = calculate_atom(sample_count, sample_count, floor(sample_count / 2), x[i][2], chn, residuum, RETURNATOM, fix_phase);
+    //targetfunction of realGaborAtom and Residuum: the negative scalarproduct, which calculate_atom already returns
+    bool no_envelope = gabor_Atom->scale == sample_count && gabor_Atom->translation == floor(sample_count / 2);
 
-            else
-                atom_fx = calculate_atom(sample_count, x[i][0], x[i][1], x[i][2], chn, residuum, RETURNATOM, fix_phase);
-
-            //create targetfunction of realGaborAtom and Residuum
-            double target = 0;
-            for(qint32 k = 0; k < atom_fx.rows(); k++)
-            {
-                target -=atom_fx[k]*residuum(k, chn); //ToDo: old residuum(k,0)
-            }
+    for(qint32 i=0; i < N+1; ++i)
+    {
+        if(no_envelope)
+            vf[i] = -calculate_atom(sample_count, sample_count, floor(sample_count / 2), x[i][2], chn, residuum, RETURNPARAMETERS, fix_phase)[4];
+        else
+            vf[i] = -calculate_atom(sample_count, x[i][0], x[i][1], x[i][2], chn, residuum, RETURNPARAMETERS, fix_phase)[4];
+    }
 
-            vf[i] = target;
-        }
+    //optimization begins, vf holds the target at every vertex and is only updated for vertices which moved
+    for(cnt=0; cnt<iterations; ++cnt)
+    {
 
         x1=0; xn=0; xnp1=0;//find index of max, second max, min of vf.
 
@@ -576,21 +775,19 @@ void AdaptiveMp::simplex_maximisation(qint32 simplex_it, qreal simplex_reflectio
         for( qint32 i=0; i<N; ++i) xr[i]=xg[i]+a*(xg[i]-x[xnp1][i]);
         //reflection, xr found
 
-        VectorXd atom_fxr = VectorXd::Zero(sample_count);
+        double fxr = 0;
 
-        if(gabor_Atom->scale == sample_count && gabor_Atom->translation == floor(sample_count / 2))
-            atom_fxr = calculate_atom(sample_count, sample_count, floor(sample_count / 2), xr[2], chn, residuum, RETURNATOM, fix_phase);
+        if(no_envelope)
+            fxr = -calculate_atom(sample_count, sample_count, floor(sample_count / 2), xr[2], chn, residuum, RETURNPARAMETERS, fix_phase)[4];
 
         else
-            atom_fxr = calculate_atom(sample_count, xr[0], xr[1], xr[2], chn, residuum, RETURNATOM, fix_phase);
-
-        //create targetfunction of realGaborAtom and Residuum
-        double fxr = 0;
-        for(qint32 k = 0; k < atom_fxr.rows(); k++) fxr -=atom_fxr[k]*residuum(k,chn);//ToDo: old residuum(k,0)
+            fxr = -calculate_atom(sample_count, xr[0], xr[1], xr[2], chn, residuum, RETURNPARAMETERS, fix_phase)[4];
 
-        //double fxr = target;//record function at xr
-
-        if(vf[x1]<=fxr && fxr<=vf[xn]) std::copy(xr.begin(), xr.end(), x[xnp1].begin());
+        if(vf[x1]<=fxr && fxr<=vf[xn])
+        {
+            std::copy(xr.begin(), xr.end(), x[xnp1].begin());
+            vf[xnp1] = fxr;
+        }
 
         //expansion:
         else if(fxr<vf[x1])
@@ -599,20 +796,24 @@ void AdaptiveMp::simplex_maximisation(qint32 simplex_it, qreal simplex_reflectio
 
             for( qint32 i=0; i<N; ++i) xe[i]=xr[i]+b*(xr[i]-xg[i]);
 
-            VectorXd atom_fxe = VectorXd::Zero(sample_count);
+            double fxe = 0;
 
-            if(gabor_Atom->scale == sample_count && gabor_Atom->translation == floor(sample_count / 2))
-                atom_fxe = calculate_atom(sample_count, sample_count, floor(sample_count / 2), xe[2], chn, residuum, RETURNATOM, fix_phase);
+            if(no_envelope)
+                fxe = -calculate_atom(sample_count, sample_count, floor(sample_count / 2), xe[2], chn, residuum, RETURNPARAMETERS, fix_phase)[4];
 
             else
-                atom_fxe = calculate_atom(sample_count, xe[0], xe[1], xe[2], chn, residuum, RETURNATOM, fix_phase);
+                fxe = -calculate_atom(sample_count, xe[0], xe[1], xe[2], chn, residuum, RETURNPARAMETERS, fix_phase)[4];
 
-            //create targetfunction of realGaborAtom and Residuum
-            double fxe = 0;
-            for(qint32 k = 0; k < atom_fxe.rows(); k++) fxe -=atom_fxe[k]*residuum(k,chn);//ToDo: old residuum(k,0)
-
-            if( fxe < fxr ) std::copy(xe.begin(), xe.end(), x[xnp1].begin() );
-            else std::copy(xr.begin(), xr.end(), x[xnp1].begin() );
+            if( fxe < fxr )
+            {
+                std::copy(xe.begin(), xe.end(), x[xnp1].begin() );
+                vf[xnp1] = fxe;
+            }
+            else
+            {
+                std::copy(xr.begin(), xr.end(), x[xnp1].begin() );
+                vf[xnp1] = fxr;
+            }
         }//expansion finished,  xe is not used outside the scope
 
         //contraction:
@@ -623,33 +824,32 @@ void AdaptiveMp::simplex_maximisation(qint32 simplex_it, qreal simplex_reflectio
             for( qint32 i=0; i<N; ++i)
                 xc[i]=xg[i]+g*(x[xnp1][i]-xg[i]);
 
-            if(gabor_Atom->scale == sample_count && gabor_Atom->translation == floor(sample_count / 2))
+            if(no_envelope)
                 atom_fxc_params = AdaptiveMp::calculate_atom(sample_count, sample_count, floor(sample_count / 2), xc[2], chn, residuum, RETURNPARAMETERS, fix_phase);
 
             else
                 atom_fxc_params = AdaptiveMp::calculate_atom(sample_count, xc[0], xc[1], xc[2], chn, residuum, RETURNPARAMETERS, fix_phase);
 
-            VectorXd atom_fxc = gabor_Atom->create_real(gabor_Atom->sample_count, atom_fxc_params[0], atom_fxc_params[1], atom_fxc_params[2], atom_fxc_params[3]);
-
-            atom_fxc_params[4] = 0;
-
-            for(qint32 i = 0; i < sample_count; i++)
-                atom_fxc_params[4] += atom_fxc[i] * residuum(i, chn);
-
-            //create targetfunction of realGaborAtom and Residuum
-            double fxc = 0;
-
-            for(qint32 k = 0; k < atom_fxc.rows(); k++)
-                fxc -=atom_fxc[k]*residuum(k,chn);//ToDo: old residuum(k,0)
+            double fxc = -atom_fxc_params[4];
 
             if( fxc < vf[xnp1] )
+            {
                 std::copy(xc.begin(), xc.end(), x[xnp1].begin() );
+                vf[xnp1] = fxc;
+            }
 
             else
                 for( quint32 i=0; i<x.size(); ++i )
                     if( i!=x1 )
+                    {
                         for(qint32 j=0; j<N; ++j)
                             x[i][j] = x[x1][j] + h * ( x[i][j]-x[x1][j] );
+
+                        if(no_envelope)
+                            vf[i] = -calculate_atom(sample_count, sample_count, floor(sample_count / 2), x[i][2], chn, residuum, RETURNPARAMETERS, fix_phase)[4];
+                        else
+                            vf[i] = -calculate_atom(sample_count, x[i][0], x[i][1], x[i][2], chn, residuum, RETURNPARAMETERS, fix_phase)[4];
+                    }
         }//contraction finished, xc is not used outside the scope
     }//optimization is finished
     //end Maximisation Copyright (C) 2010 Botao Jia
@@ -657,7 +857,7 @@ void AdaptiveMp::simplex_maximisation(qint32 simplex_it, qreal simplex_reflectio
     if(iterations != 0)
     {
 
-        if(gabor_Atom->scale == sample_count && gabor_Atom->translation == floor(sample_count / 2))
+        if(no_envelope)
             atom_fxc_params = AdaptiveMp::calculate_atom(sample_count, sample_count, floor(sample_count / 2), x[x1][2], chn, residuum, RETURNPARAMETERS, fix_phase);
 
         else
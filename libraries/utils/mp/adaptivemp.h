@@ -193,7 +193,7 @@ public:
     *
     * @return depending on returnValue returning the real atom calculated or the manipulated parameters: scale, translation, modulation, phase, scalarproduct
     */
-    static VectorXd calculate_atom(qint32 sample_count, qreal scale, qint32 translation, qreal modulation, qint32 channel, MatrixXd residuum, ReturnValue return_value, bool fix_phase);
+    static VectorXd calculate_atom(qint32 sample_count, qreal scale, qint32 translation, qreal modulation, qint32 channel, const MatrixXd& residuum, ReturnValue return_value, bool fix_phase);
 
     //=========================================================================================================
     /**
@@ -214,10 +214,12 @@ public:
     * @param[in] fix_phase                  whether fix phase or varying
     * @param[in] residuum                   the signalresiduun after each MP Algorithm iterationstep
     *
+    * The target function is evaluated once per new vertex, vertices which are kept are not recalculated.
+    *
     * @return depending on returnValue returning the real atom calculated or the manipulated parameters: scale, translation, modulation, phase, scalarproduct
     */
     void simplex_maximisation(qint32 simplex_it, qreal simplex_reflection, qreal simplex_expansion, qreal simplex_contraction, qreal simplex_full_contraction,
-                              GaborAtom *gabor_Atom, VectorXd max_scalar_product, qint32 sample_count, bool fix_phase, MatrixXd residuum, bool trial_separation, qint32 chn);
+                              GaborAtom *gabor_Atom, const VectorXd& max_scalar_product, qint32 sample_count, bool fix_phase, const MatrixXd& residuum, bool trial_separation, qint32 chn);
 
     //=========================================================================================================
 
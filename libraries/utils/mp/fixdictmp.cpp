@@ -53,6 +53,7 @@
 #include <iostream>
 #include <vector>
 #include <math.h>
+#include <string.h>
 
 
 //*************************************************************************************************************
@@ -73,6 +74,10 @@
 #include <QtConcurrent>
 #include <QFuture>
 #include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QDataStream>
+#include <QCoreApplication>
 #include <QStringList>
 
 
@@ -83,6 +88,35 @@
 
 using namespace UTILSLIB;
 
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINE GLOBAL METHODS
+//=============================================================================================================
+
+//
+// Header of a compiled dictionary. The metadata (part dictionaries, atom parameters and samples) is
+// serialized with QDataStream, the atom spectra follow as one contiguous block of complex doubles.
+//
+struct BinDictHeader
+{
+    qint32 magic;
+    qint32 version;
+    qint32 sample_count;        // signal length of the spectra
+    qint32 spectra_stride;      // complex values from one atom spectrum to the next
+    qint64 xml_size;            // size and modification time of the xml dictionary
+    qint64 xml_modified;
+    qint64 meta_offset;
+    qint64 meta_size;
+    qint64 spectra_offset;
+    qint64 spectra_size;
+};
+
+static qint64 bin_dict_align(qint64 offset)
+{
+    return (offset + MP_BIN_DICT_ALIGN - 1) / MP_BIN_DICT_ALIGN * MP_BIN_DICT_ALIGN;
+}
+
 //*************************************************************************************************************
 //=============================================================================================================
 // DEFINE MEMBER METHODS
@@ -112,6 +146,9 @@ FixDictMp::~FixDictMp()
 Dictionary::Dictionary()
 : type(AtomType::GABORATOM)
 , sample_count(0)
+, spectra_length(0)
+, spectra_stride(0)
+, atom_spectra(NULL)
 {
 
 }
@@ -145,7 +182,23 @@ void FixDictMp::matching_pursuit(MatrixXd signal, qint32 max_iterations, qreal e
     bool sample_count_mismatch = false;
 
     this->residuum = signal;
-    parsed_dicts = parse_xml_dict(path);
+    parsed_dicts = load_dict(path, sample_count);
+
+    //reducing the number of observed channels in the algorithm to increase speed performance
+    qint32 observed_count = channel_count * (boost / 100.0);
+    if(boost == 0 || observed_count == 0)
+        observed_count = 1;
+    observed_count = qMin(observed_count, channel_count);
+
+    //spectra of the observed residuum channels, updated with each found atom
+    Eigen::FFT<double> fft;
+    this->resid_spectra.resize(sample_count, observed_count);
+    VectorXcd fft_channel = VectorXcd::Zero(sample_count);
+    for(qint32 chn = 0; chn < observed_count; chn++)
+    {
+        fft.fwd(fft_channel, this->residuum.col(chn));
+        this->resid_spectra.col(chn) = fft_channel;
+    }
 
     //calculate signal_energy
     for(qint32 channel = 0; channel < channel_count; channel++)
@@ -168,8 +221,7 @@ void FixDictMp::matching_pursuit(MatrixXd signal, qint32 max_iterations, qreal e
         {
             find_best_matching current_best_matching;
             current_best_matching.pdict = parsed_dicts.at(i);
-            current_best_matching.current_resid = this->residuum;
-            current_best_matching.boost = boost;
+            current_best_matching.resid_spectra = &this->resid_spectra;
             list_of_best.append(current_best_matching);
         }
 
@@ -225,6 +277,12 @@ void FixDictMp::matching_pursuit(MatrixXd signal, qint32 max_iterations, qreal e
 
         global_best_matching.atom_samples = fitted_atom;
 
+        //the residuum changed by a multiple of the fitted atom in every channel -> update its spectra
+        VectorXcd fft_fitted_atom = VectorXcd::Zero(sample_count);
+        fft.fwd(fft_fitted_atom, fitted_atom);
+        for(qint32 chn = 0; chn < observed_count; chn++)
+            this->resid_spectra.col(chn) -= global_best_matching.max_scalar_list.at(chn) * fft_fitted_atom;
+
 
         last_energy = residuum_energy;
         /*residuum_energy = 0;
@@ -292,74 +350,61 @@ FixDictAtom FixDictMp::correlation(Dictionary current_pdict, MatrixXd current_re
         channel_count = 1;
 
     Eigen::FFT<double> fft;
-    std::ptrdiff_t max_index;
-    VectorXcd fft_atom = VectorXcd::Zero(current_resid.rows());
+    MatrixXcd resid_spectra(current_resid.rows(), channel_count);
+    VectorXcd fft_signal = VectorXcd::Zero(current_resid.rows());
 
-    FixDictAtom best_matching;
-    qreal max_scalar_product = 0;
-
-    for(qint32 i = 0; i < current_pdict.atoms.length(); i++)
+    for(qint32 chn = 0; chn < channel_count; chn++)
     {
-        VectorXd fitted_atom = VectorXd::Zero(current_resid.rows());
-        qint32 p = floor(current_resid.rows() / 2);//translation
+        fft.fwd(fft_signal, current_resid.col(chn));
+        resid_spectra.col(chn) = fft_signal;
+    }
 
-        VectorXd resized_atom = VectorXd::Zero(current_resid.rows());
+    if(current_pdict.spectra_length != current_resid.rows())
+        compute_atom_spectra(current_pdict, current_resid.rows());
 
-        if(current_pdict.atoms.at(i).atom_samples.rows() > current_resid.rows())
-            for(qint32 k = 0; k < current_resid.rows(); k++)
-                resized_atom[k] = current_pdict.atoms.at(i).atom_samples[k + floor(current_pdict.atoms.at(i).atom_samples.rows() / 2) - floor(current_resid.rows() / 2)];
-        else resized_atom = current_pdict.atoms.at(i).atom_samples;
+    return correlation(current_pdict, resid_spectra);
+}
 
-        if(resized_atom.rows() < current_resid.rows())
-            for(qint32 k = 0; k < resized_atom.rows(); k++)
-                fitted_atom[(k + p - floor(resized_atom.rows() / 2))] = resized_atom[k];
-        else fitted_atom = resized_atom;
 
-        //normalization
-        qreal norm = 0;
-        norm = fitted_atom.norm();
-        if(norm != 0) fitted_atom /= norm;
+//*************************************************************************************************************
+
+FixDictAtom FixDictMp::correlation(const Dictionary& current_pdict, const MatrixXcd& resid_spectra)
+{
+    qint32 sample_count = resid_spectra.rows();
+    qint32 channel_count = resid_spectra.cols();
+
+    Eigen::FFT<double> fft;
+    std::ptrdiff_t max_index;
+
+    FixDictAtom best_matching;
+    qreal max_scalar_product = 0;
 
-        fft.fwd(fft_atom, fitted_atom);
+    VectorXd corr_coeffs = VectorXd::Zero(sample_count);
+    VectorXcd fft_sig_atom = VectorXcd::Zero(sample_count);
+
+    for(qint32 i = 0; i < current_pdict.atoms.length(); i++)
+    {
+        Map<const VectorXcd> fft_atom = current_pdict.atom_spectrum(i);
 
         for(qint32 chn = 0; chn < channel_count; chn++)
         {
-            p = floor(current_resid.rows() / 2);//translation
-            VectorXd corr_coeffs = VectorXd::Zero(current_resid.rows());
-            VectorXcd fft_signal = VectorXcd::Zero(current_resid.rows());
-            VectorXcd fft_sig_atom = VectorXcd::Zero(current_resid.rows());
+            qint32 p = floor(sample_count / 2);//translation
 
-            fft.fwd(fft_signal, current_resid.col(chn));
-
-            for( qint32 m = 0; m < current_resid.rows(); m++)
-                fft_sig_atom[m] = fft_signal[m] * conj(fft_atom[m]);
+            fft_sig_atom = resid_spectra.col(chn).cwiseProduct(fft_atom.conjugate());
 
             fft.inv(corr_coeffs, fft_sig_atom);
 
             //find index of maximum correlation-coefficient to use in translation
             max_scalar_product = corr_coeffs.maxCoeff(&max_index);
 
-            if(i == 0)
+            if(i == 0 || std::fabs(max_scalar_product) > std::fabs(best_matching.max_scalar_product))
             {
                 best_matching = current_pdict.atoms.at(i);
                 best_matching.max_scalar_product = max_scalar_product;
 
                 //adapting translation p to create atomtranslation correctly
-                if(max_index >= p && current_resid.rows() % (2) == 0) p = max_index - p;
-                else if(max_index >= p && current_resid.rows() % (2) != 0) p = max_index - p - 1;
-                else p = max_index + p;
-
-                best_matching.translation = p;
-            }
-
-            else if(std::fabs(max_scalar_product) > std::fabs(best_matching.max_scalar_product))
-            {
-                best_matching = current_pdict.atoms.at(i);
-                best_matching.max_scalar_product = max_scalar_product;
-
-                //adapting translation p to create atomtranslation correctly
-                if(max_index >= p && current_resid.rows() % (2) == 0) p = max_index - p;
-                else if(max_index >= p && current_resid.rows() % (2) != 0) p = max_index - p - 1;
+                if(max_index >= p && sample_count % (2) == 0) p = max_index - p;
+                else if(max_index >= p && sample_count % (2) != 0) p = max_index - p - 1;
                 else p = max_index + p;
 
                 best_matching.translation = p;
@@ -375,6 +420,302 @@ FixDictAtom FixDictMp::correlation(Dictionary current_pdict, MatrixXd current_re
 }
 
 
+//*************************************************************************************************************
+
+VectorXd FixDictMp::fit_atom(const VectorXd& atom_samples, qint32 sample_count)
+{
+    VectorXd fitted_atom = VectorXd::Zero(sample_count);
+    qint32 p = floor(sample_count / 2);//translation
+
+    VectorXd resized_atom = VectorXd::Zero(sample_count);
+
+    if(atom_samples.rows() > sample_count)
+        for(qint32 k = 0; k < sample_count; k++)
+            resized_atom[k] = atom_samples[k + floor(atom_samples.rows() / 2) - floor(sample_count / 2)];
+    else resized_atom = atom_samples;
+
+    if(resized_atom.rows() < sample_count)
+        for(qint32 k = 0; k < resized_atom.rows(); k++)
+            fitted_atom[(k + p - floor(resized_atom.rows() / 2))] = resized_atom[k];
+    else fitted_atom = resized_atom;
+
+    //normalization
+    qreal norm = 0;
+    norm = fitted_atom.norm();
+    if(norm != 0) fitted_atom /= norm;
+
+    return fitted_atom;
+}
+
+
+//*************************************************************************************************************
+
+void FixDictMp::compute_atom_spectra(Dictionary& pdict, qint32 sample_count)
+{
+    Eigen::FFT<double> fft;
+    VectorXcd fft_atom = VectorXcd::Zero(sample_count);
+
+    qint32 stride = bin_dict_align(sample_count * sizeof(std::complex<double>)) / sizeof(std::complex<double>);
+
+    pdict.spectra_file.clear();
+    pdict.spectra_buffer = QVector<std::complex<double> >(pdict.atoms.length() * stride);
+
+    for(qint32 i = 0; i < pdict.atoms.length(); i++)
+    {
+        fft.fwd(fft_atom, fit_atom(pdict.atoms.at(i).atom_samples, sample_count));
+        Map<VectorXcd>(pdict.spectra_buffer.data() + (qint64)i * stride, sample_count) = fft_atom;
+    }
+
+    pdict.spectra_length = sample_count;
+    pdict.spectra_stride = stride;
+    pdict.atom_spectra = pdict.spectra_buffer.constData();
+}
+
+
+//*************************************************************************************************************
+
+QList<Dictionary> FixDictMp::load_dict(QString path, qint32 sample_count)
+{
+    QList<Dictionary> parsed_dicts;
+    QString bin_path = bin_dict_path(path, sample_count);
+
+    if(read_bin_dict(bin_path, path, sample_count, parsed_dicts))
+    {
+        std::cout << "\nloaded compiled dictionary " << qPrintable(bin_path) << "\n\n";
+
+        for(qint32 i = 0; i < parsed_dicts.length(); i++)
+            if(parsed_dicts.at(i).sample_count != sample_count)
+            {
+                emit send_warning(2);
+                break;
+            }
+
+        return parsed_dicts;
+    }
+
+    parsed_dicts = parse_xml_dict(path);
+
+    for(qint32 i = 0; i < parsed_dicts.length(); i++)
+        compute_atom_spectra(parsed_dicts[i], sample_count);
+
+    //compile the dictionary for the next run and map it, so that the spectra are not held twice
+    if(write_bin_dict(bin_path, path, parsed_dicts))
+    {
+        QList<Dictionary> mapped_dicts;
+        if(read_bin_dict(bin_path, path, sample_count, mapped_dicts))
+            return mapped_dicts;
+    }
+
+    return parsed_dicts;
+}
+
+
+//*************************************************************************************************************
+
+QString FixDictMp::bin_dict_path(const QString& path, qint32 sample_count)
+{
+    return QString("%1.%2.%3").arg(path).arg(sample_count).arg(MP_BIN_DICT_SUFFIX);
+}
+
+
+//*************************************************************************************************************
+
+bool FixDictMp::write_bin_dict(const QString& bin_path, const QString& xml_path, const QList<Dictionary>& dicts)
+{
+    QFileInfo xml_info(xml_path);
+
+    BinDictHeader header;
+    memset(&header, 0, sizeof(BinDictHeader));
+    header.magic = MP_BIN_DICT_MAGIC;
+    header.version = MP_BIN_DICT_VERSION;
+    header.xml_size = xml_info.size();
+    header.xml_modified = xml_info.lastModified().toMSecsSinceEpoch();
+
+    qint32 total_atoms = 0;
+    for(qint32 i = 0; i < dicts.length(); i++)
+    {
+        if(dicts.at(i).spectra_length == 0)
+            return false;
+        if(i == 0)
+        {
+            header.sample_count = dicts.at(i).spectra_length;
+            header.spectra_stride = dicts.at(i).spectra_stride;
+        }
+        else if(dicts.at(i).spectra_length != header.sample_count || dicts.at(i).spectra_stride != header.spectra_stride)
+            return false;
+        total_atoms += dicts.at(i).atoms.length();
+    }
+
+    QByteArray meta;
+    QDataStream meta_stream(&meta, QIODevice::WriteOnly);
+    meta_stream.setVersion(QDataStream::Qt_5_0);
+    meta_stream << (qint32)dicts.length();
+
+    for(qint32 i = 0; i < dicts.length(); i++)
+    {
+        const Dictionary& pdict = dicts.at(i);
+        meta_stream << pdict.source << pdict.atom_formula << (qint32)pdict.type << pdict.sample_count << (qint32)pdict.atoms.length();
+
+        for(qint32 j = 0; j < pdict.atoms.length(); j++)
+        {
+            const FixDictAtom& atom = pdict.atoms.at(j);
+            meta_stream << atom.id
+                        << atom.gabor_atom.scale << atom.gabor_atom.modulation << atom.gabor_atom.phase
+                        << atom.chirp_atom.scale << atom.chirp_atom.modulation << atom.chirp_atom.phase << atom.chirp_atom.chirp
+                        << atom.formula_atom.a << atom.formula_atom.b << atom.formula_atom.c << atom.formula_atom.d
+                        << atom.formula_atom.e << atom.formula_atom.f << atom.formula_atom.g << atom.formula_atom.h;
+
+            meta_stream << (qint32)atom.atom_samples.rows();
+            for(qint32 k = 0; k < atom.atom_samples.rows(); k++)
+                meta_stream << atom.atom_samples[k];
+        }
+    }
+
+    header.meta_offset = bin_dict_align(sizeof(BinDictHeader));
+    header.meta_size = meta.size();
+    header.spectra_offset = bin_dict_align(header.meta_offset + header.meta_size);
+    header.spectra_size = (qint64)total_atoms * header.spectra_stride * sizeof(std::complex<double>);
+
+    //write to a temporary file first, so that a reader never maps a partially written dictionary
+    QString tmp_path = QString("%1.%2.tmp").arg(bin_path).arg(QCoreApplication::applicationPid());
+    QFile file(tmp_path);
+    if(!file.open(QIODevice::WriteOnly))
+        return false;
+
+    bool ok = file.write((const char*)&header, sizeof(BinDictHeader)) == sizeof(BinDictHeader);
+    ok = ok && file.seek(header.meta_offset) && file.write(meta) == meta.size();
+    ok = ok && file.seek(header.spectra_offset);
+
+    for(qint32 i = 0; ok && i < dicts.length(); i++)
+    {
+        qint64 size = (qint64)dicts.at(i).atoms.length() * header.spectra_stride * sizeof(std::complex<double>);
+        ok = file.write((const char*)dicts.at(i).atom_spectra, size) == size;
+    }
+
+    file.close();
+
+    if(!ok)
+    {
+        QFile::remove(tmp_path);
+        return false;
+    }
+
+    QFile::remove(bin_path);
+    if(!QFile::rename(tmp_path, bin_path))
+    {
+        QFile::remove(tmp_path);
+        return false;
+    }
+
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+bool FixDictMp::read_bin_dict(const QString& bin_path, const QString& xml_path, qint32 sample_count, QList<Dictionary>& dicts)
+{
+    dicts.clear();
+
+    QSharedPointer<QFile> file(new QFile(bin_path));
+    if(!file->open(QIODevice::ReadOnly) || file->size() < (qint64)sizeof(BinDictHeader))
+        return false;
+
+    uchar* data = file->map(0, file->size());
+    if(!data)
+        return false;
+
+    BinDictHeader header;
+    memcpy(&header, data, sizeof(BinDictHeader));
+
+    QFileInfo xml_info(xml_path);
+
+    if(header.magic != MP_BIN_DICT_MAGIC
+            || header.version != MP_BIN_DICT_VERSION
+            || header.sample_count != sample_count
+            || header.spectra_stride < header.sample_count
+            || header.xml_size != xml_info.size()
+            || header.xml_modified != xml_info.lastModified().toMSecsSinceEpoch()
+            || header.meta_offset < (qint64)sizeof(BinDictHeader)
+            || header.meta_size < 0
+            || header.spectra_size < 0
+            || header.meta_offset + header.meta_size > header.spectra_offset
+            || header.spectra_offset + header.spectra_size > file->size()
+            || header.spectra_offset % MP_BIN_DICT_ALIGN != 0)
+        return false;
+
+    QByteArray meta = QByteArray::fromRawData((const char*)data + header.meta_offset, header.meta_size);
+    QDataStream meta_stream(meta);
+    meta_stream.setVersion(QDataStream::Qt_5_0);
+
+    const std::complex<double>* spectra = (const std::complex<double>*)(data + header.spectra_offset);
+    qint64 atom_offset = 0;
+
+    qint32 dict_count = 0;
+    meta_stream >> dict_count;
+    if(dict_count <= 0 || meta_stream.status() != QDataStream::Ok)
+        return false;
+
+    for(qint32 i = 0; i < dict_count; i++)
+    {
+        Dictionary pdict;
+        qint32 type = 0;
+        qint32 atom_count = 0;
+        meta_stream >> pdict.source >> pdict.atom_formula >> type >> pdict.sample_count >> atom_count;
+        pdict.type = (AtomType)type;
+
+        for(qint32 j = 0; j < atom_count; j++)
+        {
+            FixDictAtom atom;
+            meta_stream >> atom.id
+                        >> atom.gabor_atom.scale >> atom.gabor_atom.modulation >> atom.gabor_atom.phase
+                        >> atom.chirp_atom.scale >> atom.chirp_atom.modulation >> atom.chirp_atom.phase >> atom.chirp_atom.chirp
+                        >> atom.formula_atom.a >> atom.formula_atom.b >> atom.formula_atom.c >> atom.formula_atom.d
+                        >> atom.formula_atom.e >> atom.formula_atom.f >> atom.formula_atom.g >> atom.formula_atom.h;
+
+            qint32 samples = 0;
+            meta_stream >> samples;
+            //a corrupt count must not allocate more samples than the metadata holds
+            if(samples < 0 || meta_stream.status() != QDataStream::Ok
+                    || samples > (header.meta_size - meta_stream.device()->pos()) / (qint64)sizeof(double))
+            {
+                dicts.clear();
+                return false;
+            }
+            atom.atom_samples = VectorXd::Zero(samples);
+            for(qint32 k = 0; k < samples; k++)
+                meta_stream >> atom.atom_samples[k];
+
+            pdict.atoms.append(atom);
+        }
+
+        if(meta_stream.status() != QDataStream::Ok
+                || atom_count < 0
+                || (atom_offset + atom_count) * header.spectra_stride * (qint64)sizeof(std::complex<double>) > header.spectra_size)
+        {
+            dicts.clear();
+            return false;
+        }
+
+        pdict.spectra_length = header.sample_count;
+        pdict.spectra_stride = header.spectra_stride;
+        pdict.atom_spectra = spectra + atom_offset * header.spectra_stride;
+        pdict.spectra_file = file;
+        atom_offset += atom_count;
+
+        dicts.append(pdict);
+    }
+
+    if(!meta_stream.atEnd() || atom_offset * header.spectra_stride * (qint64)sizeof(std::complex<double>) != header.spectra_size)
+    {
+        dicts.clear();
+        return false;
+    }
+
+    return true;
+}
+
+
 //*************************************************************************************************************
 
 QList<Dictionary> FixDictMp::parse_xml_dict(QString path)
@@ -588,6 +929,11 @@ qint32 Dictionary::atom_count()
      this->atom_formula = "";
      this->sample_count = 0;
      this->source = "";
+     this->spectra_length = 0;
+     this->spectra_stride = 0;
+     this->atom_spectra = NULL;
+     this->spectra_buffer.clear();
+     this->spectra_file.clear();
  }
 
 
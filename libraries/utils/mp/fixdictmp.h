@@ -63,6 +63,20 @@
 //=============================================================================================================
 
 #include <QtXml>
+#include <QFile>
+#include <QSharedPointer>
+#include <QVector>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINES
+//=============================================================================================================
+
+#define MP_BIN_DICT_MAGIC    0x4450424d      /**< "MBPD", identifies a compiled dictionary file. */
+#define MP_BIN_DICT_VERSION  1               /**< Version of the compiled dictionary layout. */
+#define MP_BIN_DICT_ALIGN    64              /**< Alignment of the atom spectra in bytes. */
+#define MP_BIN_DICT_SUFFIX   "bdict"         /**< Suffix of compiled dictionary files. */
 
 
 //*************************************************************************************************************
@@ -121,10 +135,29 @@ public:
     QString atom_formula;
     qint32 sample_count;
 
+    qint32 spectra_length;                              /**< Signal length the atom spectra belong to, 0 if there are none. */
+    qint32 spectra_stride;                              /**< Distance between the spectra of two atoms (complex values). */
+    const std::complex<double>* atom_spectra;           /**< Spectra of the fitted, normalized atoms, atom after atom. */
+    QVector<std::complex<double> > spectra_buffer;      /**< Holds the spectra if they were computed in memory. */
+    QSharedPointer<QFile> spectra_file;                 /**< Holds the compiled dictionary the spectra are mapped from. */
+
     qint32 atom_count();
 
     void clear();
 
+    //=========================================================================================================
+    /**
+    * Returns the spectrum of an atom.
+    *
+    * @param[in] atom   Index of the atom.
+    *
+    * @return The spectrum (spectra_length values).
+    */
+    inline Map<const VectorXcd> atom_spectrum(qint32 atom) const
+    {
+        return Map<const VectorXcd>(atom_spectra + (qint64)atom * spectra_stride, spectra_length);
+    }
+
 };//class
 
 
@@ -150,6 +183,7 @@ public:
     qint32 it;
     qint32 max_iterations;
     MatrixXd residuum;
+    MatrixXcd resid_spectra;                            /**< Spectra of the observed residuum channels, updated with each found atom. */
     QList<FixDictAtom> fix_dict_list;
     QList<GaborAtom> adaptive_list;
 
@@ -182,6 +216,18 @@ public:
 
     FixDictAtom correlation(Dictionary current_pdict, MatrixXd current_resid, qint32 boost);
 
+    //=========================================================================================================
+    /**
+    * Finds the best matching atom of a dictionary by correlating the precomputed atom spectra with the
+    * spectra of the residuum channels.
+    *
+    * @param[in] current_pdict      The dictionary, its atom spectra must belong to the residuum length.
+    * @param[in] resid_spectra      Spectra of the observed residuum channels (samples x channels).
+    *
+    * @return The best matching atom.
+    */
+    FixDictAtom correlation(const Dictionary& current_pdict, const MatrixXcd& resid_spectra);
+
     //=========================================================================================================
 
     //static void create_tree_dict(QString save_path);
@@ -195,20 +241,88 @@ public:
     struct find_best_matching
     {
         Dictionary pdict;
-        MatrixXd current_resid;
-        qint32 boost;
+        const MatrixXcd* resid_spectra;
 
         FixDictAtom parallel_correlation() const
         {
             FixDictAtom best_matching;
             FixDictMp fix_dict_mp;
-            best_matching = fix_dict_mp.correlation(this->pdict, this->current_resid, this->boost);
+            best_matching = fix_dict_mp.correlation(this->pdict, *this->resid_spectra);
             return best_matching;
         }
     };
 
     QList<Dictionary> parse_xml_dict(QString path);
 
+    //=========================================================================================================
+    /**
+    * Loads a dictionary together with the atom spectra for the given signal length. The spectra are mapped
+    * from the compiled dictionary next to the xml file. If it is missing or outdated, the xml file is parsed,
+    * the spectra are computed and the compiled dictionary is written for the next run.
+    *
+    * @param[in] path           Path of the xml dictionary.
+    * @param[in] sample_count   Length of the signal.
+    *
+    * @return The part dictionaries.
+    */
+    QList<Dictionary> load_dict(QString path, qint32 sample_count);
+
+    //=========================================================================================================
+    /**
+    * Returns the path of the compiled dictionary which belongs to an xml dictionary and a signal length.
+    *
+    * @param[in] path           Path of the xml dictionary.
+    * @param[in] sample_count   Length of the signal.
+    *
+    * @return The path of the compiled dictionary.
+    */
+    static QString bin_dict_path(const QString& path, qint32 sample_count);
+
+    //=========================================================================================================
+    /**
+    * Writes the dictionaries and their atom spectra to a compiled dictionary.
+    *
+    * @param[in] bin_path       Path of the compiled dictionary.
+    * @param[in] xml_path       Path of the xml dictionary it is compiled from.
+    * @param[in] dicts          The dictionaries with their atom spectra.
+    *
+    * @return True if the file was written.
+    */
+    static bool write_bin_dict(const QString& bin_path, const QString& xml_path, const QList<Dictionary>& dicts);
+
+    //=========================================================================================================
+    /**
+    * Maps a compiled dictionary.
+    *
+    * @param[in] bin_path       Path of the compiled dictionary.
+    * @param[in] xml_path       Path of the xml dictionary it has to be compiled from.
+    * @param[in] sample_count   Length of the signal.
+    * @param[out] dicts         The dictionaries, their spectra point into the mapped file.
+    *
+    * @return True if a valid and up to date compiled dictionary was mapped.
+    */
+    static bool read_bin_dict(const QString& bin_path, const QString& xml_path, qint32 sample_count, QList<Dictionary>& dicts);
+
+    //=========================================================================================================
+    /**
+    * Computes the spectra of the fitted, normalized atoms of a dictionary for the given signal length.
+    *
+    * @param[in, out] pdict     The dictionary.
+    * @param[in] sample_count   Length of the signal.
+    */
+    static void compute_atom_spectra(Dictionary& pdict, qint32 sample_count);
+
+    //=========================================================================================================
+    /**
+    * Cuts or zero pads an atom to the signal length, centered, and normalizes it.
+    *
+    * @param[in] atom_samples   The samples of the atom.
+    * @param[in] sample_count   Length of the signal.
+    *
+    * @return The fitted atom.
+    */
+    static VectorXd fit_atom(const VectorXd& atom_samples, qint32 sample_count);
+
     //=========================================================================================================
 
     Dictionary fill_dict(const QDomNode &pdict);
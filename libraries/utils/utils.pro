@@ -126,6 +126,7 @@ HEADERS += \
     generics/circularmultichannelbuffer_old.h \
     generics/commandpattern.h \
     generics/observerpattern.h \
+    generics/spscringbuffer.h \
     generics/typename_old.h
 
 INCLUDEPATH += $${EIGEN_INCLUDE_DIR}
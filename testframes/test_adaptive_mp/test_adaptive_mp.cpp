@@ -0,0 +1,206 @@
+//=============================================================================================================
+/**
+* @file     test_adaptive_mp.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Test and per-iteration latency benchmark of the adaptive matching pursuit
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <utils/mp/adaptivemp.h>
+#include <utils/mp/atom.h>
+
+#include <iostream>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace UTILSLIB;
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestAdaptiveMp
+*
+* @brief The TestAdaptiveMp class provides adaptive matching pursuit tests and benchmarks
+*
+*/
+class TestAdaptiveMp: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestAdaptiveMp();
+
+private slots:
+    void initTestCase();
+    void singleAtom();
+    void benchmarkIterationLatency();
+    void cleanupTestCase();
+
+private:
+    int m_iNumChannels;
+    int m_iNumSamples;
+    int m_iNumAtoms;
+    MatrixXd m_matSignal;
+};
+
+
+//*************************************************************************************************************
+
+TestAdaptiveMp::TestAdaptiveMp()
+: m_iNumChannels(64)
+, m_iNumSamples(4096)
+, m_iNumAtoms(100)
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestAdaptiveMp::initTestCase()
+{
+    //mixture of gabor atoms with channel dependent amplitudes plus noise
+    std::srand(42);
+    GaborAtom gaborAtom;
+    m_matSignal = 0.05 * MatrixXd::Random(m_iNumSamples, m_iNumChannels);
+
+    for(int i = 0; i < 20; ++i) {
+        qreal scale = std::pow(2.0, 3 + i % 8);
+        quint32 translation = std::rand() % m_iNumSamples;
+        qreal modulation = std::rand() % (m_iNumSamples / 2);
+        qreal phase = 2 * PI * std::rand() / RAND_MAX;
+        VectorXd atom = gaborAtom.create_real(m_iNumSamples, scale, translation, modulation, phase);
+
+        m_matSignal += atom * (10.0 * RowVectorXd::Random(m_iNumChannels));
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestAdaptiveMp::singleAtom()
+{
+    GaborAtom gaborAtom;
+    VectorXd atom = gaborAtom.create_real(256, 32, 100, 40, 0.5);
+
+    MatrixXd matSignal(256, 4);
+    for(int chn = 0; chn < matSignal.cols(); ++chn)
+        matSignal.col(chn) = (chn + 1) * atom;
+
+    AdaptiveMp adaptiveMp;
+    QList<QList<GaborAtom> > atomList = adaptiveMp.matching_pursuit(matSignal, 1, 0.0, false, 100, 1000, 1.0, 0.2, 0.5, 0.5, false);
+
+    QCOMPARE(atomList.size(), 1);
+    const GaborAtom& fitted = atomList.first().first();
+
+    QCOMPARE(fitted.scale, 32.0);
+    QCOMPARE(fitted.translation, 100);
+    QCOMPARE(fitted.modulation, 40.0);
+    QVERIFY(std::fabs(fitted.phase - 0.5) < 1e-6);
+    QCOMPARE(fitted.bm_channel, 3);
+    QVERIFY(adaptiveMp.current_energy > 0.999 * adaptiveMp.signal_energy);
+}
+
+
+//*************************************************************************************************************
+
+void TestAdaptiveMp::benchmarkIterationLatency()
+{
+    //Fitting 100 atoms to the 64 channel signal is too slow for the default run, only run it on request
+    if(qgetenv("MNE_RUN_BENCHMARKS").isEmpty())
+        QSKIP("Iteration latency benchmark disabled, set MNE_RUN_BENCHMARKS to run it.");
+
+    AdaptiveMp adaptiveMp;
+    QVector<qint64> vecIterationNs;
+    QElapsedTimer timer;
+
+    connect(&adaptiveMp, &AdaptiveMp::current_result,
+            [&vecIterationNs, &timer](qint32, qint32, qreal, qreal, MatrixXd, AdaptiveMp::adaptive_atom_list, AdaptiveMp::fix_dict_atom_list) {
+        vecIterationNs.append(timer.nsecsElapsed());
+        timer.restart();
+    });
+
+    //boost 10 searches 10% of the channels for the best atom, the residuum of all channels is updated
+    QList<QList<GaborAtom> > atomList;
+    QBENCHMARK_ONCE {
+        timer.start();
+        atomList = adaptiveMp.matching_pursuit(m_matSignal, m_iNumAtoms, 0.0, false, 10, 1000, 1.0, 0.2, 0.5, 0.5, false);
+    }
+
+    QCOMPARE(atomList.size(), m_iNumAtoms);
+    QCOMPARE(vecIterationNs.size(), m_iNumAtoms);
+    QVERIFY(adaptiveMp.current_energy > 0.5 * adaptiveMp.signal_energy);
+
+    qint64 iTotalNs = 0;
+    qint64 iMaxNs = 0;
+    for(int i = 0; i < vecIterationNs.size(); ++i) {
+        iTotalNs += vecIterationNs[i];
+        iMaxNs = qMax(iMaxNs, vecIterationNs[i]);
+    }
+
+    std::cout << "AdaptiveMp " << m_iNumChannels << " channels x " << m_iNumSamples << " samples, "
+              << m_iNumAtoms << " atoms: "
+              << iTotalNs / 1e6 / vecIterationNs.size() << " ms mean, "
+              << iMaxNs / 1e6 << " ms max per iteration, "
+              << 100.0 * adaptiveMp.current_energy / adaptiveMp.signal_energy << " % energy explained" << std::endl;
+}
+
+
+//*************************************************************************************************************
+
+void TestAdaptiveMp::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_GUILESS_MAIN(TestAdaptiveMp)
+#include "test_adaptive_mp.moc"
@@ -0,0 +1,390 @@
+//=============================================================================================================
+/**
+* @file     test_circular_buffer.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Test and throughput/latency benchmark of the circular buffers
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <utils/generics/circularbuffer.h>
+#include <utils/generics/circularmatrixbuffer.h>
+
+#include <iostream>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+#include <QtConcurrent>
+#include <QSemaphore>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace IOBUFFER;
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* Reference implementation of the former semaphore based CircularMatrixBuffer, which copies element by element
+* and acquires/releases the semaphores per element count. Used as the baseline of the benchmark only.
+*/
+class SemaphoreMatrixBuffer
+{
+public:
+    SemaphoreMatrixBuffer(unsigned int uiMaxNumMatrices, unsigned int uiRows, unsigned int uiCols)
+    : m_uiRows(uiRows)
+    , m_uiCols(uiCols)
+    , m_uiMaxNumElements(uiMaxNumMatrices*uiRows*uiCols)
+    , m_pBuffer(new float[m_uiMaxNumElements])
+    , m_iCurrentReadIndex(-1)
+    , m_iCurrentWriteIndex(-1)
+    , m_freeElements(m_uiMaxNumElements)
+    , m_usedElements(0)
+    {
+    }
+
+    ~SemaphoreMatrixBuffer()
+    {
+        delete [] m_pBuffer;
+    }
+
+    void push(const MatrixXf* pMatrix)
+    {
+        unsigned int t_size = pMatrix->size();
+        m_freeElements.acquire(t_size);
+        for(unsigned int i = 0; i < t_size; ++i)
+            m_pBuffer[mapIndex(m_iCurrentWriteIndex)] = pMatrix->data()[i];
+        m_usedElements.release(t_size);
+    }
+
+    MatrixXf pop()
+    {
+        MatrixXf matrix(m_uiRows, m_uiCols);
+        m_usedElements.acquire(m_uiRows*m_uiCols);
+        for(quint32 i = 0; i < m_uiRows*m_uiCols; ++i)
+            matrix.data()[i] = m_pBuffer[mapIndex(m_iCurrentReadIndex)];
+        m_freeElements.release(m_uiRows*m_uiCols);
+        return matrix;
+    }
+
+private:
+    unsigned int mapIndex(int& index)
+    {
+        int AuxIndex = ++index;
+        return index = AuxIndex % m_uiMaxNumElements;
+    }
+
+    unsigned int    m_uiRows;
+    unsigned int    m_uiCols;
+    unsigned int    m_uiMaxNumElements;
+    float*          m_pBuffer;
+    int             m_iCurrentReadIndex;
+    int             m_iCurrentWriteIndex;
+    QSemaphore      m_freeElements;
+    QSemaphore      m_usedElements;
+};
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestCircularBuffer
+*
+* @brief The TestCircularBuffer class provides circular buffer tests and benchmarks
+*
+*/
+class TestCircularBuffer: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestCircularBuffer();
+
+private slots:
+    void initTestCase();
+    void testOrderAndWrapAround();
+    void testBatchPop();
+    void testTryAndTimedPop();
+    void testReleaseFromPop();
+    void testReleaseThenClear();
+    void testScalarBuffer();
+    void benchmarkThroughput_data();
+    void benchmarkThroughput();
+    void cleanupTestCase();
+
+private:
+    template<typename BufferType>
+    double transfer(BufferType& buffer, int iNumMatrices, double& dMaxLatencyUs);
+
+    int m_iRows;
+    int m_iCols;
+};
+
+
+//*************************************************************************************************************
+
+TestCircularBuffer::TestCircularBuffer()
+: m_iRows(306)
+, m_iCols(100)
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestCircularBuffer::initTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestCircularBuffer::testOrderAndWrapAround()
+{
+    //
+    //   Buffer of three matrices, pushed from another thread so that the ring wraps many times
+    //
+    CircularMatrixBuffer<double> buffer(3, 4, 5);
+    const int iNumMatrices = 1000;
+
+    QFuture<void> producer = QtConcurrent::run([&buffer, iNumMatrices]() {
+        for(int i = 0; i < iNumMatrices; ++i) {
+            MatrixXd matrix = MatrixXd::Constant(4, 5, i);
+            matrix(3, 4) = -i;
+            buffer.push(&matrix);
+        }
+    });
+
+    for(int i = 0; i < iNumMatrices; ++i) {
+        MatrixXd matrix = buffer.pop();
+        QCOMPARE(matrix(0, 0), static_cast<double>(i));
+        QCOMPARE(matrix(3, 4), static_cast<double>(-i));
+    }
+
+    producer.waitForFinished();
+}
+
+
+//*************************************************************************************************************
+
+void TestCircularBuffer::testBatchPop()
+{
+    CircularMatrixBuffer<float> buffer(4, 2, 3);
+
+    for(int i = 0; i < 3; ++i) {
+        MatrixXf matrix = MatrixXf::Constant(2, 3, i);
+        buffer.push(&matrix);
+    }
+
+    MatrixXf batch = buffer.popBatch(3);
+    QVERIFY(batch.rows() == 2 && batch.cols() == 9);
+    for(int i = 0; i < 3; ++i) {
+        QVERIFY(batch.block(0, i*3, 2, 3).isApproxToConstant(static_cast<float>(i)));
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestCircularBuffer::testTryAndTimedPop()
+{
+    CircularMatrixBuffer<double> buffer(2, 3, 3);
+    MatrixXd matrix;
+
+    QVERIFY(!buffer.tryPop(matrix));
+
+    QElapsedTimer timer;
+    timer.start();
+    QVERIFY(!buffer.pop(matrix, 20));
+    QVERIFY(timer.elapsed() >= 20);
+
+    MatrixXd pushed = MatrixXd::Identity(3, 3);
+    buffer.push(&pushed);
+    QVERIFY(buffer.tryPop(matrix));
+    QVERIFY(matrix.isIdentity());
+}
+
+
+//*************************************************************************************************************
+
+void TestCircularBuffer::testReleaseFromPop()
+{
+    CircularMatrixBuffer<double> buffer(2, 3, 3);
+
+    QFuture<MatrixXd> consumer = QtConcurrent::run([&buffer]() {
+        return buffer.pop();
+    });
+
+    QTest::qWait(20);
+    QVERIFY(buffer.releaseFromPop());
+
+    MatrixXd matrix = consumer.result();
+    QVERIFY(matrix.isZero());
+}
+
+
+//*************************************************************************************************************
+
+void TestCircularBuffer::testReleaseThenClear()
+{
+    //The stop() pattern of the plugins: the release must survive the clear and wake the sleeping pop
+    CircularMatrixBuffer<double> buffer(2, 3, 3);
+
+    QFuture<MatrixXd> consumer = QtConcurrent::run([&buffer]() {
+        return buffer.pop();
+    });
+
+    QTest::qWait(50);
+    QVERIFY(buffer.releaseFromPop());
+    buffer.clear();
+
+    MatrixXd matrix = consumer.result();
+    QVERIFY(matrix.isZero());
+}
+
+
+//*************************************************************************************************************
+
+void TestCircularBuffer::testScalarBuffer()
+{
+    CircularBuffer<int> buffer(5);
+    int values[4] = {1, 2, 3, 4};
+
+    buffer.push(values, 4);
+    buffer.push(5);
+
+    int popped[3];
+    QVERIFY(buffer.pop(popped, 3));
+    QCOMPARE(popped[2], 3);
+    QCOMPARE(buffer.pop(), 4);
+
+    int element;
+    QVERIFY(buffer.tryPop(element));
+    QCOMPARE(element, 5);
+    QVERIFY(!buffer.pop(element, 10));
+}
+
+
+//*************************************************************************************************************
+
+void TestCircularBuffer::benchmarkThroughput_data()
+{
+    QTest::addColumn<bool>("lockFree");
+
+    QTest::newRow("QSemaphore, per element") << false;
+    QTest::newRow("SpscRingBuffer, block copy") << true;
+}
+
+
+//*************************************************************************************************************
+
+void TestCircularBuffer::benchmarkThroughput()
+{
+    QFETCH(bool, lockFree);
+
+    const int iNumMatrices = 2000;
+    double dSeconds = 0.0;
+    double dMaxLatencyUs = 0.0;
+
+    QBENCHMARK_ONCE {
+        if(lockFree) {
+            CircularMatrixBuffer<float> buffer(10, m_iRows, m_iCols);
+            dSeconds = transfer(buffer, iNumMatrices, dMaxLatencyUs);
+        } else {
+            SemaphoreMatrixBuffer buffer(10, m_iRows, m_iCols);
+            dSeconds = transfer(buffer, iNumMatrices, dMaxLatencyUs);
+        }
+    }
+
+    double dMBytes = static_cast<double>(iNumMatrices) * m_iRows * m_iCols * sizeof(float) / (1024.0 * 1024.0);
+
+    std::cout << (lockFree ? "SpscRingBuffer" : "QSemaphore") << ": "
+              << dMBytes / dSeconds << " MB/s, "
+              << dSeconds * 1e6 / iNumMatrices << " us per matrix, "
+              << dMaxLatencyUs << " us max pop latency" << std::endl;
+}
+
+
+//*************************************************************************************************************
+
+void TestCircularBuffer::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+
+template<typename BufferType>
+double TestCircularBuffer::transfer(BufferType& buffer, int iNumMatrices, double& dMaxLatencyUs)
+{
+    MatrixXf matrix = MatrixXf::Random(m_iRows, m_iCols);
+
+    QElapsedTimer timer;
+    timer.start();
+
+    QFuture<void> producer = QtConcurrent::run([&buffer, &matrix, iNumMatrices]() {
+        for(int i = 0; i < iNumMatrices; ++i) {
+            buffer.push(&matrix);
+        }
+    });
+
+    QElapsedTimer popTimer;
+    dMaxLatencyUs = 0.0;
+    for(int i = 0; i < iNumMatrices; ++i) {
+        popTimer.start();
+        MatrixXf popped = buffer.pop();
+        dMaxLatencyUs = qMax(dMaxLatencyUs, popTimer.nsecsElapsed() / 1000.0);
+    }
+
+    producer.waitForFinished();
+
+    return timer.nsecsElapsed() / 1e9;
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_GUILESS_MAIN(TestCircularBuffer)
+#include "test_circular_buffer.moc"
@@ -77,6 +77,7 @@ private slots:
     void initTestCase();
     void dipoleFitSimple();
     void dipoleFitAdvanced();
+    void dipoleFitThreads();
     void cleanupTestCase();
 
 private:
@@ -273,6 +274,59 @@ void TestDipoleFit::dipoleFitAdvanced()
 }
 
 
+//*************************************************************************************************************
+
+void TestDipoleFit::dipoleFitThreads()
+{
+    QFile testFile;
+
+    //*********************************************************************************************************
+    // Dipole Fit Settings
+    //*********************************************************************************************************
+
+    //Same as dipoleFitSimple, with warm starts: --meas ./mne-cpp-test-data/MEG/sample/sample_audvis-ave.fif --set 1 --meg --eeg --tmin 32 --tmax 148 --bmin -100 --bmax 0 --warmstart
+    DipoleFitSettings settings;
+    testFile.setFileName(QDir::currentPath()+"/mne-cpp-test-data/MEG/sample/sample_audvis-ave.fif"); QVERIFY( testFile.exists() );
+    settings.measname = testFile.fileName();
+    settings.is_raw = false;
+    settings.setno = 1;
+    settings.include_meg = true;
+    settings.include_eeg = true;
+    settings.tmin = 32.0f/1000.0f;
+    settings.tmax = 148.0f/1000.0f;
+    settings.bmin = -100.0f/1000.0f;
+    settings.bmax = 0.0f/1000.0f;
+    settings.warm_start = true;
+
+    settings.checkIntegrity();
+
+    //*********************************************************************************************************
+    // Compute Dipole Fit with one and with several threads
+    //*********************************************************************************************************
+
+    printf(">>>>>>>>>>>>>>>>>>>>>>>>> Compute Dipole Fit Threads >>>>>>>>>>>>>>>>>>>>>>>>>\n");
+
+    settings.nthreads = 1;
+    DipoleFit dipFitSingle(&settings);
+    m_refECDSet = dipFitSingle.calculateFit();
+
+    settings.nthreads = 4;
+    DipoleFit dipFitMulti(&settings);
+    m_ECDSet = dipFitMulti.calculateFit();
+
+    printf("<<<<<<<<<<<<<<<<<<<<<<<<< Compute Dipole Fit Threads Finished <<<<<<<<<<<<<<<<<<<<<<<<<\n");
+
+    //*********************************************************************************************************
+    // Compare Fit, the results must not depend on the number of threads
+    //*********************************************************************************************************
+
+    for (int i = 1; i < m_ECDSet.size(); ++i)
+        QVERIFY( m_ECDSet[i-1].time < m_ECDSet[i].time );
+
+    compareFit();
+}
+
+
 //*************************************************************************************************************
 
 void TestDipoleFit::compareFit()
@@ -0,0 +1,258 @@
+//=============================================================================================================
+/**
+* @file     test_fiff_raw_index.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Test and benchmark for the indexed raw directory lookup
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <fiff/fiff.h>
+
+#include <iostream>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FIFFLIB;
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestFiffRawIndex
+*
+* @brief The TestFiffRawIndex class verifies and benchmarks the sample offset index of FiffRawData
+*
+*/
+class TestFiffRawIndex: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestFiffRawIndex();
+
+private slots:
+    void initTestCase();
+    void compareLookup();
+    void compareSegments();
+    void benchmarkLookup_data();
+    void benchmarkLookup();
+    void cleanupTestCase();
+
+private:
+    //=========================================================================================================
+    /**
+    * Creates a raw directory which describes a file of the given size, without any backing data.
+    */
+    FiffRawData createSyntheticRaw(double dSizeGB, bool bIndexed) const;
+
+    double epsilon;
+
+    FiffRawData m_raw;
+    MatrixXd m_matFullData;
+};
+
+
+//*************************************************************************************************************
+
+TestFiffRawIndex::TestFiffRawIndex()
+: epsilon(0.000001)
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffRawIndex::initTestCase()
+{
+    qDebug() << "Epsilon" << epsilon;
+
+    QFile t_fileIn("./mne-cpp-test-data/MEG/sample/sample_audvis_raw_short.fif");
+
+    m_raw = FiffRawData(t_fileIn);
+    QVERIFY(!m_raw.isEmpty());
+    QVERIFY(m_raw.rawdir_index.size() == m_raw.rawdir.size());
+
+    MatrixXd times;
+    QVERIFY(m_raw.read_raw_segment(m_matFullData, times));
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffRawIndex::compareLookup()
+{
+    //
+    //   The binary search has to agree with walking the directory for every buffer boundary
+    //
+    for(qint32 k = 0; k < m_raw.rawdir.size(); ++k) {
+        QCOMPARE(m_raw.find_rawdir_entry(m_raw.rawdir[k].first), k);
+        QCOMPARE(m_raw.find_rawdir_entry(m_raw.rawdir[k].last), k);
+    }
+
+    QCOMPARE(m_raw.find_rawdir_entry(m_raw.last_samp + 1), -1);
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffRawIndex::compareSegments()
+{
+    //
+    //   Random access segments have to match the corresponding part of the full read
+    //
+    qsrand(42);
+    fiff_int_t nsamp = m_raw.last_samp - m_raw.first_samp + 1;
+
+    for(qint32 i = 0; i < 20; ++i) {
+        fiff_int_t from = m_raw.first_samp + qrand() % nsamp;
+        fiff_int_t to = qMin(from + qrand() % 2000, m_raw.last_samp);
+
+        MatrixXd data, times;
+        QVERIFY(m_raw.read_raw_segment(data, times, from, to));
+        QVERIFY(data.cols() == to - from + 1);
+
+        MatrixXd diff = data - m_matFullData.block(0, from - m_raw.first_samp, data.rows(), data.cols());
+        QVERIFY(diff.cwiseAbs().maxCoeff() < epsilon);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffRawIndex::benchmarkLookup_data()
+{
+    QTest::addColumn<double>("sizeGB");
+    QTest::addColumn<bool>("indexed");
+
+    QTest::newRow("1 GB linear")    << 1.0   << false;
+    QTest::newRow("1 GB indexed")   << 1.0   << true;
+    QTest::newRow("10 GB linear")   << 10.0  << false;
+    QTest::newRow("10 GB indexed")  << 10.0  << true;
+    QTest::newRow("100 GB linear")  << 100.0 << false;
+    QTest::newRow("100 GB indexed") << 100.0 << true;
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffRawIndex::benchmarkLookup()
+{
+    QFETCH(double, sizeGB);
+    QFETCH(bool, indexed);
+
+    FiffRawData raw = createSyntheticRaw(sizeGB, indexed);
+    QCOMPARE(raw.rawdir_index.size() == raw.rawdir.size(), indexed);
+
+    //
+    //   Seek close to the end of the file, which is the worst case for walking the directory
+    //
+    fiff_int_t sample = raw.last_samp - 10;
+    qint32 k = -1;
+
+    QBENCHMARK {
+        k = raw.find_rawdir_entry(sample);
+    }
+
+    QVERIFY(k >= 0);
+    QVERIFY(raw.rawdir[k].first <= sample && raw.rawdir[k].last >= sample);
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffRawIndex::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+
+FiffRawData TestFiffRawIndex::createSyntheticRaw(double dSizeGB, bool bIndexed) const
+{
+    //
+    //   306 channels, float samples and 1 s buffers at 1 kHz, with a skip every 100 buffers
+    //
+    const qint32 nchan = 306;
+    const qint32 nsamp = 1000;
+    const double dBufferBytes = static_cast<double>(nchan) * nsamp * 4 + FiffDirEntry::storageSize();
+    const qint32 nbuf = static_cast<qint32>(dSizeGB * 1024.0 * 1024.0 * 1024.0 / dBufferBytes);
+
+    FiffRawData raw;
+    raw.first_samp = 0;
+    raw.info.nchan = nchan;
+
+    fiff_int_t first = 0;
+    for(qint32 k = 0; k < nbuf; ++k) {
+        FiffRawDir t_RawDir;
+        if(k % 100 != 99) {
+            t_RawDir.ent = FiffDirEntry::SPtr(new FiffDirEntry);
+            t_RawDir.ent->kind = FIFF_DATA_BUFFER;
+            t_RawDir.ent->type = FIFFT_FLOAT;
+            t_RawDir.ent->size = nchan * nsamp * 4;
+        }
+        t_RawDir.first = first;
+        t_RawDir.last = first + nsamp - 1;
+        t_RawDir.nsamp = nsamp;
+        raw.rawdir.append(t_RawDir);
+        first += nsamp;
+    }
+    raw.last_samp = first - 1;
+
+    if(bIndexed)
+        raw.build_rawdir_index();
+
+    return raw;
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_APPLESS_MAIN(TestFiffRawIndex)
+#include "test_fiff_raw_index.moc"
@@ -0,0 +1,292 @@
+//=============================================================================================================
+/**
+* @file     test_fiff_raw_recorder.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Test of the asynchronous raw recorder and benchmark of the acquisition side latency
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <fiff/fiff.h>
+
+#include <iostream>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+#include <QTemporaryDir>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FIFFLIB;
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestFiffRawRecorder
+*
+* @brief The TestFiffRawRecorder class verifies the asynchronous raw recorder and benchmarks the time the
+* acquisition thread spends per block compared to writing inline.
+*
+*/
+class TestFiffRawRecorder: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestFiffRawRecorder();
+
+private slots:
+    void initTestCase();
+    void recordAndSplit();
+    void dropWhenNotRecording();
+    void benchmarkProducerLatency_data();
+    void benchmarkProducerLatency();
+    void cleanupTestCase();
+
+private:
+    FiffInfo createInfo(int p_iNumChannels) const;
+
+    QTemporaryDir   m_tempDir;
+};
+
+
+//*************************************************************************************************************
+
+TestFiffRawRecorder::TestFiffRawRecorder()
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffRawRecorder::initTestCase()
+{
+    QVERIFY(m_tempDir.isValid());
+}
+
+
+//*************************************************************************************************************
+
+FiffInfo TestFiffRawRecorder::createInfo(int p_iNumChannels) const
+{
+    FiffInfo info;
+    info.sfreq = 1000.0f;
+    info.nchan = p_iNumChannels;
+
+    for(int k = 0; k < p_iNumChannels; ++k) {
+        FiffChInfo ch;
+        ch.ch_name = QString("EEG%1").arg(k + 1);
+        ch.kind = FIFFV_EEG_CH;
+        ch.cal = 1e-6f * (k % 5 + 1);
+        ch.range = 1.0f;
+        info.chs.append(ch);
+        info.ch_names.append(ch.ch_name);
+    }
+
+    return info;
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffRawRecorder::recordAndSplit()
+{
+    const int iNumChannels = 32;
+    const int iBlockSize = 100;
+    const int iNumBlocks = 40;
+
+    FiffInfo info = createInfo(iNumChannels);
+    QString sFileName = m_tempDir.path() + "/recorder_raw.fif";
+
+    MatrixXd matData = 1e-4 * MatrixXd::Random(iNumChannels, iNumBlocks * iBlockSize);
+
+    //Each block takes 12.8 kB, split after roughly 8 blocks
+    FiffRawRecorder recorder(iNumBlocks);
+    recorder.setSplitFileSize(100 * 1024);
+    QVERIFY(recorder.startRecording(sFileName, info));
+    QVERIFY(recorder.isRecording());
+
+    for(int i = 0; i < iNumBlocks; ++i) {
+        if(i % 2 == 0)
+            QVERIFY(recorder.push(MatrixXd(matData.middleCols(i * iBlockSize, iBlockSize))));
+        else
+            QVERIFY(recorder.push(MatrixXf(matData.middleCols(i * iBlockSize, iBlockSize).cast<float>())));
+    }
+
+    recorder.stopRecording();
+    QVERIFY(!recorder.isRecording());
+
+    FiffRawRecorder::Statistics stats = recorder.statistics();
+    QCOMPARE(stats.iBlocksWritten, static_cast<qint64>(iNumBlocks));
+    QCOMPARE(stats.iBlocksDropped, static_cast<qint64>(0));
+    QCOMPARE(stats.iSamplesWritten, static_cast<qint64>(iNumBlocks * iBlockSize));
+    QCOMPARE(stats.iQueueDepth, 0);
+    QVERIFY(stats.iMaxQueueDepth >= 1);
+    QVERIFY(stats.iFileCount > 1);
+    QVERIFY(stats.dMaxWriteMs >= stats.dMeanWriteMs);
+
+    //Read all split files back and compare them with the recorded data
+    MatrixXd matRead(iNumChannels, 0);
+    for(int n = 0; n < stats.iFileCount; ++n) {
+        QFile file(FiffRawRecorder::splitFileName(sFileName, n));
+        QVERIFY(file.size() <= 100 * 1024 + 4096);
+
+        FiffRawData raw(file);
+        QCOMPARE(raw.first_samp, static_cast<fiff_int_t>(matRead.cols()));
+
+        MatrixXd data, times;
+        QVERIFY(raw.read_raw_segment(data, times));
+
+        matRead.conservativeResize(iNumChannels, matRead.cols() + data.cols());
+        matRead.rightCols(data.cols()) = data;
+    }
+
+    QCOMPARE(matRead.cols(), matData.cols());
+    QVERIFY((matRead - matData).cwiseAbs().maxCoeff() < 1e-6 * matData.cwiseAbs().maxCoeff());
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffRawRecorder::dropWhenNotRecording()
+{
+    FiffRawRecorder recorder(2);
+    QVERIFY(!recorder.isRecording());
+    QVERIFY(!recorder.push(MatrixXd(MatrixXd::Zero(4, 10))));
+    QCOMPARE(recorder.statistics().iBlocksDropped, static_cast<qint64>(1));
+
+    //Stopping a recorder which was never started is a no-op
+    recorder.stopRecording();
+
+    //A file which can not be created is reported right away
+    QVERIFY(!recorder.startRecording(m_tempDir.path() + "/missing/dir/recorder_raw.fif", createInfo(4)));
+    QVERIFY(!recorder.isRecording());
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffRawRecorder::benchmarkProducerLatency_data()
+{
+    QTest::addColumn<bool>("async");
+
+    QTest::newRow("Inline write_raw_buffer") << false;
+    QTest::newRow("FiffRawRecorder") << true;
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffRawRecorder::benchmarkProducerLatency()
+{
+    QFETCH(bool, async);
+
+    //400 channels at 5 kHz in blocks of 100 ms, 10 seconds of data
+    const int iNumChannels = 400;
+    const int iBlockSize = 500;
+    const int iNumBlocks = 100;
+
+    FiffInfo info = createInfo(iNumChannels);
+    MatrixXf matBlock = (1e-4 * MatrixXd::Random(iNumChannels, iBlockSize)).cast<float>();
+    QString sFileName = m_tempDir.path() + (async ? "/async_raw.fif" : "/inline_raw.fif");
+
+    double dMaxMs = 0.0;
+    double dTotalMs = 0.0;
+
+    QBENCHMARK_ONCE {
+        FiffRawRecorder recorder(iNumBlocks);
+        QFile file(sFileName);
+        RowVectorXd cals;
+        FiffStream::SPtr outfid;
+
+        if(async) {
+            QVERIFY(recorder.startRecording(sFileName, info));
+        } else {
+            outfid = FiffStream::start_writing_raw(file, info, cals);
+            QVERIFY(outfid);
+        }
+
+        for(int i = 0; i < iNumBlocks; ++i) {
+            QElapsedTimer timer;
+            timer.start();
+
+            //This is the time the acquisition thread is blocked per block
+            if(async)
+                recorder.push(matBlock);
+            else
+                outfid->write_raw_buffer(matBlock.cast<double>(), cals);
+
+            double dMs = timer.nsecsElapsed() / 1e6;
+            dTotalMs += dMs;
+            dMaxMs = qMax(dMaxMs, dMs);
+        }
+
+        if(async) {
+            recorder.stopRecording();
+            QCOMPARE(recorder.statistics().iBlocksDropped, static_cast<qint64>(0));
+        } else {
+            outfid->finish_writing_raw();
+        }
+    }
+
+    std::cout << (async ? "FiffRawRecorder" : "Inline write_raw_buffer") << ": "
+              << dTotalMs / iNumBlocks << " ms mean, " << dMaxMs << " ms max acquisition side latency per "
+              << iNumChannels << " x " << iBlockSize << " block" << std::endl;
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffRawRecorder::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_APPLESS_MAIN(TestFiffRawRecorder)
+#include "test_fiff_raw_recorder.moc"
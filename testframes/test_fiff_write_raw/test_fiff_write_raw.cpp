@@ -0,0 +1,402 @@
+//=============================================================================================================
+/**
+* @file     test_fiff_write_raw.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Test and throughput benchmark for the raw buffer writer
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <fiff/fiff.h>
+
+#include <iostream>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+#include <QTemporaryDir>
+#include <QTemporaryFile>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FIFFLIB;
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* Reference implementation of the former raw buffer writer, which scales with a sparse diagonal matrix and
+* streams the samples one float at a time. Used to verify the output and as the baseline of the benchmark.
+*/
+void writeReferenceRawBuffer(QDataStream& stream, const MatrixXd& buf, const RowVectorXd& cals)
+{
+    typedef Eigen::Triplet<double> T;
+    std::vector<T> tripletList;
+    tripletList.reserve(cals.cols());
+    for(qint32 i = 0; i < cals.cols(); ++i)
+        tripletList.push_back(T(i, i, 1.0/cals[i]));
+
+    SparseMatrix<double> inv_calsMat(cals.cols(), cals.cols());
+    inv_calsMat.setFromTriplets(tripletList.begin(), tripletList.end());
+
+    MatrixXf tmp = (inv_calsMat*buf).cast<float>();
+
+    stream << (qint32)FIFF_DATA_BUFFER;
+    stream << (qint32)FIFFT_FLOAT;
+    stream << (qint32)(tmp.size() * 4);
+    stream << (qint32)FIFFV_NEXT_SEQ;
+
+    for(qint32 i = 0; i < tmp.size(); ++i)
+        stream << tmp.data()[i];
+}
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestFiffWriteRaw
+*
+* @brief The TestFiffWriteRaw class verifies and benchmarks the bulk raw buffer writer of FiffStream
+*
+*/
+class TestFiffWriteRaw: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestFiffWriteRaw();
+
+private slots:
+    void initTestCase();
+    void compareTags();
+    void compareRawBuffer();
+    void writeDirectory();
+    void directoryCache();
+    void benchmarkThroughput_data();
+    void benchmarkThroughput();
+    void cleanupTestCase();
+
+private:
+    void compareDirectories(const QList<FiffDirEntry::SPtr>& dir, const QList<FiffDirEntry::SPtr>& dirRef);
+    void writeRawFile(QFile& file, int numBuffers);
+
+    int         m_iNumChannels;
+    int         m_iBufferSize;
+    FiffInfo    m_info;
+    MatrixXd    m_matBuffer;
+    RowVectorXd m_vecCals;
+};
+
+
+//*************************************************************************************************************
+
+TestFiffWriteRaw::TestFiffWriteRaw()
+: m_iNumChannels(400)
+, m_iBufferSize(500)
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffWriteRaw::initTestCase()
+{
+    //400 channels at 5 kHz, written in buffers of 100 ms
+    m_info.sfreq = 5000.0f;
+    m_info.nchan = m_iNumChannels;
+    m_vecCals.resize(m_iNumChannels);
+
+    for(int k = 0; k < m_iNumChannels; ++k) {
+        FiffChInfo ch;
+        ch.ch_name = QString("CH%1").arg(k + 1);
+        ch.kind = FIFFV_EEG_CH;
+        ch.cal = 1e-6f * (k % 7 + 1);
+        ch.range = 1.0f;
+        m_info.chs.append(ch);
+        m_info.ch_names.append(ch.ch_name);
+        m_vecCals[k] = ch.cal;
+    }
+
+    m_matBuffer = 1e-4 * MatrixXd::Random(m_iNumChannels, m_iBufferSize);
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffWriteRaw::compareTags()
+{
+    QVector<float> vecFloats;
+    QVector<fiff_int_t> vecInts;
+    for(int i = 0; i < 37; ++i) {
+        vecFloats.append(1.5f * i - 7.25f);
+        vecInts.append(1000 * i - 12345);
+    }
+
+    QByteArray bulk;
+    FiffStream bulkStream(&bulk, QIODevice::WriteOnly);
+    bulkStream.write_float(FIFF_SFREQ, vecFloats.constData(), vecFloats.size());
+    bulkStream.write_int(FIFF_NCHAN, vecInts.constData(), vecInts.size(), FIFFV_NEXT_NONE);
+    bulkStream.write_float(FIFF_LOWPASS, vecFloats.constData(), 0);
+
+    QByteArray reference;
+    QDataStream referenceStream(&reference, QIODevice::WriteOnly);
+    referenceStream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+    referenceStream.setByteOrder(QDataStream::BigEndian);
+    referenceStream << (qint32)FIFF_SFREQ << (qint32)FIFFT_FLOAT << (qint32)(vecFloats.size() * 4) << (qint32)FIFFV_NEXT_SEQ;
+    for(int i = 0; i < vecFloats.size(); ++i)
+        referenceStream << vecFloats[i];
+    referenceStream << (qint32)FIFF_NCHAN << (qint32)FIFFT_INT << (qint32)(vecInts.size() * 4) << (qint32)FIFFV_NEXT_NONE;
+    for(int i = 0; i < vecInts.size(); ++i)
+        referenceStream << (qint32)vecInts[i];
+    referenceStream << (qint32)FIFF_LOWPASS << (qint32)FIFFT_FLOAT << (qint32)0 << (qint32)FIFFV_NEXT_SEQ;
+
+    QCOMPARE(bulk, reference);
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffWriteRaw::compareRawBuffer()
+{
+    QByteArray reference;
+    QDataStream referenceStream(&reference, QIODevice::WriteOnly);
+    referenceStream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+    referenceStream.setByteOrder(QDataStream::BigEndian);
+    writeReferenceRawBuffer(referenceStream, m_matBuffer, m_vecCals);
+
+    QByteArray bulk;
+    FiffStream bulkStream(&bulk, QIODevice::WriteOnly);
+    QVERIFY(bulkStream.write_raw_buffer(m_matBuffer, m_vecCals));
+    QCOMPARE(bulk, reference);
+
+    //the inverse calibrations are recomputed if different calibrations are handed in
+    RowVectorXd vecCals = 2.0 * m_vecCals;
+    QByteArray reference2;
+    QDataStream referenceStream2(&reference2, QIODevice::WriteOnly);
+    referenceStream2.setFloatingPointPrecision(QDataStream::SinglePrecision);
+    referenceStream2.setByteOrder(QDataStream::BigEndian);
+    writeReferenceRawBuffer(referenceStream2, m_matBuffer, vecCals);
+
+    bulk.clear();
+    bulkStream.device()->seek(0);
+    QVERIFY(bulkStream.write_raw_buffer(m_matBuffer, vecCals));
+    QCOMPARE(bulk, reference2);
+
+    QVERIFY(!bulkStream.write_raw_buffer(m_matBuffer, vecCals.head(10)));
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffWriteRaw::compareDirectories(const QList<FiffDirEntry::SPtr>& dir, const QList<FiffDirEntry::SPtr>& dirRef)
+{
+    QCOMPARE(dir.size(), dirRef.size());
+    for(int k = 0; k < dir.size(); ++k) {
+        QCOMPARE(dir[k]->kind, dirRef[k]->kind);
+        QCOMPARE(dir[k]->type, dirRef[k]->type);
+        QCOMPARE(dir[k]->size, dirRef[k]->size);
+        QCOMPARE(dir[k]->pos, dirRef[k]->pos);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffWriteRaw::writeRawFile(QFile& file, int numBuffers)
+{
+    RowVectorXd cals;
+    FiffStream::SPtr outfid = FiffStream::start_writing_raw(file, m_info, cals);
+    QVERIFY(outfid);
+    for(int i = 0; i < numBuffers; ++i)
+        QVERIFY(outfid->write_raw_buffer(m_matBuffer, cals));
+    outfid->finish_writing_raw();
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffWriteRaw::writeDirectory()
+{
+    QTemporaryFile file;
+    QVERIFY(file.open());
+    file.close();
+    writeRawFile(file, 10);
+
+    //the directory pointer points to the directory written on finish
+    FiffStream stream(&file);
+    QVERIFY(stream.open());
+    FiffTag::SPtr t_pTag;
+    QVERIFY(stream.read_tag(t_pTag, stream.dir()[1]->pos));
+    QCOMPARE(t_pTag->kind, (fiff_int_t)FIFF_DIR_POINTER);
+    QVERIFY(*t_pTag->toInt() > 0);
+
+    //it lists the same tags as scanning the file
+    bool ok = false;
+    QList<FiffDirEntry::SPtr> dirScanned = stream.make_dir(&ok);
+    QVERIFY(ok);
+    compareDirectories(stream.dir(), dirScanned);
+    stream.close();
+
+    //the data is read through the directory
+    FiffRawData raw(file);
+    MatrixXd data, times;
+    QVERIFY(raw.read_raw_segment(data, times));
+    QCOMPARE(static_cast<int>(data.cols()), 10 * m_iBufferSize);
+    QVERIFY((data.leftCols(m_iBufferSize) - m_matBuffer).cwiseAbs().maxCoeff() < 1e-6 * m_matBuffer.cwiseAbs().maxCoeff());
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffWriteRaw::directoryCache()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QString sFileName = dir.path() + "/legacy_raw.fif";
+    QString sCacheName = FiffStream::dir_cache_file_name(sFileName);
+
+    //open_update drops the directory, which leaves a file like the ones written before FIFF_DIR was added
+    QFile file(sFileName);
+    writeRawFile(file, 10);
+    FiffStream::SPtr t_pUpdate = FiffStream::open_update(file);
+    QVERIFY(t_pUpdate);
+    t_pUpdate->close();
+
+    FiffStream::set_dir_cache_enabled(true);
+
+    //the first open scans the file and stores the directory
+    FiffStream stream(&file);
+    QVERIFY(stream.open());
+    QVERIFY(QFile::exists(sCacheName));
+    QList<FiffDirEntry::SPtr> dirScanned = stream.make_dir();
+    compareDirectories(stream.dir(), dirScanned);
+    stream.close();
+
+    //the second one reads it from the cache
+    QFile cacheFile(sCacheName);
+    QDateTime cacheModified = QFileInfo(cacheFile).lastModified();
+    FiffStream stream2(&file);
+    QVERIFY(stream2.open());
+    compareDirectories(stream2.dir(), dirScanned);
+    stream2.close();
+    QCOMPARE(QFileInfo(cacheFile).lastModified(), cacheModified);
+
+    //a cache of a file which changed since is not used, the file is scanned again
+    QVERIFY(file.open(QIODevice::Append));
+    file.write(QByteArray(16, 0));
+    file.close();
+
+    FiffStream stream3(&file);
+    QVERIFY(stream3.open());
+    dirScanned = stream3.make_dir();
+    compareDirectories(stream3.dir(), dirScanned);
+    stream3.close();
+
+    FiffStream::set_dir_cache_enabled(false);
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffWriteRaw::benchmarkThroughput_data()
+{
+    QTest::addColumn<bool>("bulk");
+
+    QTest::newRow("QDataStream, per element") << false;
+    QTest::newRow("Bulk tag writer") << true;
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffWriteRaw::benchmarkThroughput()
+{
+    QFETCH(bool, bulk);
+
+    //10 seconds of data
+    const int iNumBuffers = 100;
+    double dSeconds = 0.0;
+    qint64 iBytes = 0;
+
+    QTemporaryFile file;
+    QVERIFY(file.open());
+
+    QBENCHMARK_ONCE {
+        QElapsedTimer timer;
+        timer.start();
+
+        RowVectorXd cals;
+        FiffStream::SPtr outfid = FiffStream::start_writing_raw(file, m_info, cals);
+
+        for(int i = 0; i < iNumBuffers; ++i) {
+            if(bulk)
+                outfid->write_raw_buffer(m_matBuffer, cals);
+            else
+                writeReferenceRawBuffer(*outfid, m_matBuffer, cals);
+        }
+
+        outfid->finish_writing_raw();
+        dSeconds = timer.nsecsElapsed() / 1e9;
+        iBytes = file.size();
+    }
+
+    QVERIFY(iBytes > static_cast<qint64>(iNumBuffers) * m_iNumChannels * m_iBufferSize * 4);
+
+    std::cout << (bulk ? "Bulk tag writer" : "QDataStream, per element") << ": "
+              << iBytes / (1024.0 * 1024.0) / dSeconds << " MB/s, "
+              << dSeconds * 1e3 / iNumBuffers << " ms per " << m_iNumChannels << " x " << m_iBufferSize << " buffer" << std::endl;
+}
+
+
+//*************************************************************************************************************
+
+void TestFiffWriteRaw::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_APPLESS_MAIN(TestFiffWriteRaw)
+#include "test_fiff_write_raw.moc"
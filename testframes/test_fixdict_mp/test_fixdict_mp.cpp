@@ -0,0 +1,432 @@
+//=============================================================================================================
+/**
+* @file     test_fixdict_mp.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Test of the compiled dictionaries and the incremental residuum spectra of the fixed dictionary matching pursuit
+*
+*/
+
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <utils/mp/fixdictmp.h>
+#include <utils/mp/atom.h>
+
+#include <unsupported/Eigen/FFT>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+#include <QTemporaryDir>
+#include <QXmlStreamWriter>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace UTILSLIB;
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestFixDictMp
+*
+* @brief The TestFixDictMp class tests the fixed dictionary matching pursuit against the xml dictionary path
+*
+*/
+class TestFixDictMp: public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Corruption {
+        TruncatedSpectra,
+        TruncatedHeader,
+        BadMagic,
+        MetaOnes,
+        MetaZeros
+    };
+
+    TestFixDictMp();
+
+private slots:
+    void initTestCase();
+    void compiledDictMatchesXmlDict();
+    void touchedXmlRebuildsCompiledDict();
+    void corruptCompiledDictFallsBack_data();
+    void corruptCompiledDictFallsBack();
+    void residSpectraMatchResiduum_data();
+    void residSpectraMatchResiduum();
+    void cleanupTestCase();
+
+private:
+    void writeDictionary(const QList<qreal>& scales);
+    void compareWithXmlPath(const FixDictMp& fixDictMp, qint32 boost);
+
+    int m_iNumChannels;
+    int m_iNumSamples;
+    int m_iNumIterations;
+    double m_dEpsilon;
+    QList<qreal> m_lScales;
+    QList<qreal> m_lModulations;
+    QTemporaryDir m_tmpDir;
+    QString m_sDictPath;
+    QString m_sBinDictPath;
+    MatrixXd m_matSignal;
+};
+
+
+//*************************************************************************************************************
+
+TestFixDictMp::TestFixDictMp()
+: m_iNumChannels(4)
+, m_iNumSamples(128)
+, m_iNumIterations(8)
+, m_dEpsilon(1.0e-10)
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestFixDictMp::initTestCase()
+{
+    QVERIFY(m_tmpDir.isValid());
+
+    m_lScales << 4 << 8 << 16 << 32;
+    m_lModulations << 4 << 8 << 12 << 16 << 24 << 32;
+
+    m_sDictPath = m_tmpDir.path() + "/gabor.dict";
+    m_sBinDictPath = FixDictMp::bin_dict_path(m_sDictPath, m_iNumSamples);
+    writeDictionary(m_lScales);
+
+    //dictionary atoms at random positions with channel dependent amplitudes plus noise
+    std::srand(42);
+    GaborAtom gaborAtom;
+    m_matSignal = 0.01 * MatrixXd::Random(m_iNumSamples, m_iNumChannels);
+
+    for(int i = 0; i < 6; ++i) {
+        qreal scale = m_lScales.at(std::rand() % m_lScales.size());
+        qreal modulation = m_lModulations.at(std::rand() % m_lModulations.size());
+        quint32 translation = std::rand() % m_iNumSamples;
+        VectorXd atom = gaborAtom.create_real(m_iNumSamples, scale, translation, modulation, 0);
+
+        m_matSignal += atom * (5.0 * RowVectorXd::Random(m_iNumChannels));
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestFixDictMp::compiledDictMatchesXmlDict()
+{
+    QFile::remove(m_sBinDictPath);
+
+    //the first run parses the xml dictionary and compiles it
+    FixDictMp compilingMp;
+    compilingMp.matching_pursuit(m_matSignal, m_iNumIterations, 0.0, 100, m_sDictPath, 0.0);
+    QVERIFY(QFile::exists(m_sBinDictPath));
+    QCOMPARE(compilingMp.fix_dict_list.size(), m_iNumIterations);
+    compareWithXmlPath(compilingMp, 100);
+
+    //the second run maps the compiled dictionary
+    QList<Dictionary> dicts;
+    QVERIFY(FixDictMp::read_bin_dict(m_sBinDictPath, m_sDictPath, m_iNumSamples, dicts));
+    dicts.clear();
+
+    FixDictMp mappedMp;
+    mappedMp.matching_pursuit(m_matSignal, m_iNumIterations, 0.0, 100, m_sDictPath, 0.0);
+    QCOMPARE(mappedMp.fix_dict_list.size(), m_iNumIterations);
+    compareWithXmlPath(mappedMp, 100);
+}
+
+
+//*************************************************************************************************************
+
+void TestFixDictMp::touchedXmlRebuildsCompiledDict()
+{
+    FixDictMp fixDictMp;
+    QList<Dictionary> dicts = fixDictMp.load_dict(m_sDictPath, m_iNumSamples);
+    dicts.clear();
+    QVERIFY(FixDictMp::read_bin_dict(m_sBinDictPath, m_sDictPath, m_iNumSamples, dicts));
+    dicts.clear();
+
+    //same content, newer modification time; wait for file systems with a coarse time resolution
+    QTest::qSleep(2000);
+    writeDictionary(m_lScales);
+    QVERIFY(!FixDictMp::read_bin_dict(m_sBinDictPath, m_sDictPath, m_iNumSamples, dicts));
+
+    dicts = fixDictMp.load_dict(m_sDictPath, m_iNumSamples);
+    QCOMPARE(dicts.size(), 2);
+    dicts.clear();
+    QVERIFY(FixDictMp::read_bin_dict(m_sBinDictPath, m_sDictPath, m_iNumSamples, dicts));
+    dicts.clear();
+
+    //changed content, the compiled dictionary has to follow
+    QList<qreal> lScales = m_lScales;
+    lScales << 64;
+    writeDictionary(lScales);
+
+    dicts = fixDictMp.load_dict(m_sDictPath, m_iNumSamples);
+    QCOMPARE(dicts.first().atoms.size(), lScales.size() * m_lModulations.size());
+    dicts.clear();
+    QVERIFY(FixDictMp::read_bin_dict(m_sBinDictPath, m_sDictPath, m_iNumSamples, dicts));
+    QCOMPARE(dicts.first().atoms.size(), lScales.size() * m_lModulations.size());
+    dicts.clear();
+
+    writeDictionary(m_lScales);
+}
+
+
+//*************************************************************************************************************
+
+void TestFixDictMp::corruptCompiledDictFallsBack_data()
+{
+    QTest::addColumn<int>("corruption");
+
+    QTest::newRow("truncated spectra") << (int)TruncatedSpectra;
+    QTest::newRow("truncated header") << (int)TruncatedHeader;
+    QTest::newRow("bad magic") << (int)BadMagic;
+    QTest::newRow("metadata ones") << (int)MetaOnes;
+    QTest::newRow("metadata zeros") << (int)MetaZeros;
+}
+
+
+//*************************************************************************************************************
+
+void TestFixDictMp::corruptCompiledDictFallsBack()
+{
+    QFETCH(int, corruption);
+
+    FixDictMp fixDictMp;
+    fixDictMp.residuum = m_matSignal;
+    QList<Dictionary> xmlDicts = fixDictMp.parse_xml_dict(m_sDictPath);
+    fixDictMp.load_dict(m_sDictPath, m_iNumSamples);
+
+    QFile file(m_sBinDictPath);
+    QVERIFY(file.open(QIODevice::ReadWrite));
+    qint64 iSize = file.size();
+
+    //the metadata starts at the first aligned offset, right behind the header
+    switch(corruption) {
+        case TruncatedSpectra:
+            QVERIFY(file.resize(iSize - MP_BIN_DICT_ALIGN));
+            break;
+        case TruncatedHeader:
+            QVERIFY(file.resize(16));
+            break;
+        case BadMagic:
+            QCOMPARE(file.write(QByteArray(4, '\0')), (qint64)4);
+            break;
+        case MetaOnes:
+            QVERIFY(file.seek(MP_BIN_DICT_ALIGN));
+            QCOMPARE(file.write(QByteArray(64, '\xff')), (qint64)64);
+            break;
+        case MetaZeros:
+            QVERIFY(file.seek(MP_BIN_DICT_ALIGN));
+            QCOMPARE(file.write(QByteArray(64, '\0')), (qint64)64);
+            break;
+    }
+    file.close();
+
+    QList<Dictionary> dicts;
+    QVERIFY(!FixDictMp::read_bin_dict(m_sBinDictPath, m_sDictPath, m_iNumSamples, dicts));
+    QVERIFY(dicts.isEmpty());
+
+    //falls back to the xml dictionary and compiles it again
+    dicts = fixDictMp.load_dict(m_sDictPath, m_iNumSamples);
+    QCOMPARE(dicts.size(), xmlDicts.size());
+
+    for(int i = 0; i < xmlDicts.size(); ++i) {
+        Dictionary& xmlDict = xmlDicts[i];
+        FixDictMp::compute_atom_spectra(xmlDict, m_iNumSamples);
+
+        QCOMPARE(dicts.at(i).source, xmlDict.source);
+        QCOMPARE(dicts.at(i).sample_count, xmlDict.sample_count);
+        QCOMPARE(dicts.at(i).atoms.size(), xmlDict.atoms.size());
+
+        for(int j = 0; j < xmlDict.atoms.size(); ++j) {
+            QCOMPARE(dicts.at(i).atoms.at(j).id, xmlDict.atoms.at(j).id);
+            QVERIFY(dicts.at(i).atoms.at(j).atom_samples == xmlDict.atoms.at(j).atom_samples);
+            QVERIFY(dicts.at(i).atom_spectrum(j) == xmlDict.atom_spectrum(j));
+        }
+    }
+    dicts.clear();
+
+    QVERIFY(FixDictMp::read_bin_dict(m_sBinDictPath, m_sDictPath, m_iNumSamples, dicts));
+}
+
+
+//*************************************************************************************************************
+
+void TestFixDictMp::residSpectraMatchResiduum_data()
+{
+    QTest::addColumn<int>("iterations");
+
+    QTest::newRow("1 iteration") << 1;
+    QTest::newRow("3 iterations") << 3;
+    QTest::newRow("12 iterations") << 12;
+}
+
+
+//*************************************************************************************************************
+
+void TestFixDictMp::residSpectraMatchResiduum()
+{
+    QFETCH(int, iterations);
+
+    //boost 50 observes half of the channels
+    FixDictMp fixDictMp;
+    fixDictMp.matching_pursuit(m_matSignal, iterations, 0.0, 50, m_sDictPath, 0.0);
+    QCOMPARE(fixDictMp.fix_dict_list.size(), iterations);
+    QCOMPARE((int)fixDictMp.resid_spectra.cols(), m_iNumChannels / 2);
+
+    Eigen::FFT<double> fft;
+    VectorXcd spectrum = VectorXcd::Zero(m_iNumSamples);
+
+    for(int chn = 0; chn < fixDictMp.resid_spectra.cols(); ++chn) {
+        fft.fwd(spectrum, fixDictMp.residuum.col(chn));
+
+        double dError = (fixDictMp.resid_spectra.col(chn) - spectrum).norm();
+        QVERIFY(dError <= m_dEpsilon * std::sqrt((double)m_iNumSamples) * m_matSignal.col(chn).norm());
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestFixDictMp::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestFixDictMp::writeDictionary(const QList<qreal>& scales)
+{
+    QFile file(m_sDictPath);
+    QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+
+    QXmlStreamWriter xmlWriter(&file);
+    xmlWriter.setAutoFormatting(true);
+    xmlWriter.writeStartDocument();
+    xmlWriter.writeStartElement("COUNT");
+
+    //one part dictionary of the signal length and one of half the length, which has to be zero padded
+    GaborAtom gaborAtom;
+
+    for(int part = 0; part < 2; ++part) {
+        int iLength = m_iNumSamples >> part;
+
+        xmlWriter.writeStartElement("built_Atoms");
+        xmlWriter.writeAttribute("formula", "Gaboratom");
+        xmlWriter.writeAttribute("sample_count", QString::number(iLength));
+        xmlWriter.writeAttribute("atom_count", QString::number(scales.size() * m_lModulations.size()));
+        xmlWriter.writeAttribute("source_dict", QString("gabor_%1").arg(iLength));
+
+        int iAtom = 0;
+        for(int i = 0; i < scales.size(); ++i) {
+            for(int j = 0; j < m_lModulations.size(); ++j) {
+                VectorXd atom = gaborAtom.create_real(iLength, scales.at(i), iLength / 2, m_lModulations.at(j) * iLength / m_iNumSamples, 0);
+
+                QString samples;
+                for(int k = 0; k < atom.rows(); ++k)
+                    samples.append(QString::number(atom[k], 'g', 17)).append(":");
+
+                xmlWriter.writeStartElement("ATOM");
+                xmlWriter.writeAttribute("ID", QString::number(iAtom++));
+                xmlWriter.writeAttribute("scale", QString::number(scales.at(i)));
+                xmlWriter.writeAttribute("modu", QString::number(m_lModulations.at(j)));
+                xmlWriter.writeAttribute("phase", QString::number(0));
+                xmlWriter.writeStartElement("samples");
+                xmlWriter.writeAttribute("samples", samples);
+                xmlWriter.writeEndElement();
+                xmlWriter.writeEndElement();
+            }
+        }
+
+        xmlWriter.writeEndElement();
+    }
+
+    xmlWriter.writeEndElement();
+    xmlWriter.writeEndDocument();
+}
+
+
+//*************************************************************************************************************
+
+void TestFixDictMp::compareWithXmlPath(const FixDictMp& fixDictMp, qint32 boost)
+{
+    //the xml path: parsed dictionary, spectra of the atoms and of the residuum computed in every iteration
+    FixDictMp xmlMp;
+    xmlMp.residuum = m_matSignal;
+    QList<Dictionary> xmlDicts = xmlMp.parse_xml_dict(m_sDictPath);
+    MatrixXd matResiduum = m_matSignal;
+
+    for(int it = 0; it < fixDictMp.fix_dict_list.size(); ++it) {
+        FixDictAtom best;
+        for(int i = 0; i < xmlDicts.size(); ++i) {
+            FixDictAtom current = xmlMp.correlation(xmlDicts.at(i), matResiduum, boost);
+            if(i == 0 || std::fabs(current.max_scalar_product) > std::fabs(best.max_scalar_product))
+                best = current;
+        }
+
+        const FixDictAtom& found = fixDictMp.fix_dict_list.at(it);
+        QCOMPARE(found.dict_source, best.dict_source);
+        QCOMPARE(found.id, best.id);
+        QCOMPARE(found.translation, best.translation);
+        QVERIFY(std::fabs(found.max_scalar_product - best.max_scalar_product) <= m_dEpsilon * std::fabs(best.max_scalar_product));
+
+        //the pursuit stores the fitted, normalized atom
+        const VectorXd& fitted = found.atom_samples;
+        matResiduum -= fitted * (fitted.transpose() * matResiduum);
+    }
+
+    QVERIFY((fixDictMp.residuum - matResiduum).norm() <= m_dEpsilon * m_matSignal.norm());
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_GUILESS_MAIN(TestFixDictMp)
+#include "test_fixdict_mp.moc"
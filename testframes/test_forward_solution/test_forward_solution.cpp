@@ -50,6 +50,7 @@
 //=============================================================================================================
 
 #include <QtTest>
+#include <QThreadPool>
 
 
 //*************************************************************************************************************
@@ -78,12 +79,19 @@ public:
 private slots:
     void initTestCase();
     void computeForward();
+    void benchmarkThreadScaling_data();
+    void benchmarkThreadScaling();
+    void cleanup();
     void cleanupTestCase();
 
 private:
+    void initSettings(ComputeFwdSettings& settings);
     void compareForward();
+    bool readSolution(const QString& sFileName, Eigen::MatrixXd& matSol);
 
     double epsilon;
+    int m_iMaxThreadCount;
+    Eigen::MatrixXd m_matRefSol;
 
 };
 
@@ -92,6 +100,7 @@ private:
 
 TestForwardSolution::TestForwardSolution()
 : epsilon(0.000001)
+, m_iMaxThreadCount(QThreadPool::globalInstance()->maxThreadCount())
 {
 }
 
@@ -100,7 +109,8 @@ TestForwardSolution::TestForwardSolution()
 
 void TestForwardSolution::initTestCase()
 {
-
+    //Restored after every test function, the benchmark changes the pool size
+    m_iMaxThreadCount = QThreadPool::globalInstance()->maxThreadCount();
 }
 
 
@@ -121,15 +131,7 @@ void TestForwardSolution::computeForward()
     // --mindist 5 --fwd ./MNE-sample-data/Result/sample_audvis-meg-oct-6-fwd.fif
     ComputeFwdSettings settings;
 
-    settings.include_meg = true;
-    settings.accurate = true;
-    settings.srcname = QDir::currentPath()+"./MNE-sample-data/subjects/sample/bem/sample-oct-6-src.fif";
-    settings.measname = QDir::currentPath()+"./MNE-sample-data/MEG/sample/sample_audvis_raw.fif";
-    settings.mriname = QDir::currentPath()+"./MNE-sample-data/subjects/sample/mri/brain-neuromag/sets/COR.fif";
-    settings.mri_head_ident = false;
-    settings.transname.clear();
-    settings.bemname = QDir::currentPath()+"./MNE-sample-data/subjects/sample/bem/sample-5120-5120-5120-bem.fif";
-    settings.mindist = 5.0f/1000.0f;
+    initSettings(settings);
     settings.solname = QDir::currentPath()+"./mne-cpp-test-data/Result/sample_audvis-meg-oct-6-fwd.fif";
 
     settings.checkIntegrity();
@@ -166,6 +168,98 @@ void TestForwardSolution::computeForward()
 }
 
 
+//*************************************************************************************************************
+
+void TestForwardSolution::benchmarkThreadScaling_data()
+{
+    QTest::addColumn<int>("nthreads");
+
+    for (int nthreads = 1; nthreads <= 64; nthreads *= 2)
+        QTest::newRow(QString("%1 threads").arg(nthreads).toUtf8().constData()) << nthreads;
+}
+
+
+//*************************************************************************************************************
+
+void TestForwardSolution::benchmarkThreadScaling()
+{
+    //The sweep computes the forward solution eight times, only run it on request
+    if(qgetenv("MNE_RUN_BENCHMARKS").isEmpty())
+        QSKIP("Thread scaling benchmark disabled, set MNE_RUN_BENCHMARKS to run it.");
+
+    QFETCH(int, nthreads);
+
+    //The single threaded solution is the reference
+    if(m_matRefSol.size() == 0) {
+        ComputeFwdSettings settings;
+        initSettings(settings);
+        settings.solname = QDir::tempPath()+"/sample_audvis-meg-oct-6-ref-fwd.fif";
+        settings.nthreads = 1;
+        settings.checkIntegrity();
+
+        ComputeFwd cmpFwd(&settings);
+        cmpFwd.calculateFwd();
+
+        QVERIFY(readSolution(settings.solname, m_matRefSol));
+    }
+
+    ComputeFwdSettings settings;
+
+    initSettings(settings);
+    settings.solname = QDir::tempPath()+"/sample_audvis-meg-oct-6-bench-fwd.fif";
+    settings.nthreads = nthreads;
+
+    settings.checkIntegrity();
+
+    //Allow more workers than cores to measure oversubscription as well, cleanup() restores the pool size
+    QThreadPool::globalInstance()->setMaxThreadCount(qMax(m_iMaxThreadCount, nthreads));
+
+    ComputeFwd cmpFwd(&settings);
+
+    QBENCHMARK_ONCE {
+        cmpFwd.calculateFwd();
+    }
+
+    Eigen::MatrixXd matSol;
+    QVERIFY(readSolution(settings.solname, matSol));
+    QCOMPARE(matSol.rows(), m_matRefSol.rows());
+    QCOMPARE(matSol.cols(), m_matRefSol.cols());
+    QVERIFY((matSol - m_matRefSol).cwiseAbs().maxCoeff() <= 1e-5 * m_matRefSol.cwiseAbs().maxCoeff());
+}
+
+
+//*************************************************************************************************************
+
+bool TestForwardSolution::readSolution(const QString& sFileName, Eigen::MatrixXd& matSol)
+{
+    QFile t_fileForwardSolution(sFileName);
+    MNEForwardSolution t_Fwd(t_fileForwardSolution);
+    QFile::remove(sFileName);
+
+    if(t_Fwd.isEmpty() || !t_Fwd.sol)
+        return false;
+
+    matSol = t_Fwd.sol->data;
+    return true;
+}
+
+
+//*************************************************************************************************************
+
+void TestForwardSolution::initSettings(ComputeFwdSettings& settings)
+{
+    settings.include_meg = true;
+    settings.accurate = true;
+    settings.srcname = QDir::currentPath()+"./MNE-sample-data/subjects/sample/bem/sample-oct-6-src.fif";
+    settings.measname = QDir::currentPath()+"./MNE-sample-data/MEG/sample/sample_audvis_raw.fif";
+    settings.mriname = QDir::currentPath()+"./MNE-sample-data/subjects/sample/mri/brain-neuromag/sets/COR.fif";
+    settings.mri_head_ident = false;
+    settings.transname.clear();
+    settings.bemname = QDir::currentPath()+"./MNE-sample-data/subjects/sample/bem/sample-5120-5120-5120-bem.fif";
+    settings.mindist = 5.0f/1000.0f;
+}
+
+
 //*************************************************************************************************************
 
 void TestForwardSolution::compareForward()
@@ -209,6 +303,14 @@ void TestForwardSolution::compareForward()
 }
 
 
+//*************************************************************************************************************
+
+void TestForwardSolution::cleanup()
+{
+    QThreadPool::globalInstance()->setMaxThreadCount(m_iMaxThreadCount);
+}
+
+
 //*************************************************************************************************************
 
 void TestForwardSolution::cleanupTestCase()
@@ -0,0 +1,397 @@
+//=============================================================================================================
+/**
+* @file     test_fwd_bem_model.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Test of the BEM solution and field evaluation
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <fwd/fwd_bem_model.h>
+#include <fwd/fwd_coil.h>
+#include <fwd/fwd_coil_set.h>
+#include <fiff/fiff_constants.h>
+#include <mne/c/mne_surface_old.h>
+
+#include <stdlib.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+#include <QTemporaryDir>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FWDLIB;
+using namespace MNELIB;
+using namespace Eigen;
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// DEFINES
+//=============================================================================================================
+
+#ifndef FAIL
+#define FAIL -1
+#endif
+
+#ifndef OK
+#define OK 0
+#endif
+
+#ifndef TRUE
+#define TRUE 1
+#endif
+
+
+//=============================================================================================================
+class TestFwdBemModel: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestFwdBemModel();
+
+private slots:
+    void initTestCase();
+    void compareFieldBlock_data();
+    void compareFieldBlock();
+    void compareSolutionWithReference();
+    void writeReadSolution();
+    void solutionCacheIsOptIn();
+    void cleanupTestCase();
+
+private:
+    FwdBemModel* loadModel(int iBemMethod) const;
+    FwdCoilSet* createCoils(const Vector3f& vecCenter, float fRadius, int iNumCoils) const;
+    Vector3f surfaceCenter(FwdBemModel* pModel) const;
+    double relativeError(FwdBemModel* pModel, FwdBemModel* pRefModel) const;
+
+    QString         m_sBemName;
+    double          m_dEpsilon;
+    QTemporaryDir   m_tempDir;
+};
+
+
+//*************************************************************************************************************
+
+TestFwdBemModel::TestFwdBemModel()
+: m_dEpsilon(1e-4)
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestFwdBemModel::initTestCase()
+{
+    m_sBemName = QDir::currentPath()+"/mne-cpp-test-data/subjects/sample/bem/sample-5120-bem.fif";
+    QVERIFY(QFile::exists(m_sBemName));
+    QVERIFY(m_tempDir.isValid());
+
+    //Keep the tests independent of a solution cache of the user
+    qunsetenv("MNE_BEM_SOL_CACHE");
+}
+
+
+//*************************************************************************************************************
+
+FwdBemModel* TestFwdBemModel::loadModel(int iBemMethod) const
+{
+    FwdBemModel* pModel = FwdBemModel::fwd_bem_load_homog_surface(m_sBemName);
+    if (!pModel)
+        return NULL;
+
+    if (FwdBemModel::fwd_bem_load_recompute_solution(FwdBemModel::fwd_bem_make_bem_sol_name(m_sBemName),iBemMethod,false,pModel) == FAIL) {
+        delete pModel;
+        return NULL;
+    }
+
+    return pModel;
+}
+
+
+//*************************************************************************************************************
+
+FwdCoilSet* TestFwdBemModel::createCoils(const Vector3f& vecCenter, float fRadius, int iNumCoils) const
+{
+    //Point magnetometers spread evenly over a sphere around the head, measuring the radial field
+    FwdCoilSet* pCoils = new FwdCoilSet();
+    pCoils->coils = (FwdCoil**)malloc(iNumCoils*sizeof(FwdCoil*));
+    pCoils->ncoil = iNumCoils;
+    pCoils->coord_frame = FIFFV_COORD_MRI;
+
+    const float fGoldenAngle = M_PI*(3.0 - sqrt(5.0));
+
+    for (int k = 0; k < iNumCoils; ++k) {
+        float z = 1.0f - 2.0f*(k + 0.5f)/iNumCoils;
+        float r = sqrt(1.0f - z*z);
+        Vector3f vecDir(r*cos(k*fGoldenAngle), r*sin(k*fGoldenAngle), z);
+        Vector3f vecPos = vecCenter + fRadius*vecDir;
+
+        FwdCoil* pCoil = new FwdCoil(1);
+        pCoil->chname = QString("MAG %1").arg(k + 1);
+        pCoil->coord_frame = FIFFV_COORD_MRI;
+        pCoil->coil_class = FWD_COILC_MAG;
+        pCoil->type = FIFFV_COIL_POINT_MAGNETOMETER;
+        for (int c = 0; c < 3; ++c) {
+            pCoil->r0[c] = pCoil->rmag[0][c] = vecPos[c];
+            pCoil->ez[c] = pCoil->cosmag[0][c] = vecDir[c];
+        }
+        pCoil->w[0] = 1.0f;
+
+        pCoils->coils[k] = pCoil;
+    }
+
+    return pCoils;
+}
+
+
+//*************************************************************************************************************
+
+Vector3f TestFwdBemModel::surfaceCenter(FwdBemModel* pModel) const
+{
+    MneSurfaceOld* pSurf = pModel->surfs[0];
+    Vector3f vecCenter = Vector3f::Zero();
+
+    for (int k = 0; k < pSurf->np; ++k)
+        vecCenter += Map<const Vector3f>(pSurf->rr[k]);
+
+    return vecCenter / pSurf->np;
+}
+
+
+//*************************************************************************************************************
+
+double TestFwdBemModel::relativeError(FwdBemModel* pModel, FwdBemModel* pRefModel) const
+{
+    Map<const MatrixXf> matSol(pModel->solution[0],pModel->nsol,pModel->nsol);
+    Map<const MatrixXf> matRefSol(pRefModel->solution[0],pRefModel->nsol,pRefModel->nsol);
+
+    return (matSol - matRefSol).cwiseAbs().maxCoeff() / matRefSol.cwiseAbs().maxCoeff();
+}
+
+
+//*************************************************************************************************************
+
+void TestFwdBemModel::compareFieldBlock_data()
+{
+    QTest::addColumn<int>("bemMethod");
+
+    QTest::newRow("Constant collocation") << FWD_BEM_CONSTANT_COLL;
+    QTest::newRow("Linear collocation") << FWD_BEM_LINEAR_COLL;
+}
+
+
+//*************************************************************************************************************
+
+void TestFwdBemModel::compareFieldBlock()
+{
+    QFETCH(int, bemMethod);
+
+    FwdBemModel* pModel = loadModel(bemMethod);
+    QVERIFY(pModel);
+    QCOMPARE(pModel->bem_method, bemMethod);
+
+    Vector3f vecCenter = surfaceCenter(pModel);
+    FwdCoilSet* pCoils = createCoils(vecCenter, 0.12f, 100);
+    QVERIFY(FwdBemModel::fwd_bem_specify_coils(pModel,pCoils) == OK);
+
+    //Dipoles of random orientation well inside the inner skull
+    const int iNumDipoles = 150;
+    MatrixX3f matRd(iNumDipoles,3);
+    MatrixX3f matQ(iNumDipoles,3);
+
+    for (int j = 0; j < iNumDipoles; ++j) {
+        matRd.row(j) = (vecCenter + 0.02f*Vector3f::Random()).transpose();
+        matQ.row(j) = Vector3f::Random().normalized().transpose();
+    }
+
+    //The per dipole evaluation is the reference
+    MatrixXf matRef(iNumDipoles,pCoils->ncoil);
+    VectorXf vecB(pCoils->ncoil);
+    float rd[3],Q[3];
+
+    for (int j = 0; j < iNumDipoles; ++j) {
+        for (int c = 0; c < 3; ++c) {
+            rd[c] = matRd(j,c);
+            Q[c] = matQ(j,c);
+        }
+        if (bemMethod == FWD_BEM_CONSTANT_COLL)
+            FwdBemModel::fwd_bem_field_calc(rd,Q,pCoils,pModel,vecB.data());
+        else
+            FwdBemModel::fwd_bem_lin_field_calc(rd,Q,pCoils,pModel,vecB.data());
+        matRef.row(j) = vecB.transpose();
+    }
+
+    float fScale = matRef.cwiseAbs().maxCoeff();
+    QVERIFY(fScale > 0.0f);
+
+    //Automatic chunking, a single chunk, and chunks which do not divide the number of dipoles
+    QList<int> lChunks;
+    lChunks << 0 << iNumDipoles << 1 << 7;
+
+    for (int i = 0; i < lChunks.size(); ++i) {
+        MatrixXf matB;
+        QVERIFY(FwdBemModel::fwd_bem_field_block(matRd,matQ,pCoils,pModel,matB,lChunks[i]) == OK);
+        QCOMPARE(matB.rows(), matRef.rows());
+        QCOMPARE(matB.cols(), matRef.cols());
+        QVERIFY((matB - matRef).cwiseAbs().maxCoeff() < m_dEpsilon*fScale);
+    }
+
+    //Mismatching positions and moments are rejected
+    MatrixXf matB;
+    QVERIFY(FwdBemModel::fwd_bem_field_block(matRd,matQ.topRows(iNumDipoles - 1),pCoils,pModel,matB) == FAIL);
+
+    delete pCoils;
+    delete pModel;
+}
+
+
+//*************************************************************************************************************
+
+void TestFwdBemModel::compareSolutionWithReference()
+{
+    //The reference solution was computed by MNE-C with a LAPACK LU factorization
+    QString sSolName = FwdBemModel::fwd_bem_make_bem_sol_name(m_sBemName);
+    if (!QFile::exists(sSolName))
+        QSKIP("Reference BEM solution not available.");
+
+    FwdBemModel* pRefModel = FwdBemModel::fwd_bem_load_homog_surface(m_sBemName);
+    QVERIFY(pRefModel);
+    QVERIFY(FwdBemModel::fwd_bem_load_solution(sSolName,FWD_BEM_UNKNOWN,pRefModel) == TRUE);
+
+    //Recompute with the in place LU factorization
+    FwdBemModel* pModel = FwdBemModel::fwd_bem_load_homog_surface(m_sBemName);
+    QVERIFY(pModel);
+    QVERIFY(FwdBemModel::fwd_bem_compute_solution(pModel,pRefModel->bem_method) == OK);
+
+    QCOMPARE(pModel->nsol, pRefModel->nsol);
+    QVERIFY(relativeError(pModel,pRefModel) < 1e-3);
+
+    delete pModel;
+    delete pRefModel;
+}
+
+
+//*************************************************************************************************************
+
+void TestFwdBemModel::writeReadSolution()
+{
+    QList<int> lMethods;
+    lMethods << FWD_BEM_CONSTANT_COLL << FWD_BEM_LINEAR_COLL;
+
+    for (int i = 0; i < lMethods.size(); ++i) {
+        FwdBemModel* pModel = loadModel(lMethods[i]);
+        QVERIFY(pModel);
+
+        QString sFileName = m_tempDir.path() + QString("/method-%1-bem-sol.fif").arg(lMethods[i]);
+        QVERIFY(FwdBemModel::fwd_bem_write_solution(sFileName,pModel) == OK);
+
+        //The temporary file is renamed once the solution is complete
+        QVERIFY(QFile::exists(sFileName));
+        QCOMPARE(QDir(m_tempDir.path()).entryList(QStringList() << "*.tmp",QDir::Files).size(), 0);
+
+        FwdBemModel* pReadModel = FwdBemModel::fwd_bem_load_homog_surface(m_sBemName);
+        QVERIFY(pReadModel);
+        QVERIFY(FwdBemModel::fwd_bem_load_solution(sFileName,lMethods[i],pReadModel) == TRUE);
+
+        QCOMPARE(pReadModel->bem_method, pModel->bem_method);
+        QCOMPARE(pReadModel->nsol, pModel->nsol);
+        QVERIFY(relativeError(pReadModel,pModel) == 0.0);
+
+        delete pReadModel;
+        delete pModel;
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestFwdBemModel::solutionCacheIsOptIn()
+{
+    FwdBemModel* pModel = FwdBemModel::fwd_bem_load_homog_surface(m_sBemName);
+    QVERIFY(pModel);
+
+    //No caching unless requested
+    qunsetenv("MNE_BEM_SOL_CACHE");
+    QVERIFY(FwdBemModel::fwd_bem_cache_sol_name(pModel,FWD_BEM_LINEAR_COLL).isEmpty());
+
+    QString sCacheDir = m_tempDir.path() + "/bem-sol-cache";
+    qputenv("MNE_BEM_SOL_CACHE", sCacheDir.toLocal8Bit());
+
+    QString sCacheName = FwdBemModel::fwd_bem_cache_sol_name(pModel,FWD_BEM_LINEAR_COLL);
+    QVERIFY(sCacheName.startsWith(sCacheDir + "/"));
+    QVERIFY(sCacheName.endsWith("-bem-sol.fif"));
+    QVERIFY(sCacheName != FwdBemModel::fwd_bem_cache_sol_name(pModel,FWD_BEM_CONSTANT_COLL));
+
+    //A computed solution is written to the cache and found there the next time
+    QVERIFY(FwdBemModel::fwd_bem_load_recompute_solution(m_tempDir.path() + "/missing-bem-sol.fif",FWD_BEM_LINEAR_COLL,false,pModel) == OK);
+    QVERIFY(QFile::exists(sCacheName));
+
+    FwdBemModel* pCachedModel = FwdBemModel::fwd_bem_load_homog_surface(m_sBemName);
+    QVERIFY(pCachedModel);
+    QVERIFY(FwdBemModel::fwd_bem_load_recompute_solution(m_tempDir.path() + "/missing-bem-sol.fif",FWD_BEM_LINEAR_COLL,false,pCachedModel) == OK);
+    QVERIFY(relativeError(pCachedModel,pModel) == 0.0);
+
+    qunsetenv("MNE_BEM_SOL_CACHE");
+
+    delete pCachedModel;
+    delete pModel;
+}
+
+
+//*************************************************************************************************************
+
+void TestFwdBemModel::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_APPLESS_MAIN(TestFwdBemModel)
+#include "test_fwd_bem_model.moc"
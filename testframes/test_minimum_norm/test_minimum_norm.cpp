@@ -0,0 +1,229 @@
+//=============================================================================================================
+/**
+* @file     test_minimum_norm.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Test and benchmark for the dense, factored and single precision minimum norm kernels
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <mne/mne.h>
+#include <inverse/minimumNorm/minimumnorm.h>
+
+#include <iostream>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace MNELIB;
+using namespace INVERSELIB;
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* DECLARE CLASS TestMinimumNorm
+*
+* @brief The TestMinimumNorm class verifies and benchmarks the kernel modes of MinimumNorm
+*
+*/
+class TestMinimumNorm: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestMinimumNorm();
+
+private slots:
+    void initTestCase();
+    void compareKernelModes_data();
+    void compareKernelModes();
+    void benchmarkKernelModes_data();
+    void benchmarkKernelModes();
+    void cleanupTestCase();
+
+private:
+    //=========================================================================================================
+    /**
+    * Creates a minimum norm object which is set up with the given kernel mode.
+    */
+    MinimumNorm::SPtr createMinimumNorm(const QString& sMethod, bool bFactored, bool bSinglePrecision) const;
+
+    double epsilon;
+    double epsilonFloat;
+
+    QString invName;
+
+    MNEInverseOperator m_invOp;
+    MatrixXd m_matData;
+};
+
+
+//*************************************************************************************************************
+
+TestMinimumNorm::TestMinimumNorm()
+: epsilon(0.000001)
+, epsilonFloat(0.0001)
+, invName("./mne-cpp-test-data/MEG/sample/sample_audvis-meg-eeg-oct-6-meg-eeg-inv.fif")
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestMinimumNorm::initTestCase()
+{
+    qDebug() << "Epsilon" << epsilon;
+    qDebug() << "Inverse Operator File Name" << invName;
+
+    QFile t_fileInv(invName);
+    if(!t_fileInv.exists())
+        QSKIP("Inverse operator test data not available.");
+
+    m_invOp = MNEInverseOperator(t_fileInv);
+
+    //One second of white noise data at 1 kHz
+    m_matData = MatrixXd::Random(m_invOp.nchan, 1000) * 1e-12;
+}
+
+
+//*************************************************************************************************************
+
+void TestMinimumNorm::compareKernelModes_data()
+{
+    QTest::addColumn<QString>("method");
+    QTest::addColumn<bool>("factored");
+    QTest::addColumn<bool>("singlePrecision");
+
+    QTest::newRow("MNE factored") << QString("MNE") << true << false;
+    QTest::newRow("MNE float") << QString("MNE") << false << true;
+    QTest::newRow("dSPM factored") << QString("dSPM") << true << false;
+    QTest::newRow("dSPM float") << QString("dSPM") << false << true;
+    QTest::newRow("dSPM factored float") << QString("dSPM") << true << true;
+}
+
+
+//*************************************************************************************************************
+
+void TestMinimumNorm::compareKernelModes()
+{
+    QFETCH(QString, method);
+    QFETCH(bool, factored);
+    QFETCH(bool, singlePrecision);
+
+    MNESourceEstimate stcRef = createMinimumNorm(method, false, false)->calculateInverse(m_matData, 0.0f, 0.001f);
+    MNESourceEstimate stc = createMinimumNorm(method, factored, singlePrecision)->calculateInverse(m_matData, 0.0f, 0.001f);
+
+    QVERIFY(stc.data.rows() == stcRef.data.rows());
+    QVERIFY(stc.data.cols() == stcRef.data.cols());
+
+    double dRelError = (stc.data - stcRef.data).norm() / stcRef.data.norm();
+
+    QVERIFY(dRelError < (singlePrecision ? epsilonFloat : epsilon));
+}
+
+
+//*************************************************************************************************************
+
+void TestMinimumNorm::benchmarkKernelModes_data()
+{
+    QTest::addColumn<bool>("factored");
+    QTest::addColumn<bool>("singlePrecision");
+
+    QTest::newRow("dense") << false << false;
+    QTest::newRow("factored") << true << false;
+    QTest::newRow("dense float") << false << true;
+    QTest::newRow("factored float") << true << true;
+}
+
+
+//*************************************************************************************************************
+
+void TestMinimumNorm::benchmarkKernelModes()
+{
+    QFETCH(bool, factored);
+    QFETCH(bool, singlePrecision);
+
+    MinimumNorm::SPtr pMinimumNorm = createMinimumNorm("dSPM", factored, singlePrecision);
+    MNESourceEstimate stc;
+
+    QBENCHMARK {
+        stc = pMinimumNorm->calculateInverse(m_matData, 0.0f, 0.001f);
+    }
+
+    QVERIFY(stc.data.cols() == m_matData.cols());
+}
+
+
+//*************************************************************************************************************
+
+void TestMinimumNorm::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+
+MinimumNorm::SPtr TestMinimumNorm::createMinimumNorm(const QString& sMethod, bool bFactored, bool bSinglePrecision) const
+{
+    double snr = 3.0;
+    double lambda2 = 1.0 / pow(snr, 2);
+
+    MinimumNorm::SPtr pMinimumNorm(new MinimumNorm(m_invOp, lambda2, sMethod));
+    pMinimumNorm->setFactoredKernel(bFactored);
+    pMinimumNorm->setSinglePrecision(bSinglePrecision);
+    pMinimumNorm->doInverseSetup(1, false);
+
+    return pMinimumNorm;
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_APPLESS_MAIN(TestMinimumNorm)
+#include "test_minimum_norm.moc"
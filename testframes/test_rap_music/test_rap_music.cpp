@@ -0,0 +1,265 @@
+//=============================================================================================================
+/**
+* @file     test_rap_music.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Test of the tiled RAP MUSIC pair correlation against the per pair SVD subspace correlation
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <inverse/rapMusic/rapmusic.h>
+#include <utils/mnemath.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+#include <QThread>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace INVERSELIB;
+using namespace UTILSLIB;
+using namespace Eigen;
+
+
+//=============================================================================================================
+/**
+* Exposes the protected correlation kernels of RapMusic.
+*/
+class RapMusicKernels : public RapMusic
+{
+public:
+    RapMusicKernels(int p_iNumGridPoints)
+    {
+        m_iNumGridPoints = p_iNumGridPoints;
+        m_iNumLeadFieldCombinations = MNEMath::nchoose2(p_iNumGridPoints+1);
+        m_iMaxNumThreads = QThread::idealThreadCount();
+    }
+
+    using RapMusic::subcorr;
+    using RapMusic::calcPointBases;
+    using RapMusic::calcPairCorrelations;
+    using RapMusic::getPointPair;
+    using RapMusic::getPairIndex;
+    using RapMusic::getGainMatrixPair;
+};
+
+
+//=============================================================================================================
+class TestRapMusic: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestRapMusic();
+
+private slots:
+    void initTestCase();
+    void pairCorrelationsMatchSubcorr();
+    void pairIndexRoundTrip();
+    void pairIndexNear32BitLimit();
+    void cleanupTestCase();
+
+private:
+    MatrixXd    m_matProjGain;
+    MatrixXd    m_matU_B;
+    int         m_iNumChannels;
+    int         m_iNumGridPoints;
+    int         m_iProjectedOutPoint;
+    double      m_dEpsilon;
+};
+
+
+//*************************************************************************************************************
+
+TestRapMusic::TestRapMusic()
+: m_iNumChannels(40)
+, m_iNumGridPoints(150)
+, m_iProjectedOutPoint(3)
+, m_dEpsilon(1e-10)
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestRapMusic::initTestCase()
+{
+    //More grid points than one tile, so the pairs of different tiles and the partial last tile are covered
+    MatrixXd matGain = MatrixXd::Random(m_iNumChannels, 3*m_iNumGridPoints);
+
+    //Rank deficient points: rank 2 and rank 1
+    matGain.col(3*7+2) = 0.3*matGain.col(3*7) - 0.8*matGain.col(3*7+1);
+    matGain.col(3*100+1) = -2.0*matGain.col(3*100);
+    matGain.col(3*100+2) = 0.5*matGain.col(3*100);
+
+    //Found sources like after two RAP iterations: all directions of one point, which is projected out completely,
+    //and one direction of another point, which leaves it with rank 2
+    MatrixXd matA(m_iNumChannels, 4);
+    matA.leftCols(3) = matGain.block(0, 3*m_iProjectedOutPoint, m_iNumChannels, 3);
+    matA.col(3) = matGain.block(0, 3*70, m_iNumChannels, 3) * Vector3d(0.6, -0.2, 0.7);
+
+    MatrixXd matOrthProj = MatrixXd::Identity(m_iNumChannels, m_iNumChannels)
+                           - matA * (matA.transpose()*matA).inverse() * matA.transpose();
+
+    m_matProjGain = matOrthProj * matGain;
+
+    //Projected signal subspace of rank 4
+    MatrixXd matPhi_s = MatrixXd::Random(m_iNumChannels, 4).householderQr().householderQ() * MatrixXd::Identity(m_iNumChannels, 4);
+    JacobiSVD<MatrixXd> svdProjPhi_s(matOrthProj * matPhi_s, ComputeThinU);
+    m_matU_B = svdProjPhi_s.matrixU();
+}
+
+
+//*************************************************************************************************************
+
+void TestRapMusic::pairCorrelationsMatchSubcorr()
+{
+    RapMusicKernels rap(m_iNumGridPoints);
+
+    MatrixXd matQ, matP;
+    rap.calcPointBases(m_matProjGain, m_matU_B, matQ, matP);
+
+    VectorXd vecRoh;
+    rap.calcPairCorrelations(matQ, matP, vecRoh);
+
+    int iNumPairs = MNEMath::nchoose2(m_iNumGridPoints+1);
+    QCOMPARE((int)vecRoh.size(), iNumPairs);
+
+    //Reference: SVD of the projected m x 6 gain of every pair
+    VectorXd vecRohRef(iNumPairs);
+    RapMusic::MatrixX6T matPairGain(m_iNumChannels, 6);
+
+    for(int i = 0; i < iNumPairs; ++i) {
+        int iIdx1, iIdx2;
+        RapMusicKernels::getPointPair(m_iNumGridPoints, i, iIdx1, iIdx2);
+        RapMusicKernels::getGainMatrixPair(m_matProjGain, matPairGain, iIdx1, iIdx2);
+
+        if(iIdx1 == m_iProjectedOutPoint && iIdx2 == m_iProjectedOutPoint) {
+            //Nothing is left of this pair, the SVD would correlate a direction of round-off noise
+            QVERIFY(vecRoh(i) < m_dEpsilon);
+            vecRohRef(i) = 0.0;
+            continue;
+        }
+
+        vecRohRef(i) = RapMusicKernels::subcorr(matPairGain, m_matU_B);
+        QVERIFY(std::fabs(vecRoh(i) - vecRohRef(i)) < m_dEpsilon);
+    }
+
+    //The scan picks the same pair
+    VectorXd::Index iMaxIdx, iMaxIdxRef;
+    vecRoh.maxCoeff(&iMaxIdx);
+    vecRohRef.maxCoeff(&iMaxIdxRef);
+    QCOMPARE(iMaxIdx, iMaxIdxRef);
+}
+
+
+//*************************************************************************************************************
+
+void TestRapMusic::pairIndexRoundTrip()
+{
+    int iNumPairs = MNEMath::nchoose2(m_iNumGridPoints+1);
+
+    int iIdx = 0;
+    for(int i = 0; i < m_iNumGridPoints; ++i) {
+        for(int j = i; j < m_iNumGridPoints; ++j, ++iIdx) {
+            QCOMPARE(RapMusicKernels::getPairIndex(m_iNumGridPoints, i, j), iIdx);
+
+            int iIdx1, iIdx2;
+            RapMusicKernels::getPointPair(m_iNumGridPoints, iIdx, iIdx1, iIdx2);
+            QCOMPARE(iIdx1, i);
+            QCOMPARE(iIdx2, j);
+        }
+    }
+    QCOMPARE(iIdx, iNumPairs);
+}
+
+
+//*************************************************************************************************************
+
+void TestRapMusic::pairIndexNear32BitLimit()
+{
+    //The largest number of points whose pairs can still be indexed with an int
+    const int iNumPoints = 65535;
+    const qint64 iNumPairs = (qint64)iNumPoints*(iNumPoints+1)/2;
+    QVERIFY(iNumPairs - 1 <= std::numeric_limits<int>::max());
+    QVERIFY((qint64)(iNumPoints+1)*(iNumPoints+2)/2 - 1 > std::numeric_limits<int>::max());
+
+    QList<qint64> lIndices;
+    for(qint64 i = 0; i < 1000; ++i)
+        lIndices << i;
+    for(qint64 i = 0; i < iNumPairs; i += 1000003)
+        lIndices << i;
+    for(qint64 i = iNumPairs - 200000; i < iNumPairs; ++i)
+        lIndices << i;
+
+    for(int k = 0; k < lIndices.size(); ++k) {
+        int iIdx = (int)lIndices.at(k);
+
+        int iIdx1, iIdx2;
+        RapMusicKernels::getPointPair(iNumPoints, iIdx, iIdx1, iIdx2);
+        QVERIFY(0 <= iIdx1 && iIdx1 <= iIdx2 && iIdx2 < iNumPoints);
+        QCOMPARE(RapMusicKernels::getPairIndex(iNumPoints, iIdx1, iIdx2), iIdx);
+    }
+
+    //The last pair
+    int iIdx1, iIdx2;
+    RapMusicKernels::getPointPair(iNumPoints, (int)(iNumPairs-1), iIdx1, iIdx2);
+    QCOMPARE(iIdx1, iNumPoints-1);
+    QCOMPARE(iIdx2, iNumPoints-1);
+}
+
+
+//*************************************************************************************************************
+
+void TestRapMusic::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_APPLESS_MAIN(TestRapMusic)
+#include "test_rap_music.moc"
@@ -0,0 +1,232 @@
+//=============================================================================================================
+/**
+* @file     test_rt_cov_accumulator.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Test of the incremental covariance accumulator against a batch covariance
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <realtime/rtProcessing/rtcovaccumulator.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace REALTIMELIB;
+using namespace Eigen;
+
+
+//=============================================================================================================
+class TestRtCovAccumulator: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestRtCovAccumulator();
+
+private slots:
+    void initTestCase();
+    void cumulativeMatchesBatch();
+    void slidingWindowMatchesBatch();
+    void mergeMatchesBatch();
+    void cleanupTestCase();
+
+private:
+    MatrixXd batchCovariance(const MatrixXd& matData) const;
+    double relativeError(const MatrixXd& matA, const MatrixXd& matB) const;
+
+    MatrixXd    m_matData;
+    int         m_iBlockSize;
+    int         m_iNumBlocks;
+    double      m_dEpsilon;
+};
+
+
+//*************************************************************************************************************
+
+TestRtCovAccumulator::TestRtCovAccumulator()
+: m_iBlockSize(50)
+, m_iNumBlocks(40)
+, m_dEpsilon(1e-9)
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestRtCovAccumulator::initTestCase()
+{
+    const int iNumChannels = 16;
+
+    //Correlated channels with a large offset relative to the noise, this stresses the rank-k downdates
+    MatrixXd matMix = MatrixXd::Random(iNumChannels, iNumChannels);
+    VectorXd vecOffset = 1e2 * VectorXd::Random(iNumChannels);
+
+    m_matData = matMix * MatrixXd::Random(iNumChannels, m_iNumBlocks * m_iBlockSize);
+    m_matData.colwise() += vecOffset;
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd TestRtCovAccumulator::batchCovariance(const MatrixXd& matData) const
+{
+    MatrixXd matCentered = matData.colwise() - matData.rowwise().mean();
+    return matCentered * matCentered.transpose() / (double)(matData.cols() - 1);
+}
+
+
+//*************************************************************************************************************
+
+double TestRtCovAccumulator::relativeError(const MatrixXd& matA, const MatrixXd& matB) const
+{
+    return (matA - matB).cwiseAbs().maxCoeff() / matB.cwiseAbs().maxCoeff();
+}
+
+
+//*************************************************************************************************************
+
+void TestRtCovAccumulator::cumulativeMatchesBatch()
+{
+    RtCovAccumulator accumulator(RtCovAccumulator::Cumulative);
+
+    for(int i = 0; i < m_iNumBlocks; ++i) {
+        accumulator.append(m_matData.middleCols(i * m_iBlockSize, m_iBlockSize));
+
+        if(i == 0)
+            continue;
+
+        MatrixXd matBatch = m_matData.leftCols((i + 1) * m_iBlockSize);
+        QCOMPARE(accumulator.count(), (double)matBatch.cols());
+        QVERIFY(relativeError(accumulator.mean(), matBatch.rowwise().mean()) < m_dEpsilon);
+        QVERIFY(relativeError(accumulator.covariance(), batchCovariance(matBatch)) < m_dEpsilon);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestRtCovAccumulator::slidingWindowMatchesBatch()
+{
+    //The window holds 8 blocks, the blocks before are evicted with removeBlock(). The window is recomputed after
+    //every 8 evictions, so the intermediate estimates are the ones built from the downdates.
+    const int iWindowBlocks = 8;
+
+    RtCovAccumulator accumulator(RtCovAccumulator::SlidingWindow);
+    accumulator.setWindowSize(iWindowBlocks * m_iBlockSize);
+
+    for(int i = 0; i < m_iNumBlocks; ++i) {
+        accumulator.append(m_matData.middleCols(i * m_iBlockSize, m_iBlockSize));
+
+        if(i == 0)
+            continue;
+
+        int iFirstBlock = qMax(0, i + 1 - iWindowBlocks);
+        MatrixXd matBatch = m_matData.middleCols(iFirstBlock * m_iBlockSize, (i + 1 - iFirstBlock) * m_iBlockSize);
+
+        QCOMPARE(accumulator.count(), (double)matBatch.cols());
+        QVERIFY(relativeError(accumulator.mean(), matBatch.rowwise().mean()) < m_dEpsilon);
+        QVERIFY(relativeError(accumulator.covariance(), batchCovariance(matBatch)) < m_dEpsilon);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestRtCovAccumulator::mergeMatchesBatch()
+{
+    //Split the data unevenly between three partial states
+    const int iSplit1 = 7 * m_iBlockSize + 13;
+    const int iSplit2 = 25 * m_iBlockSize + 1;
+
+    RtCovAccumulator partial1, partial2, partial3;
+    partial1.append(m_matData.leftCols(iSplit1));
+    partial2.append(m_matData.middleCols(iSplit1, iSplit2 - iSplit1));
+    partial3.append(m_matData.rightCols(m_matData.cols() - iSplit2));
+
+    MatrixXd matBatchCov = batchCovariance(m_matData);
+    MatrixXd matBatchScatter = matBatchCov * (double)(m_matData.cols() - 1);
+
+    //Merge into an empty accumulator, this takes over the state of the first partial one
+    RtCovAccumulator merged;
+    merged.merge(partial1);
+    QVERIFY(relativeError(merged.covariance(), partial1.covariance()) < m_dEpsilon);
+
+    merged.merge(partial2);
+    merged.merge(partial3);
+
+    QCOMPARE(merged.count(), (double)m_matData.cols());
+    QVERIFY(relativeError(merged.mean(), m_matData.rowwise().mean()) < m_dEpsilon);
+    QVERIFY(relativeError(merged.scatter(), matBatchScatter) < m_dEpsilon);
+    QVERIFY(relativeError(merged.covariance(), matBatchCov) < m_dEpsilon);
+
+    //The merge order must not matter
+    RtCovAccumulator reversed;
+    reversed.merge(partial3);
+    reversed.merge(partial2);
+    reversed.merge(partial1);
+    QVERIFY(relativeError(reversed.covariance(), matBatchCov) < m_dEpsilon);
+
+    //Merging an empty state is a no-op
+    merged.merge(RtCovAccumulator());
+    QCOMPARE(merged.count(), (double)m_matData.cols());
+    QVERIFY(relativeError(merged.covariance(), matBatchCov) < m_dEpsilon);
+}
+
+
+//*************************************************************************************************************
+
+void TestRtCovAccumulator::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_APPLESS_MAIN(TestRtCovAccumulator)
+#include "test_rt_cov_accumulator.moc"
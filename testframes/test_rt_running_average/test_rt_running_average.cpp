@@ -0,0 +1,222 @@
+//=============================================================================================================
+/**
+* @file     test_rt_running_average.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Test of the running average and variance against a batch computation over the epoch window
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include <realtime/rtProcessing/rtrunningaverage.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace REALTIMELIB;
+using namespace Eigen;
+
+
+//=============================================================================================================
+class TestRtRunningAverage: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestRtRunningAverage();
+
+private slots:
+    void initTestCase();
+    void cumulativeMatchesBatch();
+    void movingWindowMatchesBatch();
+    void epochSizeChangeResets();
+    void cleanupTestCase();
+
+private:
+    void compareWithBatch(const RtRunningAverage& average, int iFirstEpoch, int iNumEpochs) const;
+    double relativeError(const MatrixXd& matA, const MatrixXd& matB) const;
+
+    QList<MatrixXd> m_lEpochs;
+    int             m_iNumChannels;
+    int             m_iNumSamples;
+    double          m_dEpsilon;
+};
+
+
+//*************************************************************************************************************
+
+TestRtRunningAverage::TestRtRunningAverage()
+: m_iNumChannels(8)
+, m_iNumSamples(60)
+, m_dEpsilon(1e-9)
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestRtRunningAverage::initTestCase()
+{
+    //An evoked response with a large offset on top of small trial to trial noise, this stresses the replace updates
+    MatrixXd matEvoked = 1e3 * MatrixXd::Random(m_iNumChannels, m_iNumSamples);
+
+    for(int i = 0; i < 250; ++i)
+        m_lEpochs.append(matEvoked + MatrixXd::Random(m_iNumChannels, m_iNumSamples));
+}
+
+
+//*************************************************************************************************************
+
+void TestRtRunningAverage::compareWithBatch(const RtRunningAverage& average, int iFirstEpoch, int iNumEpochs) const
+{
+    MatrixXd matMean = MatrixXd::Zero(m_iNumChannels, m_iNumSamples);
+    for(int i = iFirstEpoch; i < iFirstEpoch + iNumEpochs; ++i)
+        matMean += m_lEpochs.at(i);
+    matMean /= iNumEpochs;
+
+    MatrixXd matVar = MatrixXd::Zero(m_iNumChannels, m_iNumSamples);
+    if(iNumEpochs > 1) {
+        for(int i = iFirstEpoch; i < iFirstEpoch + iNumEpochs; ++i)
+            matVar.array() += (m_lEpochs.at(i) - matMean).array().square();
+        matVar /= iNumEpochs - 1;
+    }
+
+    QCOMPARE(average.count(), iNumEpochs);
+    QVERIFY(relativeError(average.average(), matMean) < m_dEpsilon);
+
+    if(iNumEpochs > 1) {
+        QVERIFY(relativeError(average.variance(), matVar) < m_dEpsilon);
+
+        MatrixXd matSnr = (matMean.array().abs() / (matVar.array() / iNumEpochs).sqrt()).matrix();
+        QVERIFY(relativeError(average.snr(), matSnr) < m_dEpsilon);
+    } else {
+        QVERIFY(average.variance().isZero());
+    }
+}
+
+
+//*************************************************************************************************************
+
+double TestRtRunningAverage::relativeError(const MatrixXd& matA, const MatrixXd& matB) const
+{
+    return (matA - matB).cwiseAbs().maxCoeff() / matB.cwiseAbs().maxCoeff();
+}
+
+
+//*************************************************************************************************************
+
+void TestRtRunningAverage::cumulativeMatchesBatch()
+{
+    RtRunningAverage average;
+    QVERIFY(average.isEmpty());
+
+    for(int i = 0; i < m_lEpochs.size(); ++i) {
+        average.append(m_lEpochs.at(i));
+        compareWithBatch(average, 0, i + 1);
+    }
+}
+
+
+//*************************************************************************************************************
+
+void TestRtRunningAverage::movingWindowMatchesBatch()
+{
+    //The window is turned over many times. Each append past the first 10 epochs evicts the oldest one with a
+    //replace update and every 10 replace updates the average and variance are recomputed from the ring.
+    const int iMaxEpochs = 10;
+
+    RtRunningAverage average(iMaxEpochs);
+    QCOMPARE(average.maxEpochs(), iMaxEpochs);
+
+    for(int i = 0; i < m_lEpochs.size(); ++i) {
+        average.append(m_lEpochs.at(i));
+
+        int iNumEpochs = qMin(i + 1, iMaxEpochs);
+        compareWithBatch(average, i + 1 - iNumEpochs, iNumEpochs);
+    }
+
+    //A window change restarts the average
+    average.setMaxEpochs(3);
+    QVERIFY(average.isEmpty());
+
+    for(int i = 0; i < 7; ++i)
+        average.append(m_lEpochs.at(i));
+    compareWithBatch(average, 4, 3);
+}
+
+
+//*************************************************************************************************************
+
+void TestRtRunningAverage::epochSizeChangeResets()
+{
+    RtRunningAverage average(4);
+
+    for(int i = 0; i < 6; ++i)
+        average.append(m_lEpochs.at(i));
+    QCOMPARE(average.count(), 4);
+
+    //An epoch of a different length starts over
+    average.append(m_lEpochs.at(6).leftCols(m_iNumSamples / 2));
+    QCOMPARE(average.count(), 1);
+    QCOMPARE(average.average().cols(), m_iNumSamples / 2);
+
+    average.reset();
+    QVERIFY(average.isEmpty());
+}
+
+
+//*************************************************************************************************************
+
+void TestRtRunningAverage::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_APPLESS_MAIN(TestRtRunningAverage)
+#include "test_rt_running_average.moc"
@@ -0,0 +1,305 @@
+//=============================================================================================================
+/**
+* @file     test_rtsss_algo.cpp
+* @author   agent <agent@local>
+* @version  1.0
+* @date     October, 2026
+*
+* @section  LICENSE
+*
+* Copyright (C) 2026, agent. All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without modification, are permitted provided that
+* the following conditions are met:
+*     * Redistributions of source code must retain the above copyright notice, this list of conditions and the
+*       following disclaimer.
+*     * Redistributions in binary form must reproduce the above copyright notice, this list of conditions and
+*       the following disclaimer in the documentation and/or other materials provided with the distribution.
+*     * Neither the name of MNE-CPP authors nor the names of its contributors may be used
+*       to endorse or promote products derived from this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR IMPLIED
+* WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A
+* PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT,
+* INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+* PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION)
+* HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+* NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+* POSSIBILITY OF SUCH DAMAGE.
+*
+*
+* @brief    Test of the cached rtSSS operator and the fused OLS projection against uncached results
+*
+*/
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// INCLUDES
+//=============================================================================================================
+
+#include "rtsssalgo.h"
+
+#include <fiff/fiff_constants.h>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// QT INCLUDES
+//=============================================================================================================
+
+#include <QtTest>
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// USED NAMESPACES
+//=============================================================================================================
+
+using namespace FIFFLIB;
+using namespace Eigen;
+
+
+//=============================================================================================================
+class TestRtSssAlgo: public QObject
+{
+    Q_OBJECT
+
+public:
+    TestRtSssAlgo();
+
+private slots:
+    void initTestCase();
+    void fusedProjectionMatchesDirectSolve();
+    void cachedOperatorMatchesUncached();
+    void cacheEvictionKeepsResults();
+    void cleanupTestCase();
+
+private:
+    void buildOperator(RtSssAlgo& algo, const RowVectorXi& vecPicks, const Vector3d& vecOrigin) const;
+    void compareWithUncached(RtSssAlgo& algo, const RowVectorXi& vecPicks, const Vector3d& vecOrigin) const;
+    MatrixXd pickRows(const MatrixXd& mat, const RowVectorXi& vecPicks) const;
+    double relativeError(const MatrixXd& matA, const MatrixXd& matB) const;
+
+    FiffInfo::SPtr  m_pFiffInfo;
+    RowVectorXi     m_vecAllPicks;
+    QList<int>      m_lExpOrder;
+    Vector3d        m_vecOrigin;
+    MatrixXd        m_matData;
+    MatrixXd        m_matDataIn;
+    int             m_iNumChannels;
+    int             m_iNumSamples;
+    double          m_dEpsilon;
+};
+
+
+//*************************************************************************************************************
+
+TestRtSssAlgo::TestRtSssAlgo()
+: m_iNumChannels(120)
+, m_iNumSamples(20)
+, m_dEpsilon(1e-6)
+{
+}
+
+
+//*************************************************************************************************************
+
+void TestRtSssAlgo::initTestCase()
+{
+    //BabyMEG magnetometers on a hemispherical helmet around the default SSS origin, alternating between the
+    //inner layer at 9 cm and the outer layer at 12 cm. Every coil points away from the center.
+    m_vecOrigin << 0.0, 0.0, 0.04;
+    m_lExpOrder << 4 << 2 << 5 << 2;
+
+    m_pFiffInfo = FiffInfo::SPtr(new FiffInfo);
+    m_vecAllPicks.resize(m_iNumChannels);
+
+    const double dGoldenAngle = M_PI * (3.0 - std::sqrt(5.0));
+
+    for(int i = 0; i < m_iNumChannels; ++i) {
+        double z = (i + 0.5) / m_iNumChannels;
+        double r = std::sqrt(1.0 - z * z);
+        Vector3d ez(r * std::cos(i * dGoldenAngle), r * std::sin(i * dGoldenAngle), z);
+        Vector3d ex = ez.cross(std::abs(ez.z()) < 0.9 ? Vector3d::UnitZ() : Vector3d::UnitX()).normalized();
+        Vector3d ey = ez.cross(ex);
+
+        Matrix4d matTrans = Matrix4d::Identity();
+        matTrans.block(0,0,3,1) = ex;
+        matTrans.block(0,1,3,1) = ey;
+        matTrans.block(0,2,3,1) = ez;
+        matTrans.block(0,3,3,1) = m_vecOrigin + (i % 2 == 0 ? 0.09 : 0.12) * ez;
+
+        FiffChInfo chInfo;
+        chInfo.kind = FIFFV_MEG_CH;
+        chInfo.ch_name = QString("MEG%1").arg(i, 3, 10, QChar('0'));
+        chInfo.chpos.coil_type = (i % 2 == 0) ? FIFFV_COIL_BABY_MAG : FIFFV_COIL_BABY_REF_MAG;
+        chInfo.coil_trans = matTrans.cast<float>();
+
+        m_pFiffInfo->chs.append(chInfo);
+        m_vecAllPicks(i) = i;
+    }
+    m_pFiffInfo->nchan = m_iNumChannels;
+
+    //Data of internal and external sources, a little noise and two channels with artifacts for the robust
+    //regression
+    RtSssAlgo algo;
+    buildOperator(algo, m_vecAllPicks, m_vecOrigin);
+
+    QList<MatrixXd> lLinEqn = algo.getLinEqn();
+    m_matDataIn = lLinEqn[0] * MatrixXd::Random(lLinEqn[0].cols(), m_iNumSamples);
+    m_matData = m_matDataIn + lLinEqn[1] * MatrixXd::Random(lLinEqn[1].cols(), m_iNumSamples);
+    m_matData += 1e-3 * m_matData.cwiseAbs().maxCoeff() * MatrixXd::Random(m_iNumChannels, m_iNumSamples);
+    m_matData.row(10) *= 5.0;
+    m_matData.row(70) *= -5.0;
+}
+
+
+//*************************************************************************************************************
+
+void TestRtSssAlgo::buildOperator(RtSssAlgo& algo, const RowVectorXi& vecPicks, const Vector3d& vecOrigin) const
+{
+    algo.setMEGInfo(m_pFiffInfo, vecPicks);
+    algo.setSSSParameter(m_lExpOrder);
+    algo.setOrigin(vecOrigin);
+    algo.buildLinearEqn();
+}
+
+
+//*************************************************************************************************************
+
+void TestRtSssAlgo::compareWithUncached(RtSssAlgo& algo, const RowVectorXi& vecPicks, const Vector3d& vecOrigin) const
+{
+    //A new instance has an empty operator cache
+    RtSssAlgo algoUncached;
+    buildOperator(algoUncached, vecPicks, vecOrigin);
+
+    MatrixXd matData = pickRows(m_matData, vecPicks);
+
+    QList<MatrixXd> lLinEqn = algo.getLinEqn();
+    QList<MatrixXd> lLinEqnUncached = algoUncached.getLinEqn();
+    for(int i = 0; i < 4; ++i)
+        QVERIFY(relativeError(lLinEqn[i], lLinEqnUncached[i]) < m_dEpsilon);
+
+    QVERIFY(relativeError(algo.getSSSOLS(matData), algoUncached.getSSSOLS(matData)) < m_dEpsilon);
+    QVERIFY(relativeError(algo.getSSSRR(matData), algoUncached.getSSSRR(matData)) < m_dEpsilon);
+}
+
+
+//*************************************************************************************************************
+
+MatrixXd TestRtSssAlgo::pickRows(const MatrixXd& mat, const RowVectorXi& vecPicks) const
+{
+    MatrixXd matPicked(vecPicks.cols(), mat.cols());
+    for(int i = 0; i < vecPicks.cols(); ++i)
+        matPicked.row(i) = mat.row(vecPicks(i));
+
+    return matPicked;
+}
+
+
+//*************************************************************************************************************
+
+double TestRtSssAlgo::relativeError(const MatrixXd& matA, const MatrixXd& matB) const
+{
+    return (matA - matB).cwiseAbs().maxCoeff() / matB.cwiseAbs().maxCoeff();
+}
+
+
+//*************************************************************************************************************
+
+void TestRtSssAlgo::fusedProjectionMatchesDirectSolve()
+{
+    RtSssAlgo algo;
+    buildOperator(algo, m_vecAllPicks, m_vecOrigin);
+
+    //Solve the least squares problem of the full expansion and keep the internal part
+    QList<MatrixXd> lLinEqn = algo.getLinEqn();
+    const MatrixXd& matEqnIn = lLinEqn[0];
+    const MatrixXd& matEqnA = lLinEqn[3];
+
+    MatrixXd matSol = matEqnA.colPivHouseholderQr().solve(m_matData);
+    MatrixXd matSssIn = matEqnIn * matSol.topRows(matEqnIn.cols());
+
+    QVERIFY(relativeError(algo.getSSSOLS(m_matData), matSssIn) < m_dEpsilon);
+
+    //Without noise and artifacts the internal signal is recovered
+    MatrixXd matDataClean = m_matDataIn + lLinEqn[1] * MatrixXd::Random(lLinEqn[1].cols(), m_iNumSamples);
+    QVERIFY(relativeError(algo.getSSSOLS(matDataClean), m_matDataIn) < m_dEpsilon);
+}
+
+
+//*************************************************************************************************************
+
+void TestRtSssAlgo::cachedOperatorMatchesUncached()
+{
+    RtSssAlgo algo;
+    buildOperator(algo, m_vecAllPicks, m_vecOrigin);
+
+    MatrixXd matOls = algo.getSSSOLS(m_matData);
+    MatrixXd matRR = algo.getSSSRR(m_matData);
+    MatrixXd matEqnIn = algo.getLinEqn()[0];
+    compareWithUncached(algo, m_vecAllPicks, m_vecOrigin);
+
+    //The head moved, this gives a new operator
+    Vector3d vecOriginMoved(0.005, -0.003, 0.046);
+    algo.setOrigin(vecOriginMoved);
+    algo.buildLinearEqn();
+    QVERIFY(relativeError(algo.getLinEqn()[0], matEqnIn) > m_dEpsilon);
+    compareWithUncached(algo, m_vecAllPicks, vecOriginMoved);
+
+    //Three channels were marked bad
+    RowVectorXi vecPicks(m_iNumChannels - 3);
+    for(int i = 0, k = 0; i < m_iNumChannels; ++i)
+        if(i != 5 && i != 42 && i != 99)
+            vecPicks(k++) = i;
+
+    algo.setMEGInfo(m_pFiffInfo, vecPicks);
+    algo.buildLinearEqn();
+    compareWithUncached(algo, vecPicks, vecOriginMoved);
+
+    //Back to the first configuration, which comes from the cache
+    algo.setMEGInfo(m_pFiffInfo, m_vecAllPicks);
+    algo.setOrigin(m_vecOrigin);
+    algo.buildLinearEqn();
+    QVERIFY(algo.getSSSOLS(m_matData) == matOls);
+    QVERIFY(algo.getSSSRR(m_matData) == matRR);
+    compareWithUncached(algo, m_vecAllPicks, m_vecOrigin);
+}
+
+
+//*************************************************************************************************************
+
+void TestRtSssAlgo::cacheEvictionKeepsResults()
+{
+    RtSssAlgo algo;
+    buildOperator(algo, m_vecAllPicks, m_vecOrigin);
+    MatrixXd matOls = algo.getSSSOLS(m_matData);
+
+    //More head positions than the cache holds
+    for(int i = 1; i <= SSS_OPERATOR_CACHE_SIZE + 2; ++i) {
+        algo.setOrigin(m_vecOrigin + Vector3d(0.0, 0.0, 0.001 * i));
+        algo.buildLinearEqn();
+    }
+
+    algo.setOrigin(m_vecOrigin);
+    algo.buildLinearEqn();
+    QVERIFY(relativeError(algo.getSSSOLS(m_matData), matOls) < m_dEpsilon);
+    compareWithUncached(algo, m_vecAllPicks, m_vecOrigin);
+}
+
+
+//*************************************************************************************************************
+
+void TestRtSssAlgo::cleanupTestCase()
+{
+}
+
+
+//*************************************************************************************************************
+//=============================================================================================================
+// MAIN
+//=============================================================================================================
+
+QTEST_GUILESS_MAIN(TestRtSssAlgo)
+#include "test_rtsss_algo.moc"
@@ -39,10 +39,22 @@ TEMPLATE = subdirs
 
 SUBDIRS += \
     test_codecov \
+    test_circular_buffer \
     test_dipole_fit \
     test_fiff_rwr \
+    test_fiff_raw_index \
+    test_fiff_write_raw \
+    test_fiff_raw_recorder \
+    test_rt_cov_accumulator \
+    test_rt_running_average \
+    test_rtsss_algo \
+    test_minimum_norm \
+    test_rap_music \
+    test_adaptive_mp \
+    test_fixdict_mp \
     test_fiff_mne_types_io \
     test_forward_solution \
+    test_fwd_bem_model \
     test_fiff_cov \
     test_fiff_digitizer \
     test_mne_msh_display_surface_set \
@@ -2,7 +2,7 @@
 cd bin
 
 :: Array of tests to run
-set tests=test_fiff_rwr test_dipole_fit test_fiff_mne_types_io test_fiff_cov test_fiff_digitizer test_mne_msh_display_surface_set test_geometryinfo  test_interpolation
+set tests=test_fiff_rwr test_fiff_raw_index test_fiff_write_raw test_fiff_raw_recorder test_circular_buffer test_rt_cov_accumulator test_rt_running_average test_rtsss_algo test_minimum_norm test_rap_music test_adaptive_mp test_fixdict_mp test_dipole_fit test_fwd_bem_model test_fiff_mne_types_io test_fiff_cov test_fiff_digitizer test_mne_msh_display_surface_set test_geometryinfo  test_interpolation
 
 :: Run tests
 (for %%t in (%tests%) do ( 